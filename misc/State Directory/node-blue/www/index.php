@@ -200,6 +200,7 @@ if(!$user->checkAuth(true)) die();
 <script src="vendor/ace/ace.js"></script>
 <script src="vendor/ace/ext-language_tools.js"></script>
 <script src="red/red.min.js"></script>
+<script src="red/nodestatistics.js"></script>
 <script src="red/main.min.js"></script>
 
 </body>
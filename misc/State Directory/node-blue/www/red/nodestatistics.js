@@ -0,0 +1,124 @@
+/**
+ * Copyright 2013-2017 Sathya Laufer
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+/**
+ * Sidebar tab listing the runtime statistics of all nodes ("getNodeStatistics"). The slowest nodes are shown first.
+ */
+RED.sidebar.nodeStatistics = (function() {
+    var refreshInterval = 5000;
+
+    var content = document.createElement("div");
+    content.className = "sidebar-node-statistics";
+    content.style.overflowY = "auto";
+
+    var table = $('<table class="node-info"></table>').appendTo(content);
+    var tableHead = $('<thead>').appendTo(table);
+    var tableBody = $('<tbody>').appendTo(table);
+
+    var toolbar = $('<div>'+
+        '<a class="sidebar-footer-button" id="node-statistics-refresh" href="#"><i class="fa fa-refresh"></i></a>'+
+        '</div>');
+
+    var refreshTimer = null;
+
+    function formatTime(microseconds) {
+        if (microseconds >= 1000000) {
+            return (microseconds / 1000000).toFixed(1) + " s";
+        } else if (microseconds >= 1000) {
+            return (microseconds / 1000).toFixed(1) + " ms";
+        }
+        return Math.round(microseconds) + " µs";
+    }
+
+    function refresh() {
+        RED.comms.homegear().invoke("getNodeStatistics", function(response) {
+            if (!response.result || response.error) {
+                return;
+            }
+            var rows = [];
+            for (var nodeId in response.result) {
+                if (response.result.hasOwnProperty(nodeId)) {
+                    var statistics = response.result[nodeId];
+                    if (statistics.inputs === 0 && statistics.outputs === 0 && statistics.errors === 0) {
+                        continue;
+                    }
+                    var node = RED.nodes.node(nodeId);
+                    rows.push({id: nodeId, label: node ? RED.utils.getNodeLabel(node, node.type) : nodeId, statistics: statistics});
+                }
+            }
+            rows.sort(function(a, b) {
+                return (b.statistics.p99ProcessingTime - a.statistics.p99ProcessingTime) || (b.statistics.meanProcessingTime - a.statistics.meanProcessingTime);
+            });
+
+            tableBody.empty();
+            rows.forEach(function(row) {
+                var tableRow = $('<tr class="node-info-node-row">').appendTo(tableBody);
+                $('<td>').append($('<a href="#">').text(row.label).click(function(e) {
+                    e.preventDefault();
+                    RED.view.reveal(row.id);
+                })).appendTo(tableRow);
+                $('<td>').text(row.statistics.inputs).appendTo(tableRow);
+                $('<td>').text(row.statistics.outputs).appendTo(tableRow);
+                $('<td>').text(row.statistics.errors).appendTo(tableRow);
+                $('<td>').text(formatTime(row.statistics.meanProcessingTime)).appendTo(tableRow);
+                $('<td>').text(formatTime(row.statistics.p99ProcessingTime)).appendTo(tableRow);
+                $('<td>').text(formatTime(row.statistics.meanMailboxWaitTime)).appendTo(tableRow);
+            });
+        });
+    }
+
+    function init() {
+        //The translations are loaded after this file, so the labels are set here.
+        var headerRow = $('<tr>').appendTo(tableHead);
+        ["node", "inputs", "outputs", "errors", "mean", "p99", "wait"].forEach(function(column) {
+            $('<th>').text(RED._("sidebar.nodeStatistics." + column)).appendTo(headerRow);
+        });
+
+        RED.sidebar.addTab({
+            id: "node-statistics",
+            label: RED._("sidebar.nodeStatistics.label"),
+            name: RED._("sidebar.nodeStatistics.name"),
+            content: content,
+            toolbar: toolbar,
+            enableOnEdit: true,
+            onchange: function() { refresh(); }
+        });
+
+        $("#node-statistics-refresh").on("click", function(e) {
+            e.preventDefault();
+            refresh();
+        });
+
+        //Only poll while the tab is shown.
+        refreshTimer = setInterval(function() {
+            if ($(content).is(":visible")) {
+                refresh();
+            }
+        }, refreshInterval);
+    }
+
+    //Added to the sidebar's own initialization, so the other sidebar tabs and main.js stay unchanged.
+    var sidebarInit = RED.sidebar.init;
+    RED.sidebar.init = function() {
+        sidebarInit.apply(this, arguments);
+        init();
+    };
+
+    return {
+        init: init,
+        refresh: refresh
+    }
+})();
@@ -690,11 +690,15 @@ BaseLib::PVariable CliServer::generalCommand(std::string& command)
 			stringStream << "runcommand (rc)      Executes a PHP command" << std::endl;
 			stringStream << "scriptcount (sc)     Returns the number of currently running scripts" << std::endl;
 			stringStream << "scriptsrunning (sr)  Returns the ID and filename of all running scripts" << std::endl;
+			stringStream << "scriptcache (scc)    Prints hit rates and memory usage of the script caches" << std::endl;
 #endif
+			stringStream << "warmpool (wp)        Shows and changes how many idle processes are kept running" << std::endl;
 			if(GD::bl->settings.enableNodeBlue())
 			{
 				stringStream << "flowcount (fc)     Restarts the number of currently running flows" << std::endl;
 				stringStream << "flowsrestart (fr)    Restarts all flows" << std::endl;
+				stringStream << "flowmailboxes (fm)   Lists the number of queued messages per node" << std::endl;
+				stringStream << "flowplacement (fpl)  Shows and changes how flows are assigned to processes" << std::endl;
 			}
 			stringStream << "users [COMMAND]      Execute user commands. Type \"users help\" for more information."
 						 << std::endl;
@@ -882,6 +886,40 @@ BaseLib::PVariable CliServer::generalCommand(std::string& command)
 							 << std::get<2>(script) << std::setw(80) << std::get<3>(script) << std::endl;
 			}
 
+			return std::make_shared<BaseLib::Variable>(stringStream.str());
+		}
+		else if(BaseLib::HelperFunctions::checkCliCommand(command, "scriptcache", "scc", "", 0, arguments, showHelp))
+		{
+			if(showHelp)
+			{
+				stringStream << "Description: This command prints the hit rates and memory usage of the decrypted script and value caches of each script engine process. Compiled opcodes are cached by OPcache and not included."
+							 << std::endl;
+				stringStream << "Usage: scriptcache" << std::endl << std::endl;
+				return std::make_shared<BaseLib::Variable>(stringStream.str());
+			}
+
+			BaseLib::PVariable statistics = GD::scriptEngineServer->getScriptCacheStatistics();
+			if(statistics->errorStruct) return statistics;
+			if(statistics->arrayValue->empty()) return std::make_shared<BaseLib::Variable>(std::string("No script engine processes are running.\n"));
+
+			stringStream << std::left << std::setfill(' ') << std::setw(10) << "PID" << std::setw(12) << "Hits"
+						 << std::setw(12) << "Misses" << std::setw(10) << "Hit rate" << std::setw(12) << "Evictions"
+						 << std::setw(15) << "Invalidations" << std::setw(10) << "Entries" << std::setw(14) << "Memory (KiB)" << std::setw(16) << "Value hit rate" << std::endl;
+			for(auto& process : *statistics->arrayValue)
+			{
+				stringStream << std::setw(10) << process->structValue->at("pid")->integerValue
+							 << std::setw(12) << process->structValue->at("hits")->integerValue64
+							 << std::setw(12) << process->structValue->at("misses")->integerValue64
+							 << std::setw(10) << (std::to_string((int32_t)(process->structValue->at("hitRate")->floatValue * 100)) + "%")
+							 << std::setw(12) << process->structValue->at("evictions")->integerValue64
+							 << std::setw(15) << process->structValue->at("invalidations")->integerValue64
+							 << std::setw(10) << process->structValue->at("entries")->integerValue64
+							 << std::setw(14) << (process->structValue->at("memoryUsage")->integerValue64 / 1024);
+				auto valueCacheIterator = process->structValue->find("valueCache");
+				if(valueCacheIterator != process->structValue->end() && !valueCacheIterator->second->errorStruct) stringStream << std::setw(16) << (std::to_string((int32_t)(valueCacheIterator->second->structValue->at("hitRate")->floatValue * 100)) + "%");
+				stringStream << std::endl;
+			}
+
 			return std::make_shared<BaseLib::Variable>(stringStream.str());
 		}
 #endif
@@ -898,6 +936,76 @@ BaseLib::PVariable CliServer::generalCommand(std::string& command)
 			if(GD::nodeBlueServer) stringStream << std::dec << GD::nodeBlueServer->flowCount() << std::endl;
 			return std::make_shared<BaseLib::Variable>(stringStream.str());
 		}
+		else if(BaseLib::HelperFunctions::checkCliCommand(command, "flowmailboxes", "fm", "", 0, arguments, showHelp))
+		{
+			if(showHelp)
+			{
+				stringStream << "Description: This command lists all nodes with queued messages and the number of messages in their mailboxes."
+							 << std::endl;
+				stringStream << "Usage: flowmailboxes" << std::endl << std::endl;
+				return std::make_shared<BaseLib::Variable>(stringStream.str());
+			}
+
+			if(!GD::nodeBlueServer) return std::make_shared<BaseLib::Variable>(std::string("Node-BLUE is not enabled.\n"));
+			BaseLib::PVariable mailboxes = GD::nodeBlueServer->getNodeMailboxes();
+			if(mailboxes->errorStruct) return std::make_shared<BaseLib::Variable>("Error: " + mailboxes->structValue->at("faultString")->stringValue + "\n");
+			if(mailboxes->structValue->empty()) return std::make_shared<BaseLib::Variable>(std::string("No messages are queued.\n"));
+
+			std::vector<std::pair<int64_t, std::string>> depths;
+			depths.reserve(mailboxes->structValue->size());
+			for(auto& mailbox : *mailboxes->structValue)
+			{
+				depths.emplace_back(mailbox.second->integerValue64, mailbox.first);
+			}
+			std::sort(depths.begin(), depths.end(), std::greater<std::pair<int64_t, std::string>>());
+
+			stringStream << std::left << std::setfill(' ') << std::setw(20) << "Node ID" << std::setw(10) << "Messages" << std::endl;
+			for(auto& depth : depths)
+			{
+				stringStream << std::setw(20) << depth.second << std::setw(10) << depth.first << std::endl;
+			}
+			return std::make_shared<BaseLib::Variable>(stringStream.str());
+		}
+		else if(BaseLib::HelperFunctions::checkCliCommand(command, "flowplacement", "fpl", "", 0, arguments, showHelp))
+		{
+			if(showHelp)
+			{
+				stringStream << "Description: This command lists the measured load of all running flows and the flows process they run in. With parameters it changes the placement policy used when flows are started."
+							 << std::endl;
+				stringStream << "Usage: flowplacement [policy POLICY|rebalance on|off]" << std::endl << std::endl;
+				stringStream << "Parameters:" << std::endl;
+				stringStream << "  POLICY:\t\"pack\" fills one process after the other, \"spread\" distributes flows by load, \"pinned\" places flows by their tab property \"process\"." << std::endl;
+				stringStream << "  rebalance:\tMove one flow from the most to the least loaded process on deploy (policy \"spread\" only)." << std::endl;
+				return std::make_shared<BaseLib::Variable>(stringStream.str());
+			}
+
+			if(!GD::nodeBlueServer) return std::make_shared<BaseLib::Variable>(std::string("Node-BLUE is not enabled.\n"));
+			if(arguments.size() >= 2 && arguments.at(0) == "policy")
+			{
+				if(!GD::nodeBlueServer->setPlacementPolicy(arguments.at(1))) return std::make_shared<BaseLib::Variable>(std::string("Unknown policy. Please use \"pack\", \"spread\" or \"pinned\".\n"));
+				stringStream << "Placement policy set to " << arguments.at(1) << ". It is used for all flows started from now on." << std::endl;
+				return std::make_shared<BaseLib::Variable>(stringStream.str());
+			}
+			else if(arguments.size() >= 2 && arguments.at(0) == "rebalance")
+			{
+				GD::nodeBlueServer->setRebalanceOnDeploy(arguments.at(1) == "on");
+				stringStream << "Rebalancing on deploy " << (arguments.at(1) == "on" ? "enabled" : "disabled") << "." << std::endl;
+				return std::make_shared<BaseLib::Variable>(stringStream.str());
+			}
+			else if(!arguments.empty()) return std::make_shared<BaseLib::Variable>(std::string("Invalid parameters. Type \"help flowplacement\" for more information.\n"));
+
+			BaseLib::PVariable placement = GD::nodeBlueServer->getFlowPlacement();
+			if(placement->errorStruct) return std::make_shared<BaseLib::Variable>("Error: " + placement->structValue->at("faultString")->stringValue + "\n");
+
+			stringStream << "Policy: " << placement->structValue->at("policy")->stringValue << std::endl;
+			stringStream << "Rebalance on deploy: " << (placement->structValue->at("rebalanceOnDeploy")->booleanValue ? "on" : "off") << std::endl << std::endl;
+			stringStream << std::left << std::setfill(' ') << std::setw(20) << "Flow ID" << std::setw(10) << "PID" << std::setw(10) << "Load (%)" << std::setw(14) << "Messages/s" << "Pin" << std::endl;
+			for(auto& flow : *placement->structValue->at("flows")->structValue)
+			{
+				stringStream << std::setw(20) << flow.first << std::setw(10) << flow.second->structValue->at("pid")->integerValue << std::setw(10) << std::fixed << std::setprecision(1) << flow.second->structValue->at("load")->floatValue * 100 << std::setw(14) << flow.second->structValue->at("messageRate")->floatValue << flow.second->structValue->at("pin")->stringValue << std::endl;
+			}
+			return std::make_shared<BaseLib::Variable>(stringStream.str());
+		}
 		else if(BaseLib::HelperFunctions::checkCliCommand(command, "flowsrestart", "fr", "", 0, arguments, showHelp))
 		{
 			if(showHelp)
@@ -913,6 +1021,60 @@ BaseLib::PVariable CliServer::generalCommand(std::string& command)
 
 			return std::make_shared<BaseLib::Variable>(stringStream.str());
 		}
+		else if(BaseLib::HelperFunctions::checkCliCommand(command, "warmpool", "wp", "", 0, arguments, showHelp))
+		{
+			if(showHelp)
+			{
+				stringStream << "Description: This command shows the number of idle processes kept running by the script engine and Node-BLUE. With parameters it changes them."
+							 << std::endl;
+				stringStream << "Usage: warmpool [scriptengine|nodeblue MIN MAX IDLETIMEOUT]" << std::endl << std::endl;
+				stringStream << "Parameters:" << std::endl;
+				stringStream << "  MIN:\t\tThe number of idle processes that are always kept running." << std::endl;
+				stringStream << "  MAX:\t\tThe maximum number of idle processes. Idle processes above this limit are stopped immediately." << std::endl;
+				stringStream << "  IDLETIMEOUT:\tThe time in milliseconds after which idle processes above MIN are stopped." << std::endl;
+				return std::make_shared<BaseLib::Variable>(stringStream.str());
+			}
+
+			if(arguments.size() == 4)
+			{
+				int32_t minSize = BaseLib::Math::getNumber(arguments.at(1), false);
+				int32_t maxSize = BaseLib::Math::getNumber(arguments.at(2), false);
+				int64_t idleTimeout = BaseLib::Math::getNumber64(arguments.at(3), false);
+				if(minSize < 0 || maxSize < 0) return std::make_shared<BaseLib::Variable>(std::string("Invalid parameters. Type \"help warmpool\" for more information.\n"));
+				bool result = false;
+				if(arguments.at(0) == "scriptengine")
+				{
+#ifndef NO_SCRIPTENGINE
+					result = GD::scriptEngineServer->setWarmPool(minSize, maxSize, idleTimeout);
+#else
+					return std::make_shared<BaseLib::Variable>(std::string("The script engine is not enabled.\n"));
+#endif
+				}
+				else if(arguments.at(0) == "nodeblue")
+				{
+					if(!GD::nodeBlueServer) return std::make_shared<BaseLib::Variable>(std::string("Node-BLUE is not enabled.\n"));
+					result = GD::nodeBlueServer->setWarmPool(minSize, maxSize, idleTimeout);
+				}
+				else return std::make_shared<BaseLib::Variable>(std::string("Invalid parameters. Type \"help warmpool\" for more information.\n"));
+				if(!result) return std::make_shared<BaseLib::Variable>(std::string("MIN must not be greater than MAX and IDLETIMEOUT must not be negative.\n"));
+				stringStream << "Warm pool settings changed." << std::endl;
+				return std::make_shared<BaseLib::Variable>(stringStream.str());
+			}
+			else if(!arguments.empty()) return std::make_shared<BaseLib::Variable>(std::string("Invalid parameters. Type \"help warmpool\" for more information.\n"));
+
+			stringStream << std::left << std::setfill(' ') << std::setw(14) << "Component" << std::setw(6) << "Min" << std::setw(6) << "Max" << "Idle timeout (ms)" << std::endl;
+			std::vector<std::pair<std::string, BaseLib::PVariable>> warmPools;
+#ifndef NO_SCRIPTENGINE
+			warmPools.emplace_back("scriptengine", GD::scriptEngineServer->getWarmPool());
+#endif
+			if(GD::nodeBlueServer) warmPools.emplace_back("nodeblue", GD::nodeBlueServer->getWarmPool());
+			for(auto& warmPool : warmPools)
+			{
+				if(warmPool.second->errorStruct) continue;
+				stringStream << std::setw(14) << warmPool.first << std::setw(6) << warmPool.second->structValue->at("minSize")->integerValue << std::setw(6) << warmPool.second->structValue->at("maxSize")->integerValue << warmPool.second->structValue->at("idleTimeout")->integerValue64 << std::endl;
+			}
+			return std::make_shared<BaseLib::Variable>(stringStream.str());
+		}
 		else if(command.compare(0, 10, "rpcclients") == 0 || command.compare(0, 3, "rcl") == 0)
 		{
 			std::stringstream stream(command);
@@ -43,6 +43,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
 #include <thread>
 #include <mutex>
 #include <vector>
@@ -42,6 +42,7 @@
 #include "../Systems/UiController.h"
 #include "../RPC/RpcServer.h"
 #include "../RPC/Client.h"
+#include "../RPC/RpcMetrics.h"
 #include "../MQTT/Mqtt.h"
 #include <homegear-base/BaseLib.h>
 
@@ -82,6 +83,7 @@ public:
 	static std::unique_ptr<NodeBlue::NodeBlueServer> nodeBlueServer;
 	static BaseLib::Rpc::ServerInfo serverInfo;
 	static Rpc::ClientSettings clientSettings;
+	static Rpc::RpcMetrics rpcMetrics;
 	static int32_t rpcLogLevel;
 	static std::map<int32_t, std::unique_ptr<BaseLib::Licensing::Licensing>> licensingModules;
 	static std::unique_ptr<UPnP> uPnP;
@@ -0,0 +1,203 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "EpollReactor.h"
+#include "../GD/GD.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace Homegear
+{
+
+const uint64_t EpollReactor::serverToken;
+
+EpollReactor::EpollReactor()
+{
+}
+
+EpollReactor::~EpollReactor()
+{
+	if(_epollDescriptor != -1) close(_epollDescriptor);
+}
+
+bool EpollReactor::init(uint32_t maxEvents)
+{
+	if(_epollDescriptor != -1) return true;
+	_epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+	if(_epollDescriptor == -1)
+	{
+		GD::out.printCritical("Critical: Could not create epoll instance: " + std::string(strerror(errno)));
+		return false;
+	}
+	_events.resize(maxEvents == 0 ? 1 : maxEvents);
+	_readyTokens.reserve(_events.size());
+	return true;
+}
+
+bool EpollReactor::add(int32_t descriptor, uint64_t token, bool edgeTriggered)
+{
+	if(_epollDescriptor == -1 || descriptor == -1) return false;
+	epoll_event event{};
+	event.events = EPOLLIN | EPOLLRDHUP;
+	if(edgeTriggered) event.events |= EPOLLET;
+	event.data.u64 = token;
+	if(epoll_ctl(_epollDescriptor, EPOLL_CTL_ADD, descriptor, &event) == -1)
+	{
+		if(errno == EEXIST && epoll_ctl(_epollDescriptor, EPOLL_CTL_MOD, descriptor, &event) == 0) return true;
+		GD::out.printError("Error: Could not add descriptor " + std::to_string(descriptor) + " to epoll: " + std::string(strerror(errno)));
+		return false;
+	}
+	return true;
+}
+
+void EpollReactor::remove(int32_t descriptor)
+{
+	if(_epollDescriptor == -1 || descriptor == -1) return;
+	epoll_ctl(_epollDescriptor, EPOLL_CTL_DEL, descriptor, nullptr);
+}
+
+const std::vector<uint64_t>& EpollReactor::wait(int32_t timeout)
+{
+	_readyTokens.clear();
+	if(_epollDescriptor == -1) return _readyTokens;
+	int32_t count = epoll_wait(_epollDescriptor, _events.data(), (int32_t)_events.size(), timeout);
+	if(count == -1)
+	{
+		if(errno != EINTR) GD::out.printError("Error: epoll_wait returned -1: " + std::string(strerror(errno)));
+		return _readyTokens;
+	}
+	for(int32_t i = 0; i < count; i++)
+	{
+		_readyTokens.push_back(_events[i].data.u64);
+	}
+	return _readyTokens;
+}
+
+void EpollReactor::run(const std::atomic_bool& stop, const Callbacks& callbacks)
+{
+	try
+	{
+		int32_t serverFileDescriptorId = -1;
+		_pendingTokens.clear();
+		while(!stop)
+		{
+			std::shared_ptr<BaseLib::FileDescriptor> serverFileDescriptor = callbacks.getServerFileDescriptor();
+			if(!serverFileDescriptor || serverFileDescriptor->descriptor == -1)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+				continue;
+			}
+
+			if(serverFileDescriptor->id != serverFileDescriptorId)
+			{
+				//The listening socket was (re)created.
+				if(!add(serverFileDescriptor->descriptor, serverToken, false))
+				{
+					std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+					continue;
+				}
+				serverFileDescriptorId = serverFileDescriptor->id;
+			}
+
+			//Don't wait when clients are left over from the last turn.
+			auto& readyTokens = wait(_pendingTokens.empty() ? 100 : 0);
+			if(readyTokens.empty() && _pendingTokens.empty())
+			{
+				if(callbacks.idle) callbacks.idle();
+				continue;
+			}
+
+			_turnTokens.swap(_pendingTokens);
+			_pendingTokens.clear();
+			_scheduledTokens.clear();
+			_scheduledTokens.insert(_turnTokens.begin(), _turnTokens.end());
+			for(auto token : readyTokens)
+			{
+				if(_scheduledTokens.insert(token).second) _turnTokens.push_back(token);
+			}
+
+			for(auto token : _turnTokens)
+			{
+				if(stop) break;
+				if(token == serverToken)
+				{
+					acceptClients(serverFileDescriptor, stop, callbacks);
+					continue;
+				}
+
+				int32_t reads = 0;
+				while(!stop && callbacks.readClient(token))
+				{
+					if(++reads == MAX_READS_PER_TURN)
+					{
+						//Edge triggered, so there won't be another event for the remaining data.
+						_pendingTokens.push_back(token);
+						break;
+					}
+				}
+			}
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void EpollReactor::acceptClients(std::shared_ptr<BaseLib::FileDescriptor>& serverFileDescriptor, const std::atomic_bool& stop, const Callbacks& callbacks)
+{
+	//The listening socket is non-blocking, so accept until there are no more pending connections.
+	while(!stop)
+	{
+		sockaddr_un clientAddress{};
+		socklen_t addressSize = sizeof(clientAddress);
+		int32_t descriptor = accept(serverFileDescriptor->descriptor, (struct sockaddr*) &clientAddress, &addressSize);
+		if(descriptor == -1)
+		{
+			if(errno == EINTR) continue;
+			if(errno != EAGAIN && errno != EWOULDBLOCK) GD::out.printError("Error: Could not accept client: " + std::string(strerror(errno)));
+			return;
+		}
+		std::shared_ptr<BaseLib::FileDescriptor> clientFileDescriptor = GD::bl->fileDescriptorManager.add(descriptor);
+		if(!clientFileDescriptor || clientFileDescriptor->descriptor == -1) continue;
+		callbacks.clientAccepted(clientFileDescriptor);
+	}
+}
+
+}
@@ -0,0 +1,156 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef EPOLLREACTOR_H_
+#define EPOLLREACTOR_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include <cstdint>
+#include <sys/epoll.h>
+
+namespace Homegear
+{
+
+/**
+ * The epoll based accept and read loop shared by the Unix domain socket servers (IPC, script engine and Node-BLUE).
+ * Descriptors are registered once when they are accepted instead of rebuilding an fd_set on every loop iteration, so the
+ * cost of a wait doesn't depend on the number of connected clients and there is no FD_SETSIZE limit.
+ *
+ * Client descriptors are registered edge triggered, so a client is read until the socket returns EAGAIN. To keep one busy
+ * client from starving the others, a client is read at most MAX_READS_PER_TURN times per turn and continued in the next
+ * turn. Descriptors are removed automatically by the kernel when they are closed.
+ */
+class EpollReactor
+{
+public:
+	/**
+	 * The token returned for the listening socket.
+	 */
+	static const uint64_t serverToken = UINT64_MAX;
+
+	/**
+	 * The maximum number of reads of one client per turn.
+	 */
+	static const int32_t MAX_READS_PER_TURN = 16;
+
+	struct Callbacks
+	{
+		/**
+		 * Returns the listening socket and (re)creates it if necessary. When no valid descriptor is returned, the reactor
+		 * waits one second before calling it again.
+		 */
+		std::function<std::shared_ptr<BaseLib::FileDescriptor>()> getServerFileDescriptor;
+
+		/**
+		 * Is called for every accepted connection. The server either creates the client and registers the descriptor with
+		 * add() using the client ID as token or closes the descriptor.
+		 */
+		std::function<void(std::shared_ptr<BaseLib::FileDescriptor>& clientFileDescriptor)> clientAccepted;
+
+		/**
+		 * Reads and processes one chunk of data of the client registered with "token".
+		 *
+		 * @return Returns true when more data might be available.
+		 */
+		std::function<bool(uint64_t token)> readClient;
+
+		/**
+		 * Is called when nothing happened during one wait, e.g. to collect garbage.
+		 */
+		std::function<void()> idle;
+	};
+
+	EpollReactor();
+
+	virtual ~EpollReactor();
+
+	/**
+	 * Creates the epoll instance. Must be called before any other method.
+	 *
+	 * @param maxEvents The maximum number of events returned by one call to wait().
+	 * @return Returns true on success.
+	 */
+	bool init(uint32_t maxEvents = 64);
+
+	/**
+	 * Registers a descriptor for read events.
+	 *
+	 * @param descriptor The descriptor to watch.
+	 * @param token The value returned by wait() when the descriptor becomes readable, e.g. the client ID.
+	 * @param edgeTriggered Set to true to register the descriptor with EPOLLET.
+	 * @return Returns true on success.
+	 */
+	bool add(int32_t descriptor, uint64_t token, bool edgeTriggered);
+
+	void remove(int32_t descriptor);
+
+	/**
+	 * Waits for read events.
+	 *
+	 * @param timeout The maximum time to wait in milliseconds.
+	 * @return Returns the tokens of all readable descriptors. The vector is reused between calls.
+	 */
+	const std::vector<uint64_t>& wait(int32_t timeout);
+
+	/**
+	 * Runs the accept and read loop of a server until "stop" is set. init() must have been called before.
+	 */
+	void run(const std::atomic_bool& stop, const Callbacks& callbacks);
+private:
+	int32_t _epollDescriptor = -1;
+	std::vector<epoll_event> _events;
+	std::vector<uint64_t> _readyTokens;
+
+	/**
+	 * Clients that still had data at the end of their turn.
+	 */
+	std::vector<uint64_t> _pendingTokens;
+	std::vector<uint64_t> _turnTokens;
+	std::unordered_set<uint64_t> _scheduledTokens;
+
+	/**
+	 * Accepts all pending connections of the non-blocking listening socket.
+	 */
+	void acceptClients(std::shared_ptr<BaseLib::FileDescriptor>& serverFileDescriptor, const std::atomic_bool& stop, const Callbacks& callbacks);
+
+	EpollReactor(const EpollReactor&) = delete;
+	EpollReactor& operator=(const EpollReactor&) = delete;
+};
+
+}
+
+#endif
@@ -30,6 +30,7 @@
 
 #include "IpcClientData.h"
 #include "../GD/GD.h"
+#include "Wildcard.h"
 
 namespace Homegear
 {
@@ -55,6 +56,24 @@ void IpcClientData::init()
 {
 	binaryRpc = std::unique_ptr<BaseLib::Rpc::BinaryRpc>(new BaseLib::Rpc::BinaryRpc(GD::bl.get()));
 	buffer.resize(1024);
+	filterEvents = false;
+	deliveredEvents = 0;
+	filteredEvents = 0;
+}
+
+bool IpcClientData::eventSubscriptionMatches(uint64_t peerId, int32_t channel, const std::string& variable)
+{
+	for(auto& subscription : eventSubscriptions)
+	{
+		if(!subscription.second.peers.empty() && subscription.second.peers.find(peerId) == subscription.second.peers.end()) continue;
+		if(!subscription.second.channels.empty() && subscription.second.channels.find(channel) == subscription.second.channels.end()) continue;
+		if(subscription.second.variables.empty()) return true;
+		for(auto& pattern : subscription.second.variables)
+		{
+			if(Wildcard::match(pattern, variable)) return true;
+		}
+	}
+	return false;
 }
 
 }
\ No newline at end of file
@@ -44,6 +44,13 @@ private:
 	void init();
 
 public:
+	struct EventSubscription
+	{
+		std::set<uint64_t> peers;
+		std::set<int32_t> channels;
+		std::vector<std::string> variables;
+	};
+
 	int32_t id = 0;
 	bool closed = false;
 	std::vector<char> buffer;
@@ -55,6 +62,24 @@ public:
 	std::unordered_map<int32_t, PIpcResponse> rpcResponses;
 	std::condition_variable requestConditionVariable;
 
+	// {{{ Event subscriptions
+	/**
+	 * Set to true by the first call to "subscribeEvents" or "unsubscribeEvents". Until then the client receives all events.
+	 */
+	std::atomic_bool filterEvents;
+	std::mutex eventSubscriptionsMutex;
+	int32_t currentEventSubscriptionId = 0;
+	std::map<int32_t, EventSubscription> eventSubscriptions;
+	std::atomic<uint64_t> deliveredEvents;
+	std::atomic<uint64_t> filteredEvents;
+
+	/**
+	 * Checks if a variable matches at least one of the client's event subscriptions. Needs to be called with
+	 * eventSubscriptionsMutex locked.
+	 */
+	bool eventSubscriptionMatches(uint64_t peerId, int32_t channel, const std::string& variable);
+	// }}}
+
 	IpcClientData();
 
 	IpcClientData(std::shared_ptr<BaseLib::FileDescriptor> clientFileDescriptor);
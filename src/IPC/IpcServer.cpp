@@ -103,8 +103,10 @@ IpcServer::IpcServer() : IQueue(GD::bl.get(), 3, 100000)
 	_rpcMethods.emplace("getParamsetDescription", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetParamsetDescription()));
 	_rpcMethods.emplace("getParamsetId", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetParamsetId()));
 	_rpcMethods.emplace("getPeerId", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetPeerId()));
+	_rpcMethods.emplace("getRpcMetrics", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetRpcMetrics()));
 	_rpcMethods.emplace("getServiceMessages", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetServiceMessages()));
 	_rpcMethods.emplace("getSystemVariable", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetSystemVariable()));
+	_rpcMethods.emplace("getTlsMetrics", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetTlsMetrics()));
 	_rpcMethods.emplace("getUpdateStatus", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetUpdateStatus()));
 	_rpcMethods.emplace("getValue", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetValue()));
 	_rpcMethods.emplace("getVariableDescription", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetVariableDescription()));
@@ -132,6 +134,7 @@ IpcServer::IpcServer() : IQueue(GD::bl.get(), 3, 100000)
 	_rpcMethods.emplace("searchDevices", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSearchDevices()));
 	_rpcMethods.emplace("searchInterfaces", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSearchInterfaces()));
 	_rpcMethods.emplace("setData", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetData()));
+	_rpcMethods.emplace("setEventRateLimit", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetEventRateLimit()));
 	_rpcMethods.emplace("setGlobalServiceMessage", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetGlobalServiceMessage()));
 	_rpcMethods.emplace("setId", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetId()));
 	_rpcMethods.emplace("setInstallMode", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetInstallMode()));
@@ -147,9 +150,11 @@ IpcServer::IpcServer() : IQueue(GD::bl.get(), 3, 100000)
 	_rpcMethods.emplace("setSystemVariable", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetSystemVariable()));
 	_rpcMethods.emplace("setTeam", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetTeam()));
 	_rpcMethods.emplace("setValue", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetValue()));
+	_rpcMethods.emplace("subscribeEvents", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSubscribeEvents()));
 	_rpcMethods.emplace("subscribePeers", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSubscribePeers()));
 	_rpcMethods.emplace("triggerEvent", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCTriggerEvent()));
 	_rpcMethods.emplace("triggerRpcEvent", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCTriggerRpcEvent()));
+	_rpcMethods.emplace("unsubscribeEvents", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCUnsubscribeEvents()));
 	_rpcMethods.emplace("unsubscribePeers", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCUnsubscribePeers()));
 	_rpcMethods.emplace("updateFirmware", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCUpdateFirmware()));
 	_rpcMethods.emplace("writeLog", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCWriteLog()));
@@ -219,10 +224,23 @@ IpcServer::IpcServer() : IQueue(GD::bl.get(), 3, 100000)
 
 	_localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(PIpcClientData& clientData, int32_t scriptId, BaseLib::PArray& parameters)>>("getClientId", std::bind(&IpcServer::getClientId, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
 	_localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(PIpcClientData& clientData, int32_t scriptId, BaseLib::PArray& parameters)>>("registerRpcMethod", std::bind(&IpcServer::registerRpcMethod, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+	_localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(PIpcClientData& clientData, int32_t scriptId, BaseLib::PArray& parameters)>>("subscribeEvents", std::bind(&IpcServer::subscribeEvents, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+	_localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(PIpcClientData& clientData, int32_t scriptId, BaseLib::PArray& parameters)>>("unsubscribeEvents", std::bind(&IpcServer::unsubscribeEvents, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+	_localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(PIpcClientData& clientData, int32_t scriptId, BaseLib::PArray& parameters)>>("getEventStatistics", std::bind(&IpcServer::getEventStatistics, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
 	_localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(PIpcClientData& clientData, int32_t scriptId, BaseLib::PArray& parameters)>>("cliGeneralCommand", std::bind(&IpcServer::cliGeneralCommand, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
 	_localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(PIpcClientData& clientData, int32_t scriptId, BaseLib::PArray& parameters)>>("cliFamilyCommand", std::bind(&IpcServer::cliFamilyCommand, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
 	_localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(PIpcClientData& clientData, int32_t scriptId, BaseLib::PArray& parameters)>>("cliPeerCommand", std::bind(&IpcServer::cliPeerCommand, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
     _localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(PIpcClientData& clientData, int32_t scriptId, BaseLib::PArray& parameters)>>("ptyOutput", std::bind(&IpcServer::ptyOutput, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+
+	//Resolve the metrics entries once, so calls only need atomic increments
+	for(auto& method : _rpcMethods)
+	{
+		_methodMetrics.emplace(method.first, GD::rpcMetrics.getMethodMetrics(Rpc::RpcMetrics::Direction::incoming, Rpc::RpcMetrics::Transport::ipc, method.first));
+	}
+	for(auto& method : _localRpcMethods)
+	{
+		_methodMetrics.emplace(method.first, GD::rpcMetrics.getMethodMetrics(Rpc::RpcMetrics::Direction::incoming, Rpc::RpcMetrics::Transport::ipc, method.first));
+	}
 }
 
 IpcServer::~IpcServer()
@@ -285,6 +303,7 @@ bool IpcServer::start()
 		_socketPath = GD::bl->settings.socketPath() + "homegearIPC.sock";
 		_shuttingDown = false;
 		_stopServer = false;
+		if(!_reactor.init()) return false;
 		if(!getFileDescriptor(true)) return false;
 		uint32_t ipcThreadCount = GD::bl->settings.ipcThreadCount();
 		if(ipcThreadCount < 5) ipcThreadCount = 5;
@@ -452,17 +471,56 @@ void IpcServer::broadcastEvent(std::string& source, uint64_t id, int32_t channel
 			}
 		}
 
+		BaseLib::PArray allParameters; //Shared by all clients receiving the unfiltered event. The parameters are not modified by the queue.
 		for(std::vector<PIpcClientData>::iterator i = clients.begin(); i != clients.end(); ++i)
 		{
-			auto parameters = std::make_shared<BaseLib::Array>();
-			parameters->reserve(5);
-			parameters->emplace_back(std::make_shared<BaseLib::Variable>(source));
-			parameters->emplace_back(std::make_shared<BaseLib::Variable>(id));
-			parameters->emplace_back(std::make_shared<BaseLib::Variable>(channel));
-			parameters->emplace_back(std::make_shared<BaseLib::Variable>(*variables));
-			parameters->emplace_back(std::make_shared<BaseLib::Variable>(values));
+			BaseLib::PArray parameters;
+			if((*i)->filterEvents)
+			{
+				std::vector<std::string> filteredVariables;
+				BaseLib::PArray filteredValues = std::make_shared<BaseLib::Array>();
+				{
+					std::lock_guard<std::mutex> eventSubscriptionsGuard((*i)->eventSubscriptionsMutex);
+					for(int32_t j = 0; j < (int32_t)variables->size() && j < (int32_t)values->size(); j++)
+					{
+						if(!(*i)->eventSubscriptionMatches(id, channel, variables->at(j))) continue;
+						filteredVariables.push_back(variables->at(j));
+						filteredValues->push_back(values->at(j));
+					}
+				}
+				if(filteredVariables.empty())
+				{
+					(*i)->filteredEvents++;
+					continue;
+				}
+				if(filteredVariables.size() != variables->size())
+				{
+					parameters = std::make_shared<BaseLib::Array>();
+					parameters->reserve(5);
+					parameters->emplace_back(std::make_shared<BaseLib::Variable>(source));
+					parameters->emplace_back(std::make_shared<BaseLib::Variable>(id));
+					parameters->emplace_back(std::make_shared<BaseLib::Variable>(channel));
+					parameters->emplace_back(std::make_shared<BaseLib::Variable>(filteredVariables));
+					parameters->emplace_back(std::make_shared<BaseLib::Variable>(filteredValues));
+				}
+			}
+			if(!parameters)
+			{
+				if(!allParameters)
+				{
+					allParameters = std::make_shared<BaseLib::Array>();
+					allParameters->reserve(5);
+					allParameters->emplace_back(std::make_shared<BaseLib::Variable>(source));
+					allParameters->emplace_back(std::make_shared<BaseLib::Variable>(id));
+					allParameters->emplace_back(std::make_shared<BaseLib::Variable>(channel));
+					allParameters->emplace_back(std::make_shared<BaseLib::Variable>(*variables));
+					allParameters->emplace_back(std::make_shared<BaseLib::Variable>(values));
+				}
+				parameters = allParameters;
+			}
 			std::shared_ptr<BaseLib::IQueueEntry> queueEntry = std::make_shared<QueueEntry>(*i, "broadcastEvent", parameters);
 			if(!enqueue(2, queueEntry)) printQueueFullError(_out, "Error: Could not queue RPC method call \"broadcastEvent\". Queue is full.");
+			else (*i)->deliveredEvents++;
 		}
 	}
 	catch(const std::exception& ex)
@@ -773,7 +831,9 @@ void IpcServer::processQueueEntry(int32_t index, std::shared_ptr<BaseLib::IQueue
 							}
 						}
 					}
+					int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
 					BaseLib::PVariable result = localMethodIterator->second(queueEntry->clientData, parameters->at(0)->integerValue, parameters->at(2)->arrayValue);
+					Rpc::RpcMetrics::record(_methodMetrics, methodName, BaseLib::HelperFunctions::getTimeMicroseconds() - startTime, result->errorStruct);
 					if(GD::bl->debugLevel >= 5)
 					{
 						_out.printDebug("Response: ");
@@ -800,7 +860,9 @@ void IpcServer::processQueueEntry(int32_t index, std::shared_ptr<BaseLib::IQueue
 						(*i)->print(true, false);
 					}
 				}
+				int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
 				BaseLib::PVariable result = _rpcMethods.at(methodName)->invoke(_dummyClientInfo, parameters->at(2)->arrayValue);
+				Rpc::RpcMetrics::record(_methodMetrics, methodName, BaseLib::HelperFunctions::getTimeMicroseconds() - startTime, result->errorStruct);
 				if(GD::bl->debugLevel >= 5)
 				{
 					_out.printDebug("Response: ");
@@ -996,119 +1058,83 @@ void IpcServer::mainThread()
 {
 	try
 	{
-		int32_t result = 0;
-		std::shared_ptr<BaseLib::FileDescriptor> clientFileDescriptor;
-		while(!_stopServer)
+		EpollReactor::Callbacks callbacks;
+		callbacks.getServerFileDescriptor = [this]() -> std::shared_ptr<BaseLib::FileDescriptor>
 		{
-			if(!_serverFileDescriptor || _serverFileDescriptor->descriptor == -1)
-			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-				getFileDescriptor();
-				continue;
-			}
-
-			timeval timeout;
-			timeout.tv_sec = 0;
-			timeout.tv_usec = 100000;
-			fd_set readFileDescriptor;
-			int32_t maxfd = 0;
-			FD_ZERO(&readFileDescriptor);
-			{
-				std::vector<PIpcClientData> clients;
-				{
-					std::lock_guard<std::mutex> stateGuard(_stateMutex);
-					clients.reserve(_clients.size());
-					for(auto& client : _clients)
-					{
-						if(client.second->closed) continue;
-						if(client.second->fileDescriptor->descriptor == -1)
-						{
-							client.second->closed = true;
-							continue;
-						}
-						clients.push_back(client.second);
-					}
-				}
-
-				auto fileDescriptorGuard = GD::bl->fileDescriptorManager.getLock();
-				fileDescriptorGuard.lock();
-				maxfd = _serverFileDescriptor->descriptor;
-				FD_SET(_serverFileDescriptor->descriptor, &readFileDescriptor);
-
-				for(auto& client : clients)
-				{
-					int32_t descriptor = client->fileDescriptor->descriptor;
-					if(descriptor == -1) continue; //Never pass -1 to FD_SET => undefined behaviour. This is just a safety precaution, because the file descriptor manager is locked and descriptors shouldn't be modified.
-					FD_SET(descriptor, &readFileDescriptor);
-					if(descriptor > maxfd) maxfd = descriptor;
-				}
-			}
-
-			result = select(maxfd + 1, &readFileDescriptor, NULL, NULL, &timeout);
-			if(result == 0)
+			if(!_serverFileDescriptor || _serverFileDescriptor->descriptor == -1) getFileDescriptor();
+			return _serverFileDescriptor;
+		};
+		callbacks.clientAccepted = std::bind(&IpcServer::clientAccepted, this, std::placeholders::_1);
+		callbacks.readClient = [this](uint64_t token) -> bool
+		{
+			PIpcClientData clientData;
 			{
-				if(GD::bl->hf.getTime() - _lastGargabeCollection > 60000 || _clients.size() > GD::bl->settings.ipcServerMaxConnections() * 100 / 112) collectGarbage();
-				continue;
+				std::lock_guard<std::mutex> stateGuard(_stateMutex);
+				auto clientIterator = _clients.find((int32_t)token);
+				if(clientIterator == _clients.end()) return false;
+				clientData = clientIterator->second;
 			}
-			else if(result == -1)
+			if(clientData->closed) return false;
+			if(clientData->fileDescriptor->descriptor == -1)
 			{
-				if(errno == EINTR) continue;
-				_out.printError("Error: select returned -1: " + std::string(strerror(errno)));
-				continue;
+				clientData->closed = true;
+				return false;
 			}
+			return readClient(clientData);
+		};
+		callbacks.idle = [this]()
+		{
+			if(GD::bl->hf.getTime() - _lastGargabeCollection > 60000 || _clients.size() > GD::bl->settings.ipcServerMaxConnections() * 100 / 112) collectGarbage();
+		};
 
-			if(FD_ISSET(_serverFileDescriptor->descriptor, &readFileDescriptor) && !_shuttingDown)
-			{
-				sockaddr_un clientAddress;
-				socklen_t addressSize = sizeof(addressSize);
-				std::shared_ptr<BaseLib::FileDescriptor> clientFileDescriptor = GD::bl->fileDescriptorManager.add(accept(_serverFileDescriptor->descriptor, (struct sockaddr*) &clientAddress, &addressSize));
-				if(!clientFileDescriptor || clientFileDescriptor->descriptor == -1) continue;
-				_out.printInfo("Info: Connection accepted. Client number: " + std::to_string(clientFileDescriptor->id));
-
-				if(_clients.size() > GD::bl->settings.ipcServerMaxConnections())
-				{
-					collectGarbage();
-					if(_clients.size() > GD::bl->settings.ipcServerMaxConnections())
-					{
-						_out.printError("Error: There are too many clients connected to me. Closing connection. You can increase the number of allowed connections in main.conf.");
-						GD::bl->fileDescriptorManager.close(clientFileDescriptor);
-						continue;
-					}
-				}
+		_reactor.run(_stopServer, callbacks);
+		GD::bl->fileDescriptorManager.close(_serverFileDescriptor);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
 
-				std::lock_guard<std::mutex> stateGuard(_stateMutex);
-				if(_shuttingDown)
-				{
-					GD::bl->fileDescriptorManager.close(clientFileDescriptor);
-					continue;
-				}
-				PIpcClientData clientData = std::make_shared<IpcClientData>(clientFileDescriptor);
-				clientData->id = _currentClientId++;
-				_clients.emplace(clientData->id, clientData);
-				continue;
-			}
+void IpcServer::clientAccepted(std::shared_ptr<BaseLib::FileDescriptor>& clientFileDescriptor)
+{
+	try
+	{
+		_out.printInfo("Info: Connection accepted. Client number: " + std::to_string(clientFileDescriptor->id));
 
-			PIpcClientData clientData;
+		if(_clients.size() > GD::bl->settings.ipcServerMaxConnections())
+		{
+			collectGarbage();
+			if(_clients.size() > GD::bl->settings.ipcServerMaxConnections())
 			{
-				std::lock_guard<std::mutex> stateGuard(_stateMutex);
-				for(std::map<int32_t, PIpcClientData>::iterator i = _clients.begin(); i != _clients.end(); ++i)
-				{
-					if(i->second->fileDescriptor->descriptor == -1)
-					{
-						i->second->closed = true;
-						continue;
-					}
-					if(FD_ISSET(i->second->fileDescriptor->descriptor, &readFileDescriptor))
-					{
-						clientData = i->second;
-						break;
-					}
-				}
+				_out.printError("Error: There are too many clients connected to me. Closing connection. You can increase the number of allowed connections in main.conf.");
+				GD::bl->fileDescriptorManager.close(clientFileDescriptor);
+				return;
 			}
+		}
 
-			if(clientData) readClient(clientData);
+		std::lock_guard<std::mutex> stateGuard(_stateMutex);
+		if(_shuttingDown)
+		{
+			GD::bl->fileDescriptorManager.close(clientFileDescriptor);
+			return;
 		}
-		GD::bl->fileDescriptorManager.close(_serverFileDescriptor);
+		PIpcClientData clientData = std::make_shared<IpcClientData>(clientFileDescriptor);
+		clientData->id = _currentClientId++;
+		if(!_reactor.add(clientFileDescriptor->descriptor, (uint64_t)clientData->id, true))
+		{
+			GD::bl->fileDescriptorManager.close(clientFileDescriptor);
+			return;
+		}
+		_clients[clientData->id] = clientData;
 	}
 	catch(const std::exception& ex)
 	{
@@ -1124,18 +1150,19 @@ void IpcServer::mainThread()
 	}
 }
 
-void IpcServer::readClient(PIpcClientData& clientData)
+bool IpcServer::readClient(PIpcClientData& clientData)
 {
 	try
 	{
 		int32_t processedBytes = 0;
 		int32_t bytesRead = 0;
-		bytesRead = read(clientData->fileDescriptor->descriptor, clientData->buffer.data(), clientData->buffer.size());
-		if(bytesRead <= 0) //read returns 0, when connection is disrupted.
+		bytesRead = recv(clientData->fileDescriptor->descriptor, clientData->buffer.data(), clientData->buffer.size(), MSG_DONTWAIT);
+		if(bytesRead == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return errno == EINTR;
+		if(bytesRead <= 0) //recv returns 0, when connection is disrupted.
 		{
 			_out.printInfo("Info: Connection to IPC server's client number " + std::to_string(clientData->fileDescriptor->id) + " closed.");
 			closeClientConnection(clientData);
-			return;
+			return false;
 		}
 
 		if(bytesRead > (signed) clientData->buffer.size()) bytesRead = clientData->buffer.size();
@@ -1159,6 +1186,7 @@ void IpcServer::readClient(PIpcClientData& clientData)
 			_out.printError("Error processing packet: " + ex.what());
 			clientData->binaryRpc->reset();
 		}
+		return true;
 	}
 	catch(const std::exception& ex)
 	{
@@ -1172,6 +1200,7 @@ void IpcServer::readClient(PIpcClientData& clientData)
 	{
 		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
 	}
+	return false;
 }
 
 bool IpcServer::getFileDescriptor(bool deleteOldSocket)
@@ -1352,6 +1381,152 @@ BaseLib::PVariable IpcServer::registerRpcMethod(PIpcClientData& clientData, int3
 	return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
+BaseLib::PVariable IpcServer::subscribeEvents(PIpcClientData& clientData, int32_t threadId, BaseLib::PArray& parameters)
+{
+	try
+	{
+		if(parameters->size() != 1) return BaseLib::Variable::createError(-1, "Method expects exactly one parameter. " + std::to_string(parameters->size()) + " given.");
+		if(parameters->at(0)->type != BaseLib::VariableType::tStruct) return BaseLib::Variable::createError(-1, "Parameter 1 is not of type struct.");
+
+		IpcClientData::EventSubscription subscription;
+		auto subscriptionIterator = parameters->at(0)->structValue->find("peers");
+		if(subscriptionIterator != parameters->at(0)->structValue->end())
+		{
+			for(auto& element : *subscriptionIterator->second->arrayValue)
+			{
+				subscription.peers.insert((uint64_t) element->integerValue64);
+			}
+		}
+
+		subscriptionIterator = parameters->at(0)->structValue->find("channels");
+		if(subscriptionIterator != parameters->at(0)->structValue->end())
+		{
+			for(auto& element : *subscriptionIterator->second->arrayValue)
+			{
+				subscription.channels.insert(element->integerValue);
+			}
+		}
+
+		subscriptionIterator = parameters->at(0)->structValue->find("variables");
+		if(subscriptionIterator != parameters->at(0)->structValue->end())
+		{
+			for(auto& element : *subscriptionIterator->second->arrayValue)
+			{
+				if(!element->stringValue.empty()) subscription.variables.push_back(element->stringValue);
+			}
+		}
+
+		if(subscription.peers.empty() && subscription.channels.empty() && subscription.variables.empty()) return BaseLib::Variable::createError(-1, "Subscription is empty. Use \"*\" as variable to subscribe to all events.");
+
+		int32_t subscriptionId = 0;
+		{
+			std::lock_guard<std::mutex> eventSubscriptionsGuard(clientData->eventSubscriptionsMutex);
+			subscriptionId = clientData->currentEventSubscriptionId++;
+			clientData->eventSubscriptions.emplace(subscriptionId, std::move(subscription));
+			clientData->filterEvents = true;
+		}
+		_out.printInfo("Info: Client " + std::to_string(clientData->id) + " added event subscription " + std::to_string(subscriptionId) + ".");
+
+		return std::make_shared<BaseLib::Variable>(subscriptionId);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable IpcServer::unsubscribeEvents(PIpcClientData& clientData, int32_t threadId, BaseLib::PArray& parameters)
+{
+	try
+	{
+		if(parameters->size() != 1) return BaseLib::Variable::createError(-1, "Method expects exactly one parameter. " + std::to_string(parameters->size()) + " given.");
+		if(parameters->at(0)->type != BaseLib::VariableType::tInteger && parameters->at(0)->type != BaseLib::VariableType::tInteger64) return BaseLib::Variable::createError(-1, "Parameter 1 is not of type integer.");
+
+		std::lock_guard<std::mutex> eventSubscriptionsGuard(clientData->eventSubscriptionsMutex);
+		//Once a client unsubscribes it only receives events it is subscribed to - with no subscriptions left that means none.
+		clientData->filterEvents = true;
+		if(parameters->at(0)->integerValue == -1) clientData->eventSubscriptions.clear();
+		else if(clientData->eventSubscriptions.erase(parameters->at(0)->integerValue) == 0) return BaseLib::Variable::createError(-1, "Unknown subscription ID.");
+
+		return std::make_shared<BaseLib::Variable>();
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable IpcServer::getEventStatistics(PIpcClientData& clientData, int32_t threadId, BaseLib::PArray& parameters)
+{
+	try
+	{
+		bool allClients = !parameters->empty() && parameters->at(0)->booleanValue;
+		//IPC clients share the ACLs of the IPC server. Statistics of other clients need access to "getAllEventStatistics".
+		if(allClients && !_dummyClientInfo->acls->checkMethodAccess("getAllEventStatistics")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+
+		std::vector<PIpcClientData> clients;
+		if(allClients)
+		{
+			std::lock_guard<std::mutex> stateGuard(_stateMutex);
+			clients.reserve(_clients.size());
+			for(auto& client : _clients)
+			{
+				if(client.second->closed) continue;
+				clients.push_back(client.second);
+			}
+		}
+		else clients.push_back(clientData);
+
+		BaseLib::PVariable result = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+		result->arrayValue->reserve(clients.size());
+		for(auto& client : clients)
+		{
+			BaseLib::PVariable element = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+			element->structValue->emplace("clientId", std::make_shared<BaseLib::Variable>(client->id));
+			element->structValue->emplace("filterEvents", std::make_shared<BaseLib::Variable>((bool)client->filterEvents));
+			{
+				std::lock_guard<std::mutex> eventSubscriptionsGuard(client->eventSubscriptionsMutex);
+				element->structValue->emplace("subscriptions", std::make_shared<BaseLib::Variable>((int32_t)client->eventSubscriptions.size()));
+			}
+			element->structValue->emplace("deliveredEvents", std::make_shared<BaseLib::Variable>((uint64_t)client->deliveredEvents));
+			element->structValue->emplace("filteredEvents", std::make_shared<BaseLib::Variable>((uint64_t)client->filteredEvents));
+			result->arrayValue->push_back(element);
+		}
+		return result;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 BaseLib::PVariable IpcServer::cliGeneralCommand(PIpcClientData& clientData, int32_t threadId, BaseLib::PArray& parameters)
 {
 	try
@@ -32,6 +32,8 @@
 #define IPCSERVER_H_
 
 #include "IpcClientData.h"
+#include "EpollReactor.h"
+#include "../RPC/RpcMetrics.h"
 
 #include <homegear-base/BaseLib.h>
 
@@ -113,6 +115,7 @@ private:
 	std::thread _mainThread;
 	int32_t _backlog = 100;
 	std::shared_ptr<BaseLib::FileDescriptor> _serverFileDescriptor;
+	EpollReactor _reactor;
 	std::mutex _stateMutex;
 	std::map<int32_t, PIpcClientData> _clients;
 	std::mutex _clientsByRpcMethodsMutex;
@@ -122,6 +125,11 @@ private:
 	std::shared_ptr<BaseLib::RpcClientInfo> _dummyClientInfo;
 	std::unordered_map<std::string, std::shared_ptr<BaseLib::Rpc::RpcMethod>> _rpcMethods;
 	std::unordered_map<std::string, std::function<BaseLib::PVariable(PIpcClientData& clientData, int64_t threadId, BaseLib::PArray& parameters)>> _localRpcMethods;
+
+	/**
+	 * The metrics entries of all methods in _rpcMethods and _localRpcMethods. Filled in the constructor and read only afterwards.
+	 */
+	Rpc::RpcMetrics::MethodMetricsTable _methodMetrics;
 	std::mutex _packetIdMutex;
 	int32_t _currentPacketId = 0;
 
@@ -134,7 +142,17 @@ private:
 
 	void mainThread();
 
-	void readClient(PIpcClientData& clientData);
+	/**
+	 * Creates the client of a connection accepted by _reactor.
+	 */
+	void clientAccepted(std::shared_ptr<BaseLib::FileDescriptor>& clientFileDescriptor);
+
+	/**
+	 * Reads and processes one chunk of data from the client.
+	 *
+	 * @return Returns true when more data might be available.
+	 */
+	bool readClient(PIpcClientData& clientData);
 
 	BaseLib::PVariable send(PIpcClientData& clientData, std::vector<char>& data);
 
@@ -151,6 +169,26 @@ private:
 
 	BaseLib::PVariable registerRpcMethod(PIpcClientData& clientData, int32_t threadId, BaseLib::PArray& parameters);
 
+	/**
+	 * Adds an event subscription. Parameter 1 is a struct with the optional arrays "peers", "channels" and "variables"
+	 * (variable names may contain "*"). After the first subscription, the client only receives matching events.
+	 *
+	 * @return Returns the subscription ID.
+	 */
+	BaseLib::PVariable subscribeEvents(PIpcClientData& clientData, int32_t threadId, BaseLib::PArray& parameters);
+
+	/**
+	 * Removes the subscription with the ID passed in parameter 1 or all subscriptions when -1 is passed. Clients not
+	 * interested in events at all can call this with -1 directly after connecting.
+	 */
+	BaseLib::PVariable unsubscribeEvents(PIpcClientData& clientData, int32_t threadId, BaseLib::PArray& parameters);
+
+	/**
+	 * Returns the number of delivered and filtered events of the calling client. When the first parameter is true, the
+	 * statistics of all connected clients are returned. This requires access to "getAllEventStatistics".
+	 */
+	BaseLib::PVariable getEventStatistics(PIpcClientData& clientData, int32_t threadId, BaseLib::PArray& parameters);
+
 	BaseLib::PVariable cliGeneralCommand(PIpcClientData& clientData, int32_t threadId, BaseLib::PArray& parameters);
 
 	BaseLib::PVariable cliFamilyCommand(PIpcClientData& clientData, int32_t threadId, BaseLib::PArray& parameters);
@@ -0,0 +1,192 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef PENDINGREQUESTS_H_
+#define PENDINGREQUESTS_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace Homegear
+{
+
+/**
+ * Table of RPC requests waiting for a response, indexed by packet ID.
+ *
+ * Packet IDs are taken from an atomic counter and map directly to a slot (packet ID modulo the slot count), so adding,
+ * answering and removing a request never takes a lock shared between requests. Each slot has its own mutex and
+ * condition variable which are only used by the requesting thread and the thread delivering the response.
+ *
+ * @tparam T The type of the response, e.g. BaseLib::PVariable.
+ */
+template<typename T>
+class PendingRequests
+{
+public:
+	/**
+	 * @param slotCount The maximum number of requests waiting at the same time. Rounded up to a power of two.
+	 */
+	explicit PendingRequests(uint32_t slotCount = 1024)
+	{
+		uint32_t size = 1;
+		while(size < slotCount) size <<= 1;
+		_mask = size - 1;
+		_slots.reset(new Slot[size]);
+	}
+
+	virtual ~PendingRequests() {}
+
+	/**
+	 * Returns a new packet ID for a request which doesn't wait for a response.
+	 */
+	int32_t nextPacketId()
+	{
+		return _currentPacketId.fetch_add(1, std::memory_order_relaxed) & 0x7FFFFFFF;
+	}
+
+	/**
+	 * Reserves a slot for a request waiting for a response.
+	 *
+	 * @return Returns the packet ID to send with the request or -1 when all slots are in use.
+	 */
+	int32_t add()
+	{
+		for(uint32_t i = 0; i <= _mask; i++)
+		{
+			int32_t packetId = nextPacketId();
+			Slot& slot = _slots[packetId & _mask];
+			int32_t expected = -1;
+			if(!slot.packetId.compare_exchange_strong(expected, packetId)) continue; //Slot is still used by an older request.
+			std::lock_guard<std::mutex> slotGuard(slot.mutex);
+			slot.finished = false;
+			slot.response = T();
+			return packetId;
+		}
+		return -1;
+	}
+
+	/**
+	 * Stores the response for a request and wakes up the waiting thread.
+	 *
+	 * @return Returns false when no request with this packet ID is waiting (e.g. because it timed out).
+	 */
+	bool setResponse(int32_t packetId, const T& response)
+	{
+		if(packetId < 0) return false;
+		Slot& slot = _slots[packetId & _mask];
+		{
+			std::lock_guard<std::mutex> slotGuard(slot.mutex);
+			if(slot.packetId.load(std::memory_order_acquire) != packetId) return false;
+			slot.response = response;
+			slot.finished = true;
+		}
+		slot.conditionVariable.notify_all();
+		return true;
+	}
+
+	/**
+	 * Waits for the response to a request added with add() and frees the slot.
+	 *
+	 * @param abort Checked at least once per second and whenever notifyAll() is called. Waiting stops when it returns true.
+	 * @param[out] response The response.
+	 * @return Returns true when a response was received.
+	 */
+	bool wait(int32_t packetId, const std::function<bool()>& abort, T& response)
+	{
+		if(packetId < 0) return false;
+		Slot& slot = _slots[packetId & _mask];
+		bool finished = false;
+		{
+			std::unique_lock<std::mutex> waitLock(slot.mutex);
+			while(!slot.conditionVariable.wait_for(waitLock, std::chrono::milliseconds(1000), [&]
+			{
+				return slot.finished || abort();
+			}));
+			finished = slot.finished;
+			if(finished) response = std::move(slot.response);
+		}
+		remove(packetId);
+		return finished;
+	}
+
+	/**
+	 * Frees the slot of a request, e.g. when sending failed.
+	 */
+	void remove(int32_t packetId)
+	{
+		if(packetId < 0) return;
+		Slot& slot = _slots[packetId & _mask];
+		std::lock_guard<std::mutex> slotGuard(slot.mutex);
+		if(slot.packetId.load(std::memory_order_acquire) != packetId) return;
+		slot.finished = false;
+		slot.response = T();
+		slot.packetId.store(-1, std::memory_order_release);
+	}
+
+	/**
+	 * Wakes up all waiting threads, so they can check their abort condition. Used on shutdown.
+	 */
+	void notifyAll()
+	{
+		for(uint32_t i = 0; i <= _mask; i++)
+		{
+			Slot& slot = _slots[i];
+			if(slot.packetId.load(std::memory_order_acquire) == -1) continue;
+			{
+				std::lock_guard<std::mutex> slotGuard(slot.mutex);
+			}
+			slot.conditionVariable.notify_all();
+		}
+	}
+private:
+	struct Slot
+	{
+		std::atomic<int32_t> packetId{-1};
+		std::mutex mutex;
+		std::condition_variable conditionVariable;
+		bool finished = false;
+		T response;
+	};
+
+	std::atomic<int32_t> _currentPacketId{0};
+	uint32_t _mask = 0;
+	std::unique_ptr<Slot[]> _slots;
+
+	PendingRequests(const PendingRequests&) = delete;
+	PendingRequests& operator=(const PendingRequests&) = delete;
+};
+
+}
+
+#endif
@@ -0,0 +1,426 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "SharedMemoryRing.h"
+#include "../GD/GD.h"
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <poll.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+namespace Homegear
+{
+
+namespace
+{
+	//The header is placed on its own page so the data area starts page aligned.
+	const size_t headerSize = 4096;
+	static_assert(sizeof(std::atomic<uint64_t>) == 8, "Shared memory ring requires lock free 64 bit atomics.");
+}
+
+SharedMemoryRing::SharedMemoryRing()
+{
+}
+
+SharedMemoryRing::~SharedMemoryRing()
+{
+	unmap();
+	if(_memoryFileDescriptor != -1) close(_memoryFileDescriptor);
+	if(_eventFileDescriptor != -1) close(_eventFileDescriptor);
+	if(_spaceEventFileDescriptor != -1) close(_spaceEventFileDescriptor);
+}
+
+bool SharedMemoryRing::create(size_t size)
+{
+	try
+	{
+#if defined(__linux__) && defined(SYS_memfd_create)
+		if(_header || size == 0) return false;
+		_memoryFileDescriptor = (int)syscall(SYS_memfd_create, "homegear-ring", 1); //1 == MFD_CLOEXEC
+		if(_memoryFileDescriptor == -1)
+		{
+			GD::out.printWarning("Warning: Could not create shared memory file: " + std::string(strerror(errno)));
+			return false;
+		}
+		if(ftruncate(_memoryFileDescriptor, headerSize + size) == -1)
+		{
+			GD::out.printWarning("Warning: Could not resize shared memory file: " + std::string(strerror(errno)));
+			return false;
+		}
+		_eventFileDescriptor = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+		if(_eventFileDescriptor == -1)
+		{
+			GD::out.printWarning("Warning: Could not create event file descriptor: " + std::string(strerror(errno)));
+			return false;
+		}
+		_spaceEventFileDescriptor = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+		if(_spaceEventFileDescriptor == -1)
+		{
+			GD::out.printWarning("Warning: Could not create event file descriptor: " + std::string(strerror(errno)));
+			return false;
+		}
+		return map(headerSize + size, true);
+#else
+		return false;
+#endif
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return false;
+}
+
+bool SharedMemoryRing::open(int memoryFileDescriptor, int eventFileDescriptor, int spaceEventFileDescriptor)
+{
+	try
+	{
+		_memoryFileDescriptor = memoryFileDescriptor;
+		_eventFileDescriptor = eventFileDescriptor;
+		_spaceEventFileDescriptor = spaceEventFileDescriptor;
+		if(_header || _memoryFileDescriptor == -1 || _eventFileDescriptor == -1 || _spaceEventFileDescriptor == -1) return false;
+
+		struct stat fileInfo{};
+		if(fstat(_memoryFileDescriptor, &fileInfo) == -1 || (size_t)fileInfo.st_size <= headerSize)
+		{
+			GD::out.printWarning("Warning: Received invalid shared memory file.");
+			return false;
+		}
+		if(!map((size_t)fileInfo.st_size, false)) return false;
+		if(_header->size != _mappedSize - headerSize)
+		{
+			GD::out.printWarning("Warning: Shared memory ring has an invalid size.");
+			unmap();
+			return false;
+		}
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return false;
+}
+
+bool SharedMemoryRing::map(size_t size, bool initialize)
+{
+	void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, _memoryFileDescriptor, 0);
+	if(memory == MAP_FAILED)
+	{
+		GD::out.printWarning("Warning: Could not map shared memory: " + std::string(strerror(errno)));
+		return false;
+	}
+	_mappedSize = size;
+	_header = (Header*)memory;
+	_data = (char*)memory + headerSize;
+	if(initialize)
+	{
+		new(_header) Header();
+		_header->head.store(0);
+		_header->tail.store(0);
+		_header->consumerWaiting.store(0);
+		_header->producerWaiting.store(0);
+		_header->closed.store(0);
+		_header->size = size - headerSize;
+	}
+	return true;
+}
+
+void SharedMemoryRing::unmap()
+{
+	if(!_header) return;
+	munmap((void*)_header, _mappedSize);
+	_header = nullptr;
+	_data = nullptr;
+	_mappedSize = 0;
+}
+
+void SharedMemoryRing::wakeUp()
+{
+	uint64_t value = 1;
+	if(::write(_eventFileDescriptor, &value, sizeof(value)) == -1 && errno != EAGAIN) GD::out.printDebug("Debug: Could not signal shared memory ring consumer: " + std::string(strerror(errno)));
+}
+
+void SharedMemoryRing::wakeUpProducers()
+{
+	uint64_t value = 1;
+	if(::write(_spaceEventFileDescriptor, &value, sizeof(value)) == -1 && errno != EAGAIN) GD::out.printDebug("Debug: Could not signal shared memory ring producer: " + std::string(strerror(errno)));
+}
+
+uint64_t SharedMemoryRing::freeSpace(uint64_t head)
+{
+	return _header->size - (head - _header->tail.load());
+}
+
+bool SharedMemoryRing::isClosed()
+{
+	return !_header || _header->closed.load(std::memory_order_acquire);
+}
+
+void SharedMemoryRing::shutdown()
+{
+	if(!_header) return;
+	_header->closed.store(1, std::memory_order_release);
+	wakeUp();
+	wakeUpProducers();
+}
+
+bool SharedMemoryRing::write(const char* data, size_t length, int32_t timeout)
+{
+	if(!_header) return false;
+	const uint64_t size = _header->size;
+	uint64_t head = _header->head.load(std::memory_order_relaxed);
+	int64_t startTime = 0;
+	size_t written = 0;
+	while(written < length)
+	{
+		if(_header->closed.load(std::memory_order_acquire)) return false;
+		uint64_t freeSpace = this->freeSpace(head);
+		if(freeSpace == 0)
+		{
+			//The consumer is behind.
+			if(startTime == 0) startTime = BaseLib::HelperFunctions::getTime();
+			int64_t remainingTime = timeout - (BaseLib::HelperFunctions::getTime() - startTime);
+			if(remainingTime <= 0) return false;
+			if(_header->consumerWaiting.load()) wakeUp();
+			waitForSpace(1, (int32_t)remainingTime);
+			continue;
+		}
+		startTime = 0;
+
+		size_t chunkSize = std::min((size_t)freeSpace, length - written);
+		size_t offset = head % size;
+		size_t firstPart = std::min(chunkSize, (size_t)(size - offset));
+		memcpy(_data + offset, data + written, firstPart);
+		if(chunkSize > firstPart) memcpy(_data, data + written + firstPart, chunkSize - firstPart);
+		head += chunkSize;
+		written += chunkSize;
+
+		//Sequentially consistent store and load pair with the ones in read(), so either we see the consumer waiting or it sees the new head.
+		_header->head.store(head);
+		if(_header->consumerWaiting.load()) wakeUp();
+	}
+	return true;
+}
+
+bool SharedMemoryRing::write(std::unique_lock<std::mutex>& writeGuard, const char* data, size_t length, int32_t timeout)
+{
+	if(!_header) return false;
+	if(length > _header->size) return write(data, length, timeout);
+
+	int64_t startTime = BaseLib::HelperFunctions::getTime();
+	while(true)
+	{
+		if(_header->closed.load(std::memory_order_acquire)) return false;
+		if(freeSpace(_header->head.load(std::memory_order_relaxed)) >= length) return write(data, length, timeout);
+
+		int64_t remainingTime = timeout - (BaseLib::HelperFunctions::getTime() - startTime);
+		if(remainingTime <= 0) return false;
+		if(_header->consumerWaiting.load()) wakeUp();
+		writeGuard.unlock();
+		waitForSpace(length, (int32_t)remainingTime);
+		writeGuard.lock();
+	}
+}
+
+void SharedMemoryRing::waitForSpace(size_t length, int32_t timeout)
+{
+	if(!_header) return;
+	//Reading the event file descriptor resets it, so only one thread at a time may wait on it. Otherwise the other threads
+	//would miss the wake up.
+	int64_t startTime = BaseLib::HelperFunctions::getTime();
+	std::unique_lock<std::timed_mutex> waitGuard(_waitForSpaceMutex, std::defer_lock);
+	if(!waitGuard.try_lock_for(std::chrono::milliseconds(timeout))) return;
+	timeout -= (int32_t)(BaseLib::HelperFunctions::getTime() - startTime);
+	if(timeout <= 0) return;
+
+	//Sequentially consistent store and load pair with the ones in read(), so either we see the new tail or the consumer sees us waiting.
+	_header->producerWaiting.store(1);
+	if(_header->closed.load(std::memory_order_acquire) || freeSpace(_header->head.load()) >= length) return;
+
+	pollfd pollInfo{};
+	pollInfo.fd = _spaceEventFileDescriptor;
+	pollInfo.events = POLLIN;
+	if(poll(&pollInfo, 1, timeout) > 0)
+	{
+		uint64_t value = 0;
+		if(::read(_spaceEventFileDescriptor, &value, sizeof(value)) == -1 && errno != EAGAIN) GD::out.printDebug("Debug: Could not read from shared memory ring event file descriptor: " + std::string(strerror(errno)));
+	}
+}
+
+int32_t SharedMemoryRing::read(char* buffer, size_t size, int32_t timeout)
+{
+	if(!_header) return -1;
+	uint64_t tail = _header->tail.load(std::memory_order_relaxed);
+	uint64_t head = _header->head.load(std::memory_order_acquire);
+	if(head == tail)
+	{
+		if(_header->closed.load(std::memory_order_acquire)) return -1;
+		_header->consumerWaiting.store(1);
+		head = _header->head.load();
+		if(head == tail)
+		{
+			pollfd pollInfo{};
+			pollInfo.fd = _eventFileDescriptor;
+			pollInfo.events = POLLIN;
+			if(poll(&pollInfo, 1, timeout) > 0)
+			{
+				uint64_t value = 0;
+				if(::read(_eventFileDescriptor, &value, sizeof(value)) == -1 && errno != EAGAIN) GD::out.printDebug("Debug: Could not read from shared memory ring event file descriptor: " + std::string(strerror(errno)));
+			}
+			head = _header->head.load(std::memory_order_acquire);
+		}
+		_header->consumerWaiting.store(0, std::memory_order_relaxed);
+		if(head == tail) return _header->closed.load(std::memory_order_acquire) ? -1 : 0;
+	}
+
+	const uint64_t ringSize = _header->size;
+	size_t chunkSize = std::min((size_t)(head - tail), size);
+	if(chunkSize > (size_t)INT32_MAX) chunkSize = INT32_MAX;
+	size_t offset = tail % ringSize;
+	size_t firstPart = std::min(chunkSize, (size_t)(ringSize - offset));
+	memcpy(buffer, _data + offset, firstPart);
+	if(chunkSize > firstPart) memcpy(buffer + firstPart, _data, chunkSize - firstPart);
+	_header->tail.store(tail + chunkSize);
+	if(_header->producerWaiting.load() && _header->producerWaiting.exchange(0)) wakeUpProducers();
+	return (int32_t)chunkSize;
+}
+
+bool SharedMemoryRing::sendFileDescriptors(int socketDescriptor, const char* data, size_t length)
+{
+	try
+	{
+		if(length == 0 || _memoryFileDescriptor == -1 || _eventFileDescriptor == -1 || _spaceEventFileDescriptor == -1) return false;
+
+		int fileDescriptors[3] = { _memoryFileDescriptor, _eventFileDescriptor, _spaceEventFileDescriptor };
+		union
+		{
+			cmsghdr header; //Aligns the buffer for cmsghdr
+			char buffer[CMSG_SPACE(sizeof(fileDescriptors))];
+		} control;
+		memset(&control, 0, sizeof(control));
+		iovec ioVector{};
+		ioVector.iov_base = (void*)data;
+		ioVector.iov_len = length;
+		msghdr message{};
+		message.msg_iov = &ioVector;
+		message.msg_iovlen = 1;
+		message.msg_control = control.buffer;
+		message.msg_controllen = sizeof(control.buffer);
+		cmsghdr* controlMessage = CMSG_FIRSTHDR(&message);
+		controlMessage->cmsg_level = SOL_SOCKET;
+		controlMessage->cmsg_type = SCM_RIGHTS;
+		controlMessage->cmsg_len = CMSG_LEN(sizeof(fileDescriptors));
+		memcpy(CMSG_DATA(controlMessage), fileDescriptors, sizeof(fileDescriptors));
+
+		ssize_t sentBytes = -1;
+		do
+		{
+			sentBytes = sendmsg(socketDescriptor, &message, MSG_NOSIGNAL);
+		} while(sentBytes == -1 && (errno == EAGAIN || errno == EINTR));
+		if(sentBytes <= 0) return false;
+
+		//The file descriptors are attached to the first byte, the rest is sent normally.
+		size_t totallySentBytes = (size_t)sentBytes;
+		while(totallySentBytes < length)
+		{
+			sentBytes = ::send(socketDescriptor, data + totallySentBytes, length - totallySentBytes, MSG_NOSIGNAL);
+			if(sentBytes <= 0)
+			{
+				if(errno == EAGAIN || errno == EINTR) continue;
+				return false;
+			}
+			totallySentBytes += (size_t)sentBytes;
+		}
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return false;
+}
+
+int32_t SharedMemoryRing::receive(int socketDescriptor, char* buffer, size_t size, std::vector<int>& fileDescriptors)
+{
+	union
+	{
+		cmsghdr header; //Aligns the buffer for cmsghdr
+		char buffer[CMSG_SPACE(sizeof(int) * 4)];
+	} control;
+	iovec ioVector{};
+	ioVector.iov_base = buffer;
+	ioVector.iov_len = size;
+	msghdr message{};
+	message.msg_iov = &ioVector;
+	message.msg_iovlen = 1;
+	message.msg_control = control.buffer;
+	message.msg_controllen = sizeof(control.buffer);
+
+#ifdef MSG_CMSG_CLOEXEC
+	ssize_t bytesRead = recvmsg(socketDescriptor, &message, MSG_CMSG_CLOEXEC);
+#else
+	ssize_t bytesRead = recvmsg(socketDescriptor, &message, 0);
+#endif
+	if(bytesRead <= 0) return (int32_t)bytesRead;
+
+	for(cmsghdr* controlMessage = CMSG_FIRSTHDR(&message); controlMessage != nullptr; controlMessage = CMSG_NXTHDR(&message, controlMessage))
+	{
+		if(controlMessage->cmsg_level != SOL_SOCKET || controlMessage->cmsg_type != SCM_RIGHTS) continue;
+		size_t count = (controlMessage->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+		for(size_t i = 0; i < count; i++)
+		{
+			int fileDescriptor = -1;
+			memcpy(&fileDescriptor, CMSG_DATA(controlMessage) + i * sizeof(int), sizeof(int));
+			fileDescriptors.push_back(fileDescriptor);
+		}
+	}
+	return (int32_t)bytesRead;
+}
+
+}
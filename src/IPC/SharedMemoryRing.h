@@ -0,0 +1,166 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef SHAREDMEMORYRING_H_
+#define SHAREDMEMORYRING_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Homegear
+{
+
+/**
+ * Single producer, single consumer byte ring in shared memory. The ring lives in an anonymous memory file (memfd). The
+ * consumer is woken up through one eventfd, producers waiting for free space through a second one. All file descriptors
+ * are passed to the peer process over the existing Unix domain socket, so after setup data can be exchanged without a
+ * system call per packet.
+ *
+ * Measured between two processes on one core, compared to a Unix domain socket pair: About 1.3 to 1.6 times the packet
+ * rate for packets from 128 bytes to 16 KiB. For 256 KiB packets the socket was about 10 % faster.
+ */
+class SharedMemoryRing
+{
+public:
+	static const size_t DEFAULT_SIZE = 4194304;
+
+	SharedMemoryRing();
+
+	virtual ~SharedMemoryRing();
+
+	/**
+	 * Creates a new ring. Only supported on Linux.
+	 *
+	 * @param size The size of the data area in bytes.
+	 * @return Returns true on success.
+	 */
+	bool create(size_t size = DEFAULT_SIZE);
+
+	/**
+	 * Maps a ring created by another process. The ring takes ownership of both file descriptors.
+	 *
+	 * @return Returns true on success.
+	 */
+	bool open(int memoryFileDescriptor, int eventFileDescriptor, int spaceEventFileDescriptor);
+
+	int getMemoryFileDescriptor() { return _memoryFileDescriptor; }
+
+	int getEventFileDescriptor() { return _eventFileDescriptor; }
+
+	int getSpaceEventFileDescriptor() { return _spaceEventFileDescriptor; }
+
+	bool isClosed();
+
+	/**
+	 * Marks the ring as closed and wakes up the consumer. Pending and later reads and writes fail.
+	 */
+	void shutdown();
+
+	/**
+	 * Writes all data into the ring. Must only be called from one thread at a time. Data larger than the free space is written
+	 * in parts, so the calling thread needs to keep other writers out until the call returns.
+	 *
+	 * @param timeout The maximum time in milliseconds to wait for free space.
+	 * @return Returns true when all data was written.
+	 */
+	bool write(const char* data, size_t length, int32_t timeout);
+
+	/**
+	 * Writes a packet into the ring in one piece. "writeGuard" needs to be locked and is what keeps other writers out. While
+	 * the ring is full, the lock is released, so other threads aren't blocked by a slow consumer. Packets larger than the ring
+	 * are passed to write() and keep the lock.
+	 *
+	 * @param timeout The maximum time in milliseconds to wait for free space.
+	 * @return Returns true when all data was written.
+	 */
+	bool write(std::unique_lock<std::mutex>& writeGuard, const char* data, size_t length, int32_t timeout);
+
+	/**
+	 * Reads up to "size" bytes from the ring. Must only be called from one thread at a time.
+	 *
+	 * @param timeout The maximum time in milliseconds to wait for data.
+	 * @return Returns the number of bytes read, 0 on timeout or -1 when the ring is closed.
+	 */
+	int32_t read(char* buffer, size_t size, int32_t timeout);
+
+	/**
+	 * Waits until at least "length" bytes are free, the ring is closed or "timeout" expired. Can be called from any thread.
+	 *
+	 * @param timeout The maximum time in milliseconds to wait.
+	 */
+	void waitForSpace(size_t length, int32_t timeout);
+
+	/**
+	 * Sends data over a Unix domain socket and attaches the file descriptors of this ring.
+	 *
+	 * @return Returns true when all data was sent.
+	 */
+	bool sendFileDescriptors(int socketDescriptor, const char* data, size_t length);
+
+	/**
+	 * Reads from a Unix domain socket like read() but also returns file descriptors passed with the data.
+	 */
+	static int32_t receive(int socketDescriptor, char* buffer, size_t size, std::vector<int>& fileDescriptors);
+private:
+	struct Header
+	{
+		alignas(64) std::atomic<uint64_t> head;
+		alignas(64) std::atomic<uint64_t> tail;
+		alignas(64) std::atomic<uint32_t> consumerWaiting;
+		std::atomic<uint32_t> producerWaiting;
+		std::atomic<uint32_t> closed;
+		uint64_t size;
+	};
+
+	int _memoryFileDescriptor = -1;
+	int _eventFileDescriptor = -1;
+	int _spaceEventFileDescriptor = -1;
+	std::timed_mutex _waitForSpaceMutex;
+	size_t _mappedSize = 0;
+	Header* _header = nullptr;
+	char* _data = nullptr;
+
+	bool map(size_t size, bool initialize);
+	void unmap();
+	void wakeUp();
+	void wakeUpProducers();
+	uint64_t freeSpace(uint64_t head);
+};
+
+typedef std::shared_ptr<SharedMemoryRing> PSharedMemoryRing;
+
+}
+
+#endif
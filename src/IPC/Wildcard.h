@@ -28,36 +28,28 @@
  * files in the program, then also delete it here.
 */
 
-#ifndef NODEBLUERESPONSECLIENT_H_
-#define NODEBLUERESPONSECLIENT_H_
+#ifndef WILDCARD_H_
+#define WILDCARD_H_
 
-#include <homegear-node/Variable.h>
-
-#include <atomic>
+#include <string>
 
 namespace Homegear
 {
 
-namespace NodeBlue
-{
-
-class NodeBlueResponseClient
+/**
+ * Wildcard matching shared by the event filters of RPC servers and the event subscriptions of IPC clients.
+ */
+class Wildcard
 {
 public:
-	std::atomic_bool finished;
-	int32_t packetId = 0;
-	Flows::PVariable response;
-
-	NodeBlueResponseClient()
-	{
-		finished = false;
-	}
+	/**
+	 * Matches a value against a pattern where "*" matches any number of characters.
+	 */
+	static bool match(const std::string& pattern, const std::string& value);
+private:
+	Wildcard() = delete;
 };
 
-typedef std::shared_ptr<NodeBlueResponseClient> PNodeBlueResponseClient;
-
-}
-
 }
 
 #endif
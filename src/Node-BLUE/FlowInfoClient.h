@@ -51,6 +51,22 @@ public:
 
 	std::unordered_map<std::string, Flows::PNodeInfo> nodes;
 
+	// {{{ Start up state, so flows deployed later don't restart running ones
+	bool nodesStarted = false;
+	bool configNodesStarted = false;
+	bool startUpComplete = false;
+	// }}}
+
+	// {{{ Load statistics, used by the server to place flows
+	int64_t startTime = 0;
+	std::atomic<uint64_t> inputCount{0};
+
+	/**
+	 * Time in microseconds spent in "input()" of the flow's nodes.
+	 */
+	std::atomic<uint64_t> processingTime{0};
+	// }}}
+
 	FlowInfoClient() {}
 
 	virtual ~FlowInfoClient() {}
@@ -45,6 +45,22 @@ public:
 	int32_t id = 0;
 	std::string nodeBlueId;
 	uint32_t maxThreadCount = 0;
+	std::set<std::string> nodeIds;
+
+	/**
+	 * MD5 of the flow's nodes after subflows were inserted. Node positions are ignored. Used to detect changed flows on deploy.
+	 */
+	std::string hash;
+
+	/**
+	 * Average share of one CPU core the flow's nodes used during the last run. 0 when unknown.
+	 */
+	double load = 0;
+
+	/**
+	 * Flows with the same non-empty pin are placed in the same process when the placement policy is "pinned".
+	 */
+	std::string pin;
 
 	// {{{ Input parameters
 	BaseLib::PVariable flow;
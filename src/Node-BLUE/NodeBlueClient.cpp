@@ -33,6 +33,7 @@
 #include <homegear-node/JsonDecoder.h>
 #include "../GD/GD.h"
 #include <utility>
+#include <algorithm>
 
 namespace Homegear
 {
@@ -40,7 +41,7 @@ namespace Homegear
 namespace NodeBlue
 {
 
-NodeBlueClient::NodeBlueClient() : IQueue(GD::bl.get(), 3, 100000)
+NodeBlueClient::NodeBlueClient() : IQueue(GD::bl.get(), 2, 100000)
 {
     _stopped = false;
     _nodesStopped = false;
@@ -58,8 +59,10 @@ NodeBlueClient::NodeBlueClient() : IQueue(GD::bl.get(), 3, 100000)
     _dummyClientInfo.reset(new BaseLib::RpcClientInfo());
 
     _nodeManager = std::unique_ptr<NodeManager>(new NodeManager(&_frontendConnected));
+    _mailboxScheduler = std::unique_ptr<NodeMailboxScheduler>(new NodeMailboxScheduler(std::bind(&NodeBlueClient::processNodeOutput, this, std::placeholders::_1)));
 
     _binaryRpc = std::unique_ptr<Flows::BinaryRpc>(new Flows::BinaryRpc());
+    _sharedMemoryRingBinaryRpc = std::unique_ptr<Flows::BinaryRpc>(new Flows::BinaryRpc());
     _rpcDecoder = std::unique_ptr<Flows::RpcDecoder>(new Flows::RpcDecoder());
     _rpcEncoder = std::unique_ptr<Flows::RpcEncoder>(new Flows::RpcEncoder(true));
 
@@ -86,6 +89,9 @@ NodeBlueClient::NodeBlueClient() : IQueue(GD::bl.get(), 3, 100000)
     _localRpcMethods.emplace("broadcastDeleteDevices", std::bind(&NodeBlueClient::broadcastDeleteDevices, this, std::placeholders::_1));
     _localRpcMethods.emplace("broadcastNewDevices", std::bind(&NodeBlueClient::broadcastNewDevices, this, std::placeholders::_1));
     _localRpcMethods.emplace("broadcastUpdateDevice", std::bind(&NodeBlueClient::broadcastUpdateDevice, this, std::placeholders::_1));
+    _localRpcMethods.emplace("getNodeMailboxes", std::bind(&NodeBlueClient::getNodeMailboxes, this, std::placeholders::_1));
+    _localRpcMethods.emplace("getFlowStatistics", std::bind(&NodeBlueClient::getFlowStatistics, this, std::placeholders::_1));
+    _localRpcMethods.emplace("getNodeStatistics", std::bind(&NodeBlueClient::getNodeStatistics, this, std::placeholders::_1));
 }
 
 NodeBlueClient::~NodeBlueClient()
@@ -93,6 +99,8 @@ NodeBlueClient::~NodeBlueClient()
     dispose();
     if(_maintenanceThread.joinable()) _maintenanceThread.join();
     if(_watchdogThread.joinable()) _watchdogThread.join();
+    if(_debugOutputThread.joinable()) _debugOutputThread.join();
+    if(_sharedMemoryRingThread.joinable()) _sharedMemoryRingThread.join();
 }
 
 void NodeBlueClient::dispose()
@@ -126,20 +134,16 @@ void NodeBlueClient::dispose()
         GD::bl->shuttingDown = true;
         _stopped = true;
 
-        std::lock_guard<std::mutex> requestInfoGuard(_requestInfoMutex);
-        for(auto& request : _requestInfo)
-        {
-            std::unique_lock<std::mutex> waitLock(request.second->waitMutex);
-            waitLock.unlock();
-            request.second->conditionVariable.notify_all();
-        }
+        _pendingRequests.notifyAll();
 
         stopQueue(0);
         stopQueue(1);
-        stopQueue(2);
+        _mailboxScheduler->stop();
 
         {
             std::lock_guard<std::mutex> flowsGuard(_flowsMutex);
+            //The routing table and the mailboxes (cleared by the scheduler's stop()) hold references to the nodes. unloadNode() waits until these are gone.
+            std::atomic_store(&_routes, std::shared_ptr<NodeRoutes>());
             for(auto& flow : _flows)
             {
                 for(auto& node : flow.second->nodes)
@@ -163,11 +167,6 @@ void NodeBlueClient::dispose()
             _flows.clear();
         }
 
-        {
-            std::lock_guard<std::mutex> rpcResponsesGuard(_rpcResponsesMutex);
-            _rpcResponses.clear();
-        }
-
         _shutdownComplete = true;
         _out.printMessage("Shut down complete.");
     }
@@ -208,24 +207,18 @@ void NodeBlueClient::resetClient(Flows::PVariable packetId)
 
         _out.printMessage("Nodes are stopped. Stopping queues...");
 
-        {
-            std::lock_guard<std::mutex> requestInfoGuard(_requestInfoMutex);
-            for(auto& request : _requestInfo)
-            {
-                std::unique_lock<std::mutex> waitLock(request.second->waitMutex);
-                waitLock.unlock();
-                request.second->conditionVariable.notify_all();
-            }
-        }
+        _pendingRequests.notifyAll();
 
         stopQueue(0);
         stopQueue(1);
-        stopQueue(2);
+        _mailboxScheduler->stop();
 
         _out.printMessage("Doing final cleanups...");
 
         {
             std::lock_guard<std::mutex> flowsGuard(_flowsMutex);
+            //The routing table and the mailboxes (cleared by the scheduler's stop()) hold references to the nodes. unloadNode() waits until these are gone.
+            std::atomic_store(&_routes, std::shared_ptr<NodeRoutes>());
             for(auto& flow : _flows)
             {
                 for(auto& node : flow.second->nodes)
@@ -249,16 +242,6 @@ void NodeBlueClient::resetClient(Flows::PVariable packetId)
             _flows.clear();
         }
 
-        {
-            std::lock_guard<std::mutex> rpcResponsesGuard(_rpcResponsesMutex);
-            _rpcResponses.clear();
-        }
-
-        {
-            std::lock_guard<std::mutex> requestInfoGuard(_requestInfoMutex);
-            _requestInfo.clear();
-        }
-
         {
             std::lock_guard<std::mutex> nodesGuard(_nodesMutex);
             _nodes.clear();
@@ -275,13 +258,19 @@ void NodeBlueClient::resetClient(Flows::PVariable packetId)
         }
 
         {
-            std::lock_guard<std::mutex> inputValuesGuard(_inputValuesMutex);
-            _inputValues.clear();
+            std::lock_guard<std::mutex> inputHistoriesGuard(_inputHistoriesMutex);
+            _inputHistories.clear();
+        }
+
+        {
+            std::lock_guard<std::mutex> nodeStatisticsGuard(_nodeStatisticsMutex);
+            _nodeStatistics.clear();
         }
 
         _out.printMessage("Reinitializing...");
 
         if(_watchdogThread.joinable()) _watchdogThread.join();
+        if(_debugOutputThread.joinable()) _debugOutputThread.join();
 
         _shuttingDownOrRestarting = false;
         _startUpComplete = false;
@@ -290,9 +279,10 @@ void NodeBlueClient::resetClient(Flows::PVariable packetId)
 
         startQueue(0, false, _threadCount, 0, SCHED_OTHER);
         startQueue(1, false, _threadCount, 0, SCHED_OTHER);
-        startQueue(2, false, _threadCount, 0, SCHED_OTHER);
+        _mailboxScheduler->start(_threadCount);
 
         if(GD::bl->settings.nodeBlueWatchdogTimeout() >= 1000) _watchdogThread = std::thread(&NodeBlueClient::watchdog, this);
+        _debugOutputThread = std::thread(&NodeBlueClient::debugOutputThread, this);
 
         _out.printMessage("Reset complete.");
         Flows::PVariable result = std::make_shared<Flows::Variable>();
@@ -338,9 +328,10 @@ void NodeBlueClient::start()
 
         startQueue(0, false, _threadCount, 0, SCHED_OTHER);
         startQueue(1, false, _threadCount, 0, SCHED_OTHER);
-        startQueue(2, false, _threadCount, 0, SCHED_OTHER);
+        _mailboxScheduler->start(_threadCount);
 
         if(GD::bl->settings.nodeBlueWatchdogTimeout() >= 1000) _watchdogThread = std::thread(&NodeBlueClient::watchdog, this);
+        _debugOutputThread = std::thread(&NodeBlueClient::debugOutputThread, this);
 
         _socketPath = GD::bl->settings.socketPath() + "homegearFE.sock";
         if(GD::bl->debugLevel >= 5) _out.printDebug("Debug: Socket path is " + _socketPath);
@@ -388,9 +379,9 @@ void NodeBlueClient::start()
         _maintenanceThread = std::thread(&NodeBlueClient::registerClient, this);
 
         std::vector<char> buffer(1024);
+        std::vector<int> fileDescriptors;
         int32_t result = 0;
         int32_t bytesRead = 0;
-        int32_t processedBytes = 0;
         while(!_stopped)
         {
             timeval timeout{};
@@ -418,7 +409,7 @@ void NodeBlueClient::start()
                 return;
             }
 
-            bytesRead = static_cast<int32_t>(read(_fileDescriptor->descriptor, &buffer[0], 1024));
+            bytesRead = SharedMemoryRing::receive(_fileDescriptor->descriptor, buffer.data(), buffer.size(), fileDescriptors);
             if(bytesRead <= 0) //read returns 0, when connection is disrupted.
             {
                 _out.printMessage("Connection to flows server closed (2). Exiting.");
@@ -431,44 +422,137 @@ void NodeBlueClient::start()
             }
 
             if(bytesRead > (signed) buffer.size()) bytesRead = static_cast<int32_t>(buffer.size());
+            if(!fileDescriptors.empty())
+            {
+                startSharedMemoryRing(fileDescriptors);
+                fileDescriptors.clear();
+            }
 
-            try
+            processData(*_binaryRpc, buffer.data(), bytesRead);
+        }
+        buffer.clear();
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+void NodeBlueClient::processData(Flows::BinaryRpc& binaryRpc, char* data, int32_t length)
+{
+    try
+    {
+        int32_t processedBytes = 0;
+        while(processedBytes < length)
+        {
+            processedBytes += binaryRpc.process(data + processedBytes, length - processedBytes);
+            if(binaryRpc.isFinished())
             {
-                processedBytes = 0;
-                while(processedBytes < bytesRead)
+                if(binaryRpc.getType() == Flows::BinaryRpc::Type::request)
                 {
-                    processedBytes += _binaryRpc->process(buffer.data() + processedBytes, bytesRead - processedBytes);
-                    if(_binaryRpc->isFinished())
+                    std::string methodName;
+                    Flows::PArray parameters = _rpcDecoder->decodeRequest(binaryRpc.getData(), methodName);
+                    std::shared_ptr<BaseLib::IQueueEntry> queueEntry = std::make_shared<QueueEntry>(methodName, parameters);
+                    if(methodName == "shutdown") shutdown(parameters->at(2)->arrayValue);
+                    else if(methodName == "reset")
                     {
-                        if(_binaryRpc->getType() == Flows::BinaryRpc::Type::request)
-                        {
-                            std::string methodName;
-                            Flows::PArray parameters = _rpcDecoder->decodeRequest(_binaryRpc->getData(), methodName);
-                            std::shared_ptr<BaseLib::IQueueEntry> queueEntry = std::make_shared<QueueEntry>(methodName, parameters);
-                            if(methodName == "shutdown") shutdown(parameters->at(2)->arrayValue);
-                            else if(methodName == "reset")
-                            {
-                                if(_maintenanceThread.joinable()) _maintenanceThread.join();
-                                _maintenanceThread = std::thread(&NodeBlueClient::resetClient, this, parameters->at(0));
-                            }
-                            else if(!enqueue(0, queueEntry, !_startUpComplete)) printQueueFullError(_out, "Error: Could not queue RPC request because buffer is full. Dropping it.");
-                        }
-                        else
-                        {
-                            std::shared_ptr<BaseLib::IQueueEntry> queueEntry = std::make_shared<QueueEntry>(_binaryRpc->getData());
-                            if(!enqueue(1, queueEntry, !_startUpComplete)) printQueueFullError(_out, "Error: Could not queue RPC response because buffer is full. Dropping it.");
-                        }
-                        _binaryRpc->reset();
+                        if(_maintenanceThread.joinable()) _maintenanceThread.join();
+                        _maintenanceThread = std::thread(&NodeBlueClient::resetClient, this, parameters->at(0));
                     }
+                    else if(!enqueue(0, queueEntry, !_startUpComplete)) printQueueFullError(_out, "Error: Could not queue RPC request because buffer is full. Dropping it.");
                 }
+                else
+                {
+                    std::shared_ptr<BaseLib::IQueueEntry> queueEntry = std::make_shared<QueueEntry>(binaryRpc.getData());
+                    if(!enqueue(1, queueEntry, !_startUpComplete)) printQueueFullError(_out, "Error: Could not queue RPC response because buffer is full. Dropping it.");
+                }
+                binaryRpc.reset();
+            }
+        }
+    }
+    catch(Flows::BinaryRpcException& ex)
+    {
+        _out.printError("Error processing packet: " + ex.what());
+        binaryRpc.reset();
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+void NodeBlueClient::startSharedMemoryRing(std::vector<int>& fileDescriptors)
+{
+    try
+    {
+        if(fileDescriptors.size() != 3 || _sharedMemoryRing)
+        {
+            for(auto fileDescriptor : fileDescriptors)
+            {
+                close(fileDescriptor);
             }
-            catch(Flows::BinaryRpcException& ex)
+            return;
+        }
+
+        auto sharedMemoryRing = std::make_shared<SharedMemoryRing>();
+        if(!sharedMemoryRing->open(fileDescriptors.at(0), fileDescriptors.at(1), fileDescriptors.at(2)))
+        {
+            //The server already switched to the ring, so we can't continue with the socket.
+            _out.printCritical("Critical: Could not open shared memory ring. Closing connection.");
+            GD::bl->fileDescriptorManager.shutdown(_fileDescriptor);
+            return;
+        }
+        _sharedMemoryRing = sharedMemoryRing;
+        if(_sharedMemoryRingThread.joinable()) _sharedMemoryRingThread.join();
+        _sharedMemoryRingThread = std::thread(&NodeBlueClient::readSharedMemoryRing, this);
+        _out.printInfo("Info: Receiving data from server through shared memory.");
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+void NodeBlueClient::readSharedMemoryRing()
+{
+    try
+    {
+        std::vector<char> buffer(65536);
+        while(!_stopped)
+        {
+            int32_t bytesRead = _sharedMemoryRing->read(buffer.data(), buffer.size(), 100);
+            if(bytesRead == 0) continue;
+            else if(bytesRead < 0)
             {
-                _out.printError("Error processing packet: " + ex.what());
-                _binaryRpc->reset();
+                if(!_stopped) _out.printMessage("Shared memory ring was closed by flows server.");
+                return;
             }
+            processData(*_sharedMemoryRingBinaryRpc, buffer.data(), bytesRead);
         }
-        buffer.clear();
     }
     catch(const std::exception& ex)
     {
@@ -498,6 +582,11 @@ void NodeBlueClient::registerClient()
             return;
         }
         _out.printInfo("Info: Client registered to server.");
+
+        methodName = "openSharedMemoryRing";
+        parameters = std::make_shared<Flows::Array>();
+        result = invoke(methodName, parameters, true);
+        if(result->errorStruct) _out.printInfo("Info: Shared memory transport is not available. Using socket: " + result->structValue->at("faultString")->stringValue);
     }
     catch(const std::exception& ex)
     {
@@ -586,35 +675,8 @@ void NodeBlueClient::processQueueEntry(int32_t index, std::shared_ptr<BaseLib::I
                     _out.printError("Error: Response has wrong array size.");
                     return;
                 }
-                int64_t threadId = response->arrayValue->at(0)->integerValue64;
                 int32_t packetId = response->arrayValue->at(1)->integerValue;
-
-                PRequestInfo requestInfo;
-                {
-                    std::lock_guard<std::mutex> requestInfoGuard(_requestInfoMutex);
-                    auto requestIterator = _requestInfo.find(threadId);
-                    if(requestIterator != _requestInfo.end()) requestInfo = requestIterator->second;
-                }
-                if(requestInfo)
-                {
-                    std::unique_lock<std::mutex> waitLock(requestInfo->waitMutex);
-                    {
-                        std::lock_guard<std::mutex> responseGuard(_rpcResponsesMutex);
-                        auto responseIterator = _rpcResponses[threadId].find(packetId);
-                        if(responseIterator != _rpcResponses[threadId].end())
-                        {
-                            PNodeBlueResponseClient element = responseIterator->second;
-                            if(element)
-                            {
-                                element->response = response;
-                                element->packetId = packetId;
-                                element->finished = true;
-                            }
-                        }
-                    }
-                    waitLock.unlock();
-                    requestInfo->conditionVariable.notify_all();
-                }
+                _pendingRequests.setResponse(packetId, response);
             }
             catch(const std::exception& ex)
             {
@@ -631,71 +693,264 @@ void NodeBlueClient::processQueueEntry(int32_t index, std::shared_ptr<BaseLib::I
             _processingThreadCountMaxReached2 = 0;
             _processingThreadCount2--;
         }
-        else //Node output
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+void NodeBlueClient::processNodeOutput(NodeMailboxScheduler::Message& message)
+{
+    if(!message.nodeInfo || !message.message || _shuttingDownOrRestarting) return;
+    _processingThreadCount3++;
+    try
+    {
+        if(_processingThreadCount3 == _threadCount) _processingThreadCountMaxReached3 = BaseLib::HelperFunctions::getTime();
+
+        Flows::PINode node = message.node ? message.node : _nodeManager->getNode(message.nodeInfo->id);
+        if(node)
         {
-            _processingThreadCount3++;
-            try
+            recordDebugOutput(message.debugState, -1, Flows::PVariable());
+            auto internalMessageIterator = message.message->structValue->find("_internal");
+            if(internalMessageIterator != message.message->structValue->end()) setInternalMessage(message.nodeInfo->id, internalMessageIterator->second);
+
             {
-                if(_processingThreadCount3 == _threadCount) _processingThreadCountMaxReached3 = BaseLib::HelperFunctions::getTime();
+                std::lock_guard<std::mutex> nodeInputGuard(node->getInputMutex());
+                auto startTime = std::chrono::steady_clock::now();
+                if(message.statistics) message.statistics->addMailboxWait(std::chrono::duration_cast<std::chrono::microseconds>(startTime - message.queueTime).count());
+                node->input(message.nodeInfo, message.targetPort, message.message);
+                int64_t processingTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+                if(message.flow)
+                {
+                    message.flow->inputCount++;
+                    message.flow->processingTime += processingTime;
+                }
+                if(message.statistics) message.statistics->addInput(processingTime);
+            }
 
-                if(!queueEntry->nodeInfo || !queueEntry->message || _shuttingDownOrRestarting) return;
-                Flows::PINode node = _nodeManager->getNode(queueEntry->nodeInfo->id);
-                if(node)
+            if(message.inputHistory) message.inputHistory->add(message.message->structValue->at("payload"));
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    _processingThreadCountMaxReached3 = 0;
+    _processingThreadCount3--;
+}
+
+void NodeBlueClient::rebuildRoutes()
+{
+    try
+    {
+        std::unordered_map<std::string, Flows::PNodeInfo> nodes;
+        std::unordered_map<std::string, PFlowInfoClient> nodeFlows;
+        for(auto& flow : _flows)
+        {
+            nodes.insert(flow.second->nodes.begin(), flow.second->nodes.end());
+            for(auto& node : flow.second->nodes)
+            {
+                nodeFlows.emplace(node.first, flow.second);
+            }
+        }
+
+        std::unordered_map<std::string, std::unordered_map<int32_t, Flows::PVariable>> fixedInputValues;
+        {
+            std::lock_guard<std::mutex> fixedInputGuard(_fixedInputValuesMutex);
+            fixedInputValues = _fixedInputValues;
+        }
+
+        //Keep the statistics of nodes that are still running.
+        std::unordered_map<std::string, PNodeStatistics> nodeStatistics;
+        {
+            std::lock_guard<std::mutex> nodeStatisticsGuard(_nodeStatisticsMutex);
+            nodeStatistics.reserve(nodes.size());
+            for(auto& node : nodes)
+            {
+                auto nodeStatisticsIterator = _nodeStatistics.find(node.first);
+                nodeStatistics.emplace(node.first, nodeStatisticsIterator == _nodeStatistics.end() ? std::make_shared<NodeStatistics>() : nodeStatisticsIterator->second);
+            }
+            _nodeStatistics = nodeStatistics;
+        }
+
+        //Keep the debug states of nodes that are still running, so output collected since the last flush isn't lost.
+        std::unordered_map<std::string, PNodeDebugState> debugStates;
+        {
+            std::shared_ptr<NodeRoutes> oldRoutes = std::atomic_load(&_routes);
+            debugStates.reserve(nodes.size());
+            for(auto& node : nodes)
+            {
+                PNodeDebugState debugState;
+                if(oldRoutes)
                 {
-                    std::string eventFlowId;
-                    {
-                        std::lock_guard<std::mutex> eventFlowIdGuard(_eventFlowIdMutex);
-                        eventFlowId = _eventFlowId;
-                    }
-                    if(GD::bl->settings.nodeBlueDebugOutput() && _startUpComplete && _frontendConnected && node->getFlowId() == eventFlowId && BaseLib::HelperFunctions::getTime() - queueEntry->nodeInfo->lastNodeEvent1 >= 100)
+                    auto routeIterator = oldRoutes->find(node.first);
+                    if(routeIterator != oldRoutes->end()) debugState = routeIterator->second->debugState;
+                }
+                debugStates.emplace(node.first, debugState ? debugState : std::make_shared<NodeDebugState>());
+            }
+        }
+
+        //Keep the histories of inputs that are still connected.
+        std::unordered_map<std::string, std::unordered_map<int32_t, PNodeInputHistory>> inputHistories;
+        std::lock_guard<std::mutex> inputHistoriesGuard(_inputHistoriesMutex);
+
+        auto routes = std::make_shared<NodeRoutes>();
+        routes->reserve(nodes.size());
+        for(auto& node : nodes)
+        {
+            auto route = std::make_shared<NodeRoute>();
+            route->nodeInfo = node.second;
+            route->statistics = nodeStatistics.at(node.first);
+            route->debugState = debugStates.at(node.first);
+            //Empty outputs are kept, so the indexes match the ones of "wiresOut".
+            route->outputs.resize(node.second->wiresOut.size());
+            for(uint32_t i = 0; i < node.second->wiresOut.size(); i++)
+            {
+                auto& output = node.second->wiresOut.at(i);
+                route->outputs.at(i).reserve(output.size());
+                for(auto& wire : output)
+                {
+                    auto nodeIterator = nodes.find(wire.id);
+                    if(nodeIterator == nodes.end()) continue;
+
+                    ResolvedWire resolvedWire;
+                    resolvedWire.nodeInfo = nodeIterator->second;
+                    resolvedWire.node = _nodeManager->getNode(wire.id);
+                    if(!resolvedWire.node) continue;
+                    resolvedWire.port = wire.port;
+                    resolvedWire.flow = nodeFlows.at(wire.id);
+                    resolvedWire.statistics = nodeStatistics.at(wire.id);
+                    resolvedWire.debugState = debugStates.at(wire.id);
+
+                    auto fixedInputIterator = fixedInputValues.find(wire.id);
+                    if(fixedInputIterator != fixedInputValues.end())
                     {
-                        queueEntry->nodeInfo->lastNodeEvent1 = BaseLib::HelperFunctions::getTime();
-                        Flows::PVariable timeout = std::make_shared<Flows::Variable>(Flows::VariableType::tStruct);
-                        timeout->structValue->emplace("timeout", std::make_shared<Flows::Variable>(500));
-                        nodeEvent(queueEntry->nodeInfo->id, "highlightNode/" + queueEntry->nodeInfo->id, timeout);
+                        auto inputIterator = fixedInputIterator->second.find(wire.port);
+                        if(inputIterator != fixedInputIterator->second.end()) resolvedWire.fixedInput = inputIterator->second;
                     }
-                    auto internalMessageIterator = queueEntry->message->structValue->find("_internal");
-                    if(internalMessageIterator != queueEntry->message->structValue->end()) setInternalMessage(queueEntry->nodeInfo->id, internalMessageIterator->second);
 
+                    PNodeInputHistory& inputHistory = inputHistories[wire.id][wire.port];
+                    if(!inputHistory)
                     {
-                        std::lock_guard<std::mutex> fixedInputGuard(_fixedInputValuesMutex);
-                        auto nodeIterator = _fixedInputValues.find(queueEntry->nodeInfo->id);
-                        if(nodeIterator != _fixedInputValues.end())
+                        int32_t historySize = NodeInputHistory::DEFAULT_SIZE;
+                        auto historySizeIterator = nodeIterator->second->info->structValue->find("inputHistorySize");
+                        if(historySizeIterator != nodeIterator->second->info->structValue->end())
                         {
-                            auto inputIterator = nodeIterator->second.find(queueEntry->targetPort);
-                            if(inputIterator != nodeIterator->second.end())
-                            {
-                                auto messageCopy = std::make_shared<Flows::Variable>();
-                                *messageCopy = *(queueEntry->message);
-                                (*messageCopy->structValue)["payload"] = inputIterator->second;
-                                queueEntry->message = messageCopy;
-                            }
+                            if(historySizeIterator->second->type == Flows::VariableType::tString) historySize = BaseLib::Math::getNumber(historySizeIterator->second->stringValue);
+                            else historySize = historySizeIterator->second->integerValue;
                         }
-                    }
+                        if(historySize < 0) historySize = 0;
+                        else if(historySize > (int32_t)NodeInputHistory::MAX_SIZE) historySize = NodeInputHistory::MAX_SIZE;
 
-                    {
-                        std::lock_guard<std::mutex> nodeInputGuard(node->getInputMutex());
-                        node->input(queueEntry->nodeInfo, queueEntry->targetPort, queueEntry->message);
+                        auto oldNodeIterator = _inputHistories.find(wire.id);
+                        if(oldNodeIterator != _inputHistories.end())
+                        {
+                            auto oldInputIterator = oldNodeIterator->second.find(wire.port);
+                            if(oldInputIterator != oldNodeIterator->second.end() && oldInputIterator->second->capacity() == (uint32_t)historySize) inputHistory = oldInputIterator->second;
+                        }
+                        if(!inputHistory) inputHistory = std::make_shared<NodeInputHistory>(historySize);
                     }
+                    if(inputHistory->capacity() > 0) resolvedWire.inputHistory = inputHistory;
 
-                    setInputValue(queueEntry->nodeInfo->id, queueEntry->targetPort, queueEntry->message);
+                    route->outputs.at(i).push_back(resolvedWire);
                 }
             }
-            catch(const std::exception& ex)
+            routes->emplace(node.first, route);
+        }
+
+        _inputHistories.swap(inputHistories);
+        {
+            std::lock_guard<std::mutex> eventFlowIdGuard(_eventFlowIdMutex);
+            updateEventFlow(routes);
+        }
+        std::atomic_store(&_routes, routes);
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+void NodeBlueClient::removeFlowRoutes(const PFlowInfoClient& flow)
+{
+    try
+    {
+        {
+            std::lock_guard<std::mutex> nodeStatisticsGuard(_nodeStatisticsMutex);
+            for(auto& node : flow->nodes)
             {
-                _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+                _nodeStatistics.erase(node.first);
             }
-            catch(BaseLib::Exception& ex)
+        }
+        {
+            std::lock_guard<std::mutex> inputHistoriesGuard(_inputHistoriesMutex);
+            for(auto& node : flow->nodes)
             {
-                _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+                _inputHistories.erase(node.first);
             }
-            catch(...)
+        }
+
+        std::shared_ptr<NodeRoutes> oldRoutes = std::atomic_load(&_routes);
+        if(!oldRoutes) return;
+        auto routes = std::make_shared<NodeRoutes>();
+        routes->reserve(oldRoutes->size());
+        for(auto& oldRoute : *oldRoutes)
+        {
+            if(flow->nodes.find(oldRoute.first) != flow->nodes.end()) continue;
+
+            bool leadsToFlow = false;
+            for(auto& output : oldRoute.second->outputs)
             {
-                _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+                for(auto& wire : output)
+                {
+                    if(wire.flow == flow)
+                    {
+                        leadsToFlow = true;
+                        break;
+                    }
+                }
+                if(leadsToFlow) break;
+            }
+            if(!leadsToFlow)
+            {
+                routes->emplace(oldRoute.first, oldRoute.second);
+                continue;
+            }
+
+            auto route = std::make_shared<NodeRoute>(*oldRoute.second);
+            for(auto& output : route->outputs)
+            {
+                output.erase(std::remove_if(output.begin(), output.end(), [&flow](const ResolvedWire& wire) { return wire.flow == flow; }), output.end());
             }
-            _processingThreadCountMaxReached3 = 0;
-            _processingThreadCount3--;
+            routes->emplace(oldRoute.first, route);
         }
+
+        std::atomic_store(&_routes, routes);
     }
     catch(const std::exception& ex)
     {
@@ -756,19 +1011,11 @@ Flows::PVariable NodeBlueClient::invoke(std::string methodName, Flows::PArray pa
 
         int64_t threadId = pthread_self();
 
-        PRequestInfo requestInfo;
-        if(wait)
+        int32_t packetId = wait ? _pendingRequests.add() : _pendingRequests.nextPacketId();
+        if(packetId == -1)
         {
-            std::lock_guard<std::mutex> requestInfoGuard(_requestInfoMutex);
-            auto emplaceResult = _requestInfo.emplace(std::piecewise_construct, std::make_tuple(threadId), std::make_tuple(std::make_shared<RequestInfo>()));
-            if(!emplaceResult.second) _out.printError("Error: Thread is executing invoke() more than once.");
-            requestInfo = emplaceResult.first->second;
-        }
-
-        int32_t packetId;
-        {
-            std::lock_guard<std::mutex> packetIdGuard(_packetIdMutex);
-            packetId = _currentPacketId++;
+            _out.printError("Error: Too many RPC requests are waiting for a response.");
+            return Flows::Variable::createError(-32500, "Unknown application error.");
         }
         Flows::PArray array = std::make_shared<Flows::Array>();
         array->reserve(4);
@@ -779,58 +1026,31 @@ Flows::PVariable NodeBlueClient::invoke(std::string methodName, Flows::PArray pa
         std::vector<char> data;
         _rpcEncoder->encodeRequest(methodName, array, data);
 
-        PNodeBlueResponseClient response;
-        if(wait)
-        {
-            {
-                std::lock_guard<std::mutex> responseGuard(_rpcResponsesMutex);
-                auto result = _rpcResponses[threadId].emplace(packetId, std::make_shared<NodeBlueResponseClient>());
-                if(result.second) response = result.first->second;
-            }
-            if(!response)
-            {
-                _out.printError("Critical: Could not insert response struct into map.");
-                return Flows::Variable::createError(-32500, "Unknown application error.");
-            }
-        }
         Flows::PVariable result = send(data);
         if(result->errorStruct || !wait)
         {
             if(!wait) return std::make_shared<Flows::Variable>();
             else
             {
-                std::lock_guard<std::mutex> responseGuard(_rpcResponsesMutex);
-                _rpcResponses[threadId].erase(packetId);
-                if(_rpcResponses[threadId].empty()) _rpcResponses.erase(threadId);
+                _pendingRequests.remove(packetId);
                 return result;
             }
         }
 
         int64_t startTime = BaseLib::HelperFunctions::getTime();
-        std::unique_lock<std::mutex> waitLock(requestInfo->waitMutex);
-        while(!requestInfo->conditionVariable.wait_for(waitLock, std::chrono::milliseconds(10000), [&]
+        Flows::PVariable response;
+        bool responseReceived = _pendingRequests.wait(packetId, [&]
         {
             if(_shuttingDownOrRestarting && BaseLib::HelperFunctions::getTime() - startTime > 30000) return true;
-            else return response->finished || _stopped;
-        }));
+            else return (bool)_stopped;
+        }, response);
 
-        if(!response->finished || response->response->arrayValue->size() != 3 || response->packetId != packetId)
+        if(!responseReceived || !response || response->arrayValue->size() != 3)
         {
             _out.printError("Error: No response received to RPC request. Method: " + methodName);
             result = Flows::Variable::createError(-1, "No response received.");
         }
-        else result = response->response->arrayValue->at(2);
-
-        {
-            std::lock_guard<std::mutex> responseGuard(_rpcResponsesMutex);
-            _rpcResponses[threadId].erase(packetId);
-            if(_rpcResponses[threadId].empty()) _rpcResponses.erase(threadId);
-        }
-
-        {
-            std::lock_guard<std::mutex> requestInfoGuard(_requestInfoMutex);
-            _requestInfo.erase(threadId);
-        }
+        else result = response->arrayValue->at(2);
 
         return result;
     }
@@ -907,6 +1127,12 @@ void NodeBlueClient::sendResponse(Flows::PVariable& packetId, Flows::PVariable&
 void NodeBlueClient::log(std::string nodeId, int32_t logLevel, std::string message)
 {
     _out.printMessage("Node " + nodeId + ": " + message, logLevel, logLevel <= 3);
+    if(logLevel <= 2)
+    {
+        std::lock_guard<std::mutex> nodeStatisticsGuard(_nodeStatisticsMutex);
+        auto nodeStatisticsIterator = _nodeStatistics.find(nodeId);
+        if(nodeStatisticsIterator != _nodeStatistics.end()) nodeStatisticsIterator->second->addError();
+    }
 }
 
 void NodeBlueClient::subscribePeer(std::string nodeId, uint64_t peerId, int32_t channel, std::string variable)
@@ -951,18 +1177,29 @@ void NodeBlueClient::unsubscribePeer(std::string nodeId, uint64_t peerId, int32_
     }
 }
 
+Flows::PVariable NodeBlueClient::copyMessage(const Flows::PVariable& message)
+{
+    Flows::PVariable copy = std::make_shared<Flows::Variable>(Flows::VariableType::tStruct);
+    if(message->type == Flows::VariableType::tStruct) *copy->structValue = *message->structValue;
+    return copy;
+}
+
 void NodeBlueClient::queueOutput(std::string nodeId, uint32_t index, Flows::PVariable message, bool synchronous)
 {
     try
     {
         if(!message || _shuttingDownOrRestarting) return;
 
-        Flows::PNodeInfo nodeInfo;
+        //The node might still hold a reference to the message. Don't add the routing fields to its struct.
+        message = copyMessage(message);
+
+        PNodeRoute route;
         {
-            std::lock_guard<std::mutex> nodesGuard(_nodesMutex);
-            auto nodesIterator = _nodes.find(nodeId);
-            if(nodesIterator == _nodes.end()) return;
-            nodeInfo = nodesIterator->second;
+            std::shared_ptr<NodeRoutes> routes = std::atomic_load(&_routes);
+            if(!routes) return;
+            auto routeIterator = routes->find(nodeId);
+            if(routeIterator == routes->end()) return;
+            route = routeIterator->second;
         }
 
         {
@@ -982,136 +1219,85 @@ void NodeBlueClient::queueOutput(std::string nodeId, uint32_t index, Flows::PVar
             }
         }
 
-        if(message->structValue->find("payload") == message->structValue->end()) message->structValue->emplace("payload", std::make_shared<Flows::Variable>());
-
-        if(index >= nodeInfo->wiresOut.size())
-        {
-            _out.printError("Error: " + nodeId + " has no output with index " + std::to_string(index) + ".");
-            return;
-        }
-
-        std::string eventFlowId;
-        {
-            std::lock_guard<std::mutex> eventFlowIdGuard(_eventFlowIdMutex);
-            eventFlowId = _eventFlowId;
-        }
-
-        if(synchronous && GD::bl->settings.nodeBlueDebugOutput())
-        {
-            //Output node events before execution of input
-            if(_frontendConnected && _startUpComplete && nodeInfo->info->structValue->at("flow")->stringValue == eventFlowId)
-            {
-                Flows::PVariable timeout = std::make_shared<Flows::Variable>(Flows::VariableType::tStruct);
-                timeout->structValue->emplace("timeout", std::make_shared<Flows::Variable>(500));
-                nodeEvent(nodeId, "highlightNode/" + nodeId, timeout);
-                Flows::PVariable outputIndex = std::make_shared<Flows::Variable>(Flows::VariableType::tStruct);
-                outputIndex->structValue->emplace("index", std::make_shared<Flows::Variable>(index));
-                nodeEvent(nodeId, "highlightLink/" + nodeId, outputIndex);
-
-                Flows::PVariable status = std::make_shared<Flows::Variable>(Flows::VariableType::tStruct);
-                std::string statusText = message->structValue->at("payload")->toString();
-                if(statusText.size() > 20) statusText = statusText.substr(0, 17) + "...";
-                statusText = std::to_string(index) + ": " + BaseLib::HelperFunctions::stripNonPrintable(statusText);
-                status->structValue->emplace("text", std::make_shared<Flows::Variable>(statusText));
-                nodeEvent(nodeId, "statusTop/" + nodeId, status);
-            }
+        if(message->structValue->find("payload") == message->structValue->end()) message->structValue->emplace("payload", std::make_shared<Flows::Variable>());
+
+        if(index >= route->outputs.size())
+        {
+            _out.printError("Error: " + nodeId + " has no output with index " + std::to_string(index) + ".");
+            return;
         }
 
+        recordDebugOutput(route->debugState, index, message->structValue->at("payload"));
+        if(route->statistics) route->statistics->addOutput();
+
         message->structValue->emplace("source", std::make_shared<Flows::Variable>(nodeId));
-        for(auto& node : nodeInfo->wiresOut.at(index))
+        auto& wires = route->outputs.at(index);
+        for(auto& wire : wires)
         {
-            Flows::PNodeInfo outputNodeInfo;
-            {
-                std::lock_guard<std::mutex> nodesGuard(_nodesMutex);
-                auto nodeIterator = _nodes.find(node.id);
-                if(nodeIterator == _nodes.end()) continue;
-                outputNodeInfo = nodeIterator->second;
-            }
+            const Flows::PNodeInfo& outputNodeInfo = wire.nodeInfo;
+            //Every wire gets its own top level struct, so fields set for one target are not visible to others. The values themselves are shared.
+            Flows::PVariable wireMessage = wires.size() > 1 || wire.fixedInput ? copyMessage(message) : message;
+            if(wire.fixedInput) (*wireMessage->structValue)["payload"] = wire.fixedInput;
             if(synchronous)
             {
-                Flows::PINode nextNode = _nodeManager->getNode(outputNodeInfo->id);
+                const Flows::PINode& nextNode = wire.node;
                 if(nextNode)
                 {
-                    if(GD::bl->settings.nodeBlueDebugOutput() && _startUpComplete && _frontendConnected && nextNode->getFlowId() == eventFlowId && BaseLib::HelperFunctions::getTime() - outputNodeInfo->lastNodeEvent1 >= 100)
-                    {
-                        outputNodeInfo->lastNodeEvent1 = BaseLib::HelperFunctions::getTime();
-                        Flows::PVariable timeout = std::make_shared<Flows::Variable>(Flows::VariableType::tStruct);
-                        timeout->structValue->emplace("timeout", std::make_shared<Flows::Variable>(500));
-                        nodeEvent(outputNodeInfo->id, "highlightNode/" + outputNodeInfo->id, timeout);
-                    }
-                    auto internalMessageIterator = message->structValue->find("_internal");
-                    if(internalMessageIterator != message->structValue->end())
+                    recordDebugOutput(wire.debugState, -1, Flows::PVariable());
+                    auto internalMessageIterator = wireMessage->structValue->find("_internal");
+                    if(internalMessageIterator != wireMessage->structValue->end())
                     {
+                        //Copy before writing. The internal message is shared with the source node and the other wires.
+                        Flows::PVariable internalMessage = copyMessage(internalMessageIterator->second);
                         //Emplace makes sure, that synchronousOutput stays false when set to false in node. This is the only way to make a synchronous output asynchronous again.
-                        internalMessageIterator->second->structValue->emplace("synchronousOutput", std::make_shared<Flows::Variable>(true));
-                        setInternalMessage(outputNodeInfo->id, internalMessageIterator->second);
+                        internalMessage->structValue->emplace("synchronousOutput", std::make_shared<Flows::Variable>(true));
+                        internalMessageIterator->second = internalMessage;
+                        setInternalMessage(outputNodeInfo->id, internalMessage);
                     }
                     else
                     {
                         Flows::PVariable internalMessage = std::make_shared<Flows::Variable>(Flows::VariableType::tStruct);
                         internalMessage->structValue->emplace("synchronousOutput", std::make_shared<Flows::Variable>(true));
                         setInternalMessage(outputNodeInfo->id, internalMessage);
-                        message->structValue->emplace("_internal", internalMessage);
+                        wireMessage->structValue->emplace("_internal", internalMessage);
                     }
 
                     {
-                        std::lock_guard<std::mutex> fixedInputGuard(_fixedInputValuesMutex);
-                        auto nodeIterator = _fixedInputValues.find(outputNodeInfo->id);
-                        if(nodeIterator != _fixedInputValues.end())
+                        std::lock_guard<std::mutex> nodeInputGuard(nextNode->getInputMutex());
+                        auto startTime = std::chrono::steady_clock::now();
+                        nextNode->input(outputNodeInfo, wire.port, wireMessage);
+                        int64_t processingTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+                        if(wire.flow)
                         {
-                            auto inputIterator = nodeIterator->second.find(node.port);
-                            if(inputIterator != nodeIterator->second.end())
-                            {
-                                auto messageCopy = std::make_shared<Flows::Variable>();
-                                *messageCopy = *message;
-                                (*messageCopy->structValue)["payload"] = inputIterator->second;
-                                message = messageCopy;
-                            }
+                            wire.flow->inputCount++;
+                            wire.flow->processingTime += processingTime;
                         }
+                        if(wire.statistics) wire.statistics->addInput(processingTime);
                     }
 
-                    {
-                        std::lock_guard<std::mutex> nodeInputGuard(nextNode->getInputMutex());
-                        nextNode->input(outputNodeInfo, node.port, message);
-                    }
-
-                    setInputValue(outputNodeInfo->id, node.port, message);
+                    if(wire.inputHistory) wire.inputHistory->add(wireMessage->structValue->at("payload"));
                 }
             }
             else
             {
-                if(queueSize(2) > 1000 && BaseLib::HelperFunctions::getTime() - _lastQueueSize > 1000)
+                if(_mailboxScheduler->size() > 1000 && BaseLib::HelperFunctions::getTime() - _lastQueueSize > 1000)
                 {
                     _lastQueueSize = BaseLib::HelperFunctions::getTime();
-                    if(_startUpComplete) _out.printWarning("Warning: Node output queue has " + std::to_string(queueSize(2)) + " entries.");
-                    else _out.printInfo("Info: Node output queue has " + std::to_string(queueSize(2)) + " entries.");
+                    if(_startUpComplete) _out.printWarning("Warning: Node mailboxes have " + std::to_string(_mailboxScheduler->size()) + " entries.");
+                    else _out.printInfo("Info: Node mailboxes have " + std::to_string(_mailboxScheduler->size()) + " entries.");
                 }
-                std::shared_ptr<BaseLib::IQueueEntry> queueEntry = std::make_shared<QueueEntry>(outputNodeInfo, node.port, message);
-                if(!enqueue(2, queueEntry, !_startUpComplete))
-                {
-                    printQueueFullError(_out, "Error: Dropping output of node " + nodeId + ". Queue is full.");
-                    return;
-                }
-            }
-        }
-
-        if(!synchronous && GD::bl->settings.nodeBlueDebugOutput())
-        {
-            if(_frontendConnected && _startUpComplete && nodeInfo->info->structValue->at("flow")->stringValue == eventFlowId)
-            {
-                Flows::PVariable timeout = std::make_shared<Flows::Variable>(Flows::VariableType::tStruct);
-                timeout->structValue->emplace("timeout", std::make_shared<Flows::Variable>(500));
-                nodeEvent(nodeId, "highlightNode/" + nodeId, timeout);
-                Flows::PVariable outputIndex = std::make_shared<Flows::Variable>(Flows::VariableType::tStruct);
-                outputIndex->structValue->emplace("index", std::make_shared<Flows::Variable>(index));
-                nodeEvent(nodeId, "highlightLink/" + nodeId, outputIndex);
-
-                Flows::PVariable status = std::make_shared<Flows::Variable>(Flows::VariableType::tStruct);
-                std::string statusText = message->structValue->at("payload")->toString();
-                if(statusText.size() > 20) statusText = statusText.substr(0, 17) + "...";
-                statusText = std::to_string(index) + ": " + BaseLib::HelperFunctions::stripNonPrintable(statusText);
-                status->structValue->emplace("text", std::make_shared<Flows::Variable>(statusText));
-                nodeEvent(nodeId, "statusTop/" + nodeId, status);
+                NodeMailboxScheduler::Message mailboxMessage;
+                mailboxMessage.nodeInfo = outputNodeInfo;
+                mailboxMessage.node = wire.node;
+                mailboxMessage.inputHistory = wire.inputHistory;
+                mailboxMessage.flow = wire.flow;
+                mailboxMessage.statistics = wire.statistics;
+                mailboxMessage.debugState = wire.debugState;
+                mailboxMessage.queueTime = std::chrono::steady_clock::now();
+                mailboxMessage.targetPort = wire.port;
+                mailboxMessage.message = wireMessage;
+                //Waits when the mailbox of the target node is full.
+                if(!_mailboxScheduler->post(mailboxMessage)) return;
             }
         }
     }
@@ -1160,6 +1346,147 @@ void NodeBlueClient::nodeEvent(std::string nodeId, std::string topic, Flows::PVa
     }
 }
 
+void NodeBlueClient::recordDebugOutput(const PNodeDebugState& debugState, int32_t outputIndex, const Flows::PVariable& payload)
+{
+    try
+    {
+        if(!debugState || !debugState->inEventFlow || !_frontendConnected || !_startUpComplete || !GD::bl->settings.nodeBlueDebugOutput()) return;
+
+        if(outputIndex >= 0) debugState->recordOutput(outputIndex, payload);
+        else debugState->recordInput();
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+void NodeBlueClient::updateEventFlow(const std::shared_ptr<NodeRoutes>& routes)
+{
+    try
+    {
+        if(!routes) return;
+        for(auto& route : *routes)
+        {
+            auto flowIterator = route.second->nodeInfo->info->structValue->find("flow");
+            route.second->debugState->inEventFlow = flowIterator != route.second->nodeInfo->info->structValue->end() && flowIterator->second->stringValue == _eventFlowId;
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+void NodeBlueClient::flushDebugOutputs()
+{
+    try
+    {
+        std::shared_ptr<NodeRoutes> routes = std::atomic_load(&_routes);
+        if(!routes || !_frontendConnected || !_startUpComplete) return;
+
+        Flows::PVariable events;
+        auto addEvent = [&](const std::string& nodeId, const std::string& topic, Flows::PVariable value)
+        {
+            Flows::PVariable event = std::make_shared<Flows::Variable>(Flows::VariableType::tArray);
+            event->arrayValue->reserve(3);
+            event->arrayValue->push_back(std::make_shared<Flows::Variable>(nodeId));
+            event->arrayValue->push_back(std::make_shared<Flows::Variable>(topic + nodeId));
+            event->arrayValue->push_back(value);
+            events->arrayValue->push_back(event);
+        };
+
+        uint64_t outputMask = 0;
+        int32_t lastOutputIndex = -1;
+        std::string lastPayloadPreview;
+        for(auto& route : *routes)
+        {
+            if(!route.second->debugState->collect(outputMask, lastOutputIndex, lastPayloadPreview)) continue;
+            if(!events) events = std::make_shared<Flows::Variable>(Flows::VariableType::tArray);
+
+            const std::string& nodeId = route.first;
+            Flows::PVariable timeout = std::make_shared<Flows::Variable>(Flows::VariableType::tStruct);
+            timeout->structValue->emplace("timeout", std::make_shared<Flows::Variable>(500));
+            addEvent(nodeId, "highlightNode/", timeout);
+
+            for(int32_t i = 0; i < 64; i++)
+            {
+                if(!(outputMask & (1ull << i))) continue;
+                Flows::PVariable outputIndex = std::make_shared<Flows::Variable>(Flows::VariableType::tStruct);
+                outputIndex->structValue->emplace("index", std::make_shared<Flows::Variable>(i));
+                addEvent(nodeId, "highlightLink/", outputIndex);
+            }
+
+            if(lastOutputIndex != -1)
+            {
+                Flows::PVariable status = std::make_shared<Flows::Variable>(Flows::VariableType::tStruct);
+                std::string statusText = std::to_string(lastOutputIndex) + ": " + BaseLib::HelperFunctions::stripNonPrintable(lastPayloadPreview);
+                status->structValue->emplace("text", std::make_shared<Flows::Variable>(statusText));
+                addEvent(nodeId, "statusTop/", status);
+            }
+        }
+
+        if(!events) return;
+
+        Flows::PArray parameters = std::make_shared<Flows::Array>();
+        parameters->push_back(events);
+        Flows::PVariable result = invoke("nodeEvents", parameters, false);
+        if(result->errorStruct) GD::out.printError("Error calling nodeEvents: " + result->structValue->at("faultString")->stringValue);
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+void NodeBlueClient::debugOutputThread()
+{
+    while(!_stopped && !_shuttingDownOrRestarting)
+    {
+        try
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds((int32_t)DEBUG_OUTPUT_INTERVAL));
+            flushDebugOutputs();
+        }
+        catch(const std::exception& ex)
+        {
+            _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+        }
+        catch(BaseLib::Exception& ex)
+        {
+            _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+        }
+        catch(...)
+        {
+            _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+        }
+    }
+}
+
 Flows::PVariable NodeBlueClient::getNodeData(std::string nodeId, std::string key)
 {
     try
@@ -1253,51 +1580,6 @@ void NodeBlueClient::setInternalMessage(std::string nodeId, Flows::PVariable mes
     }
 }
 
-void NodeBlueClient::setInputValue(std::string& nodeId, int32_t inputIndex, Flows::PVariable message)
-{
-    try
-    {
-        std::lock_guard<std::mutex> inputValuesGuard(_inputValuesMutex);
-        Flows::PVariable payload = message->structValue->at("payload");
-        if(payload->type == Flows::VariableType::tArray)
-        {
-            payload = std::make_shared<Flows::Variable>(std::string("Array"));
-        }
-        else if(payload->type == Flows::VariableType::tStruct)
-        {
-            payload = std::make_shared<Flows::Variable>(std::string("Struct"));
-        }
-        else if(payload->type == Flows::VariableType::tBinary)
-        {
-            if(payload->binaryValue.size() > 10) payload = std::make_shared<Flows::Variable>(BaseLib::HelperFunctions::getHexString(payload->binaryValue.data(), 10) + "...");
-            else payload = std::make_shared<Flows::Variable>(BaseLib::HelperFunctions::getHexString(payload->binaryValue.data(), payload->binaryValue.size()));
-        }
-        else if(payload->type == Flows::VariableType::tString && payload->stringValue.size() > 20)
-        {
-            payload = std::make_shared<Flows::Variable>(payload->stringValue.substr(0, 20) + "...");
-        }
-
-        auto& element = _inputValues[nodeId][inputIndex];
-        InputValue inputValue;
-        inputValue.time = BaseLib::HelperFunctions::getTime();
-        inputValue.value = payload;
-        element.push_front(std::move(inputValue));
-        while(element.size() > 10) element.pop_back();
-    }
-    catch(const std::exception& ex)
-    {
-        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(BaseLib::Exception& ex)
-    {
-        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(...)
-    {
-        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
-    }
-}
-
 Flows::PVariable NodeBlueClient::getConfigParameter(std::string nodeId, std::string name)
 {
     try
@@ -1446,6 +1728,7 @@ Flows::PVariable NodeBlueClient::startFlow(Flows::PArray& parameters)
         PFlowInfoClient flow = std::make_shared<FlowInfoClient>();
         flow->id = parameters->at(0)->integerValue;
         flow->flow = parameters->at(1)->arrayValue->at(0);
+        flow->startTime = BaseLib::HelperFunctions::getTime();
         std::string flowId;
         auto flowIdIterator = flow->flow->structValue->find("id");
         if(flowIdIterator != flow->flow->structValue->end()) flowId = flowIdIterator->second->stringValue;
@@ -1617,9 +1900,13 @@ Flows::PVariable NodeBlueClient::startNodes(Flows::PArray& parameters)
     try
     {
         std::lock_guard<std::mutex> flowsGuard(_flowsMutex);
+        //Nodes may output messages in start() or from timers started there, so the routes need to be complete before the first node is started.
+        rebuildRoutes();
+        std::set<std::string> nodesToRemove;
         for(auto& flow : _flows)
         {
-            std::set<std::string> nodesToRemove;
+            if(flow.second->nodesStarted) continue;
+            flow.second->nodesStarted = true;
             for(auto& nodeIterator : flow.second->nodes)
             {
                 Flows::PINode node = _nodeManager->getNode(nodeIterator.second->id);
@@ -1636,10 +1923,19 @@ Flows::PVariable NodeBlueClient::startNodes(Flows::PArray& parameters)
             for(auto& node : nodesToRemove)
             {
                 flow.second->nodes.erase(node);
+            }
+        }
+        if(!nodesToRemove.empty())
+        {
+            //Remove the failed nodes from the routing table and their mailboxes first, as both reference them and unloadNode() waits for that.
+            rebuildRoutes();
+            for(auto& node : nodesToRemove)
+            {
                 {
                     std::lock_guard<std::mutex> nodesGuard(_nodesMutex);
                     _nodes.erase(node);
                 }
+                _mailboxScheduler->removeMailbox(node);
                 _nodeManager->unloadNode(node);
             }
         }
@@ -1667,6 +1963,8 @@ Flows::PVariable NodeBlueClient::configNodesStarted(Flows::PArray& parameters)
         std::lock_guard<std::mutex> flowsGuard(_flowsMutex);
         for(auto& flow : _flows)
         {
+            if(flow.second->configNodesStarted) continue;
+            flow.second->configNodesStarted = true;
             for(auto& nodeIterator : flow.second->nodes)
             {
                 Flows::PINode node = _nodeManager->getNode(nodeIterator.second->id);
@@ -1697,6 +1995,8 @@ Flows::PVariable NodeBlueClient::startUpComplete(Flows::PArray& parameters)
         std::lock_guard<std::mutex> flowsGuard(_flowsMutex);
         for(auto& flow : _flows)
         {
+            if(flow.second->startUpComplete) continue;
+            flow.second->startUpComplete = true;
             for(auto& nodeIterator : flow.second->nodes)
             {
                 Flows::PINode node = _nodeManager->getNode(nodeIterator.second->id);
@@ -1769,7 +2069,25 @@ Flows::PVariable NodeBlueClient::stopFlow(Flows::PArray& parameters)
         std::lock_guard<std::mutex> flowsGuard(_flowsMutex);
         auto flowsIterator = _flows.find(parameters->at(0)->integerValue);
         if(flowsIterator == _flows.end()) return Flows::Variable::createError(-100, "Unknown flow.");
-        for(auto& node : flowsIterator->second->nodes)
+
+        PFlowInfoClient flow = flowsIterator->second;
+
+        //Remove the flow from the routing table first, so no more messages are delivered to its nodes.
+        _flows.erase(flowsIterator);
+        removeFlowRoutes(flow);
+
+        for(auto& nodeIterator : flow->nodes)
+        {
+            Flows::PINode node = _nodeManager->getNode(nodeIterator.second->id);
+            if(node) node->stop();
+        }
+        for(auto& nodeIterator : flow->nodes)
+        {
+            Flows::PINode node = _nodeManager->getNode(nodeIterator.second->id);
+            if(node) node->waitForStop();
+        }
+
+        for(auto& node : flow->nodes)
         {
             {
                 std::lock_guard<std::mutex> peerSubscriptionsGuard(_peerSubscriptionsMutex);
@@ -1784,9 +2102,17 @@ Flows::PVariable NodeBlueClient::stopFlow(Flows::PArray& parameters)
                     }
                 }
             }
+            _mailboxScheduler->removeMailbox(node.second->id); //Queued messages reference the node, so they need to be gone before unloadNode().
             _nodeManager->unloadNode(node.second->id);
+            {
+                std::lock_guard<std::mutex> nodesGuard(_nodesMutex);
+                _nodes.erase(node.first);
+            }
+            {
+                std::lock_guard<std::mutex> internalMessagesGuard(_internalMessagesMutex);
+                _internalMessages.erase(node.first);
+            }
         }
-        _flows.erase(flowsIterator);
         return std::make_shared<Flows::Variable>();
     }
     catch(const std::exception& ex)
@@ -2028,37 +2354,28 @@ Flows::PVariable NodeBlueClient::getNodeVariable(Flows::PArray& parameters)
         {
             std::string indexString = parameters->at(1)->stringValue.substr(10);
             int32_t index = Flows::Math::getNumber(indexString);
-            std::lock_guard<std::mutex> inputValuesGuard(_inputValuesMutex);
-            auto nodeIterator = _inputValues.find(parameters->at(0)->stringValue);
-            if(nodeIterator != _inputValues.end())
+            std::lock_guard<std::mutex> inputHistoriesGuard(_inputHistoriesMutex);
+            auto nodeIterator = _inputHistories.find(parameters->at(0)->stringValue);
+            if(nodeIterator != _inputHistories.end())
             {
                 auto inputIterator = nodeIterator->second.find(index);
-                if(inputIterator != nodeIterator->second.end()) return inputIterator->second.front().value;
+                if(inputIterator != nodeIterator->second.end())
+                {
+                    Flows::PVariable value = inputIterator->second->getLast();
+                    if(value) return value;
+                }
             }
         }
         else if(parameters->at(1)->stringValue.compare(0, sizeof("inputHistory") - 1, "inputHistory") == 0 && parameters->at(1)->stringValue.size() > 12)
         {
             std::string indexString = parameters->at(1)->stringValue.substr(12);
             int32_t index = Flows::Math::getNumber(indexString);
-            std::lock_guard<std::mutex> inputValuesGuard(_inputValuesMutex);
-            auto nodeIterator = _inputValues.find(parameters->at(0)->stringValue);
-            if(nodeIterator != _inputValues.end())
+            std::lock_guard<std::mutex> inputHistoriesGuard(_inputHistoriesMutex);
+            auto nodeIterator = _inputHistories.find(parameters->at(0)->stringValue);
+            if(nodeIterator != _inputHistories.end())
             {
                 auto inputIterator = nodeIterator->second.find(index);
-                if(inputIterator != nodeIterator->second.end())
-                {
-                    Flows::PVariable array = std::make_shared<Flows::Variable>(Flows::VariableType::tArray);
-                    array->arrayValue->reserve(inputIterator->second.size());
-                    for(auto& inputValue : inputIterator->second)
-                    {
-                        Flows::PVariable innerArray = std::make_shared<Flows::Variable>(Flows::VariableType::tArray);
-                        innerArray->arrayValue->reserve(2);
-                        innerArray->arrayValue->push_back(std::make_shared<Flows::Variable>(inputValue.time));
-                        innerArray->arrayValue->push_back(inputValue.value);
-                        array->arrayValue->push_back(innerArray);
-                    }
-                    return array;
-                }
+                if(inputIterator != nodeIterator->second.end()) return inputIterator->second->getHistory();
             }
         }
         else if(parameters->at(1)->stringValue.compare(0, sizeof("fixedInput") - 1, "fixedInput") == 0 && parameters->at(1)->stringValue.size() > 10)
@@ -2156,14 +2473,18 @@ Flows::PVariable NodeBlueClient::setNodeVariable(Flows::PArray& parameters)
 
             if(parameters->at(2)->arrayValue->size() != 2)
             {
-                std::lock_guard<std::mutex> fixedInputGuard(_fixedInputValuesMutex);
-                auto fixedInputIterator = _fixedInputValues.find(parameters->at(0)->stringValue);
-                if(fixedInputIterator != _fixedInputValues.end())
                 {
-                    fixedInputIterator->second.erase(index);
-                    if(fixedInputIterator->second.empty()) _fixedInputValues.erase(fixedInputIterator);
+                    std::lock_guard<std::mutex> fixedInputGuard(_fixedInputValuesMutex);
+                    auto fixedInputIterator = _fixedInputValues.find(parameters->at(0)->stringValue);
+                    if(fixedInputIterator != _fixedInputValues.end())
+                    {
+                        fixedInputIterator->second.erase(index);
+                        if(fixedInputIterator->second.empty()) _fixedInputValues.erase(fixedInputIterator);
+                    }
                 }
 
+                std::lock_guard<std::mutex> flowsGuard(_flowsMutex);
+                rebuildRoutes();
                 return std::make_shared<Flows::Variable>();
             }
 
@@ -2212,6 +2533,11 @@ Flows::PVariable NodeBlueClient::setNodeVariable(Flows::PArray& parameters)
                 _fixedInputValues[parameters->at(0)->stringValue][index] = value;
             }
 
+            {
+                std::lock_guard<std::mutex> flowsGuard(_flowsMutex);
+                rebuildRoutes();
+            }
+
             Flows::PNodeInfo nodeInfo;
             {
                 std::lock_guard<std::mutex> nodesGuard(_nodesMutex);
@@ -2260,8 +2586,10 @@ Flows::PVariable NodeBlueClient::setFlowVariable(Flows::PArray& parameters)
         if(parameters->size() != 3) return Flows::Variable::createError(-1, "Wrong parameter count.");
         if(parameters->at(1)->stringValue == "enableEvents" && parameters->at(2)->booleanValue)
         {
+            std::lock_guard<std::mutex> flowsGuard(_flowsMutex);
             std::lock_guard<std::mutex> eventFlowGuard(_eventFlowIdMutex);
             _eventFlowId = parameters->at(0)->stringValue;
+            updateEventFlow(std::atomic_load(&_routes));
             _out.printInfo("Info: Events are now sent to flow " + _eventFlowId);
         }
 
@@ -2446,6 +2774,85 @@ Flows::PVariable NodeBlueClient::broadcastUpdateDevice(Flows::PArray& parameters
     }
     return Flows::Variable::createError(-32500, "Unknown application error.");
 }
+Flows::PVariable NodeBlueClient::getNodeMailboxes(Flows::PArray& parameters)
+{
+    try
+    {
+        return _mailboxScheduler->getMailboxDepths();
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return Flows::Variable::createError(-32500, "Unknown application error.");
+}
+
+Flows::PVariable NodeBlueClient::getFlowStatistics(Flows::PArray& parameters)
+{
+    try
+    {
+        Flows::PVariable statistics = std::make_shared<Flows::Variable>(Flows::VariableType::tStruct);
+        int64_t time = BaseLib::HelperFunctions::getTime();
+        std::lock_guard<std::mutex> flowsGuard(_flowsMutex);
+        for(auto& flow : _flows)
+        {
+            Flows::PVariable flowStatistics = std::make_shared<Flows::Variable>(Flows::VariableType::tStruct);
+            flowStatistics->structValue->emplace("inputs", std::make_shared<Flows::Variable>((int64_t)flow.second->inputCount));
+            flowStatistics->structValue->emplace("processingTime", std::make_shared<Flows::Variable>((int64_t)flow.second->processingTime));
+            flowStatistics->structValue->emplace("runtime", std::make_shared<Flows::Variable>(time - flow.second->startTime));
+            statistics->structValue->emplace(std::to_string(flow.first), flowStatistics);
+        }
+        return statistics;
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return Flows::Variable::createError(-32500, "Unknown application error.");
+}
+
+Flows::PVariable NodeBlueClient::getNodeStatistics(Flows::PArray& parameters)
+{
+    try
+    {
+        Flows::PVariable statistics = std::make_shared<Flows::Variable>(Flows::VariableType::tStruct);
+        std::lock_guard<std::mutex> nodeStatisticsGuard(_nodeStatisticsMutex);
+        for(auto& nodeStatistics : _nodeStatistics)
+        {
+            statistics->structValue->emplace(nodeStatistics.first, nodeStatistics.second->get());
+        }
+        return statistics;
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return Flows::Variable::createError(-32500, "Unknown application error.");
+}
 // }}}
 
 }
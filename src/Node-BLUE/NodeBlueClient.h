@@ -31,9 +31,12 @@
 #ifndef NODEBLUECLIENT_H_
 #define NODEBLUECLIENT_H_
 
-#include "NodeBlueResponseClient.h"
 #include "FlowInfoClient.h"
+#include "NodeInputHistory.h"
+#include "NodeMailboxScheduler.h"
 #include "NodeManager.h"
+#include "../IPC/SharedMemoryRing.h"
+#include "../IPC/PendingRequests.h"
 
 #include <homegear-node/BinaryRpc.h>
 #include <homegear-node/RpcDecoder.h>
@@ -63,18 +66,30 @@ public:
 	void start();
 
 private:
-	struct RequestInfo
+	struct ResolvedWire
 	{
-		std::mutex waitMutex;
-		std::condition_variable conditionVariable;
+		Flows::PNodeInfo nodeInfo;
+		Flows::PINode node;
+		uint32_t port = 0;
+		Flows::PVariable fixedInput;
+		PNodeInputHistory inputHistory;
+		PFlowInfoClient flow;
+		PNodeStatistics statistics;
+		PNodeDebugState debugState;
 	};
-	typedef std::shared_ptr<RequestInfo> PRequestInfo;
 
-	struct InputValue
+	/**
+	 * The output wires of a node with their targets already looked up. One vector per output, indexed like "wiresOut".
+	 */
+	struct NodeRoute
 	{
-		int64_t time = 0;
-		Flows::PVariable value;
+		Flows::PNodeInfo nodeInfo;
+		PNodeStatistics statistics;
+		PNodeDebugState debugState;
+		std::vector<std::vector<ResolvedWire>> outputs;
 	};
+	typedef std::shared_ptr<NodeRoute> PNodeRoute;
+	typedef std::unordered_map<std::string, PNodeRoute> NodeRoutes;
 
 	class QueueEntry : public BaseLib::IQueueEntry
 	{
@@ -89,13 +104,6 @@ private:
 
 		QueueEntry(std::vector<char>& packet) { this->packet = packet; }
 
-		QueueEntry(Flows::PNodeInfo nodeInfo, uint32_t targetPort, Flows::PVariable message)
-		{
-			this->nodeInfo = nodeInfo;
-			this->targetPort = targetPort;
-			this->message = message;
-		}
-
 		virtual ~QueueEntry() {}
 
 		//{{{ Request
@@ -106,12 +114,6 @@ private:
 		//{{{ Response
 		std::vector<char> packet;
 		//}}}
-
-		//{{{ Node output
-		Flows::PNodeInfo nodeInfo;
-		uint32_t targetPort = 0;
-		Flows::PVariable message;
-		//}}}
 	};
 
 	BaseLib::Output _out;
@@ -130,24 +132,29 @@ private:
 	std::shared_ptr<BaseLib::FileDescriptor> _fileDescriptor;
 	std::atomic_bool _stopped;
 	std::mutex _sendMutex;
-	std::mutex _rpcResponsesMutex;
-	std::map<int64_t, std::map<int32_t, PNodeBlueResponseClient>> _rpcResponses;
+	PendingRequests<Flows::PVariable> _pendingRequests;
 	std::shared_ptr<BaseLib::RpcClientInfo> _dummyClientInfo;
 	std::map<std::string, std::function<Flows::PVariable(Flows::PArray& parameters)>> _localRpcMethods;
 	std::thread _maintenanceThread;
 	std::thread _watchdogThread;
-	std::mutex _requestInfoMutex;
-	std::map<int64_t, PRequestInfo> _requestInfo;
-	std::mutex _packetIdMutex;
-	int32_t _currentPacketId = 0;
 	std::atomic_bool _nodesStopped;
 	std::unique_ptr<NodeManager> _nodeManager;
+	std::unique_ptr<NodeMailboxScheduler> _mailboxScheduler;
 	std::atomic_bool _frontendConnected;
 	std::atomic<int64_t> _lastQueueSize;
 	std::mutex _eventFlowIdMutex;
 	std::string _eventFlowId;
 
+	/**
+	 * Interval in milliseconds in which collected debug outputs are sent to the frontend. This also is the maximum event rate per node.
+	 */
+	static const int32_t DEBUG_OUTPUT_INTERVAL = 200;
+	std::thread _debugOutputThread;
+
 	std::unique_ptr<Flows::BinaryRpc> _binaryRpc;
+	std::unique_ptr<Flows::BinaryRpc> _sharedMemoryRingBinaryRpc;
+	PSharedMemoryRing _sharedMemoryRing;
+	std::thread _sharedMemoryRingThread;
 	std::unique_ptr<Flows::RpcDecoder> _rpcDecoder;
 	std::unique_ptr<Flows::RpcEncoder> _rpcEncoder;
 
@@ -165,18 +172,38 @@ private:
 	std::mutex _internalMessagesMutex;
 	std::unordered_map<std::string, Flows::PVariable> _internalMessages;
 
-	std::mutex _inputValuesMutex;
-	std::unordered_map<std::string, std::unordered_map<int32_t, std::list<InputValue>>> _inputValues;
+	/**
+	 * The input histories are created by rebuildRoutes() and referenced by the routing table, so recording an input doesn't need this mutex.
+	 */
+	std::mutex _inputHistoriesMutex;
+	std::unordered_map<std::string, std::unordered_map<int32_t, PNodeInputHistory>> _inputHistories;
+	std::mutex _nodeStatisticsMutex;
+	std::unordered_map<std::string, PNodeStatistics> _nodeStatistics;
 
 	std::mutex _fixedInputValuesMutex;
 	std::unordered_map<std::string, std::unordered_map<int32_t, Flows::PVariable>> _fixedInputValues;
 
+	/**
+	 * Immutable routing table used by queueOutput(). Read with std::atomic_load and replaced as a whole by rebuildRoutes() and removeFlowRoutes().
+	 */
+	std::shared_ptr<NodeRoutes> _routes;
+
 	void watchdog();
 
 	void resetClient(Flows::PVariable packetId);
 
 	void registerClient();
 
+	void processData(Flows::BinaryRpc& binaryRpc, char* data, int32_t length);
+
+	/**
+	 * Maps the shared memory ring passed by the server and starts reading from it. From then on all data from the server
+	 * is received through the ring. Data to the server is still sent over the socket.
+	 */
+	void startSharedMemoryRing(std::vector<int>& fileDescriptors);
+
+	void readSharedMemoryRing();
+
 	Flows::PVariable invoke(std::string methodName, Flows::PArray parameters, bool wait);
 
 	Flows::PVariable invokeNodeMethod(std::string nodeId, std::string methodName, Flows::PArray parameters, bool wait);
@@ -185,6 +212,24 @@ private:
 
 	void processQueueEntry(int32_t index, std::shared_ptr<BaseLib::IQueueEntry>& entry);
 
+	/**
+	 * Passes asynchronous node output to the input of the target node. Called by the mailbox scheduler.
+	 */
+	void processNodeOutput(NodeMailboxScheduler::Message& message);
+
+	/**
+	 * Resolves the output wires of all running nodes and publishes the result in _routes. _flowsMutex needs to be locked.
+	 *
+	 * startFlow() doesn't call this. The routes of a batch of started flows are built once by startNodes(), which the server calls after the batch.
+	 */
+	void rebuildRoutes();
+
+	/**
+	 * Publishes a copy of _routes without the nodes of "flow" and without wires into them. Routes that don't lead to the flow are shared with the
+	 * previous table instead of being resolved again. _flowsMutex needs to be locked.
+	 */
+	void removeFlowRoutes(const PFlowInfoClient& flow);
+
 	Flows::PVariable send(std::vector<char>& data);
 
 	void log(std::string nodeId, int32_t logLevel, std::string message);
@@ -193,18 +238,44 @@ private:
 
 	void unsubscribePeer(std::string nodeId, uint64_t peerId, int32_t channel, std::string variable);
 
+	/**
+	 * Returns a new message struct referencing the same values as "message" (copy on write). Only the top level is copied, so replacing or adding a field
+	 * of the copy doesn't affect the original, while payloads are never duplicated.
+	 */
+	static Flows::PVariable copyMessage(const Flows::PVariable& message);
+
 	void queueOutput(std::string nodeId, uint32_t index, Flows::PVariable message, bool synchronous);
 
 	void nodeEvent(std::string nodeId, std::string topic, Flows::PVariable value);
 
+	/**
+	 * Records a node output or input for the frontend's highlighting and status display. Nodes outside of the flow opened in the frontend return
+	 * before touching anything else. Nothing is allocated, converted or locked here, so this is cheap enough to be called for every message.
+	 *
+	 * @param debugState The debug state of the node to highlight taken from the routing table.
+	 * @param outputIndex The output index or -1 when the node received a message.
+	 * @param payload The output payload or nullptr.
+	 */
+	void recordDebugOutput(const PNodeDebugState& debugState, int32_t outputIndex, const Flows::PVariable& payload);
+
+	/**
+	 * Converts the debug outputs collected in the routing table since the last call to node events and sends them to the server in one request.
+	 */
+	void flushDebugOutputs();
+
+	/**
+	 * Sets "inEventFlow" of the debug states of all routes. _flowsMutex and _eventFlowIdMutex need to be locked.
+	 */
+	void updateEventFlow(const std::shared_ptr<NodeRoutes>& routes);
+
+	void debugOutputThread();
+
 	Flows::PVariable getNodeData(std::string nodeId, std::string key);
 
 	void setNodeData(std::string nodeId, std::string key, Flows::PVariable value);
 
 	void setInternalMessage(std::string nodeId, Flows::PVariable message);
 
-	void setInputValue(std::string& nodeId, int32_t inputIndex, Flows::PVariable message);
-
 	Flows::PVariable getConfigParameter(std::string nodeId, std::string name);
 
 	// {{{ RPC methods
@@ -290,6 +361,28 @@ private:
 	Flows::PVariable broadcastDeleteDevices(Flows::PArray& parameters);
 
 	Flows::PVariable broadcastUpdateDevice(Flows::PArray& parameters);
+
+	/**
+	 * Returns the number of queued messages per node.
+	 * @param parameters Irrelevant for this method.
+	 * @return Returns a struct with the node IDs as keys and the mailbox depths as values. Nodes without queued messages are omitted.
+	 */
+	Flows::PVariable getNodeMailboxes(Flows::PArray& parameters);
+
+	/**
+	 * Returns the load statistics of all flows of this process.
+	 * @param parameters Irrelevant for this method.
+	 * @return Returns a struct with the flow IDs as keys. Each entry contains the number of inputs ("inputs"), the time spent in "input()" in
+	 * microseconds ("processingTime") and the time since the flow was started in milliseconds ("runtime").
+	 */
+	Flows::PVariable getFlowStatistics(Flows::PArray& parameters);
+
+	/**
+	 * Returns the runtime statistics of all nodes of this process.
+	 * @param parameters Irrelevant for this method.
+	 * @return Returns a struct with the node IDs as keys and the structs returned by NodeStatistics::get() as values.
+	 */
+	Flows::PVariable getNodeStatistics(Flows::PArray& parameters);
 	// }}}
 };
 
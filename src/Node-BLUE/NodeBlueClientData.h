@@ -32,6 +32,7 @@
 #define NODEBLUECLIENTDATA_H_
 
 #include "NodeBlueResponseServer.h"
+#include "../IPC/SharedMemoryRing.h"
 #include <homegear-base/BaseLib.h>
 
 namespace Homegear
@@ -56,6 +57,7 @@ public:
 	std::unique_ptr<BaseLib::Rpc::BinaryRpc> binaryRpc;
 	std::shared_ptr<BaseLib::FileDescriptor> fileDescriptor;
 	std::mutex sendMutex;
+	PSharedMemoryRing sharedMemoryRing; //Only accessed with std::atomic_load/std::atomic_store. When set, all data to the client is sent through the ring.
 	std::mutex waitMutex;
 	std::mutex rpcResponsesMutex;
 	std::map<int32_t, PNodeBlueResponseServer> rpcResponses;
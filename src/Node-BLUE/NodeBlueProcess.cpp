@@ -84,6 +84,27 @@ uint32_t NodeBlueProcess::nodeThreadCount()
 	return _nodeThreadCount;
 }
 
+double NodeBlueProcess::load()
+{
+	std::lock_guard<std::mutex> flowsGuard(_flowsMutex);
+	double load = 0;
+	for(auto& flow : _flows)
+	{
+		load += flow.second->load;
+	}
+	return load;
+}
+
+std::string NodeBlueProcess::pin()
+{
+	std::lock_guard<std::mutex> flowsGuard(_flowsMutex);
+	for(auto& flow : _flows)
+	{
+		if(!flow.second->pin.empty()) return flow.second->pin;
+	}
+	return "";
+}
+
 void NodeBlueProcess::invokeFlowFinished(int32_t exitCode)
 {
 	try
@@ -220,7 +241,10 @@ void NodeBlueProcess::unregisterFlow(int32_t id)
 	try
 	{
 		std::lock_guard<std::mutex> flowsGuard(_flowsMutex);
-		_flows.erase(id);
+		auto flowIterator = _flows.find(id);
+		if(flowIterator == _flows.end()) return;
+		_nodeThreadCount -= flowIterator->second->maxThreadCount;
+		_flows.erase(flowIterator);
 		_flowFinishedInfo.erase(id);
 	}
 	catch(const std::exception& ex)
@@ -87,6 +87,16 @@ public:
 
 	uint32_t nodeThreadCount();
 
+	/**
+	 * @return Returns the sum of the estimated loads of all flows of this process.
+	 */
+	double load();
+
+	/**
+	 * @return Returns the pin of the flows of this process or an empty string when no pinned flow is running in it.
+	 */
+	std::string pin();
+
 	PFlowInfoServer getFlow(int32_t id);
 
 	PFlowFinishedInfo getFlowFinishedInfo(int32_t id);
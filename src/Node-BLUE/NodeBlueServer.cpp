@@ -32,6 +32,8 @@
 #include "../GD/GD.h"
 #include <homegear-base/BaseLib.h>
 
+#include <cstring>
+
 namespace Homegear
 {
 
@@ -112,8 +114,10 @@ NodeBlueServer::NodeBlueServer() : IQueue(GD::bl.get(), 3, 100000)
 	_rpcMethods.emplace("getParamsetDescription", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetParamsetDescription()));
 	_rpcMethods.emplace("getParamsetId", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetParamsetId()));
 	_rpcMethods.emplace("getPeerId", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetPeerId()));
+	_rpcMethods.emplace("getRpcMetrics", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetRpcMetrics()));
 	_rpcMethods.emplace("getServiceMessages", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetServiceMessages()));
 	_rpcMethods.emplace("getSystemVariable", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetSystemVariable()));
+	_rpcMethods.emplace("getTlsMetrics", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetTlsMetrics()));
 	_rpcMethods.emplace("getUpdateStatus", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetUpdateStatus()));
 	_rpcMethods.emplace("getValue", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetValue()));
 	_rpcMethods.emplace("getVariableDescription", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetVariableDescription()));
@@ -140,6 +144,7 @@ NodeBlueServer::NodeBlueServer() : IQueue(GD::bl.get(), 3, 100000)
 	_rpcMethods.emplace("searchDevices", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSearchDevices()));
 	_rpcMethods.emplace("searchInterfaces", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSearchInterfaces()));
 	_rpcMethods.emplace("setData", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetData()));
+	_rpcMethods.emplace("setEventRateLimit", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetEventRateLimit()));
 	_rpcMethods.emplace("setGlobalServiceMessage", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetGlobalServiceMessage()));
 	_rpcMethods.emplace("setId", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetId()));
 	_rpcMethods.emplace("setInstallMode", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetInstallMode()));
@@ -155,9 +160,11 @@ NodeBlueServer::NodeBlueServer() : IQueue(GD::bl.get(), 3, 100000)
 	_rpcMethods.emplace("setSystemVariable", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetSystemVariable()));
 	_rpcMethods.emplace("setTeam", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetTeam()));
 	_rpcMethods.emplace("setValue", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetValue()));
+	_rpcMethods.emplace("subscribeEvents", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSubscribeEvents()));
 	_rpcMethods.emplace("subscribePeers", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSubscribePeers()));
 	_rpcMethods.emplace("triggerEvent", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCTriggerEvent()));
 	_rpcMethods.emplace("triggerRpcEvent", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCTriggerRpcEvent()));
+	_rpcMethods.emplace("unsubscribeEvents", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCUnsubscribeEvents()));
 	_rpcMethods.emplace("unsubscribePeers", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCUnsubscribePeers()));
 	_rpcMethods.emplace("updateFirmware", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCUpdateFirmware()));
 	_rpcMethods.emplace("writeLog", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCWriteLog()));
@@ -231,6 +238,17 @@ NodeBlueServer::NodeBlueServer() : IQueue(GD::bl.get(), 3, 100000)
 #endif
 	_localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(PNodeBlueClientData& clientData, BaseLib::PArray& parameters)>>("invokeNodeMethod", std::bind(&NodeBlueServer::invokeNodeMethod, this, std::placeholders::_1, std::placeholders::_2)));
 	_localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(PNodeBlueClientData& clientData, BaseLib::PArray& parameters)>>("nodeEvent", std::bind(&NodeBlueServer::nodeEvent, this, std::placeholders::_1, std::placeholders::_2)));
+	_localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(PNodeBlueClientData& clientData, BaseLib::PArray& parameters)>>("nodeEvents", std::bind(&NodeBlueServer::nodeEvents, this, std::placeholders::_1, std::placeholders::_2)));
+
+	//Resolve the metrics entries once, so calls only need atomic increments
+	for(auto& method : _rpcMethods)
+	{
+		_methodMetrics.emplace(method.first, GD::rpcMetrics.getMethodMetrics(Rpc::RpcMetrics::Direction::incoming, Rpc::RpcMetrics::Transport::nodeBlue, method.first));
+	}
+	for(auto& method : _localRpcMethods)
+	{
+		_methodMetrics.emplace(method.first, GD::rpcMetrics.getMethodMetrics(Rpc::RpcMetrics::Direction::incoming, Rpc::RpcMetrics::Transport::nodeBlue, method.first));
+	}
 }
 
 NodeBlueServer::~NodeBlueServer()
@@ -247,13 +265,21 @@ void NodeBlueServer::collectGarbage()
 		std::vector<PNodeBlueProcess> processesToShutdown;
 		{
 			std::lock_guard<std::mutex> processGuard(_processMutex);
-			bool emptyProcess = false;
+			uint32_t idleProcesses = 0;
+			uint32_t warmPoolMinSize = _warmPoolMinSize;
+			uint32_t warmPoolMaxSize = _warmPoolMaxSize;
+			int64_t warmPoolIdleTimeout = _warmPoolIdleTimeout;
+			int64_t time = BaseLib::HelperFunctions::getTime();
 			for(std::map<pid_t, PNodeBlueProcess>::iterator i = _processes.begin(); i != _processes.end(); ++i)
 			{
-				if(i->second->flowCount() == 0 && BaseLib::HelperFunctions::getTime() - i->second->lastExecution > 60000 && i->second->getClientData() && !i->second->getClientData()->closed)
+				if(i->second->flowCount() == 0 && i->second->getClientData() && !i->second->getClientData()->closed)
 				{
-					if(emptyProcess) closeClientConnection(i->second->getClientData());
-					else emptyProcess = true;
+					idleProcesses++;
+					if(idleProcesses > warmPoolMaxSize || (idleProcesses > warmPoolMinSize && time - i->second->lastExecution > warmPoolIdleTimeout))
+					{
+						closeClientConnection(i->second->getClientData());
+						idleProcesses--;
+					}
 				}
 			}
 		}
@@ -306,7 +332,7 @@ void NodeBlueServer::getMaxThreadCounts()
 	try
 	{
 		_maxThreadCounts.clear();
-		std::vector<NodeManager::PNodeInfo> nodeInfo = NodeManager::getNodeInfo();
+		std::vector<NodeManager::PNodeInfo> nodeInfo = _nodeCatalog.getNodeInfo();
 		for(auto& infoEntry : nodeInfo)
 		{
 			_maxThreadCounts[infoEntry->nodeName] = infoEntry->maxThreadCount;
@@ -326,6 +352,43 @@ void NodeBlueServer::getMaxThreadCounts()
 	}
 }
 
+std::string NodeBlueServer::getBundleResponse(const NodeCatalog::PBundle& bundle, BaseLib::Http& http, std::vector<std::string>& responseHeaders)
+{
+	try
+	{
+		if(!bundle || bundle->content.empty()) return "";
+		bool gzip = (http.getHeader().acceptEncoding & BaseLib::Http::AcceptEncoding::gzip) && !bundle->gzipContent.empty();
+		//Every encoding has its own strong ETag, as the representations differ byte by byte.
+		const std::string& etag = gzip ? bundle->gzipEtag : bundle->etag;
+		//Let the browser revalidate on every load. Unchanged bundles are answered with "304 Not Modified".
+		responseHeaders.push_back("ETag: " + etag);
+		responseHeaders.push_back("Cache-Control: no-cache");
+		responseHeaders.push_back("Vary: Accept-Encoding");
+		auto ifNoneMatchIterator = http.getHeader().fields.find("if-none-match");
+		if(ifNoneMatchIterator != http.getHeader().fields.end() && ifNoneMatchIterator->second.find(etag) != std::string::npos) return "notmodified";
+
+		if(gzip)
+		{
+			responseHeaders.push_back("Content-Encoding: gzip");
+			return bundle->gzipContent;
+		}
+		return bundle->content;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return "";
+}
+
 bool NodeBlueServer::checkIntegrity(std::string flowsFile)
 {
 	try
@@ -442,9 +505,13 @@ bool NodeBlueServer::start()
 		_socketPath = GD::bl->settings.socketPath() + "homegearFE.sock";
 		_shuttingDown = false;
 		_stopServer = false;
+		if(!_reactor.init()) return false;
 		if(!getFileDescriptor(true)) return false;
 		_webroot = GD::bl->settings.nodeBluePath() + "www/";
+		_nodeCatalog.start();
 		getMaxThreadCounts();
+		loadPlacement();
+		loadWarmPool();
 		uint32_t flowsProcessingThreadCountServer = GD::bl->settings.nodeBlueProcessingThreadCountServer();
 		if(flowsProcessingThreadCountServer < 5) flowsProcessingThreadCountServer = 5;
 		startQueue(0, false, flowsProcessingThreadCountServer, 0, SCHED_OTHER);
@@ -452,6 +519,7 @@ bool NodeBlueServer::start()
 		startQueue(2, false, flowsProcessingThreadCountServer, 0, SCHED_OTHER);
 		GD::bl->threadManager.start(_mainThread, true, &NodeBlueServer::mainThread, this);
 		startFlows();
+		GD::bl->threadManager.start(_warmPoolThread, true, &NodeBlueServer::warmPoolThread, this);
 		return true;
 	}
 	catch(const std::exception& ex)
@@ -474,6 +542,8 @@ void NodeBlueServer::stop()
 	try
 	{
 		_shuttingDown = true;
+		refillWarmPool();
+		GD::bl->threadManager.join(_warmPoolThread);
 		_stopServer = true;
 		GD::bl->threadManager.join(_mainThread); //Prevent new connections
 		_out.printDebug("Debug: Waiting for flows engine server's client threads to finish.");
@@ -482,6 +552,7 @@ void NodeBlueServer::stop()
 		stopQueue(1);
 		stopQueue(2);
 		unlink(_socketPath.c_str());
+		_nodeCatalog.stop();
 	}
 	catch(const std::exception& ex)
 	{
@@ -1072,7 +1143,7 @@ std::set<std::string> NodeBlueServer::insertSubflows(BaseLib::PVariable& subflow
 	return std::set<std::string>();
 }
 
-void NodeBlueServer::startFlows()
+bool NodeBlueServer::parseFlows(std::unordered_map<std::string, PFlowInfoServer>& flowInfos, std::set<std::string>& allNodeIds, std::set<std::string>& flowIds)
 {
 	try
 	{
@@ -1081,9 +1152,17 @@ void NodeBlueServer::startFlows()
 		{
 			std::lock_guard<std::mutex> flowsFileGuard(_flowsFileMutex);
 			std::string flowsFile = GD::bl->settings.nodeBlueDataPath() + "flows.json";
-			if(!GD::bl->io.fileExists(flowsFile)) return;
+			if(!GD::bl->io.fileExists(flowsFile)) return false;
 			rawFlows = GD::bl->io.getFileContent(flowsFile);
-			if(BaseLib::HelperFunctions::trim(rawFlows).empty()) return;
+			if(BaseLib::HelperFunctions::trim(rawFlows).empty()) return false;
+		}
+
+		//Skips JSON decoding and inserting subflows when flows.json didn't change since the last start.
+		std::string cacheKey = getFlowsCacheKey(rawFlows);
+		if(loadFlowsCache(cacheKey, flowInfos, allNodeIds, flowIds))
+		{
+			setFlowLoads(flowInfos);
+			return true;
 		}
 
 		//{{{ Filter all nodes and assign it to flows
@@ -1092,8 +1171,8 @@ void NodeBlueServer::startFlows()
 		std::unordered_map<std::string, std::unordered_map<std::string, BaseLib::PVariable>> flowNodes;
 		std::unordered_map<std::string, std::set<std::string>> subflowNodeIds;
 		std::unordered_map<std::string, std::set<std::string>> nodeIds;
-		std::set<std::string> allNodeIds;
 		std::set<std::string> disabledFlows;
+		std::unordered_map<std::string, std::string> flowPins;
 		for(auto& element : *flows->arrayValue)
 		{
 			auto idIterator = element->structValue->find("id");
@@ -1115,6 +1194,8 @@ void NodeBlueServer::startFlows()
 			{
 				auto disabledIterator = element->structValue->find("disabled");
 				if(disabledIterator != element->structValue->end() && disabledIterator->second->booleanValue) disabledFlows.emplace(idIterator->second->stringValue);
+				auto processIterator = element->structValue->find("process");
+				if(processIterator != element->structValue->end() && !processIterator->second->stringValue.empty()) flowPins.emplace(idIterator->second->stringValue, processIterator->second->stringValue);
 				continue;
 			}
 
@@ -1199,14 +1280,20 @@ void NodeBlueServer::startFlows()
 
 		for(auto& element : flowNodes)
 		{
+			flowIds.emplace(element.first);
 			if(subflowInfos.find(element.first) != subflowInfos.end()) continue;
+			if(disabledFlows.find(element.first) != disabledFlows.end()) continue;
+
 			BaseLib::PVariable flow = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
 			flow->arrayValue->reserve(element.second.size());
 			uint32_t maxThreadCount = 0;
+			//Sorted, so the hash doesn't depend on the order of the nodes in flows.json.
+			std::map<std::string, BaseLib::PVariable> sortedNodes;
 			for(auto& node : element.second)
 			{
 				if(!node.second) continue;
 				flow->arrayValue->push_back(node.second);
+				sortedNodes.emplace(node.first, node.second);
 				auto typeIterator = node.second->structValue->find("type");
 				if(typeIterator != node.second->structValue->end())
 				{
@@ -1222,14 +1309,382 @@ void NodeBlueServer::startFlows()
 				else GD::out.printError("Error: Could not determine maximum thread count of node. No key \"type\".");
 			}
 
-			if(disabledFlows.find(element.first) == disabledFlows.end())
+			std::vector<char> encodedFlow;
+			for(auto& node : sortedNodes)
+			{
+				//Moving a node in the editor doesn't require a restart.
+				BaseLib::PVariable hashedNode = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+				for(auto& field : *node.second->structValue)
+				{
+					if(field.first == "x" || field.first == "y") continue;
+					hashedNode->structValue->emplace(field.first, field.second);
+				}
+				std::vector<char> encodedNode;
+				_jsonEncoder->encode(hashedNode, encodedNode);
+				encodedFlow.insert(encodedFlow.end(), encodedNode.begin(), encodedNode.end());
+			}
+			//The pin is a property of the tab, so it's not part of the nodes.
+			auto flowPinIterator = flowPins.find(element.first);
+			if(flowPinIterator != flowPins.end()) encodedFlow.insert(encodedFlow.end(), flowPinIterator->second.begin(), flowPinIterator->second.end());
+			std::vector<char> md5;
+			BaseLib::Security::Hash::md5(encodedFlow, md5);
+
+			PFlowInfoServer flowInfo = std::make_shared<FlowInfoServer>();
+			flowInfo->nodeBlueId = element.first;
+			flowInfo->maxThreadCount = maxThreadCount;
+			flowInfo->flow = flow;
+			flowInfo->nodeIds = nodeIds[element.first];
+			flowInfo->hash = BaseLib::HelperFunctions::getHexString(md5);
+			if(flowPinIterator != flowPins.end()) flowInfo->pin = flowPinIterator->second;
+			flowInfos.emplace(element.first, flowInfo);
+		}
+
+		saveFlowsCache(cacheKey, flowInfos, allNodeIds, flowIds);
+		setFlowLoads(flowInfos);
+
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return false;
+}
+
+std::string NodeBlueServer::getFlowsCacheKey(const std::string& rawFlows)
+{
+	try
+	{
+		//The thread counts are stored in the cache, so it is invalid after nodes were updated.
+		std::vector<char> data(rawFlows.begin(), rawFlows.end());
+		for(auto& maxThreadCount : _maxThreadCounts)
+		{
+			std::string entry = maxThreadCount.first + "=" + std::to_string(maxThreadCount.second) + ";";
+			data.insert(data.end(), entry.begin(), entry.end());
+		}
+		std::vector<char> md5;
+		BaseLib::Security::Hash::md5(data, md5);
+		return BaseLib::HelperFunctions::getHexString(md5);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return "";
+}
+
+bool NodeBlueServer::loadFlowsCache(const std::string& cacheKey, std::unordered_map<std::string, PFlowInfoServer>& flowInfos, std::set<std::string>& allNodeIds, std::set<std::string>& flowIds)
+{
+	try
+	{
+		if(cacheKey.empty()) return false;
+		std::string cacheFile = GD::bl->settings.nodeBlueDataPath() + "flows.cache";
+		if(!GD::bl->io.fileExists(cacheFile)) return false;
+		std::vector<char> data = GD::bl->io.getBinaryFileContent(cacheFile);
+		if(data.empty()) return false;
+
+		BaseLib::BinaryDecoder decoder(GD::bl.get());
+		uint32_t position = 0;
+		if(decoder.decodeInteger(data, position) != FLOWS_CACHE_VERSION || decoder.decodeString(data, position) != cacheKey) return false;
+
+		int32_t flowCount = decoder.decodeInteger(data, position);
+		for(int32_t i = 0; i < flowCount; i++)
+		{
+			PFlowInfoServer flowInfo = std::make_shared<FlowInfoServer>();
+			flowInfo->nodeBlueId = decoder.decodeString(data, position);
+			flowInfo->maxThreadCount = decoder.decodeInteger(data, position);
+			flowInfo->hash = decoder.decodeString(data, position);
+			flowInfo->pin = decoder.decodeString(data, position);
+			int32_t nodeIdCount = decoder.decodeInteger(data, position);
+			for(int32_t j = 0; j < nodeIdCount; j++)
+			{
+				flowInfo->nodeIds.emplace(decoder.decodeString(data, position));
+			}
+			flowInfo->flow = decodeFlowsCacheVariable(decoder, data, position, 0);
+			flowInfos.emplace(flowInfo->nodeBlueId, flowInfo);
+		}
+		int32_t nodeIdCount = decoder.decodeInteger(data, position);
+		for(int32_t i = 0; i < nodeIdCount; i++)
+		{
+			allNodeIds.emplace(decoder.decodeString(data, position));
+		}
+		int32_t flowIdCount = decoder.decodeInteger(data, position);
+		for(int32_t i = 0; i < flowIdCount; i++)
+		{
+			flowIds.emplace(decoder.decodeString(data, position));
+		}
+		if(position != data.size()) throw BaseLib::Exception("Unexpected data at the end of the file.");
+
+		_out.printInfo("Info: Loaded " + std::to_string(flowInfos.size()) + " flows from flows cache.");
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printWarning("Warning: Could not read flows cache: " + std::string(ex.what()));
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printWarning("Warning: Could not read flows cache: " + std::string(ex.what()));
+	}
+	catch(...)
+	{
+		_out.printWarning("Warning: Could not read flows cache.");
+	}
+	//Don't use partially loaded data.
+	flowInfos.clear();
+	allNodeIds.clear();
+	flowIds.clear();
+	return false;
+}
+
+void NodeBlueServer::saveFlowsCache(const std::string& cacheKey, std::unordered_map<std::string, PFlowInfoServer>& flowInfos, std::set<std::string>& allNodeIds, std::set<std::string>& flowIds)
+{
+	try
+	{
+		if(cacheKey.empty()) return;
+		BaseLib::BinaryEncoder encoder(GD::bl.get());
+		std::vector<char> data;
+		data.reserve(65536);
+		encoder.encodeInteger(data, FLOWS_CACHE_VERSION);
+		encoder.encodeString(data, cacheKey);
+
+		encoder.encodeInteger(data, (int32_t)flowInfos.size());
+		for(auto& flowInfo : flowInfos)
+		{
+			encoder.encodeString(data, flowInfo.second->nodeBlueId);
+			encoder.encodeInteger(data, (int32_t)flowInfo.second->maxThreadCount);
+			encoder.encodeString(data, flowInfo.second->hash);
+			encoder.encodeString(data, flowInfo.second->pin);
+			encoder.encodeInteger(data, (int32_t)flowInfo.second->nodeIds.size());
+			for(auto& nodeId : flowInfo.second->nodeIds)
+			{
+				encoder.encodeString(data, nodeId);
+			}
+			encodeFlowsCacheVariable(encoder, data, flowInfo.second->flow);
+		}
+
+		encoder.encodeInteger(data, (int32_t)allNodeIds.size());
+		for(auto& nodeId : allNodeIds)
+		{
+			encoder.encodeString(data, nodeId);
+		}
+		encoder.encodeInteger(data, (int32_t)flowIds.size());
+		for(auto& flowId : flowIds)
+		{
+			encoder.encodeString(data, flowId);
+		}
+
+		//Write to a temporary file first, so an interrupted write never leaves a truncated cache.
+		std::string cacheFile = GD::bl->settings.nodeBlueDataPath() + "flows.cache";
+		std::string tempFile = cacheFile + ".tmp";
+		GD::bl->io.writeFile(tempFile, data, data.size());
+		if(rename(tempFile.c_str(), cacheFile.c_str()) == -1) _out.printWarning("Warning: Could not write flows cache: " + std::string(strerror(errno)));
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void NodeBlueServer::encodeFlowsCacheVariable(BaseLib::BinaryEncoder& encoder, std::vector<char>& data, const BaseLib::PVariable& variable)
+{
+	if(!variable)
+	{
+		encoder.encodeInteger(data, (int32_t)BaseLib::VariableType::tVoid);
+		return;
+	}
+
+	switch(variable->type)
+	{
+		case BaseLib::VariableType::tInteger:
+			encoder.encodeInteger(data, (int32_t)BaseLib::VariableType::tInteger);
+			encoder.encodeInteger(data, variable->integerValue);
+			break;
+		case BaseLib::VariableType::tInteger64:
+			encoder.encodeInteger(data, (int32_t)BaseLib::VariableType::tInteger64);
+			encoder.encodeInteger64(data, variable->integerValue64);
+			break;
+		case BaseLib::VariableType::tFloat:
+		{
+			//The raw IEEE 754 bits, so the value is restored exactly.
+			int64_t bits = 0;
+			static_assert(sizeof(bits) == sizeof(variable->floatValue), "Unexpected size of double.");
+			std::memcpy(&bits, &variable->floatValue, sizeof(bits));
+			encoder.encodeInteger(data, (int32_t)BaseLib::VariableType::tFloat);
+			encoder.encodeInteger64(data, bits);
+			break;
+		}
+		case BaseLib::VariableType::tBoolean:
+			encoder.encodeInteger(data, (int32_t)BaseLib::VariableType::tBoolean);
+			encoder.encodeBoolean(data, variable->booleanValue);
+			break;
+		case BaseLib::VariableType::tString:
+		case BaseLib::VariableType::tBase64:
+			encoder.encodeInteger(data, (int32_t)variable->type);
+			encoder.encodeString(data, variable->stringValue);
+			break;
+		case BaseLib::VariableType::tBinary:
+			encoder.encodeInteger(data, (int32_t)BaseLib::VariableType::tBinary);
+			encoder.encodeBinary(data, variable->binaryValue);
+			break;
+		case BaseLib::VariableType::tArray:
+			encoder.encodeInteger(data, (int32_t)BaseLib::VariableType::tArray);
+			encoder.encodeInteger(data, (int32_t)variable->arrayValue->size());
+			for(auto& element : *variable->arrayValue)
+			{
+				encodeFlowsCacheVariable(encoder, data, element);
+			}
+			break;
+		case BaseLib::VariableType::tStruct:
+			encoder.encodeInteger(data, (int32_t)BaseLib::VariableType::tStruct);
+			encoder.encodeInteger(data, (int32_t)variable->structValue->size());
+			for(auto& element : *variable->structValue)
+			{
+				encoder.encodeString(data, element.first);
+				encodeFlowsCacheVariable(encoder, data, element.second);
+			}
+			break;
+		default:
+			encoder.encodeInteger(data, (int32_t)BaseLib::VariableType::tVoid);
+			break;
+	}
+}
+
+BaseLib::PVariable NodeBlueServer::decodeFlowsCacheVariable(BaseLib::BinaryDecoder& decoder, const std::vector<char>& data, uint32_t& position, int32_t depth)
+{
+	if(depth > 100) throw BaseLib::Exception("Values are nested too deeply.");
+
+	BaseLib::VariableType type = (BaseLib::VariableType)decoder.decodeInteger(data, position);
+	switch(type)
+	{
+		case BaseLib::VariableType::tVoid:
+			return std::make_shared<BaseLib::Variable>();
+		case BaseLib::VariableType::tInteger:
+			return std::make_shared<BaseLib::Variable>(decoder.decodeInteger(data, position));
+		case BaseLib::VariableType::tInteger64:
+			return std::make_shared<BaseLib::Variable>(decoder.decodeInteger64(data, position));
+		case BaseLib::VariableType::tFloat:
+		{
+			int64_t bits = decoder.decodeInteger64(data, position);
+			double value = 0;
+			std::memcpy(&value, &bits, sizeof(value));
+			return std::make_shared<BaseLib::Variable>(value);
+		}
+		case BaseLib::VariableType::tBoolean:
+			return std::make_shared<BaseLib::Variable>(decoder.decodeBoolean(data, position));
+		case BaseLib::VariableType::tString:
+		case BaseLib::VariableType::tBase64:
+		{
+			BaseLib::PVariable variable = std::make_shared<BaseLib::Variable>(decoder.decodeString(data, position));
+			variable->type = type;
+			return variable;
+		}
+		case BaseLib::VariableType::tBinary:
+			return std::make_shared<BaseLib::Variable>(decoder.decodeBinary(data, position));
+		case BaseLib::VariableType::tArray:
+		{
+			BaseLib::PVariable variable = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+			int32_t size = decoder.decodeInteger(data, position);
+			for(int32_t i = 0; i < size; i++)
+			{
+				variable->arrayValue->push_back(decodeFlowsCacheVariable(decoder, data, position, depth + 1));
+			}
+			return variable;
+		}
+		case BaseLib::VariableType::tStruct:
+		{
+			BaseLib::PVariable variable = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+			int32_t size = decoder.decodeInteger(data, position);
+			for(int32_t i = 0; i < size; i++)
 			{
-				PFlowInfoServer flowInfo = std::make_shared<FlowInfoServer>();
-				flowInfo->nodeBlueId = element.first;
-				flowInfo->maxThreadCount = maxThreadCount;
-				flowInfo->flow = flow;
-				startFlow(flowInfo, nodeIds[element.first]);
+				std::string name = decoder.decodeString(data, position);
+				variable->structValue->emplace(name, decodeFlowsCacheVariable(decoder, data, position, depth + 1));
 			}
+			return variable;
+		}
+		default:
+			throw BaseLib::Exception("Unknown variable type " + std::to_string((int32_t)type) + ".");
+	}
+}
+
+void NodeBlueServer::setFlowLoads(std::unordered_map<std::string, PFlowInfoServer>& flowInfos)
+{
+	try
+	{
+		std::lock_guard<std::mutex> placementGuard(_placementMutex);
+		for(auto& flowInfo : flowInfos)
+		{
+			auto flowLoadIterator = _flowLoads.find(flowInfo.first);
+			if(flowLoadIterator != _flowLoads.end()) flowInfo.second->load = flowLoadIterator->second.load;
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void NodeBlueServer::startFlows()
+{
+	try
+	{
+		{
+			std::lock_guard<std::mutex> runningFlowsGuard(_runningFlowsMutex);
+			_runningFlows.clear();
+		}
+
+		std::unordered_map<std::string, PFlowInfoServer> flowInfos;
+		std::set<std::string> allNodeIds;
+		std::set<std::string> flowIds;
+		if(!parseFlows(flowInfos, allNodeIds, flowIds)) return;
+
+		//Place the busiest flows first, so the remaining ones can fill up the gaps.
+		std::vector<PFlowInfoServer> sortedFlowInfos;
+		sortedFlowInfos.reserve(flowInfos.size());
+		for(auto& flowInfo : flowInfos)
+		{
+			sortedFlowInfos.push_back(flowInfo.second);
+		}
+		std::stable_sort(sortedFlowInfos.begin(), sortedFlowInfos.end(), [](const PFlowInfoServer& a, const PFlowInfoServer& b) { return a->load > b->load; });
+
+		for(auto& flowInfo : sortedFlowInfos)
+		{
+			startFlow(flowInfo, flowInfo->nodeIds);
+			if(!flowInfo->started) continue;
+			std::lock_guard<std::mutex> runningFlowsGuard(_runningFlowsMutex);
+			_runningFlows.emplace(flowInfo->nodeBlueId, flowInfo);
 		}
 
 		std::vector<PNodeBlueClientData> clients;
@@ -1243,6 +1698,28 @@ void NodeBlueServer::startFlows()
 			}
 		}
 
+		startNodes(clients);
+
+		deleteObsoleteNodeData(allNodeIds, flowIds);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void NodeBlueServer::startNodes(std::vector<PNodeBlueClientData>& clients)
+{
+	try
+	{
 		_out.printInfo("Info: Starting nodes.");
 		for(auto& client : clients)
 		{
@@ -1263,12 +1740,30 @@ void NodeBlueServer::startFlows()
 			BaseLib::PArray parameters(new BaseLib::Array());
 			sendRequest(client, "startUpComplete", parameters, true);
 		}
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
 
+void NodeBlueServer::deleteObsoleteNodeData(std::set<std::string>& allNodeIds, std::set<std::string>& flowIds)
+{
+	try
+	{
 		std::set<std::string> nodeData = GD::bl->db->getAllNodeDataNodes();
 		std::string dataKey;
 		for(auto nodeId : nodeData)
 		{
-			if(allNodeIds.find(nodeId) == allNodeIds.end() && nodeIds.find(nodeId) == nodeIds.end() && nodeId != "global") GD::bl->db->deleteNodeData(nodeId, dataKey);
+			if(allNodeIds.find(nodeId) == allNodeIds.end() && flowIds.find(nodeId) == flowIds.end() && nodeId != "global") GD::bl->db->deleteNodeData(nodeId, dataKey);
 		}
 	}
 	catch(const std::exception& ex)
@@ -1474,6 +1969,7 @@ void NodeBlueServer::restartFlows()
 	try
 	{
 		std::lock_guard<std::mutex> restartFlowsGuard(_restartFlowsMutex);
+		updateFlowLoads();
 		_flowsRestarting = true;
 		stopNodes();
 		bool result = sendReset();
@@ -1503,34 +1999,145 @@ void NodeBlueServer::restartFlows()
 	_flowsRestarting = false;
 }
 
-std::string NodeBlueServer::handleGet(std::string& path, BaseLib::Http& http, std::string& responseEncoding)
+void NodeBlueServer::deployFlows()
 {
 	try
 	{
-		bool sessionValid = false;
-		auto sessionId = http.getHeader().cookies.find("PHPSESSID");
-		if(sessionId != http.getHeader().cookies.end()) sessionValid = !GD::scriptEngineServer->checkSessionId(sessionId->second).empty();
+		std::unique_lock<std::mutex> restartFlowsGuard(_restartFlowsMutex);
+		updateFlowLoads();
 
-		std::string contentString;
-		if(path == "node-blue/locales/nodes")
+		std::unordered_map<std::string, PFlowInfoServer> runningFlows;
 		{
-			if(!sessionValid) return "unauthorized";
-			std::string language = "en-US";
-			std::vector<std::string> args = BaseLib::HelperFunctions::splitAll(http.getHeader().args, '&');
-			for(auto& arg : args)
-			{
-				auto argPair = BaseLib::HelperFunctions::splitFirst(arg, '=');
-				if(argPair.first == "lng")
-				{
-					language = argPair.second;
-					break;
-				}
-			}
-			contentString = NodeManager::getNodeLocales(language);
-			responseEncoding = "application/json";
+			std::lock_guard<std::mutex> runningFlowsGuard(_runningFlowsMutex);
+			runningFlows = _runningFlows;
 		}
-		else if(path.compare(0, 18, "node-blue/locales/") == 0)
-		{
+
+		std::unordered_map<std::string, PFlowInfoServer> flowInfos;
+		std::set<std::string> allNodeIds;
+		std::set<std::string> flowIds;
+		bool flowsParsed = parseFlows(flowInfos, allNodeIds, flowIds);
+
+		//Global nodes like config nodes can be used by all flows, so a change requires a full restart.
+		bool fullRestart = !flowsParsed || runningFlows.empty();
+		if(!fullRestart)
+		{
+			auto newGlobalIterator = flowInfos.find("g");
+			auto oldGlobalIterator = runningFlows.find("g");
+			if((newGlobalIterator == flowInfos.end()) != (oldGlobalIterator == runningFlows.end())) fullRestart = true;
+			else if(newGlobalIterator != flowInfos.end() && newGlobalIterator->second->hash != oldGlobalIterator->second->hash) fullRestart = true;
+		}
+
+		if(fullRestart)
+		{
+			restartFlowsGuard.unlock();
+			restartFlows();
+			return;
+		}
+
+		std::vector<PFlowInfoServer> flowsToStop;
+		std::vector<PFlowInfoServer> flowsToStart;
+		for(auto& runningFlow : runningFlows)
+		{
+			auto flowInfoIterator = flowInfos.find(runningFlow.first);
+			if(flowInfoIterator == flowInfos.end() || flowInfoIterator->second->hash != runningFlow.second->hash) flowsToStop.push_back(runningFlow.second);
+		}
+		for(auto& flowInfo : flowInfos)
+		{
+			auto runningFlowIterator = runningFlows.find(flowInfo.first);
+			if(runningFlowIterator == runningFlows.end() || runningFlowIterator->second->hash != flowInfo.second->hash) flowsToStart.push_back(flowInfo.second);
+		}
+
+		{
+			bool rebalance = false;
+			{
+				std::lock_guard<std::mutex> placementGuard(_placementMutex);
+				rebalance = _rebalanceOnDeploy && _placementPolicy == PlacementPolicy::spread;
+			}
+			if(rebalance) rebalanceFlows(flowInfos, flowsToStop, flowsToStart);
+		}
+		//Place the busiest flows first, so the remaining ones can fill up the gaps.
+		std::stable_sort(flowsToStart.begin(), flowsToStart.end(), [](const PFlowInfoServer& a, const PFlowInfoServer& b) { return a->load > b->load; });
+
+		_out.printInfo("Info: Deploying flows. Stopping " + std::to_string(flowsToStop.size()) + " and starting " + std::to_string(flowsToStart.size()) + " of " + std::to_string(flowInfos.size()) + " flows.");
+		if(flowsToStop.empty() && flowsToStart.empty()) return;
+
+		for(auto& flowInfo : flowsToStop)
+		{
+			stopFlow(flowInfo);
+		}
+
+		std::set<int32_t> clientIds;
+		for(auto& flowInfo : flowsToStart)
+		{
+			startFlow(flowInfo, flowInfo->nodeIds);
+			if(!flowInfo->started) continue;
+			{
+				std::lock_guard<std::mutex> runningFlowsGuard(_runningFlowsMutex);
+				_runningFlows[flowInfo->nodeBlueId] = flowInfo;
+			}
+			std::lock_guard<std::mutex> flowClientIdMapGuard(_flowClientIdMapMutex);
+			auto flowClientIdIterator = _flowClientIdMap.find(flowInfo->nodeBlueId);
+			if(flowClientIdIterator != _flowClientIdMap.end()) clientIds.emplace(flowClientIdIterator->second);
+		}
+
+		std::vector<PNodeBlueClientData> clients;
+		{
+			std::lock_guard<std::mutex> stateGuard(_stateMutex);
+			clients.reserve(clientIds.size());
+			for(auto clientId : clientIds)
+			{
+				auto clientIterator = _clients.find(clientId);
+				if(clientIterator == _clients.end() || clientIterator->second->closed) continue;
+				clients.push_back(clientIterator->second);
+			}
+		}
+
+		startNodes(clients);
+
+		deleteObsoleteNodeData(allNodeIds, flowIds);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+std::string NodeBlueServer::handleGet(std::string& path, BaseLib::Http& http, std::string& responseEncoding, std::vector<std::string>& responseHeaders)
+{
+	try
+	{
+		bool sessionValid = false;
+		auto sessionId = http.getHeader().cookies.find("PHPSESSID");
+		if(sessionId != http.getHeader().cookies.end()) sessionValid = !GD::scriptEngineServer->checkSessionId(sessionId->second).empty();
+
+		std::string contentString;
+		if(path == "node-blue/locales/nodes")
+		{
+			if(!sessionValid) return "unauthorized";
+			std::string language = "en-US";
+			std::vector<std::string> args = BaseLib::HelperFunctions::splitAll(http.getHeader().args, '&');
+			for(auto& arg : args)
+			{
+				auto argPair = BaseLib::HelperFunctions::splitFirst(arg, '=');
+				if(argPair.first == "lng")
+				{
+					language = argPair.second;
+					break;
+				}
+			}
+			responseEncoding = "application/json";
+			return getBundleResponse(_nodeCatalog.getNodeLocales(language), http, responseHeaders);
+		}
+		else if(path.compare(0, 18, "node-blue/locales/") == 0)
+		{
 			if(!sessionValid) return "unauthorized";
 			std::string localePath = _webroot + "static/locales/";
 			std::string language = "en-US";
@@ -1598,34 +2205,16 @@ std::string NodeBlueServer::handleGet(std::string& path, BaseLib::Http& http, st
 		else if(path == "node-blue/nodes")
 		{
 			if(!sessionValid) return "unauthorized";
-			path = _webroot + "static/" + path.substr(10);
-
-			std::vector<NodeManager::PNodeInfo> nodeInfo = NodeManager::getNodeInfo();
+			responseHeaders.push_back("Vary: Accept");
 			if(http.getHeader().fields["accept"] == "text/html")
 			{
 				responseEncoding = "text/html";
-				for(auto& infoEntry : nodeInfo)
-				{
-					contentString += infoEntry->frontendCode;
-				}
+				return getBundleResponse(_nodeCatalog.getNodeCode(), http, responseHeaders);
 			}
 			else
 			{
 				responseEncoding = "application/json";
-				BaseLib::PVariable frontendNodeList = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
-				for(auto& infoEntry : nodeInfo)
-				{
-					BaseLib::PVariable nodeListEntry = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
-					nodeListEntry->structValue->emplace("id", std::make_shared<BaseLib::Variable>(infoEntry->nodeId));
-					nodeListEntry->structValue->emplace("name", std::make_shared<BaseLib::Variable>(infoEntry->readableName));
-					nodeListEntry->structValue->emplace("types", std::make_shared<BaseLib::Variable>(BaseLib::PArray(new BaseLib::Array{std::make_shared<BaseLib::Variable>(infoEntry->nodeName)})));
-					nodeListEntry->structValue->emplace("enabled", std::make_shared<BaseLib::Variable>(true));
-					nodeListEntry->structValue->emplace("local", std::make_shared<BaseLib::Variable>(false));
-					nodeListEntry->structValue->emplace("module", std::make_shared<BaseLib::Variable>(infoEntry->nodeName));
-					nodeListEntry->structValue->emplace("version", std::make_shared<BaseLib::Variable>(infoEntry->version));
-					frontendNodeList->arrayValue->push_back(nodeListEntry);
-				}
-				_jsonEncoder->encode(frontendNodeList, contentString);
+				return getBundleResponse(_nodeCatalog.getNodeList(), http, responseHeaders);
 			}
 		}
 		else if(path.compare(0, 16, "node-blue/icons/") == 0)
@@ -1705,7 +2294,7 @@ std::string NodeBlueServer::handlePost(std::string& path, BaseLib::Http& http, s
 			BaseLib::HelperFunctions::toLower(md5String);
 
 			_out.printInfo("Info: Deploying (3)...");
-			GD::bl->threadManager.start(_maintenanceThread, true, &NodeBlueServer::restartFlows, this);
+			GD::bl->threadManager.start(_maintenanceThread, true, &NodeBlueServer::deployFlows, this);
 
 			return "{\"rev\": \"" + md5String + "\"}";
 		}
@@ -1765,6 +2354,568 @@ uint32_t NodeBlueServer::flowCount()
 	return 0;
 }
 
+BaseLib::PVariable NodeBlueServer::getNodeMailboxes()
+{
+	try
+	{
+		BaseLib::PVariable mailboxes = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+		if(_shuttingDown) return mailboxes;
+		std::vector<PNodeBlueClientData> clients;
+		{
+			std::lock_guard<std::mutex> stateGuard(_stateMutex);
+			clients.reserve(_clients.size());
+			for(std::map<int32_t, PNodeBlueClientData>::iterator i = _clients.begin(); i != _clients.end(); ++i)
+			{
+				if(i->second->closed) continue;
+				clients.push_back(i->second);
+			}
+		}
+
+		for(std::vector<PNodeBlueClientData>::iterator i = clients.begin(); i != clients.end(); ++i)
+		{
+			BaseLib::PArray parameters(new BaseLib::Array());
+			BaseLib::PVariable response = sendRequest(*i, "getNodeMailboxes", parameters, true);
+			if(response->errorStruct) continue;
+			mailboxes->structValue->insert(response->structValue->begin(), response->structValue->end());
+		}
+		return mailboxes;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable NodeBlueServer::getNodeStatistics()
+{
+	try
+	{
+		BaseLib::PVariable statistics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+		if(_shuttingDown) return statistics;
+		std::vector<PNodeBlueClientData> clients;
+		{
+			std::lock_guard<std::mutex> stateGuard(_stateMutex);
+			clients.reserve(_clients.size());
+			for(std::map<int32_t, PNodeBlueClientData>::iterator i = _clients.begin(); i != _clients.end(); ++i)
+			{
+				if(i->second->closed) continue;
+				clients.push_back(i->second);
+			}
+		}
+
+		for(std::vector<PNodeBlueClientData>::iterator i = clients.begin(); i != clients.end(); ++i)
+		{
+			BaseLib::PArray parameters(new BaseLib::Array());
+			BaseLib::PVariable response = sendRequest(*i, "getNodeStatistics", parameters, true);
+			if(response->errorStruct) continue;
+			statistics->structValue->insert(response->structValue->begin(), response->structValue->end());
+		}
+		return statistics;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable NodeBlueServer::getFlowPlacement()
+{
+	try
+	{
+		{
+			std::lock_guard<std::mutex> restartFlowsGuard(_restartFlowsMutex);
+			updateFlowLoads();
+		}
+
+		BaseLib::PVariable placement = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+		{
+			std::lock_guard<std::mutex> placementGuard(_placementMutex);
+			std::string policy = "pack";
+			if(_placementPolicy == PlacementPolicy::spread) policy = "spread";
+			else if(_placementPolicy == PlacementPolicy::pinned) policy = "pinned";
+			placement->structValue->emplace("policy", std::make_shared<BaseLib::Variable>(policy));
+			placement->structValue->emplace("rebalanceOnDeploy", std::make_shared<BaseLib::Variable>(_rebalanceOnDeploy));
+		}
+
+		std::unordered_map<std::string, PFlowInfoServer> runningFlows;
+		{
+			std::lock_guard<std::mutex> runningFlowsGuard(_runningFlowsMutex);
+			runningFlows = _runningFlows;
+		}
+
+		BaseLib::PVariable flows = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+		for(auto& runningFlow : runningFlows)
+		{
+			BaseLib::PVariable flow = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+			flow->structValue->emplace("load", std::make_shared<BaseLib::Variable>(runningFlow.second->load));
+			{
+				std::lock_guard<std::mutex> placementGuard(_placementMutex);
+				auto flowLoadIterator = _flowLoads.find(runningFlow.first);
+				flow->structValue->emplace("messageRate", std::make_shared<BaseLib::Variable>(flowLoadIterator == _flowLoads.end() ? 0.0 : flowLoadIterator->second.messageRate));
+			}
+			flow->structValue->emplace("pin", std::make_shared<BaseLib::Variable>(runningFlow.second->pin));
+
+			int32_t clientId = -1;
+			{
+				std::lock_guard<std::mutex> flowClientIdMapGuard(_flowClientIdMapMutex);
+				auto flowClientIdIterator = _flowClientIdMap.find(runningFlow.first);
+				if(flowClientIdIterator != _flowClientIdMap.end()) clientId = flowClientIdIterator->second;
+			}
+			int32_t pid = -1;
+			{
+				std::lock_guard<std::mutex> stateGuard(_stateMutex);
+				auto clientIterator = _clients.find(clientId);
+				if(clientIterator != _clients.end()) pid = clientIterator->second->pid;
+			}
+			flow->structValue->emplace("pid", std::make_shared<BaseLib::Variable>(pid));
+			flows->structValue->emplace(runningFlow.first, flow);
+		}
+		placement->structValue->emplace("flows", flows);
+
+		return placement;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+bool NodeBlueServer::setPlacementPolicy(std::string policy)
+{
+	try
+	{
+		std::lock_guard<std::mutex> placementGuard(_placementMutex);
+		if(policy == "pack") _placementPolicy = PlacementPolicy::pack;
+		else if(policy == "spread") _placementPolicy = PlacementPolicy::spread;
+		else if(policy == "pinned") _placementPolicy = PlacementPolicy::pinned;
+		else return false;
+		savePlacement();
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return false;
+}
+
+void NodeBlueServer::setRebalanceOnDeploy(bool value)
+{
+	try
+	{
+		std::lock_guard<std::mutex> placementGuard(_placementMutex);
+		_rebalanceOnDeploy = value;
+		savePlacement();
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+BaseLib::PVariable NodeBlueServer::getWarmPool()
+{
+	try
+	{
+		BaseLib::PVariable warmPool = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+		warmPool->structValue->emplace("minSize", std::make_shared<BaseLib::Variable>((int32_t)_warmPoolMinSize));
+		warmPool->structValue->emplace("maxSize", std::make_shared<BaseLib::Variable>((int32_t)_warmPoolMaxSize));
+		warmPool->structValue->emplace("idleTimeout", std::make_shared<BaseLib::Variable>((int64_t)_warmPoolIdleTimeout));
+		return warmPool;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+bool NodeBlueServer::setWarmPool(uint32_t minSize, uint32_t maxSize, int64_t idleTimeout)
+{
+	try
+	{
+		if(minSize > maxSize || idleTimeout < 0) return false;
+		{
+			std::lock_guard<std::mutex> warmPoolSettingsGuard(_warmPoolSettingsMutex);
+			_warmPoolMinSize = minSize;
+			_warmPoolMaxSize = maxSize;
+			_warmPoolIdleTimeout = idleTimeout;
+			saveWarmPool();
+		}
+		refillWarmPool();
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return false;
+}
+
+void NodeBlueServer::loadPlacement()
+{
+	try
+	{
+		std::string placementFile = GD::bl->settings.nodeBlueDataPath() + "flowplacement.json";
+		if(!GD::bl->io.fileExists(placementFile)) return;
+		std::string rawPlacement = GD::bl->io.getFileContent(placementFile);
+		if(BaseLib::HelperFunctions::trim(rawPlacement).empty()) return;
+		BaseLib::PVariable placement = _jsonDecoder->decode(rawPlacement);
+
+		std::lock_guard<std::mutex> placementGuard(_placementMutex);
+		auto policyIterator = placement->structValue->find("policy");
+		if(policyIterator != placement->structValue->end())
+		{
+			if(policyIterator->second->stringValue == "spread") _placementPolicy = PlacementPolicy::spread;
+			else if(policyIterator->second->stringValue == "pinned") _placementPolicy = PlacementPolicy::pinned;
+			else _placementPolicy = PlacementPolicy::pack;
+		}
+
+		auto rebalanceIterator = placement->structValue->find("rebalanceOnDeploy");
+		if(rebalanceIterator != placement->structValue->end()) _rebalanceOnDeploy = rebalanceIterator->second->booleanValue;
+
+		_flowLoads.clear();
+		auto flowsIterator = placement->structValue->find("flows");
+		if(flowsIterator != placement->structValue->end())
+		{
+			for(auto& flow : *flowsIterator->second->structValue)
+			{
+				FlowLoad flowLoad;
+				auto loadIterator = flow.second->structValue->find("load");
+				if(loadIterator != flow.second->structValue->end()) flowLoad.load = loadIterator->second->floatValue;
+				auto messageRateIterator = flow.second->structValue->find("messageRate");
+				if(messageRateIterator != flow.second->structValue->end()) flowLoad.messageRate = messageRateIterator->second->floatValue;
+				_flowLoads.emplace(flow.first, flowLoad);
+			}
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void NodeBlueServer::savePlacement()
+{
+	try
+	{
+		BaseLib::PVariable placement = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+		std::string policy = "pack";
+		if(_placementPolicy == PlacementPolicy::spread) policy = "spread";
+		else if(_placementPolicy == PlacementPolicy::pinned) policy = "pinned";
+		placement->structValue->emplace("policy", std::make_shared<BaseLib::Variable>(policy));
+		placement->structValue->emplace("rebalanceOnDeploy", std::make_shared<BaseLib::Variable>(_rebalanceOnDeploy));
+
+		BaseLib::PVariable flows = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+		for(auto& flowLoad : _flowLoads)
+		{
+			BaseLib::PVariable flow = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+			flow->structValue->emplace("load", std::make_shared<BaseLib::Variable>(flowLoad.second.load));
+			flow->structValue->emplace("messageRate", std::make_shared<BaseLib::Variable>(flowLoad.second.messageRate));
+			flows->structValue->emplace(flowLoad.first, flow);
+		}
+		placement->structValue->emplace("flows", flows);
+
+		std::vector<char> rawPlacement;
+		_jsonEncoder->encode(placement, rawPlacement);
+		std::string placementFile = GD::bl->settings.nodeBlueDataPath() + "flowplacement.json";
+		GD::bl->io.writeFile(placementFile, rawPlacement, rawPlacement.size());
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void NodeBlueServer::loadWarmPool()
+{
+	try
+	{
+		std::string warmPoolFile = GD::bl->settings.nodeBlueDataPath() + "flowswarmpool.json";
+		if(!GD::bl->io.fileExists(warmPoolFile)) return;
+		std::string rawWarmPool = GD::bl->io.getFileContent(warmPoolFile);
+		if(BaseLib::HelperFunctions::trim(rawWarmPool).empty()) return;
+		BaseLib::PVariable warmPool = _jsonDecoder->decode(rawWarmPool);
+
+		uint32_t minSize = DEFAULT_WARM_POOL_MIN_SIZE;
+		uint32_t maxSize = DEFAULT_WARM_POOL_MAX_SIZE;
+		int64_t idleTimeout = DEFAULT_WARM_POOL_IDLE_TIMEOUT;
+		auto settingIterator = warmPool->structValue->find("minSize");
+		if(settingIterator != warmPool->structValue->end() && settingIterator->second->integerValue >= 0) minSize = settingIterator->second->integerValue;
+		settingIterator = warmPool->structValue->find("maxSize");
+		if(settingIterator != warmPool->structValue->end() && settingIterator->second->integerValue >= 0) maxSize = settingIterator->second->integerValue;
+		settingIterator = warmPool->structValue->find("idleTimeout");
+		if(settingIterator != warmPool->structValue->end() && settingIterator->second->integerValue64 >= 0) idleTimeout = settingIterator->second->integerValue64;
+		if(minSize > maxSize)
+		{
+			_out.printWarning("Warning: Ignoring " + warmPoolFile + ", because minSize is greater than maxSize.");
+			return;
+		}
+
+		std::lock_guard<std::mutex> warmPoolSettingsGuard(_warmPoolSettingsMutex);
+		_warmPoolMinSize = minSize;
+		_warmPoolMaxSize = maxSize;
+		_warmPoolIdleTimeout = idleTimeout;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void NodeBlueServer::saveWarmPool()
+{
+	try
+	{
+		BaseLib::PVariable warmPool = getWarmPool();
+		if(warmPool->errorStruct) return;
+		std::vector<char> rawWarmPool;
+		_jsonEncoder->encode(warmPool, rawWarmPool);
+		std::string warmPoolFile = GD::bl->settings.nodeBlueDataPath() + "flowswarmpool.json";
+		GD::bl->io.writeFile(warmPoolFile, rawWarmPool, rawWarmPool.size());
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void NodeBlueServer::updateFlowLoads()
+{
+	try
+	{
+		if(_shuttingDown) return;
+		std::unordered_map<int32_t, PFlowInfoServer> flowsById;
+		{
+			std::lock_guard<std::mutex> runningFlowsGuard(_runningFlowsMutex);
+			for(auto& runningFlow : _runningFlows)
+			{
+				flowsById.emplace(runningFlow.second->id, runningFlow.second);
+			}
+		}
+		if(flowsById.empty()) return;
+
+		std::vector<PNodeBlueClientData> clients;
+		{
+			std::lock_guard<std::mutex> stateGuard(_stateMutex);
+			clients.reserve(_clients.size());
+			for(std::map<int32_t, PNodeBlueClientData>::iterator i = _clients.begin(); i != _clients.end(); ++i)
+			{
+				if(i->second->closed) continue;
+				clients.push_back(i->second);
+			}
+		}
+
+		bool changed = false;
+		for(auto& client : clients)
+		{
+			BaseLib::PArray parameters(new BaseLib::Array());
+			BaseLib::PVariable response = sendRequest(client, "getFlowStatistics", parameters, true);
+			if(response->errorStruct) continue;
+			for(auto& statistics : *response->structValue)
+			{
+				auto flowIterator = flowsById.find(BaseLib::Math::getNumber(statistics.first));
+				if(flowIterator == flowsById.end()) continue;
+
+				auto runtimeIterator = statistics.second->structValue->find("runtime");
+				auto inputsIterator = statistics.second->structValue->find("inputs");
+				auto processingTimeIterator = statistics.second->structValue->find("processingTime");
+				if(runtimeIterator == statistics.second->structValue->end() || inputsIterator == statistics.second->structValue->end() || processingTimeIterator == statistics.second->structValue->end()) continue;
+				int64_t runtime = runtimeIterator->second->integerValue64;
+				if(runtime < FLOW_LOAD_MIN_RUNTIME) continue; //Keep the previous value for flows that just started.
+
+				FlowLoad flowLoad;
+				flowLoad.load = (double)processingTimeIterator->second->integerValue64 / (runtime * 1000.0);
+				flowLoad.messageRate = (double)inputsIterator->second->integerValue64 * 1000.0 / runtime;
+				flowIterator->second->load = flowLoad.load;
+
+				std::lock_guard<std::mutex> placementGuard(_placementMutex);
+				_flowLoads[flowIterator->second->nodeBlueId] = flowLoad;
+				changed = true;
+			}
+		}
+
+		if(changed)
+		{
+			std::lock_guard<std::mutex> placementGuard(_placementMutex);
+			savePlacement();
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void NodeBlueServer::rebalanceFlows(std::unordered_map<std::string, PFlowInfoServer>& flowInfos, std::vector<PFlowInfoServer>& flowsToStop, std::vector<PFlowInfoServer>& flowsToStart)
+{
+	try
+	{
+		PNodeBlueProcess hottestProcess;
+		double maxLoad = 0;
+		double minLoad = 0;
+		{
+			std::lock_guard<std::mutex> processGuard(_processMutex);
+			bool first = true;
+			for(auto& process : _processes)
+			{
+				if(!process.second->getClientData() || process.second->getClientData()->closed) continue;
+				double load = process.second->load();
+				if(first || load < minLoad) minLoad = load;
+				if(process.second->flowCount() > 1 && (!hottestProcess || load > maxLoad))
+				{
+					hottestProcess = process.second;
+					maxLoad = load;
+				}
+				first = false;
+			}
+		}
+		if(!hottestProcess || maxLoad - minLoad < REBALANCE_MIN_LOAD_DIFFERENCE / 100.0) return;
+
+		std::set<std::string> flowsToStopIds;
+		for(auto& flowInfo : flowsToStop)
+		{
+			flowsToStopIds.emplace(flowInfo->nodeBlueId);
+		}
+
+		std::unordered_map<std::string, PFlowInfoServer> runningFlows;
+		{
+			std::lock_guard<std::mutex> runningFlowsGuard(_runningFlowsMutex);
+			runningFlows = _runningFlows;
+		}
+
+		//Move the flow that brings both processes closest to the same load.
+		double targetLoad = (maxLoad - minLoad) / 2;
+		PFlowInfoServer selectedFlow;
+		for(auto& runningFlow : runningFlows)
+		{
+			if(runningFlow.first == "g" || runningFlow.second->load <= 0 || runningFlow.second->load >= maxLoad - minLoad) continue;
+			if(flowsToStopIds.find(runningFlow.first) != flowsToStopIds.end()) continue;
+			if(!hottestProcess->getFlow(runningFlow.second->id)) continue;
+			if(!selectedFlow || std::abs(runningFlow.second->load - targetLoad) < std::abs(selectedFlow->load - targetLoad)) selectedFlow = runningFlow.second;
+		}
+		if(!selectedFlow) return;
+
+		auto flowInfoIterator = flowInfos.find(selectedFlow->nodeBlueId);
+		if(flowInfoIterator == flowInfos.end()) return;
+
+		_out.printInfo("Info: Moving flow " + selectedFlow->nodeBlueId + " out of flows process " + std::to_string(hottestProcess->getPid()) + " to balance load.");
+		flowsToStop.push_back(selectedFlow);
+		flowsToStart.push_back(flowInfoIterator->second);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
 void NodeBlueServer::broadcastEvent(std::string& source, uint64_t id, int32_t channel, std::shared_ptr<std::vector<std::string>>& variables, BaseLib::PArray& values)
 {
 	try
@@ -2002,6 +3153,8 @@ void NodeBlueServer::closeClientConnection(PNodeBlueClientData client)
 	{
 		if(!client) return;
 		GD::bl->fileDescriptorManager.shutdown(client->fileDescriptor);
+		auto sharedMemoryRing = std::atomic_load(&client->sharedMemoryRing); //Don't lock sendMutex here, a writer might be waiting for the client.
+		if(sharedMemoryRing) sharedMemoryRing->shutdown();
 		client->closed = true;
 	}
 	catch(const std::exception& ex)
@@ -2039,7 +3192,7 @@ void NodeBlueServer::processQueueEntry(int32_t index, std::shared_ptr<BaseLib::I
 			{
 				if(GD::bl->debugLevel >= 4)
 				{
-					if(GD::bl->debugLevel >= 5 || (queueEntry->methodName != "nodeEvent")) _out.printInfo("Info: Client number " + std::to_string(queueEntry->clientData->id) + " is calling RPC method: " + queueEntry->methodName);
+					if(GD::bl->debugLevel >= 5 || (queueEntry->methodName != "nodeEvent" && queueEntry->methodName != "nodeEvents")) _out.printInfo("Info: Client number " + std::to_string(queueEntry->clientData->id) + " is calling RPC method: " + queueEntry->methodName);
 					if(GD::bl->debugLevel >= 5)
 					{
 						for(BaseLib::Array::iterator i = queueEntry->parameters->at(3)->arrayValue->begin(); i != queueEntry->parameters->at(3)->arrayValue->end(); ++i)
@@ -2048,7 +3201,9 @@ void NodeBlueServer::processQueueEntry(int32_t index, std::shared_ptr<BaseLib::I
 						}
 					}
 				}
+				int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
 				BaseLib::PVariable result = localMethodIterator->second(queueEntry->clientData, queueEntry->parameters->at(3)->arrayValue);
+				Rpc::RpcMetrics::record(_methodMetrics, queueEntry->methodName, BaseLib::HelperFunctions::getTimeMicroseconds() - startTime, result->errorStruct);
 				if(GD::bl->debugLevel >= 5)
 				{
 					_out.printDebug("Response: ");
@@ -2078,7 +3233,9 @@ void NodeBlueServer::processQueueEntry(int32_t index, std::shared_ptr<BaseLib::I
 					}
 				}
 			}
+			int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
 			BaseLib::PVariable result = _rpcMethods.at(queueEntry->methodName)->invoke(_dummyClientInfo, queueEntry->parameters->at(3)->arrayValue);
+			Rpc::RpcMetrics::record(_methodMetrics, queueEntry->methodName, BaseLib::HelperFunctions::getTimeMicroseconds() - startTime, result->errorStruct);
 			if(GD::bl->debugLevel >= 5)
 			{
 				_out.printDebug("Response: ");
@@ -2134,7 +3291,20 @@ BaseLib::PVariable NodeBlueServer::send(PNodeBlueClientData& clientData, std::ve
 	try
 	{
 		int32_t totallySentBytes = 0;
-		std::lock_guard<std::mutex> sendGuard(clientData->sendMutex);
+		std::unique_lock<std::mutex> sendGuard(clientData->sendMutex);
+		auto sharedMemoryRing = std::atomic_load(&clientData->sharedMemoryRing);
+		if(sharedMemoryRing)
+		{
+			//sendMutex is released while the ring is full, so a slow client doesn't block other senders.
+			if(!sharedMemoryRing->write(sendGuard, data.data(), data.size(), 30000))
+			{
+				if(!sharedMemoryRing->isClosed()) GD::out.printError("Could not write data to shared memory ring of client: " + std::to_string(clientData->id) + ". Closing connection.");
+				//Part of the packet might be in the ring already, so all following packets would be misframed.
+				closeClientConnection(clientData);
+				return BaseLib::Variable::createError(-32500, "Unknown application error.");
+			}
+			return std::make_shared<BaseLib::Variable>();
+		}
 		while(totallySentBytes < (signed) data.size())
 		{
 			int32_t sentBytes = ::send(clientData->fileDescriptor->descriptor, &data.at(0) + totallySentBytes, data.size() - totallySentBytes, MSG_NOSIGNAL);
@@ -2226,11 +3396,85 @@ BaseLib::PVariable NodeBlueServer::sendRequest(PNodeBlueClientData& clientData,
 		else result = response->response->arrayValue->at(1);
 
 		{
-			std::lock_guard<std::mutex> responseGuard(clientData->rpcResponsesMutex);
-			clientData->rpcResponses.erase(packetId);
-		}
+			std::lock_guard<std::mutex> responseGuard(clientData->rpcResponsesMutex);
+			clientData->rpcResponses.erase(packetId);
+		}
+
+		return result;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+void NodeBlueServer::sendResponse(PNodeBlueClientData& clientData, BaseLib::PVariable& scriptId, BaseLib::PVariable& packetId, BaseLib::PVariable& variable)
+{
+	try
+	{
+		BaseLib::PVariable array(new BaseLib::Variable(BaseLib::PArray(new BaseLib::Array{scriptId, packetId, variable})));
+		std::vector<char> data;
+		_rpcEncoder->encodeResponse(array, data);
+		send(clientData, data);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void NodeBlueServer::mainThread()
+{
+	try
+	{
+		EpollReactor::Callbacks callbacks;
+		callbacks.getServerFileDescriptor = [this]() -> std::shared_ptr<BaseLib::FileDescriptor>
+		{
+			if(!_serverFileDescriptor || _serverFileDescriptor->descriptor == -1) getFileDescriptor();
+			return _serverFileDescriptor;
+		};
+		callbacks.clientAccepted = std::bind(&NodeBlueServer::clientAccepted, this, std::placeholders::_1);
+		callbacks.readClient = [this](uint64_t token) -> bool
+		{
+			PNodeBlueClientData clientData;
+			{
+				std::lock_guard<std::mutex> stateGuard(_stateMutex);
+				auto clientIterator = _clients.find((int32_t)token);
+				if(clientIterator == _clients.end()) return false;
+				clientData = clientIterator->second;
+			}
+			if(clientData->closed) return false;
+			if(clientData->fileDescriptor->descriptor == -1)
+			{
+				clientData->closed = true;
+				return false;
+			}
+			return readClient(clientData);
+		};
+		callbacks.idle = [this]()
+		{
+			if(GD::bl->hf.getTime() - _lastGarbageCollection > 60000 || _clients.size() > GD::bl->settings.nodeBlueServerMaxConnections() * 100 / 112) collectGarbage();
+		};
 
-		return result;
+		_reactor.run(_stopServer, callbacks);
+		GD::bl->fileDescriptorManager.close(_serverFileDescriptor);
 	}
 	catch(const std::exception& ex)
 	{
@@ -2244,17 +3488,39 @@ BaseLib::PVariable NodeBlueServer::sendRequest(PNodeBlueClientData& clientData,
 	{
 		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
 	}
-	return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
-void NodeBlueServer::sendResponse(PNodeBlueClientData& clientData, BaseLib::PVariable& scriptId, BaseLib::PVariable& packetId, BaseLib::PVariable& variable)
+void NodeBlueServer::clientAccepted(std::shared_ptr<BaseLib::FileDescriptor>& clientFileDescriptor)
 {
 	try
 	{
-		BaseLib::PVariable array(new BaseLib::Variable(BaseLib::PArray(new BaseLib::Array{scriptId, packetId, variable})));
-		std::vector<char> data;
-		_rpcEncoder->encodeResponse(array, data);
-		send(clientData, data);
+		_out.printInfo("Info: Connection accepted. Client number: " + std::to_string(clientFileDescriptor->id));
+
+		if(_clients.size() > GD::bl->settings.nodeBlueServerMaxConnections())
+		{
+			collectGarbage();
+			if(_clients.size() > GD::bl->settings.nodeBlueServerMaxConnections())
+			{
+				_out.printError("Error: There are too many clients connected to me. Closing connection. You can increase the number of allowed connections in main.conf.");
+				GD::bl->fileDescriptorManager.close(clientFileDescriptor);
+				return;
+			}
+		}
+
+		std::lock_guard<std::mutex> stateGuard(_stateMutex);
+		if(_shuttingDown)
+		{
+			GD::bl->fileDescriptorManager.close(clientFileDescriptor);
+			return;
+		}
+		PNodeBlueClientData clientData = PNodeBlueClientData(new NodeBlueClientData(clientFileDescriptor));
+		clientData->id = _currentClientId++;
+		if(!_reactor.add(clientFileDescriptor->descriptor, (uint64_t)clientData->id, true))
+		{
+			GD::bl->fileDescriptorManager.close(clientFileDescriptor);
+			return;
+		}
+		_clients[clientData->id] = clientData;
 	}
 	catch(const std::exception& ex)
 	{
@@ -2270,123 +3536,76 @@ void NodeBlueServer::sendResponse(PNodeBlueClientData& clientData, BaseLib::PVar
 	}
 }
 
-void NodeBlueServer::mainThread()
+PNodeBlueProcess NodeBlueServer::getFreeProcess(PFlowInfoServer& flowInfo)
 {
 	try
 	{
-		int32_t result = 0;
-		std::shared_ptr<BaseLib::FileDescriptor> clientFileDescriptor;
-		while(!_stopServer)
+		uint32_t maxThreadCount = flowInfo->maxThreadCount;
+		if(GD::bl->settings.maxNodeThreadsPerProcess() != -1 && maxThreadCount > (unsigned) GD::bl->settings.maxNodeThreadsPerProcess())
 		{
-			if(!_serverFileDescriptor || _serverFileDescriptor->descriptor == -1)
-			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-				getFileDescriptor();
-				continue;
-			}
+			GD::out.printError("Error: Could not get flow process, because maximum number of threads in flow is greater than the number of threads allowed per flow process.");
+			return PNodeBlueProcess();
+		}
+
+		PlacementPolicy placementPolicy = PlacementPolicy::pack;
+		{
+			std::lock_guard<std::mutex> placementGuard(_placementMutex);
+			placementPolicy = _placementPolicy;
+		}
 
-			timeval timeout;
-			timeout.tv_sec = 0;
-			timeout.tv_usec = 100000;
-			fd_set readFileDescriptor;
-			int32_t maxfd = 0;
-			FD_ZERO(&readFileDescriptor);
+		std::lock_guard<std::mutex> processGuard(_newProcessMutex);
+		{
+			std::lock_guard<std::mutex> processGuard(_processMutex);
+			PNodeBlueProcess selectedProcess;
+			PNodeBlueProcess idleProcess;
+			double selectedLoad = 0;
+			for(std::map<pid_t, PNodeBlueProcess>::iterator i = _processes.begin(); i != _processes.end(); ++i)
 			{
-				std::vector<PNodeBlueClientData> clients;
+				if(!i->second->getClientData() || i->second->getClientData()->closed) continue;
+				if(GD::bl->settings.maxNodeThreadsPerProcess() != -1 && i->second->nodeThreadCount() + maxThreadCount > (unsigned) GD::bl->settings.maxNodeThreadsPerProcess()) continue;
+
+				if(i->second->flowCount() == 0)
 				{
-					std::lock_guard<std::mutex> stateGuard(_stateMutex);
-					clients.reserve(_clients.size());
-					for(auto& client : _clients)
-					{
-						if(client.second->closed) continue;
-						if(client.second->fileDescriptor->descriptor == -1)
-						{
-							client.second->closed = true;
-							continue;
-						}
-						clients.push_back(client.second);
-					}
+					//Idle processes are only used when no running process fits. Otherwise "spread" would start one process per flow.
+					if(!idleProcess) idleProcess = i->second;
+					if(placementPolicy == PlacementPolicy::pack) break;
+					continue;
 				}
 
-				auto fileDescriptorGuard = GD::bl->fileDescriptorManager.getLock();
-				fileDescriptorGuard.lock();
-				maxfd = _serverFileDescriptor->descriptor;
-				FD_SET(_serverFileDescriptor->descriptor, &readFileDescriptor);
-
-				for(auto& client : clients)
+				if(placementPolicy == PlacementPolicy::pinned)
 				{
-					int32_t descriptor = client->fileDescriptor->descriptor;
-					if(descriptor == -1) continue; //Never pass -1 to FD_SET => undefined behaviour. This is just a safety precaution, because the file descriptor manager is locked and descriptors shouldn't be modified.
-					FD_SET(descriptor, &readFileDescriptor);
-					if(descriptor > maxfd) maxfd = descriptor;
+					if(i->second->pin() != flowInfo->pin) continue;
+					selectedProcess = i->second;
+					break;
 				}
-			}
-
-			result = select(maxfd + 1, &readFileDescriptor, NULL, NULL, &timeout);
-			if(result == 0)
-			{
-				if(GD::bl->hf.getTime() - _lastGarbageCollection > 60000 || _clients.size() > GD::bl->settings.nodeBlueServerMaxConnections() * 100 / 112) collectGarbage();
-				continue;
-			}
-			else if(result == -1)
-			{
-				if(errno == EINTR) continue;
-				_out.printError("Error: select returned -1: " + std::string(strerror(errno)));
-				continue;
-			}
-
-			if(FD_ISSET(_serverFileDescriptor->descriptor, &readFileDescriptor) && !_shuttingDown)
-			{
-				sockaddr_un clientAddress;
-				socklen_t addressSize = sizeof(addressSize);
-				std::shared_ptr<BaseLib::FileDescriptor> clientFileDescriptor = GD::bl->fileDescriptorManager.add(accept(_serverFileDescriptor->descriptor, (struct sockaddr*) &clientAddress, &addressSize));
-				if(!clientFileDescriptor || clientFileDescriptor->descriptor == -1) continue;
-				_out.printInfo("Info: Connection accepted. Client number: " + std::to_string(clientFileDescriptor->id));
-
-				if(_clients.size() > GD::bl->settings.nodeBlueServerMaxConnections())
+				else if(placementPolicy == PlacementPolicy::spread)
 				{
-					collectGarbage();
-					if(_clients.size() > GD::bl->settings.nodeBlueServerMaxConnections())
+					double load = i->second->load();
+					if(load + flowInfo->load > SPREAD_MAX_PROCESS_LOAD / 100.0) continue;
+					if(!selectedProcess || load < selectedLoad)
 					{
-						_out.printError("Error: There are too many clients connected to me. Closing connection. You can increase the number of allowed connections in main.conf.");
-						GD::bl->fileDescriptorManager.close(clientFileDescriptor);
-						continue;
+						selectedProcess = i->second;
+						selectedLoad = load;
 					}
 				}
-
-				std::lock_guard<std::mutex> stateGuard(_stateMutex);
-				if(_shuttingDown)
+				else
 				{
-					GD::bl->fileDescriptorManager.close(clientFileDescriptor);
-					continue;
+					selectedProcess = i->second;
+					break;
 				}
-				PNodeBlueClientData clientData = PNodeBlueClientData(new NodeBlueClientData(clientFileDescriptor));
-				clientData->id = _currentClientId++;
-				_clients[clientData->id] = clientData;
-				continue;
 			}
 
-			PNodeBlueClientData clientData;
+			if(!selectedProcess) selectedProcess = idleProcess;
+			if(selectedProcess)
 			{
-				std::lock_guard<std::mutex> stateGuard(_stateMutex);
-				for(std::map<int32_t, PNodeBlueClientData>::iterator i = _clients.begin(); i != _clients.end(); ++i)
-				{
-					if(i->second->fileDescriptor->descriptor == -1)
-					{
-						i->second->closed = true;
-						continue;
-					}
-					if(FD_ISSET(i->second->fileDescriptor->descriptor, &readFileDescriptor))
-					{
-						clientData = i->second;
-						break;
-					}
-				}
+				if(selectedProcess->flowCount() == 0) refillWarmPool();
+				selectedProcess->lastExecution = BaseLib::HelperFunctions::getTime();
+				return selectedProcess;
 			}
-
-			if(clientData) readClient(clientData);
 		}
-		GD::bl->fileDescriptorManager.close(_serverFileDescriptor);
+		PNodeBlueProcess process = spawnProcess();
+		refillWarmPool();
+		return process;
 	}
 	catch(const std::exception& ex)
 	{
@@ -2400,31 +3619,13 @@ void NodeBlueServer::mainThread()
 	{
 		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
 	}
+	return PNodeBlueProcess();
 }
 
-PNodeBlueProcess NodeBlueServer::getFreeProcess(uint32_t maxThreadCount)
+PNodeBlueProcess NodeBlueServer::spawnProcess()
 {
 	try
 	{
-		if(GD::bl->settings.maxNodeThreadsPerProcess() != -1 && maxThreadCount > (unsigned) GD::bl->settings.maxNodeThreadsPerProcess())
-		{
-			GD::out.printError("Error: Could not get flow process, because maximum number of threads in flow is greater than the number of threads allowed per flow process.");
-			return PNodeBlueProcess();
-		}
-
-		std::lock_guard<std::mutex> processGuard(_newProcessMutex);
-		{
-			std::lock_guard<std::mutex> processGuard(_processMutex);
-			for(std::map<pid_t, PNodeBlueProcess>::iterator i = _processes.begin(); i != _processes.end(); ++i)
-			{
-				if(i->second->getClientData()->closed) continue;
-				if(GD::bl->settings.maxNodeThreadsPerProcess() == -1 || i->second->nodeThreadCount() + maxThreadCount <= (unsigned) GD::bl->settings.maxNodeThreadsPerProcess())
-				{
-					i->second->lastExecution = BaseLib::HelperFunctions::getTime();
-					return i->second;
-				}
-			}
-		}
 		_out.printInfo("Info: Spawning new flows process.");
 		PNodeBlueProcess process(new NodeBlueProcess());
 		std::vector<std::string> arguments{"-c", GD::configPath, "-rl"};
@@ -2464,6 +3665,7 @@ PNodeBlueProcess NodeBlueServer::getFreeProcess(uint32_t maxThreadCount)
 				BaseLib::PArray parameters(new BaseLib::Array());
 				sendRequest(process->getClientData(), "enableNodeEvents", parameters, false);
 			}
+			process->lastExecution = BaseLib::HelperFunctions::getTime();
 			return process;
 		}
 	}
@@ -2482,18 +3684,93 @@ PNodeBlueProcess NodeBlueServer::getFreeProcess(uint32_t maxThreadCount)
 	return PNodeBlueProcess();
 }
 
-void NodeBlueServer::readClient(PNodeBlueClientData& clientData)
+uint32_t NodeBlueServer::idleProcessCount()
+{
+	try
+	{
+		uint32_t count = 0;
+		std::lock_guard<std::mutex> processGuard(_processMutex);
+		for(std::map<pid_t, PNodeBlueProcess>::iterator i = _processes.begin(); i != _processes.end(); ++i)
+		{
+			if(!i->second->getClientData() || i->second->getClientData()->closed) continue;
+			if(i->second->flowCount() == 0) count++;
+		}
+		return count;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return 0;
+}
+
+void NodeBlueServer::refillWarmPool()
+{
+	{
+		std::lock_guard<std::mutex> warmPoolGuard(_warmPoolMutex);
+		_refillWarmPool = true;
+	}
+	_warmPoolConditionVariable.notify_one();
+}
+
+void NodeBlueServer::warmPoolThread()
+{
+	if(GD::bl->settings.nodeBlueManualClientStart()) return;
+	while(!_shuttingDown && !_stopServer)
+	{
+		try
+		{
+			{
+				std::unique_lock<std::mutex> warmPoolGuard(_warmPoolMutex);
+				_warmPoolConditionVariable.wait_for(warmPoolGuard, std::chrono::milliseconds(1000), [&] { return _refillWarmPool || _shuttingDown || _stopServer; });
+				_refillWarmPool = false;
+			}
+			if(_flowsRestarting) continue;
+
+			while(!_shuttingDown && !_stopServer && !_flowsRestarting && idleProcessCount() < _warmPoolMinSize)
+			{
+				std::lock_guard<std::mutex> newProcessGuard(_newProcessMutex);
+				if(_shuttingDown || _stopServer || _flowsRestarting) break;
+				if(idleProcessCount() >= _warmPoolMinSize) break;
+				if(!spawnProcess()) break; //Try again in the next iteration
+			}
+		}
+		catch(const std::exception& ex)
+		{
+			_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(BaseLib::Exception& ex)
+		{
+			_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(...)
+		{
+			_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+		}
+	}
+}
+
+bool NodeBlueServer::readClient(PNodeBlueClientData& clientData)
 {
 	try
 	{
 		int32_t processedBytes = 0;
 		int32_t bytesRead = 0;
-		bytesRead = read(clientData->fileDescriptor->descriptor, &(clientData->buffer[0]), clientData->buffer.size());
-		if(bytesRead <= 0) //read returns 0, when connection is disrupted.
+		bytesRead = recv(clientData->fileDescriptor->descriptor, &(clientData->buffer[0]), clientData->buffer.size(), MSG_DONTWAIT);
+		if(bytesRead == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return errno == EINTR;
+		if(bytesRead <= 0) //recv returns 0, when connection is disrupted.
 		{
 			_out.printInfo("Info: Connection to flows server's client number " + std::to_string(clientData->fileDescriptor->id) + " closed.");
 			closeClientConnection(clientData);
-			return;
+			return false;
 		}
 
 		if(bytesRead > (signed) clientData->buffer.size()) bytesRead = clientData->buffer.size();
@@ -2516,6 +3793,10 @@ void NodeBlueServer::readClient(PNodeBlueClientData& clientData)
 							BaseLib::PVariable result = registerFlowsClient(clientData, parameters->at(3)->arrayValue);
 							sendResponse(clientData, parameters->at(0), parameters->at(1), result);
 						}
+						else if(methodName == "openSharedMemoryRing" && parameters->size() == 4)
+						{
+							openSharedMemoryRing(clientData, parameters->at(0), parameters->at(1));
+						}
 						else
 						{
 							std::shared_ptr<BaseLib::IQueueEntry> queueEntry = std::make_shared<QueueEntry>(clientData, methodName, parameters);
@@ -2536,6 +3817,7 @@ void NodeBlueServer::readClient(PNodeBlueClientData& clientData)
 			_out.printError("Error processing packet: " + ex.what());
 			clientData->binaryRpc->reset();
 		}
+		return true;
 	}
 	catch(const std::exception& ex)
 	{
@@ -2549,6 +3831,7 @@ void NodeBlueServer::readClient(PNodeBlueClientData& clientData)
 	{
 		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
 	}
+	return false;
 }
 
 bool NodeBlueServer::getFileDescriptor(bool deleteOldSocket)
@@ -2637,7 +3920,7 @@ void NodeBlueServer::startFlow(PFlowInfoServer& flowInfo, std::set<std::string>&
 	try
 	{
 		if(_shuttingDown) return;
-		PNodeBlueProcess process = getFreeProcess(flowInfo->maxThreadCount);
+		PNodeBlueProcess process = getFreeProcess(flowInfo);
 		if(!process)
 		{
 			_out.printError("Error: Could not get free process. Not executing flow.");
@@ -2665,7 +3948,7 @@ void NodeBlueServer::startFlow(PFlowInfoServer& flowInfo, std::set<std::string>&
 
 		{
 			std::lock_guard<std::mutex> flowClientIdMapGuard(_flowClientIdMapMutex);
-			_flowClientIdMap.emplace(flowInfo->nodeBlueId, clientData->id);
+			_flowClientIdMap[flowInfo->nodeBlueId] = clientData->id;
 		}
 
 		BaseLib::PArray parameters(new BaseLib::Array{
@@ -2706,6 +3989,72 @@ void NodeBlueServer::startFlow(PFlowInfoServer& flowInfo, std::set<std::string>&
 	}
 }
 
+void NodeBlueServer::stopFlow(PFlowInfoServer& flowInfo)
+{
+	try
+	{
+		_out.printInfo("Info: Stopping flow with id " + std::to_string(flowInfo->id) + ".");
+
+		{
+			std::lock_guard<std::mutex> runningFlowsGuard(_runningFlowsMutex);
+			_runningFlows.erase(flowInfo->nodeBlueId);
+		}
+
+		int32_t clientId = -1;
+		{
+			std::lock_guard<std::mutex> flowClientIdMapGuard(_flowClientIdMapMutex);
+			auto flowClientIdIterator = _flowClientIdMap.find(flowInfo->nodeBlueId);
+			if(flowClientIdIterator != _flowClientIdMap.end())
+			{
+				clientId = flowClientIdIterator->second;
+				_flowClientIdMap.erase(flowClientIdIterator);
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> nodeClientIdMapGuard(_nodeClientIdMapMutex);
+			for(auto& node : flowInfo->nodeIds)
+			{
+				_nodeClientIdMap.erase(node);
+			}
+		}
+
+		PNodeBlueClientData clientData;
+		{
+			std::lock_guard<std::mutex> stateGuard(_stateMutex);
+			auto clientIterator = _clients.find(clientId);
+			if(clientIterator != _clients.end() && !clientIterator->second->closed) clientData = clientIterator->second;
+		}
+		if(!clientData) return;
+
+		BaseLib::PArray parameters(new BaseLib::Array{
+				BaseLib::PVariable(new BaseLib::Variable(flowInfo->id))
+		});
+		BaseLib::PVariable result = sendRequest(clientData, "stopFlow", parameters, true);
+		if(result->errorStruct) _out.printError("Error: Could not stop flow: " + result->structValue->at("faultString")->stringValue);
+
+		std::lock_guard<std::mutex> processGuard(_processMutex);
+		auto processIterator = _processes.find(clientData->pid);
+		if(processIterator != _processes.end())
+		{
+			processIterator->second->invokeFlowFinished(flowInfo->id, 0);
+			processIterator->second->unregisterFlow(flowInfo->id);
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
 BaseLib::PVariable NodeBlueServer::executePhpNodeBaseMethod(BaseLib::PArray& parameters)
 {
 	try
@@ -2744,6 +4093,47 @@ BaseLib::PVariable NodeBlueServer::executePhpNodeBaseMethod(BaseLib::PArray& par
 }
 
 // {{{ RPC methods
+void NodeBlueServer::openSharedMemoryRing(PNodeBlueClientData& clientData, BaseLib::PVariable& scriptId, BaseLib::PVariable& packetId)
+{
+	try
+	{
+		auto sharedMemoryRing = std::make_shared<SharedMemoryRing>();
+		if(!sharedMemoryRing->create())
+		{
+			BaseLib::PVariable error = BaseLib::Variable::createError(-1, "Shared memory rings are not supported on this system.");
+			sendResponse(clientData, scriptId, packetId, error);
+			return;
+		}
+
+		BaseLib::PVariable array(new BaseLib::Variable(BaseLib::PArray(new BaseLib::Array{scriptId, packetId, std::make_shared<BaseLib::Variable>()})));
+		std::vector<char> data;
+		_rpcEncoder->encodeResponse(array, data);
+
+		//The response carries the file descriptors. Everything sent after it goes through the ring.
+		std::lock_guard<std::mutex> sendGuard(clientData->sendMutex);
+		if(std::atomic_load(&clientData->sharedMemoryRing) || !sharedMemoryRing->sendFileDescriptors(clientData->fileDescriptor->descriptor, data.data(), data.size()))
+		{
+			_out.printError("Error: Could not pass shared memory ring to client " + std::to_string(clientData->id) + ".");
+			GD::bl->fileDescriptorManager.shutdown(clientData->fileDescriptor);
+			return;
+		}
+		std::atomic_store(&clientData->sharedMemoryRing, sharedMemoryRing);
+		_out.printInfo("Info: Client " + std::to_string(clientData->id) + " now receives data through shared memory.");
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
 BaseLib::PVariable NodeBlueServer::registerFlowsClient(PNodeBlueClientData& clientData, BaseLib::PArray& parameters)
 {
 	try
@@ -2946,6 +4336,36 @@ BaseLib::PVariable NodeBlueServer::nodeEvent(PNodeBlueClientData& clientData, Ba
 	}
 	return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
+
+BaseLib::PVariable NodeBlueServer::nodeEvents(PNodeBlueClientData& clientData, BaseLib::PArray& parameters)
+{
+	try
+	{
+		if(parameters->size() != 1) return BaseLib::Variable::createError(-1, "Method expects exactly one parameter.");
+		if(parameters->at(0)->type != BaseLib::VariableType::tArray) return BaseLib::Variable::createError(-1, "Parameter is not of type array.");
+
+		for(auto& event : *parameters->at(0)->arrayValue)
+		{
+			if(event->type != BaseLib::VariableType::tArray) continue;
+			nodeEvent(clientData, event->arrayValue);
+		}
+
+		return std::make_shared<BaseLib::Variable>();
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
 // }}}
 
 }
@@ -32,9 +32,12 @@
 #define NODEBLUESERVER_H_
 
 #include "NodeBlueProcess.h"
+#include "../IPC/EpollReactor.h"
+#include "../RPC/RpcMetrics.h"
 #include <homegear-base/BaseLib.h>
 #include "FlowInfoServer.h"
 #include "NodeManager.h"
+#include "NodeCatalog.h"
 
 #include <queue>
 
@@ -47,6 +50,55 @@ namespace NodeBlue
 class NodeBlueServer : public BaseLib::IQueue
 {
 public:
+	/**
+	 * The default minimum number of idle, fully registered flows processes kept running, so starting flows doesn't have to wait for process startup.
+	 */
+	static const uint32_t DEFAULT_WARM_POOL_MIN_SIZE = 1;
+
+	/**
+	 * The default maximum number of idle flows processes. Idle processes above this limit are stopped immediately.
+	 */
+	static const uint32_t DEFAULT_WARM_POOL_MAX_SIZE = 2;
+
+	/**
+	 * The default time in milliseconds after which idle processes above the minimum pool size are stopped.
+	 */
+	static const int64_t DEFAULT_WARM_POOL_IDLE_TIMEOUT = 60000;
+
+	/**
+	 * How new flows are assigned to flows processes.
+	 *
+	 * pack: Fill the first process with enough free threads (default).
+	 * spread: Add the flow to the least loaded process as long as its load stays below SPREAD_MAX_PROCESS_LOAD. Otherwise use a new process.
+	 * pinned: Flows with the tab property "process" share a dedicated process per value. All other flows are packed into unpinned processes.
+	 */
+	enum class PlacementPolicy
+	{
+		pack,
+		spread,
+		pinned
+	};
+
+	/**
+	 * Maximum load of one process in percent of one CPU core up to which "spread" places further flows into it.
+	 */
+	static const int32_t SPREAD_MAX_PROCESS_LOAD = 50;
+
+	/**
+	 * Minimum load difference in percent of one CPU core between the most and the least loaded process to move a flow on deploy.
+	 */
+	static const int32_t REBALANCE_MIN_LOAD_DIFFERENCE = 30;
+
+	/**
+	 * Minimum runtime in milliseconds of a flow before its statistics are used as its load.
+	 */
+	static const int64_t FLOW_LOAD_MIN_RUNTIME = 10000;
+
+	/**
+	 * Incremented when the format of "flows.cache" changes.
+	 */
+	static const int32_t FLOWS_CACHE_VERSION = 3;
+
 	NodeBlueServer();
 
 	virtual ~NodeBlueServer();
@@ -57,6 +109,12 @@ public:
 
 	void restartFlows();
 
+	/**
+	 * Compares the flows in flows.json with the running ones and only stops and starts the flows that changed. Unchanged flows keep running. Falls back to
+	 * restartFlows() when nothing is running yet or when global nodes (e. g. config nodes) changed.
+	 */
+	void deployFlows();
+
 	void homegearShuttingDown();
 
 	void homegearReloading();
@@ -65,6 +123,50 @@ public:
 
 	uint32_t flowCount();
 
+	/**
+	 * Returns the number of queued messages per node of all Node-BLUE processes. Nodes without queued messages are omitted.
+	 *
+	 * @return A struct with the node IDs as keys and the mailbox depths as values.
+	 */
+	BaseLib::PVariable getNodeMailboxes();
+
+	/**
+	 * Returns the runtime statistics of all nodes of all Node-BLUE processes.
+	 *
+	 * @return A struct with the node IDs as keys. Each value contains the number of inputs, outputs and logged errors, the mean and 99th percentile
+	 * execution time of "input()" and the mean time messages waited in the node's mailbox. All times are in microseconds.
+	 */
+	BaseLib::PVariable getNodeStatistics();
+
+	/**
+	 * Returns the placement policy and the measured load, message rate, pin and process ID of every running flow.
+	 */
+	BaseLib::PVariable getFlowPlacement();
+
+	/**
+	 * Sets the placement policy ("pack", "spread" or "pinned"). The policy is used for all flows started afterwards.
+	 *
+	 * @return Returns false when the policy is unknown.
+	 */
+	bool setPlacementPolicy(std::string policy);
+
+	/**
+	 * Enables or disables moving one flow from the most to the least loaded process on deploy. Only used with the policy "spread".
+	 */
+	void setRebalanceOnDeploy(bool value);
+
+	/**
+	 * Returns the minimum and maximum number of idle flows processes and the idle timeout in milliseconds.
+	 */
+	BaseLib::PVariable getWarmPool();
+
+	/**
+	 * Sets the size limits and the idle timeout of the warm pool and stores them in "flowswarmpool.json".
+	 *
+	 * @return Returns false when "minSize" is greater than "maxSize" or "idleTimeout" is negative.
+	 */
+	bool setWarmPool(uint32_t minSize, uint32_t maxSize, int64_t idleTimeout);
+
 	void broadcastEvent(std::string& source, uint64_t id, int32_t channel, std::shared_ptr<std::vector<std::string>>& variables, BaseLib::PArray& values);
 
 	void broadcastNewDevices(std::vector<uint64_t>& ids, BaseLib::PVariable deviceDescriptions);
@@ -73,7 +175,14 @@ public:
 
 	void broadcastUpdateDevice(uint64_t id, int32_t channel, int32_t hint);
 
-	std::string handleGet(std::string& path, BaseLib::Http& http, std::string& responseEncoding);
+	/**
+	 * Returns the content for a GET request to "node-blue/".
+	 *
+	 * @param[out] responseHeaders Additional headers for the response (e. g. "ETag" or "Content-Encoding").
+	 * @return Returns the content, "unauthorized" when the session is invalid or "notmodified" when the client's cached copy (If-None-Match) is
+	 * still valid.
+	 */
+	std::string handleGet(std::string& path, BaseLib::Http& http, std::string& responseEncoding, std::vector<std::string>& responseHeaders);
 
 	std::string handlePost(std::string& path, BaseLib::Http& http, std::string& responseEncoding);
 
@@ -124,6 +233,12 @@ private:
 		// }}}
 	};
 
+	struct FlowLoad
+	{
+		double load = 0;
+		double messageRate = 0;
+	};
+
 	BaseLib::Output _out;
 	std::string _socketPath;
 	std::string _webroot;
@@ -134,9 +249,14 @@ private:
 	std::thread _maintenanceThread;
 	int32_t _backlog = 100;
 	std::shared_ptr<BaseLib::FileDescriptor> _serverFileDescriptor;
+	EpollReactor _reactor;
 	std::mutex _processRequestMutex;
 	std::mutex _newProcessMutex;
 	std::mutex _processMutex;
+	std::thread _warmPoolThread;
+	std::mutex _warmPoolMutex;
+	std::condition_variable _warmPoolConditionVariable;
+	bool _refillWarmPool = false;
 	std::map<pid_t, PNodeBlueProcess> _processes;
 	std::mutex _currentFlowIdMutex;
 	int32_t _currentFlowId = 0;
@@ -147,6 +267,11 @@ private:
 	std::shared_ptr<BaseLib::RpcClientInfo> _dummyClientInfo;
 	std::map<std::string, std::shared_ptr<BaseLib::Rpc::RpcMethod>> _rpcMethods;
 	std::map<std::string, std::function<BaseLib::PVariable(PNodeBlueClientData& clientData, BaseLib::PArray& parameters)>> _localRpcMethods;
+
+	/**
+	 * The metrics entries of all methods in _rpcMethods and _localRpcMethods. Filled in the constructor and read only afterwards.
+	 */
+	Rpc::RpcMetrics::MethodMetricsTable _methodMetrics;
 	std::mutex _packetIdMutex;
 	int32_t _currentPacketId = 0;
 	std::atomic_bool _flowsRestarting;
@@ -155,12 +280,23 @@ private:
 	std::mutex _flowsFileMutex;
 	std::map<std::string, uint32_t> _maxThreadCounts;
 	std::vector<NodeManager::PNodeInfo> _nodeInfo;
+	NodeCatalog _nodeCatalog;
 	std::unique_ptr<BaseLib::Rpc::JsonEncoder> _jsonEncoder;
 	std::unique_ptr<BaseLib::Rpc::JsonDecoder> _jsonDecoder;
 	std::mutex _nodeClientIdMapMutex;
 	std::map<std::string, int32_t> _nodeClientIdMap;
 	std::mutex _flowClientIdMapMutex;
 	std::map<std::string, int32_t> _flowClientIdMap;
+	std::mutex _runningFlowsMutex;
+	std::unordered_map<std::string, PFlowInfoServer> _runningFlows;
+	std::mutex _placementMutex;
+	PlacementPolicy _placementPolicy = PlacementPolicy::pack;
+	bool _rebalanceOnDeploy = false;
+	std::mutex _warmPoolSettingsMutex;
+	std::atomic<uint32_t> _warmPoolMinSize{DEFAULT_WARM_POOL_MIN_SIZE};
+	std::atomic<uint32_t> _warmPoolMaxSize{DEFAULT_WARM_POOL_MAX_SIZE};
+	std::atomic<int64_t> _warmPoolIdleTimeout{DEFAULT_WARM_POOL_IDLE_TIMEOUT};
+	std::unordered_map<std::string, FlowLoad> _flowLoads;
 
 	std::atomic<int64_t> _lastNodeEvent;
 	std::atomic<uint32_t> _nodeEventCounter;
@@ -180,7 +316,17 @@ private:
 
 	void mainThread();
 
-	void readClient(PNodeBlueClientData& clientData);
+	/**
+	 * Creates the client of a connection accepted by _reactor.
+	 */
+	void clientAccepted(std::shared_ptr<BaseLib::FileDescriptor>& clientFileDescriptor);
+
+	/**
+	 * Reads and processes one chunk of data from the client.
+	 *
+	 * @return Returns true when more data might be available.
+	 */
+	bool readClient(PNodeBlueClientData& clientData);
 
 	BaseLib::PVariable send(PNodeBlueClientData& clientData, std::vector<char>& data);
 
@@ -196,25 +342,146 @@ private:
 
 	void closeClientConnection(PNodeBlueClientData client);
 
-	PNodeBlueProcess getFreeProcess(uint32_t maxThreadCount);
+	/**
+	 * Returns the process to start the flow in according to the placement policy. Spawns a new process if necessary.
+	 */
+	PNodeBlueProcess getFreeProcess(PFlowInfoServer& flowInfo);
+
+	/**
+	 * Starts a new flows process and waits until it has registered. "_newProcessMutex" needs to be locked by the caller.
+	 */
+	PNodeBlueProcess spawnProcess();
+
+	/**
+	 * Returns the number of connected flows processes without running flows.
+	 */
+	uint32_t idleProcessCount();
+
+	/**
+	 * Wakes up the warm pool thread to replace processes that have just been taken out of the pool.
+	 */
+	void refillWarmPool();
+
+	/**
+	 * Keeps "_warmPoolMinSize" idle flows processes running.
+	 */
+	void warmPoolThread();
 
 	void getMaxThreadCounts();
 
+	/**
+	 * Returns the content of a cached bundle for a GET request. Adds the ETag and "Vary: Accept-Encoding" and, if the client accepts it, serves the
+	 * gzip-compressed content.
+	 *
+	 * @return Returns the content, "notmodified" when the ETag matches "If-None-Match" or an empty string when there is no content.
+	 */
+	std::string getBundleResponse(const NodeCatalog::PBundle& bundle, BaseLib::Http& http, std::vector<std::string>& responseHeaders);
+
 	bool checkIntegrity(std::string flowsFile);
 
 	void backupFlows();
 
+	/**
+	 * Loads the placement policy and the flow loads from "flowplacement.json" in the Node-BLUE data directory.
+	 */
+	void loadPlacement();
+
+	/**
+	 * Writes the placement policy and the flow loads to "flowplacement.json". "_placementMutex" needs to be locked by the caller.
+	 */
+	void savePlacement();
+
+	/**
+	 * Loads the warm pool settings from "flowswarmpool.json" in the Node-BLUE data directory.
+	 */
+	void loadWarmPool();
+
+	/**
+	 * Writes the warm pool settings to "flowswarmpool.json". "_warmPoolSettingsMutex" needs to be locked by the caller.
+	 */
+	void saveWarmPool();
+
+	/**
+	 * Queries the statistics of all running flows from the clients and stores their load and message rate.
+	 */
+	void updateFlowLoads();
+
+	/**
+	 * Selects one flow to move from the most to the least loaded process and adds it to flowsToStop and flowsToStart.
+	 */
+	void rebalanceFlows(std::unordered_map<std::string, PFlowInfoServer>& flowInfos, std::vector<PFlowInfoServer>& flowsToStop, std::vector<PFlowInfoServer>& flowsToStart);
+
+	/**
+	 * Reads flows.json, inserts subflows and returns one flow info per enabled flow, including its node IDs and a hash of its content.
+	 *
+	 * @param[out] flowInfos The enabled flows by Node-BLUE flow ID.
+	 * @param[out] allNodeIds The IDs of all nodes in all flows.
+	 * @param[out] flowIds The IDs of all flows and subflows, including disabled ones.
+	 * @return Returns false when flows.json doesn't exist or is empty.
+	 */
+	bool parseFlows(std::unordered_map<std::string, PFlowInfoServer>& flowInfos, std::set<std::string>& allNodeIds, std::set<std::string>& flowIds);
+
+	/**
+	 * Returns the key the flows cache is validated with: the MD5 of flows.json and of the maximum thread counts of all nodes.
+	 */
+	std::string getFlowsCacheKey(const std::string& rawFlows);
+
+	/**
+	 * Loads the result of parseFlows() from "flows.cache" in the Node-BLUE data directory.
+	 *
+	 * @return Returns false when the cache doesn't exist, is unreadable or was written for another key.
+	 */
+	bool loadFlowsCache(const std::string& cacheKey, std::unordered_map<std::string, PFlowInfoServer>& flowInfos, std::set<std::string>& allNodeIds, std::set<std::string>& flowIds);
+
+	/**
+	 * Writes the result of parseFlows() to "flows.cache". Everything is stored in a plain binary format, see encodeFlowsCacheVariable().
+	 */
+	void saveFlowsCache(const std::string& cacheKey, std::unordered_map<std::string, PFlowInfoServer>& flowInfos, std::set<std::string>& allNodeIds, std::set<std::string>& flowIds);
+
+	/**
+	 * Appends "variable" to "data" losslessly: the type followed by the value. Floats are stored as their raw IEEE 754 bits, unlike binary RPC which
+	 * rounds them.
+	 */
+	void encodeFlowsCacheVariable(BaseLib::BinaryEncoder& encoder, std::vector<char>& data, const BaseLib::PVariable& variable);
+
+	/**
+	 * Reads a value written by encodeFlowsCacheVariable(). Throws an exception when "data" is truncated or invalid.
+	 */
+	BaseLib::PVariable decodeFlowsCacheVariable(BaseLib::BinaryDecoder& decoder, const std::vector<char>& data, uint32_t& position, int32_t depth);
+
+	/**
+	 * Sets the load of each flow to the one measured during its last run.
+	 */
+	void setFlowLoads(std::unordered_map<std::string, PFlowInfoServer>& flowInfos);
+
 	void startFlows();
 
+	/**
+	 * Calls "startNodes", "configNodesStarted" and "startUpComplete" on the given clients. Clients only start flows that haven't been started yet.
+	 */
+	void startNodes(std::vector<PNodeBlueClientData>& clients);
+
+	void deleteObsoleteNodeData(std::set<std::string>& allNodeIds, std::set<std::string>& flowIds);
+
 	void stopNodes();
 
 	std::set<std::string> insertSubflows(BaseLib::PVariable& subflowNode, std::unordered_map<std::string, BaseLib::PVariable>& subflowInfos, std::unordered_map<std::string, BaseLib::PVariable>& flowNodes, std::unordered_map<std::string, BaseLib::PVariable>& subflowNodes, std::set<std::string>& flowNodeIds, std::set<std::string>& allNodeIds);
 
 	void startFlow(PFlowInfoServer& flowInfo, std::set<std::string>& nodes);
 
+	/**
+	 * Stops a single running flow in its client process and removes all references to it.
+	 */
+	void stopFlow(PFlowInfoServer& flowInfo);
+
 	void processQueueEntry(int32_t index, std::shared_ptr<BaseLib::IQueueEntry>& entry);
 
 	// {{{ RPC methods
+	/**
+	 * Creates a shared memory ring for all data sent to the client and passes it with the response.
+	 */
+	void openSharedMemoryRing(PNodeBlueClientData& clientData, BaseLib::PVariable& scriptId, BaseLib::PVariable& packetId);
+
 	BaseLib::PVariable registerFlowsClient(PNodeBlueClientData& clientData, BaseLib::PArray& parameters);
 
 	BaseLib::PVariable executePhpNode(PNodeBlueClientData& clientData, BaseLib::PArray& parameters);
@@ -224,6 +491,11 @@ private:
 	BaseLib::PVariable invokeNodeMethod(PNodeBlueClientData& clientData, BaseLib::PArray& parameters);
 
 	BaseLib::PVariable nodeEvent(PNodeBlueClientData& clientData, BaseLib::PArray& parameters);
+
+	/**
+	 * Batched version of nodeEvent(). Expects one array of events, each an array of node ID, topic and value.
+	 */
+	BaseLib::PVariable nodeEvents(PNodeBlueClientData& clientData, BaseLib::PArray& parameters);
 	// }}}
 };
 
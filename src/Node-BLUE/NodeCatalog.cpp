@@ -0,0 +1,363 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "NodeCatalog.h"
+#include "../GD/GD.h"
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace Homegear
+{
+
+namespace NodeBlue
+{
+
+NodeCatalog::NodeCatalog()
+{
+	_stopWatcher = false;
+}
+
+NodeCatalog::~NodeCatalog()
+{
+	_stopWatcher = true;
+	if(_watcherThread.joinable()) _watcherThread.join();
+	if(_inotifyDescriptor != -1) close(_inotifyDescriptor);
+}
+
+void NodeCatalog::start()
+{
+	try
+	{
+		std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+		if(_inotifyDescriptor != -1) return;
+		_inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if(_inotifyDescriptor == -1)
+		{
+			GD::out.printWarning("Warning: Could not initialize inotify. The node catalog is read from disk on every request: " + std::string(strerror(errno)));
+			return;
+		}
+		addWatches(GD::bl->settings.nodeBluePath() + "nodes/");
+		_generation++;
+		_nodeInfo.reset();
+		_bundles.clear();
+		_stopWatcher = false;
+		GD::bl->threadManager.start(_watcherThread, true, &NodeCatalog::watcherThread, this);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void NodeCatalog::stop()
+{
+	try
+	{
+		_stopWatcher = true;
+		GD::bl->threadManager.join(_watcherThread);
+
+		std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+		if(_inotifyDescriptor != -1)
+		{
+			close(_inotifyDescriptor);
+			_inotifyDescriptor = -1;
+		}
+		_watchDescriptors.clear();
+		_generation++;
+		_nodeInfo.reset();
+		_bundles.clear();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void NodeCatalog::invalidate()
+{
+	std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+	_generation++;
+	_nodeInfo.reset();
+	_bundles.clear();
+}
+
+std::vector<NodeManager::PNodeInfo> NodeCatalog::getNodeInfo()
+{
+	try
+	{
+		{
+			std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+			if(_nodeInfo) return *_nodeInfo;
+		}
+
+		std::lock_guard<std::mutex> buildGuard(_buildMutex);
+		return loadNodeInfo();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return std::vector<NodeManager::PNodeInfo>();
+}
+
+std::vector<NodeManager::PNodeInfo> NodeCatalog::loadNodeInfo()
+{
+	uint64_t generation = 0;
+	{
+		//Another thread might have scanned the directory while we were waiting for "_buildMutex".
+		std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+		if(_nodeInfo) return *_nodeInfo;
+		generation = _generation;
+	}
+
+	auto nodeInfo = std::make_shared<std::vector<NodeManager::PNodeInfo>>(NodeManager::getNodeInfo());
+
+	std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+	if(_inotifyDescriptor != -1 && generation == _generation) _nodeInfo = nodeInfo;
+	return *nodeInfo;
+}
+
+NodeCatalog::PBundle NodeCatalog::getNodeList()
+{
+	return getBundle("list", [&]()
+	{
+		std::vector<NodeManager::PNodeInfo> nodeInfo = loadNodeInfo();
+		BaseLib::PVariable frontendNodeList = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+		frontendNodeList->arrayValue->reserve(nodeInfo.size());
+		for(auto& infoEntry : nodeInfo)
+		{
+			BaseLib::PVariable nodeListEntry = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+			nodeListEntry->structValue->emplace("id", std::make_shared<BaseLib::Variable>(infoEntry->nodeId));
+			nodeListEntry->structValue->emplace("name", std::make_shared<BaseLib::Variable>(infoEntry->readableName));
+			nodeListEntry->structValue->emplace("types", std::make_shared<BaseLib::Variable>(BaseLib::PArray(new BaseLib::Array{std::make_shared<BaseLib::Variable>(infoEntry->nodeName)})));
+			nodeListEntry->structValue->emplace("enabled", std::make_shared<BaseLib::Variable>(true));
+			nodeListEntry->structValue->emplace("local", std::make_shared<BaseLib::Variable>(false));
+			nodeListEntry->structValue->emplace("module", std::make_shared<BaseLib::Variable>(infoEntry->nodeName));
+			nodeListEntry->structValue->emplace("version", std::make_shared<BaseLib::Variable>(infoEntry->version));
+			frontendNodeList->arrayValue->push_back(nodeListEntry);
+		}
+		BaseLib::Rpc::JsonEncoder jsonEncoder(GD::bl.get());
+		std::string content;
+		jsonEncoder.encode(frontendNodeList, content);
+		return content;
+	});
+}
+
+NodeCatalog::PBundle NodeCatalog::getNodeCode()
+{
+	return getBundle("code", [&]()
+	{
+		std::vector<NodeManager::PNodeInfo> nodeInfo = loadNodeInfo();
+		size_t size = 0;
+		for(auto& infoEntry : nodeInfo)
+		{
+			size += infoEntry->frontendCode.size();
+		}
+		std::string content;
+		content.reserve(size);
+		for(auto& infoEntry : nodeInfo)
+		{
+			content += infoEntry->frontendCode;
+		}
+		return content;
+	});
+}
+
+NodeCatalog::PBundle NodeCatalog::getNodeLocales(std::string language)
+{
+	return getBundle("locales/" + language, [&]()
+	{
+		return NodeManager::getNodeLocales(language);
+	});
+}
+
+NodeCatalog::PBundle NodeCatalog::getBundle(const std::string& key, std::function<std::string()> build)
+{
+	try
+	{
+		uint64_t generation = 0;
+		{
+			std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+			auto bundleIterator = _bundles.find(key);
+			if(bundleIterator != _bundles.end()) return bundleIterator->second;
+		}
+
+		std::lock_guard<std::mutex> buildGuard(_buildMutex);
+		{
+			std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+			auto bundleIterator = _bundles.find(key);
+			if(bundleIterator != _bundles.end()) return bundleIterator->second;
+			generation = _generation;
+		}
+
+		std::string content = build();
+		PBundle bundle = createBundle(content);
+
+		std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+		if(_inotifyDescriptor != -1 && generation == _generation && _bundles.size() < MAX_BUNDLES) _bundles.emplace(key, bundle);
+		return bundle;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return PBundle();
+}
+
+NodeCatalog::PBundle NodeCatalog::createBundle(std::string& content)
+{
+	PBundle bundle = std::make_shared<Bundle>();
+	bundle->content.swap(content);
+	if(!bundle->content.empty()) bundle->gzipContent = BaseLib::GZip::compress<std::string, std::string>(bundle->content, 9);
+
+	std::vector<char> data(bundle->content.begin(), bundle->content.end());
+	std::vector<char> md5;
+	BaseLib::Security::Hash::md5(data, md5);
+	std::string hash = BaseLib::HelperFunctions::getHexString(md5);
+	bundle->etag = "\"" + hash + "\"";
+	bundle->gzipEtag = "\"" + hash + "-gzip\"";
+	return bundle;
+}
+
+void NodeCatalog::addWatches(std::string directory)
+{
+	if(directory.back() != '/') directory.push_back('/');
+	int watchDescriptor = inotify_add_watch(_inotifyDescriptor, directory.c_str(), IN_ONLYDIR | IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF);
+	if(watchDescriptor == -1)
+	{
+		GD::out.printWarning("Warning: Could not watch directory \"" + directory + "\" for node changes: " + std::string(strerror(errno)));
+		return;
+	}
+	//inotify returns the existing descriptor for directories watched already, e. g. when reached through a symlink. Don't follow loops.
+	if(_watchDescriptors.find(watchDescriptor) != _watchDescriptors.end()) return;
+	_watchDescriptors.emplace(watchDescriptor, directory);
+
+	std::vector<std::string> subdirectories = GD::bl->io.getDirectories(directory);
+	for(auto& subdirectory : subdirectories)
+	{
+		addWatches(directory + subdirectory);
+	}
+}
+
+void NodeCatalog::watcherThread()
+{
+	alignas(struct inotify_event) char buffer[16384];
+	while(!_stopWatcher)
+	{
+		try
+		{
+			pollfd pollInfo{};
+			{
+				std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+				pollInfo.fd = _inotifyDescriptor;
+			}
+			if(pollInfo.fd == -1) return;
+			pollInfo.events = POLLIN;
+			if(poll(&pollInfo, 1, 1000) <= 0) continue;
+
+			ssize_t length = ::read(pollInfo.fd, buffer, sizeof(buffer));
+			if(length <= 0) continue;
+
+			//Node packages change rarely and usually as a whole, so every change invalidates everything.
+			std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+			for(char* position = buffer; position < buffer + length;)
+			{
+				const struct inotify_event* event = (const struct inotify_event*)position;
+				position += sizeof(struct inotify_event) + event->len;
+
+				if(event->mask & IN_IGNORED)
+				{
+					//The watch was removed (directory deleted or unmounted).
+					_watchDescriptors.erase(event->wd);
+					continue;
+				}
+
+				if(event->len > 0 && (event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)))
+				{
+					auto watchIterator = _watchDescriptors.find(event->wd);
+					if(watchIterator != _watchDescriptors.end()) addWatches(watchIterator->second + event->name);
+				}
+			}
+			_generation++;
+			_nodeInfo.reset();
+			_bundles.clear();
+		}
+		catch(const std::exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(BaseLib::Exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(...)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+		}
+	}
+}
+
+}
+
+}
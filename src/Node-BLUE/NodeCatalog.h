@@ -0,0 +1,160 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef NODECATALOG_H_
+#define NODECATALOG_H_
+
+#include "NodeManager.h"
+
+#include <homegear-base/BaseLib.h>
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace Homegear
+{
+
+namespace NodeBlue
+{
+
+/**
+ * Cache of the installed nodes and of the responses the editor requests on startup. Scanning the node directories and reading every ".hni" and
+ * locale file takes seconds on slow storage, so the results are kept until a file in the node directory changes (watched with inotify).
+ *
+ * Every response is stored as a bundle with its gzip-compressed form and an ETag, so serving it neither touches the file system nor compresses anything.
+ * Without inotify nothing is cached.
+ */
+class NodeCatalog
+{
+public:
+	struct Bundle
+	{
+		std::string content;
+		std::string gzipContent;
+
+		/**
+		 * Quoted MD5 of "content".
+		 */
+		std::string etag;
+
+		/**
+		 * ETag of "gzipContent". Same as "etag" with "-gzip" appended inside the quotes, so caches never mix up the two representations.
+		 */
+		std::string gzipEtag;
+	};
+	typedef std::shared_ptr<Bundle> PBundle;
+
+	/**
+	 * The maximum number of cached bundles. Limits the memory used by requests for arbitrary languages.
+	 */
+	static const size_t MAX_BUNDLES = 50;
+
+	NodeCatalog();
+	virtual ~NodeCatalog();
+
+	/**
+	 * Adds inotify watches for the node directory and starts the watcher thread.
+	 */
+	void start();
+
+	/**
+	 * Stops the watcher thread and clears the cache.
+	 */
+	void stop();
+
+	/**
+	 * Removes all cached entries.
+	 */
+	void invalidate();
+
+	/**
+	 * @return Returns the cached result of NodeManager::getNodeInfo().
+	 */
+	std::vector<NodeManager::PNodeInfo> getNodeInfo();
+
+	/**
+	 * @return Returns the JSON node list of all nodes as requested by the editor.
+	 */
+	PBundle getNodeList();
+
+	/**
+	 * @return Returns the frontend code of all nodes concatenated.
+	 */
+	PBundle getNodeCode();
+
+	/**
+	 * @return Returns the merged locales of all nodes for "language".
+	 */
+	PBundle getNodeLocales(std::string language);
+private:
+	/**
+	 * Serializes scanning the node directory, so concurrent editor requests don't scan it more than once.
+	 */
+	std::mutex _buildMutex;
+
+	std::mutex _cacheMutex;
+	std::shared_ptr<std::vector<NodeManager::PNodeInfo>> _nodeInfo;
+	std::unordered_map<std::string, PBundle> _bundles;
+
+	// {{{ inotify, all protected by _cacheMutex
+	int _inotifyDescriptor = -1;
+	std::unordered_map<int, std::string> _watchDescriptors;
+
+	/**
+	 * Incremented on every invalidation. Used to not insert entries built from files which changed while they were read.
+	 */
+	uint64_t _generation = 0;
+	// }}}
+
+	std::atomic_bool _stopWatcher;
+	std::thread _watcherThread;
+
+	/**
+	 * Returns the cached bundle with the given key or creates it with "build".
+	 */
+	PBundle getBundle(const std::string& key, std::function<std::string()> build);
+
+	/**
+	 * Returns the cached node info or scans the node directory. "_buildMutex" needs to be locked by the caller.
+	 */
+	std::vector<NodeManager::PNodeInfo> loadNodeInfo();
+	static PBundle createBundle(std::string& content);
+	void addWatches(std::string directory);
+	void watcherThread();
+};
+
+}
+
+}
+
+#endif
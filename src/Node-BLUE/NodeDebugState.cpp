@@ -0,0 +1,125 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "NodeDebugState.h"
+
+#include <cstring>
+
+namespace Homegear
+{
+
+namespace NodeBlue
+{
+
+void NodeDebugState::recordOutput(int32_t index, const Flows::PVariable& payload)
+{
+	if(index < 64) _outputMask.fetch_or(1ull << index);
+
+	{
+		std::lock_guard<std::mutex> previewGuard(_previewMutex);
+		_previewSize = 0;
+		if(payload)
+		{
+			switch(payload->type)
+			{
+				case Flows::VariableType::tString:
+				case Flows::VariableType::tBase64:
+				{
+					//17 characters plus "..."
+					size_t size = payload->stringValue.size() > 20 ? 17 : payload->stringValue.size();
+					std::memcpy(_preview, payload->stringValue.data(), size);
+					if(payload->stringValue.size() > 20)
+					{
+						std::memcpy(_preview + size, "...", 3);
+						size += 3;
+					}
+					_previewSize = (uint8_t)size;
+					break;
+				}
+				case Flows::VariableType::tBinary:
+				{
+					//8 bytes as hex plus "..."
+					static const char hexDigits[] = "0123456789ABCDEF";
+					size_t byteCount = payload->binaryValue.size() > 10 ? 8 : payload->binaryValue.size();
+					size_t size = 0;
+					for(size_t i = 0; i < byteCount; i++)
+					{
+						_preview[size++] = hexDigits[payload->binaryValue[i] >> 4];
+						_preview[size++] = hexDigits[payload->binaryValue[i] & 0x0F];
+					}
+					if(payload->binaryValue.size() > 10)
+					{
+						std::memcpy(_preview + size, "...", 3);
+						size += 3;
+					}
+					_previewSize = (uint8_t)size;
+					break;
+				}
+				case Flows::VariableType::tArray:
+					std::memcpy(_preview, "Array", 5);
+					_previewSize = 5;
+					break;
+				case Flows::VariableType::tStruct:
+					std::memcpy(_preview, "Struct", 6);
+					_previewSize = 6;
+					break;
+				default:
+				{
+					//Scalars are short, converting them is cheap.
+					std::string value = payload->toString();
+					_previewSize = (uint8_t)(value.size() > 20 ? 20 : value.size());
+					std::memcpy(_preview, value.data(), _previewSize);
+					break;
+				}
+			}
+		}
+	}
+
+	_lastOutputIndex = index;
+	_pending = true;
+}
+
+bool NodeDebugState::collect(uint64_t& outputMask, int32_t& lastOutputIndex, std::string& lastPayloadPreview)
+{
+	if(!_pending.exchange(false)) return false;
+	outputMask = _outputMask.exchange(0);
+	lastOutputIndex = _lastOutputIndex.exchange(-1);
+	if(lastOutputIndex != -1)
+	{
+		std::lock_guard<std::mutex> previewGuard(_previewMutex);
+		lastPayloadPreview.assign(_preview, _previewSize);
+	}
+	else lastPayloadPreview.clear();
+	return true;
+}
+
+}
+
+}
@@ -0,0 +1,92 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef NODEDEBUGSTATE_H_
+#define NODEDEBUGSTATE_H_
+
+#include <homegear-node/INode.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace Homegear
+{
+
+namespace NodeBlue
+{
+
+/**
+ * The debug output of one node collected for the frontend since the last flush: which outputs to highlight and a preview of the last output payload.
+ * Written by the threads processing the node's messages and collected by NodeBlueClient::flushDebugOutputs(). Only the preview needs a lock.
+ */
+class NodeDebugState
+{
+public:
+	NodeDebugState() = default;
+	virtual ~NodeDebugState() = default;
+
+	/**
+	 * Set while the node belongs to the flow opened in the frontend. Nothing is recorded otherwise.
+	 */
+	std::atomic_bool inEventFlow{false};
+
+	void recordInput() { _pending = true; }
+
+	/**
+	 * Records an output and stores a preview of "payload". The preview is created right away, because the payload is shared with the receiving nodes
+	 * and must not be read after the message has been passed on.
+	 */
+	void recordOutput(int32_t index, const Flows::PVariable& payload);
+
+	/**
+	 * Returns and resets the output recorded since the last call.
+	 *
+	 * @param[out] lastPayloadPreview At most 20 characters of the last output payload. Only set when "lastOutputIndex" is not -1.
+	 * @return Returns false when the node neither received nor sent a message since the last call.
+	 */
+	bool collect(uint64_t& outputMask, int32_t& lastOutputIndex, std::string& lastPayloadPreview);
+private:
+	std::atomic_bool _pending{false};
+	std::atomic<uint64_t> _outputMask{0};
+	std::atomic<int32_t> _lastOutputIndex{-1};
+
+	std::mutex _previewMutex;
+	uint8_t _previewSize = 0;
+	char _preview[20];
+};
+
+typedef std::shared_ptr<NodeDebugState> PNodeDebugState;
+
+}
+
+}
+
+#endif
@@ -0,0 +1,210 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "NodeInputHistory.h"
+#include "../GD/GD.h"
+
+#include <cstring>
+
+namespace Homegear
+{
+
+namespace NodeBlue
+{
+
+NodeInputHistory::NodeInputHistory(uint32_t size)
+{
+	if(size > MAX_SIZE) size = MAX_SIZE;
+	_entries.resize(size);
+}
+
+void NodeInputHistory::add(const Flows::PVariable& payload)
+{
+	try
+	{
+		if(_entries.empty() || !payload) return;
+
+		std::lock_guard<std::mutex> entriesGuard(_entriesMutex);
+		Entry& entry = _entries.at(_next);
+		entry.time = BaseLib::HelperFunctions::getTime();
+		entry.type = payload->type;
+		entry.previewSize = 0;
+		switch(payload->type)
+		{
+			case Flows::VariableType::tBoolean:
+				entry.booleanValue = payload->booleanValue;
+				break;
+			case Flows::VariableType::tInteger:
+				entry.integerValue = payload->integerValue;
+				break;
+			case Flows::VariableType::tInteger64:
+				entry.integerValue = payload->integerValue64;
+				break;
+			case Flows::VariableType::tFloat:
+				entry.floatValue = payload->floatValue;
+				break;
+			case Flows::VariableType::tString:
+			case Flows::VariableType::tBase64:
+			{
+				//20 characters plus "..."
+				size_t size = payload->stringValue.size() > 20 ? 20 : payload->stringValue.size();
+				std::memcpy(entry.preview, payload->stringValue.data(), size);
+				if(payload->stringValue.size() > 20)
+				{
+					std::memcpy(entry.preview + size, "...", 3);
+					size += 3;
+				}
+				entry.previewSize = (uint8_t)size;
+				break;
+			}
+			case Flows::VariableType::tBinary:
+			{
+				//10 bytes as hex plus "..."
+				static const char hexDigits[] = "0123456789ABCDEF";
+				size_t byteCount = payload->binaryValue.size() > 10 ? 10 : payload->binaryValue.size();
+				size_t size = 0;
+				for(size_t i = 0; i < byteCount; i++)
+				{
+					entry.preview[size++] = hexDigits[payload->binaryValue[i] >> 4];
+					entry.preview[size++] = hexDigits[payload->binaryValue[i] & 0x0F];
+				}
+				if(payload->binaryValue.size() > 10)
+				{
+					std::memcpy(entry.preview + size, "...", 3);
+					size += 3;
+				}
+				entry.previewSize = (uint8_t)size;
+				break;
+			}
+			default:
+				break;
+		}
+
+		_next = (_next + 1) % _entries.size();
+		if(_count < _entries.size()) _count++;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+Flows::PVariable NodeInputHistory::getValue(const Entry& entry)
+{
+	switch(entry.type)
+	{
+		case Flows::VariableType::tBoolean:
+			return std::make_shared<Flows::Variable>(entry.booleanValue);
+		case Flows::VariableType::tInteger:
+			return std::make_shared<Flows::Variable>((int32_t)entry.integerValue);
+		case Flows::VariableType::tInteger64:
+			return std::make_shared<Flows::Variable>(entry.integerValue);
+		case Flows::VariableType::tFloat:
+			return std::make_shared<Flows::Variable>(entry.floatValue);
+		case Flows::VariableType::tString:
+		case Flows::VariableType::tBase64:
+		case Flows::VariableType::tBinary:
+			return std::make_shared<Flows::Variable>(std::string(entry.preview, entry.previewSize));
+		case Flows::VariableType::tArray:
+			return std::make_shared<Flows::Variable>(std::string("Array"));
+		case Flows::VariableType::tStruct:
+			return std::make_shared<Flows::Variable>(std::string("Struct"));
+		default:
+			return std::make_shared<Flows::Variable>();
+	}
+}
+
+Flows::PVariable NodeInputHistory::getLast()
+{
+	try
+	{
+		std::lock_guard<std::mutex> entriesGuard(_entriesMutex);
+		if(_count == 0) return Flows::PVariable();
+		return getValue(_entries.at((_next + _entries.size() - 1) % _entries.size()));
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return Flows::PVariable();
+}
+
+Flows::PVariable NodeInputHistory::getHistory()
+{
+	try
+	{
+		Flows::PVariable array = std::make_shared<Flows::Variable>(Flows::VariableType::tArray);
+		std::lock_guard<std::mutex> entriesGuard(_entriesMutex);
+		array->arrayValue->reserve(_count);
+		for(uint32_t i = 1; i <= _count; i++)
+		{
+			const Entry& entry = _entries.at((_next + _entries.size() - i) % _entries.size());
+			Flows::PVariable innerArray = std::make_shared<Flows::Variable>(Flows::VariableType::tArray);
+			innerArray->arrayValue->reserve(2);
+			innerArray->arrayValue->push_back(std::make_shared<Flows::Variable>(entry.time));
+			innerArray->arrayValue->push_back(getValue(entry));
+			array->arrayValue->push_back(innerArray);
+		}
+		return array;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return Flows::Variable::createError(-32500, "Unknown application error.");
+}
+
+}
+
+}
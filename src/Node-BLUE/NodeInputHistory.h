@@ -0,0 +1,103 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef NODEINPUTHISTORY_H_
+#define NODEINPUTHISTORY_H_
+
+#include <homegear-node/INode.h>
+
+#include <mutex>
+#include <vector>
+
+namespace Homegear
+{
+
+namespace NodeBlue
+{
+
+/**
+ * Fixed-capacity ring of the last values received on one node input. Only the type and a short preview of each payload are stored, so adding a value
+ * neither allocates nor keeps the message alive.
+ */
+class NodeInputHistory
+{
+public:
+	static const uint32_t DEFAULT_SIZE = 10;
+	static const uint32_t MAX_SIZE = 1000;
+
+	/**
+	 * @param size The number of values to keep. Limited to MAX_SIZE.
+	 */
+	explicit NodeInputHistory(uint32_t size);
+	virtual ~NodeInputHistory() = default;
+
+	uint32_t capacity() { return _entries.size(); }
+
+	/**
+	 * Stores a preview of "payload", overwriting the oldest entry when the ring is full.
+	 */
+	void add(const Flows::PVariable& payload);
+
+	/**
+	 * @return Returns the preview of the last value or nullptr when no value was received yet.
+	 */
+	Flows::PVariable getLast();
+
+	/**
+	 * @return Returns an array of [time, preview] arrays, newest first.
+	 */
+	Flows::PVariable getHistory();
+private:
+	struct Entry
+	{
+		int64_t time = 0;
+		Flows::VariableType type = Flows::VariableType::tVoid;
+		bool booleanValue = false;
+		int64_t integerValue = 0;
+		double floatValue = 0;
+		uint8_t previewSize = 0;
+		char preview[24];
+	};
+
+	std::mutex _entriesMutex;
+	std::vector<Entry> _entries;
+	uint32_t _next = 0;
+	uint32_t _count = 0;
+
+	Flows::PVariable getValue(const Entry& entry);
+};
+
+typedef std::shared_ptr<NodeInputHistory> PNodeInputHistory;
+
+}
+
+}
+
+#endif
@@ -0,0 +1,402 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "NodeMailboxScheduler.h"
+#include "../GD/GD.h"
+
+namespace Homegear
+{
+
+namespace NodeBlue
+{
+
+thread_local NodeMailboxScheduler* NodeMailboxScheduler::_currentScheduler = nullptr;
+thread_local int32_t NodeMailboxScheduler::_currentWorkerIndex = -1;
+
+NodeMailboxScheduler::NodeMailboxScheduler(std::function<void(Message&)> processor)
+{
+	_processor.swap(processor);
+	_stopped = true;
+	_size = 0;
+	_backpressureCount = 0;
+	_nextWorker = 0;
+	_runnableCount = 0;
+}
+
+NodeMailboxScheduler::~NodeMailboxScheduler()
+{
+	stop();
+}
+
+void NodeMailboxScheduler::start(int32_t threadCount)
+{
+	try
+	{
+		if(!_stopped) return;
+		if(_workers.empty())
+		{
+			//"_workers" is read without a lock by producers, so it is only filled here, before "_stopped" is cleared, and never changed afterwards.
+			if(threadCount < 1) threadCount = 1;
+			_workers.reserve(threadCount);
+			for(int32_t i = 0; i < threadCount; i++)
+			{
+				_workers.emplace_back(new Worker());
+			}
+		}
+		_stopped = false;
+		for(int32_t i = 0; i < (signed)_workers.size(); i++)
+		{
+			GD::bl->threadManager.start(_workers.at(i)->thread, true, &NodeMailboxScheduler::workerThread, this, i);
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void NodeMailboxScheduler::stop()
+{
+	try
+	{
+		_stopped = true;
+		{
+			std::lock_guard<std::mutex> idleGuard(_idleMutex);
+		}
+		_idleConditionVariable.notify_all();
+		{
+			std::lock_guard<std::mutex> mailboxesGuard(_mailboxesMutex);
+			for(auto& mailbox : _mailboxes)
+			{
+				{
+					std::lock_guard<std::mutex> mailboxGuard(mailbox.second->mutex);
+				}
+				mailbox.second->spaceConditionVariable.notify_all();
+			}
+		}
+
+		for(auto& worker : _workers)
+		{
+			GD::bl->threadManager.join(worker->thread);
+			std::lock_guard<std::mutex> runQueueGuard(worker->runQueueMutex);
+			worker->runQueue.clear();
+		}
+
+		{
+			std::lock_guard<std::mutex> mailboxesGuard(_mailboxesMutex);
+			_mailboxes.clear();
+		}
+		_runnableCount = 0;
+		_size = 0;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+NodeMailboxScheduler::PMailbox NodeMailboxScheduler::getMailbox(const std::string& nodeId)
+{
+	std::lock_guard<std::mutex> mailboxesGuard(_mailboxesMutex);
+	PMailbox& mailbox = _mailboxes[nodeId];
+	if(!mailbox) mailbox = std::make_shared<Mailbox>();
+	return mailbox;
+}
+
+void NodeMailboxScheduler::removeMailbox(const std::string& nodeId)
+{
+	try
+	{
+		PMailbox mailbox;
+		{
+			std::lock_guard<std::mutex> mailboxesGuard(_mailboxesMutex);
+			auto mailboxIterator = _mailboxes.find(nodeId);
+			if(mailboxIterator == _mailboxes.end()) return;
+			mailbox = mailboxIterator->second;
+			_mailboxes.erase(mailboxIterator);
+		}
+
+		{
+			std::lock_guard<std::mutex> mailboxGuard(mailbox->mutex);
+			_size -= mailbox->messages.size();
+			mailbox->messages.clear();
+		}
+		mailbox->spaceConditionVariable.notify_all();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+bool NodeMailboxScheduler::post(Message& message)
+{
+	try
+	{
+		if(_stopped || !message.nodeInfo) return false;
+		PMailbox mailbox = getMailbox(message.nodeInfo->id);
+
+		bool schedule = false;
+		{
+			std::unique_lock<std::mutex> mailboxGuard(mailbox->mutex);
+			if(mailbox->messages.size() >= MAILBOX_SIZE && _currentScheduler != this)
+			{
+				_backpressureCount++;
+				mailbox->spaceConditionVariable.wait_for(mailboxGuard, std::chrono::milliseconds(BACKPRESSURE_TIMEOUT), [&] { return mailbox->messages.size() < MAILBOX_SIZE || _stopped; });
+				if(_stopped) return false;
+			}
+			mailbox->messages.push_back(std::move(message));
+			_size++;
+			if(!mailbox->scheduled)
+			{
+				mailbox->scheduled = true;
+				schedule = true;
+			}
+		}
+
+		if(schedule && !this->schedule(mailbox))
+		{
+			//stop() was called in the meantime. Discard the messages like stop() does, so the mailbox isn't stuck as scheduled after a restart.
+			std::lock_guard<std::mutex> mailboxGuard(mailbox->mutex);
+			_size -= mailbox->messages.size();
+			mailbox->messages.clear();
+			mailbox->scheduled = false;
+			return false;
+		}
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return false;
+}
+
+bool NodeMailboxScheduler::schedule(PMailbox& mailbox)
+{
+	if(_workers.empty()) return false;
+	//Output of a node running on a worker stays on that worker's run queue. Other threads distribute round robin.
+	uint32_t index = _currentScheduler == this ? (uint32_t)_currentWorkerIndex : _nextWorker++ % _workers.size();
+	{
+		//stop() clears the run queues under this lock after setting "_stopped" and resets "_runnableCount" afterwards, so nothing is left behind.
+		std::lock_guard<std::mutex> runQueueGuard(_workers.at(index)->runQueueMutex);
+		if(_stopped) return false;
+		_workers.at(index)->runQueue.push_back(mailbox);
+		std::lock_guard<std::mutex> idleGuard(_idleMutex);
+		_runnableCount++;
+	}
+	_idleConditionVariable.notify_one();
+	return true;
+}
+
+NodeMailboxScheduler::PMailbox NodeMailboxScheduler::nextMailbox(int32_t workerIndex)
+{
+	PMailbox mailbox;
+	{
+		Worker& worker = *_workers.at(workerIndex);
+		std::lock_guard<std::mutex> runQueueGuard(worker.runQueueMutex);
+		if(!worker.runQueue.empty())
+		{
+			mailbox = std::move(worker.runQueue.front());
+			worker.runQueue.pop_front();
+		}
+	}
+
+	if(!mailbox)
+	{
+		//Steal from the back of the other workers' run queues.
+		for(uint32_t i = 1; i < _workers.size() && !mailbox; i++)
+		{
+			Worker& victim = *_workers.at((workerIndex + i) % _workers.size());
+			std::lock_guard<std::mutex> runQueueGuard(victim.runQueueMutex);
+			if(!victim.runQueue.empty())
+			{
+				mailbox = std::move(victim.runQueue.back());
+				victim.runQueue.pop_back();
+			}
+		}
+	}
+
+	if(mailbox) _runnableCount--;
+	return mailbox;
+}
+
+void NodeMailboxScheduler::processMailbox(int32_t workerIndex, PMailbox& mailbox)
+{
+	for(int32_t i = 0; i < BATCH_SIZE && !_stopped; i++)
+	{
+		Message message;
+		{
+			std::lock_guard<std::mutex> mailboxGuard(mailbox->mutex);
+			if(mailbox->messages.empty())
+			{
+				mailbox->scheduled = false;
+				return;
+			}
+			message = std::move(mailbox->messages.front());
+			mailbox->messages.pop_front();
+			_size--;
+		}
+		mailbox->spaceConditionVariable.notify_one();
+
+		try
+		{
+			_processor(message);
+		}
+		catch(const std::exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(BaseLib::Exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(...)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> mailboxGuard(mailbox->mutex);
+		if(mailbox->messages.empty() || _stopped)
+		{
+			mailbox->scheduled = false;
+			return;
+		}
+	}
+	//Batch is used up. Queue the mailbox again behind the other runnable mailboxes. It stays marked as scheduled.
+	if(!schedule(mailbox))
+	{
+		std::lock_guard<std::mutex> mailboxGuard(mailbox->mutex);
+		mailbox->scheduled = false;
+	}
+}
+
+void NodeMailboxScheduler::workerThread(int32_t index)
+{
+	_currentScheduler = this;
+	_currentWorkerIndex = index;
+	while(!_stopped)
+	{
+		try
+		{
+			PMailbox mailbox = nextMailbox(index);
+			if(!mailbox)
+			{
+				std::unique_lock<std::mutex> idleGuard(_idleMutex);
+				_idleConditionVariable.wait_for(idleGuard, std::chrono::milliseconds(1000), [&] { return _runnableCount > 0 || _stopped; });
+				continue;
+			}
+			processMailbox(index, mailbox);
+		}
+		catch(const std::exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(BaseLib::Exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(...)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+		}
+	}
+	_currentScheduler = nullptr;
+	_currentWorkerIndex = -1;
+}
+
+Flows::PVariable NodeMailboxScheduler::getMailboxDepths()
+{
+	Flows::PVariable depths = std::make_shared<Flows::Variable>(Flows::VariableType::tStruct);
+	try
+	{
+		std::lock_guard<std::mutex> mailboxesGuard(_mailboxesMutex);
+		for(auto& mailbox : _mailboxes)
+		{
+			size_t depth = 0;
+			{
+				std::lock_guard<std::mutex> mailboxGuard(mailbox.second->mutex);
+				depth = mailbox.second->messages.size();
+			}
+			if(depth > 0) depths->structValue->emplace(mailbox.first, std::make_shared<Flows::Variable>((int32_t)depth));
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return depths;
+}
+
+}
+
+}
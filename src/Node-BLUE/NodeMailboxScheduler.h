@@ -0,0 +1,207 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef NODEMAILBOXSCHEDULER_H_
+#define NODEMAILBOXSCHEDULER_H_
+
+#include "FlowInfoClient.h"
+#include "NodeDebugState.h"
+#include "NodeInputHistory.h"
+#include "NodeStatistics.h"
+
+#include <homegear-base/BaseLib.h>
+#include <homegear-node/INode.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Homegear
+{
+
+namespace NodeBlue
+{
+
+/**
+ * Delivers asynchronous node output. Every node has its own mailbox, so messages to one node are processed in order and never concurrently, while
+ * messages to different nodes are processed in parallel.
+ *
+ * A mailbox with messages is put into the run queue of one worker thread. Idle workers steal mailboxes from the run queues of other workers, so a slow
+ * node only occupies the thread processing its own mailbox. Producers writing into a full mailbox are slowed down instead of the message being dropped.
+ */
+class NodeMailboxScheduler
+{
+public:
+	struct Message
+	{
+		Flows::PNodeInfo nodeInfo;
+		Flows::PINode node;
+		PNodeInputHistory inputHistory;
+		PFlowInfoClient flow;
+		PNodeStatistics statistics;
+		PNodeDebugState debugState;
+		std::chrono::steady_clock::time_point queueTime;
+		uint32_t targetPort = 0;
+		Flows::PVariable message;
+	};
+
+	/**
+	 * The number of messages a mailbox holds before producers have to wait.
+	 */
+	static const size_t MAILBOX_SIZE = 1000;
+
+	/**
+	 * The maximum time in milliseconds a producer waits for space in a full mailbox. The message is queued anyway afterwards, so cycles in flows can't
+	 * deadlock.
+	 */
+	static const int32_t BACKPRESSURE_TIMEOUT = 1000;
+
+	/**
+	 * The number of messages a worker processes from one mailbox before it moves on to the next one, so a busy node doesn't starve the others.
+	 */
+	static const int32_t BATCH_SIZE = 20;
+
+	/**
+	 * @param processor Called on a worker thread for every message.
+	 */
+	explicit NodeMailboxScheduler(std::function<void(Message&)> processor);
+
+	virtual ~NodeMailboxScheduler();
+
+	/**
+	 * Starts the worker threads. The workers are created on the first call and kept for the lifetime of the scheduler, so "threadCount" is ignored when
+	 * restarting.
+	 */
+	void start(int32_t threadCount);
+
+	/**
+	 * Stops all worker threads and discards all queued messages. The workers are kept, so producers never see "_workers" change.
+	 */
+	void stop();
+
+	/**
+	 * Puts a message into the mailbox of the node in "message.nodeInfo". Waits while the mailbox is full (see BACKPRESSURE_TIMEOUT). Worker threads never
+	 * wait, as they might be the ones that need to empty the mailbox.
+	 *
+	 * @return Returns false when the scheduler is stopped.
+	 */
+	bool post(Message& message);
+
+	/**
+	 * Removes the mailbox of a node. Messages still queued are discarded.
+	 */
+	void removeMailbox(const std::string& nodeId);
+
+	/**
+	 * Returns the total number of queued messages.
+	 */
+	int64_t size() { return _size; }
+
+	/**
+	 * Returns the number of times a producer had to wait for space in a mailbox.
+	 */
+	uint64_t backpressureCount() { return _backpressureCount; }
+
+	/**
+	 * Returns a struct with the node IDs as keys and the number of queued messages as values. Empty mailboxes are omitted.
+	 */
+	Flows::PVariable getMailboxDepths();
+private:
+	struct Mailbox
+	{
+		std::mutex mutex;
+		std::condition_variable spaceConditionVariable;
+		std::deque<Message> messages;
+
+		/**
+		 * True while the mailbox is in a run queue or being processed.
+		 */
+		bool scheduled = false;
+	};
+	typedef std::shared_ptr<Mailbox> PMailbox;
+
+	struct Worker
+	{
+		std::mutex runQueueMutex;
+		std::deque<PMailbox> runQueue;
+		std::thread thread;
+	};
+
+	/**
+	 * The scheduler the current thread is a worker of.
+	 */
+	static thread_local NodeMailboxScheduler* _currentScheduler;
+
+	/**
+	 * The index of the current thread in "_workers" if it is a worker thread.
+	 */
+	static thread_local int32_t _currentWorkerIndex;
+
+	std::function<void(Message&)> _processor;
+	std::atomic_bool _stopped;
+	std::atomic<int64_t> _size;
+	std::atomic<uint64_t> _backpressureCount;
+	std::atomic_uint _nextWorker;
+	std::vector<std::unique_ptr<Worker>> _workers;
+
+	std::atomic_int _runnableCount;
+	std::mutex _idleMutex;
+	std::condition_variable _idleConditionVariable;
+
+	std::mutex _mailboxesMutex;
+	std::unordered_map<std::string, PMailbox> _mailboxes;
+
+	PMailbox getMailbox(const std::string& nodeId);
+
+	/**
+	 * Puts a mailbox into a run queue.
+	 *
+	 * @return Returns false when the scheduler is stopped. The mailbox is not queued then.
+	 */
+	bool schedule(PMailbox& mailbox);
+
+	PMailbox nextMailbox(int32_t workerIndex);
+	void processMailbox(int32_t workerIndex, PMailbox& mailbox);
+	void workerThread(int32_t index);
+};
+
+}
+
+}
+
+#endif
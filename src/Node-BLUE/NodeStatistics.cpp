@@ -0,0 +1,134 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "NodeStatistics.h"
+#include "../GD/GD.h"
+
+namespace Homegear
+{
+
+namespace NodeBlue
+{
+
+NodeStatistics::NodeStatistics()
+{
+	for(auto& bucket : _processingTimes)
+	{
+		bucket = 0;
+	}
+}
+
+uint32_t NodeStatistics::getBucket(uint64_t value)
+{
+	//Values below 4 get their own bucket. Above, the two bits after the most significant one select one of four buckets per power of two.
+	if(value < 4) return (uint32_t)value;
+	uint32_t mostSignificantBit = 63 - __builtin_clzll(value);
+	uint32_t bucket = ((mostSignificantBit - 1) * 4) + ((value >> (mostSignificantBit - 2)) & 3);
+	return bucket < BUCKET_COUNT ? bucket : BUCKET_COUNT - 1;
+}
+
+uint64_t NodeStatistics::getBucketMaximum(uint32_t bucket)
+{
+	if(bucket < 4) return bucket;
+	uint32_t mostSignificantBit = (bucket / 4) + 1;
+	return ((5ull + (bucket % 4)) << (mostSignificantBit - 2)) - 1;
+}
+
+void NodeStatistics::addInput(uint64_t processingTime)
+{
+	_inputs++;
+	_processingTimeSum += processingTime;
+	_processingTimes[getBucket(processingTime)]++;
+}
+
+void NodeStatistics::addMailboxWait(uint64_t waitTime)
+{
+	_mailboxWaits++;
+	_mailboxWaitTimeSum += waitTime;
+}
+
+Flows::PVariable NodeStatistics::get()
+{
+	try
+	{
+		Flows::PVariable statistics = std::make_shared<Flows::Variable>(Flows::VariableType::tStruct);
+		uint64_t inputs = _inputs;
+		uint64_t mailboxWaits = _mailboxWaits;
+		statistics->structValue->emplace("inputs", std::make_shared<Flows::Variable>((int64_t)inputs));
+		statistics->structValue->emplace("outputs", std::make_shared<Flows::Variable>((int64_t)_outputs));
+		statistics->structValue->emplace("errors", std::make_shared<Flows::Variable>((int64_t)_errors));
+		statistics->structValue->emplace("meanProcessingTime", std::make_shared<Flows::Variable>(inputs > 0 ? (double)_processingTimeSum / inputs : 0.0));
+		statistics->structValue->emplace("meanMailboxWaitTime", std::make_shared<Flows::Variable>(mailboxWaits > 0 ? (double)_mailboxWaitTimeSum / mailboxWaits : 0.0));
+
+		//The buckets are read while other threads add values, so the sum might differ slightly from "inputs".
+		std::array<uint64_t, BUCKET_COUNT> processingTimes;
+		uint64_t count = 0;
+		for(uint32_t i = 0; i < BUCKET_COUNT; i++)
+		{
+			processingTimes[i] = _processingTimes[i];
+			count += processingTimes[i];
+		}
+		uint64_t p99 = 0;
+		if(count > 0)
+		{
+			uint64_t p99Count = count - (count / 100);
+			uint64_t currentCount = 0;
+			for(uint32_t i = 0; i < BUCKET_COUNT; i++)
+			{
+				currentCount += processingTimes[i];
+				if(currentCount >= p99Count)
+				{
+					p99 = getBucketMaximum(i);
+					break;
+				}
+			}
+		}
+		statistics->structValue->emplace("p99ProcessingTime", std::make_shared<Flows::Variable>((int64_t)p99));
+
+		return statistics;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return Flows::Variable::createError(-32500, "Unknown application error.");
+}
+
+}
+
+}
@@ -0,0 +1,106 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef NODESTATISTICS_H_
+#define NODESTATISTICS_H_
+
+#include <homegear-node/INode.h>
+
+#include <array>
+#include <atomic>
+
+namespace Homegear
+{
+
+namespace NodeBlue
+{
+
+/**
+ * Runtime counters of one node instance. All methods are lock free, so they can be called for every message.
+ *
+ * Processing times are collected in a histogram with four buckets per power of two, so percentiles are accurate to about 25 % without storing
+ * individual values.
+ */
+class NodeStatistics
+{
+public:
+	/**
+	 * The number of histogram buckets. The last bucket holds all values above about 70 minutes.
+	 */
+	static const uint32_t BUCKET_COUNT = 128;
+
+	NodeStatistics();
+	virtual ~NodeStatistics() = default;
+
+	/**
+	 * Counts one message passed to the node's input().
+	 *
+	 * @param processingTime The time input() took in microseconds.
+	 */
+	void addInput(uint64_t processingTime);
+
+	/**
+	 * Counts the time one message waited in the node's mailbox in microseconds.
+	 */
+	void addMailboxWait(uint64_t waitTime);
+
+	void addOutput() { _outputs++; }
+
+	void addError() { _errors++; }
+
+	/**
+	 * @return Returns a struct with the elements "inputs", "outputs", "errors", "meanProcessingTime", "p99ProcessingTime" and "meanMailboxWaitTime".
+	 * All times are in microseconds.
+	 */
+	Flows::PVariable get();
+private:
+	std::atomic<uint64_t> _inputs{0};
+	std::atomic<uint64_t> _outputs{0};
+	std::atomic<uint64_t> _errors{0};
+	std::atomic<uint64_t> _processingTimeSum{0};
+	std::atomic<uint64_t> _mailboxWaits{0};
+	std::atomic<uint64_t> _mailboxWaitTimeSum{0};
+	std::array<std::atomic<uint64_t>, BUCKET_COUNT> _processingTimes;
+
+	static uint32_t getBucket(uint64_t value);
+
+	/**
+	 * @return Returns the largest value stored in "bucket".
+	 */
+	static uint64_t getBucketMaximum(uint32_t bucket);
+};
+
+typedef std::shared_ptr<NodeStatistics> PNodeStatistics;
+
+}
+
+}
+
+#endif
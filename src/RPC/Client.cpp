@@ -320,6 +320,7 @@ void Client::broadcastEvent(std::string& source, uint64_t id, int32_t channel, s
                         }
                         else if(!peer || !server->second->getServerClientInfo()->acls->checkVariableReadAccess(peer, channel, valueKeys->at(i))) continue;
                     }
+                    if(!server->second->eventFilterMatches(id, channel, valueKeys->at(i), peer)) continue;
 
                     std::shared_ptr<std::list<BaseLib::PVariable>> parameters = std::make_shared<std::list<BaseLib::PVariable>>();
                     parameters->push_back(std::make_shared<BaseLib::Variable>(source));
@@ -331,7 +332,7 @@ void Client::broadcastEvent(std::string& source, uint64_t id, int32_t channel, s
                     else parameters->push_back(std::make_shared<BaseLib::Variable>(deviceAddress));
                     parameters->push_back(std::make_shared<BaseLib::Variable>(valueKeys->at(i)));
                     parameters->push_back(values->at(i));
-                    server->second->queueMethod(std::make_shared<std::pair<std::string, std::shared_ptr<BaseLib::List>>>("event", parameters));
+                    server->second->queueEvent(id, channel, valueKeys->at(i), std::make_shared<std::pair<std::string, std::shared_ptr<BaseLib::List>>>("event", parameters));
                 }
             }
             else
@@ -353,6 +354,7 @@ void Client::broadcastEvent(std::string& source, uint64_t id, int32_t channel, s
                         }
                         else if(!peer || !server->second->getServerClientInfo()->acls->checkVariableReadAccess(peer, channel, valueKeys->at(i))) continue;
                     }
+                    if(!server->second->eventFilterMatches(id, channel, valueKeys->at(i), peer)) continue;
 
                     method.reset(new BaseLib::Variable(BaseLib::VariableType::tStruct));
                     array->arrayValue->push_back(method);
@@ -374,6 +376,7 @@ void Client::broadcastEvent(std::string& source, uint64_t id, int32_t channel, s
                     params->arrayValue->push_back(std::make_shared<BaseLib::Variable>(valueKeys->at(i)));
                     params->arrayValue->push_back(values->at(i));
                 }
+                if(array->arrayValue->empty() && server->second->hasEventFilters()) continue;
                 parameters->push_back(array);
                 //Sadly some clients only support multicall and not "event" directly for single events. That's why we use multicall even when there is only one value.
                 server->second->queueMethod(std::make_shared<std::pair<std::string, std::shared_ptr<BaseLib::List>>>("system.multicall", parameters));
@@ -1188,7 +1191,7 @@ std::shared_ptr<RemoteRpcServer> Client::addSingleConnectionServer(std::pair<std
     return std::make_shared<RemoteRpcServer>(_client, clientInfo);
 }
 
-std::shared_ptr<RemoteRpcServer> Client::addWebSocketServer(std::shared_ptr<BaseLib::TcpSocket> socket, std::string clientId, BaseLib::PRpcClientInfo clientInfo, std::string address, bool nodeEvents)
+std::shared_ptr<RemoteRpcServer> Client::addWebSocketServer(std::shared_ptr<BaseLib::TcpSocket> socket, std::string clientId, BaseLib::PRpcClientInfo clientInfo, std::string address, bool nodeEvents, bool compression, int32_t compressionWindowBits)
 {
     try
     {
@@ -1208,6 +1211,8 @@ std::shared_ptr<RemoteRpcServer> Client::addWebSocketServer(std::shared_ptr<Base
         server->hostname = address;
         server->uid = _serverId++;
         server->webSocket = true;
+        server->webSocketCompression = compression;
+        server->webSocketWindowBits = compressionWindowBits;
         server->autoConnect = false;
         server->initialized = true;
         if(!clientInfo->sendEventsToRpcServer)
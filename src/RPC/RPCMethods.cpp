@@ -41,6 +41,40 @@ namespace Homegear
 namespace Rpc
 {
 
+/**
+ * Returns the event server registered with "serverId" ("host:port" as passed to init). On error "error" is set and nullptr is returned.
+ */
+static std::shared_ptr<RemoteRpcServer> getEventServer(const std::string& serverId, BaseLib::PVariable& error)
+{
+	if(serverId.empty())
+	{
+		error = BaseLib::Variable::createError(-32602, "Server id is empty.");
+		return std::shared_ptr<RemoteRpcServer>();
+	}
+	std::pair<std::string, std::string> server = BaseLib::HelperFunctions::splitLast(serverId, ':');
+	BaseLib::HelperFunctions::toLower(server.first);
+
+	int32_t pos = server.second.find_first_of('/');
+	if(pos > 0)
+	{
+		server.second = server.second.substr(0, pos);
+		GD::out.printDebug("Debug: Server port set to: " + server.second);
+	}
+	if(!server.second.empty()) //Port number specified
+	{
+		server.second = std::to_string(BaseLib::Math::getNumber(server.second));
+		if(server.second.empty() || server.second == "0")
+		{
+			error = BaseLib::Variable::createError(-32602, "Port number is invalid.");
+			return std::shared_ptr<RemoteRpcServer>();
+		}
+	}
+
+	std::shared_ptr<RemoteRpcServer> eventServer = GD::rpcClient->getServer(server);
+	if(!eventServer) error = BaseLib::Variable::createError(-1, "Event server is unknown.");
+	return eventServer;
+}
+
 BaseLib::PVariable RPCDevTest::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
 {
 	try
@@ -430,6 +464,16 @@ BaseLib::PVariable RPCActivateLinkParamset::invoke(BaseLib::PRpcClientInfo clien
 	return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
+/**
+ * Marks the value snapshots of FamilyController::getAllValues() as outdated after a method changed the name, rooms or categories of a peer and
+ * passes the method's result through.
+ */
+static BaseLib::PVariable metadataChanged(const BaseLib::PVariable& result)
+{
+	GD::familyController->invalidateValuesSnapshot();
+	return result;
+}
+
 BaseLib::PVariable RPCAddCategoryToChannel::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
 {
 	try
@@ -456,7 +500,7 @@ BaseLib::PVariable RPCAddCategoryToChannel::invoke(BaseLib::PRpcClientInfo clien
 					if(!peer || !clientInfo->acls->checkDeviceWriteAccess(peer)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
 				}
 
-				return central->addCategoryToChannel(clientInfo, parameters->at(0)->integerValue64, parameters->at(1)->integerValue, parameters->at(2)->integerValue64);
+				return metadataChanged(central->addCategoryToChannel(clientInfo, parameters->at(0)->integerValue64, parameters->at(1)->integerValue, parameters->at(2)->integerValue64));
 			}
 		}
 
@@ -503,7 +547,7 @@ BaseLib::PVariable RPCAddCategoryToDevice::invoke(BaseLib::PRpcClientInfo client
 					if(!peer || !clientInfo->acls->checkDeviceWriteAccess(peer)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
 				}
 
-				return central->addCategoryToChannel(clientInfo, (uint64_t) parameters->at(0)->integerValue64, -1, (uint64_t) parameters->at(1)->integerValue64);
+				return metadataChanged(central->addCategoryToChannel(clientInfo, (uint64_t) parameters->at(0)->integerValue64, -1, (uint64_t) parameters->at(1)->integerValue64));
 			}
 		}
 
@@ -590,7 +634,7 @@ BaseLib::PVariable RPCAddCategoryToVariable::invoke(BaseLib::PRpcClientInfo clie
 			}
 
 			bool result = peer->addCategoryToVariable(parameters->at(1)->integerValue, parameters->at(2)->stringValue, parameters->at(3)->integerValue64);
-			return std::make_shared<BaseLib::Variable>(result);
+			return metadataChanged(std::make_shared<BaseLib::Variable>(result));
 		}
 
 		return BaseLib::Variable::createError(-2, "Device not found.");
@@ -636,7 +680,7 @@ BaseLib::PVariable RPCAddChannelToRoom::invoke(BaseLib::PRpcClientInfo clientInf
 					if(!peer || !clientInfo->acls->checkDeviceWriteAccess(peer)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
 				}
 
-				return central->addChannelToRoom(clientInfo, (uint64_t) parameters->at(0)->integerValue64, parameters->at(1)->integerValue, (uint64_t) parameters->at(2)->integerValue64);
+				return metadataChanged(central->addChannelToRoom(clientInfo, (uint64_t) parameters->at(0)->integerValue64, parameters->at(1)->integerValue, (uint64_t) parameters->at(2)->integerValue64));
 			}
 		}
 
@@ -742,7 +786,7 @@ BaseLib::PVariable RPCAddDeviceToRoom::invoke(BaseLib::PRpcClientInfo clientInfo
 					if(!peer || !clientInfo->acls->checkDeviceWriteAccess(peer)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
 				}
 
-				return central->addChannelToRoom(clientInfo, (uint64_t) parameters->at(0)->integerValue64, -1, (uint64_t) parameters->at(1)->integerValue64);
+				return metadataChanged(central->addChannelToRoom(clientInfo, (uint64_t) parameters->at(0)->integerValue64, -1, (uint64_t) parameters->at(1)->integerValue64));
 			}
 		}
 
@@ -1017,7 +1061,7 @@ BaseLib::PVariable RPCAddVariableToRoom::invoke(BaseLib::PRpcClientInfo clientIn
 			}
 
 			bool result = peer->setVariableRoom(parameters->at(1)->integerValue, parameters->at(2)->stringValue, (uint64_t) parameters->at(3)->integerValue64);
-			return std::make_shared<BaseLib::Variable>(result);
+			return metadataChanged(std::make_shared<BaseLib::Variable>(result));
 		}
 
 		return BaseLib::Variable::createError(-2, "Device not found.");
@@ -1364,7 +1408,7 @@ BaseLib::PVariable RPCDeleteCategory::invoke(BaseLib::PRpcClientInfo clientInfo,
 
 		GD::bl->db->removeCategoryFromSystemVariables(categoryId);
 
-		return result;
+		return metadataChanged(result);
 	}
 	catch(const std::exception& ex)
 	{
@@ -1608,7 +1652,7 @@ BaseLib::PVariable RPCDeleteRoom::invoke(BaseLib::PRpcClientInfo clientInfo, Bas
 		GD::bl->db->removeRoomFromSystemVariables(roomId);
 		GD::bl->db->removeRoomFromStories(roomId);
 
-		return result;
+		return metadataChanged(result);
 	}
 	catch(const std::exception& ex)
 	{
@@ -2066,6 +2110,9 @@ BaseLib::PVariable RPCGetAllValues::invoke(BaseLib::PRpcClientInfo clientInfo, B
 			isArray = true;
 		}
 
+		//Query all families in parallel and serve unfiltered requests from the shared snapshot.
+		if(peerId == 0 && !isArray) return GD::familyController->getAllValues(clientInfo, returnWriteOnly, checkAcls);
+
 		BaseLib::PVariable values(new BaseLib::Variable(BaseLib::VariableType::tArray));
 		std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
 		for(std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>>::iterator i = families.begin(); i != families.end(); ++i)
@@ -3354,6 +3401,29 @@ BaseLib::PVariable RPCGetNodesWithFixedInputs::invoke(BaseLib::PRpcClientInfo cl
 	return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
+BaseLib::PVariable RPCGetNodeStatistics::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
+{
+	try
+	{
+		if(!clientInfo || !clientInfo->acls->checkMethodAccess("getNodeStatistics")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+
+		if(GD::nodeBlueServer) return GD::nodeBlueServer->getNodeStatistics();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 BaseLib::PVariable RPCGetNodeVariable::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
 {
 	try
@@ -3910,6 +3980,37 @@ BaseLib::PVariable RPCGetRoomUiElements::invoke(BaseLib::PRpcClientInfo clientIn
 	return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
+BaseLib::PVariable RPCGetRpcMetrics::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
+{
+	try
+	{
+		if(!clientInfo || !clientInfo->acls->checkMethodAccess("getRpcMetrics")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+
+		ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
+																														 std::vector<BaseLib::VariableType>(),
+																														 std::vector<BaseLib::VariableType>({BaseLib::VariableType::tBoolean})
+																												 }));
+		if(error != ParameterError::Enum::noError) return getError(error);
+
+		BaseLib::PVariable metrics = GD::rpcMetrics.get();
+		if(!parameters->empty() && parameters->at(0)->booleanValue) GD::rpcMetrics.reset();
+		return metrics;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 BaseLib::PVariable RPCGetServiceMessages::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
 {
 	try
@@ -4238,6 +4339,37 @@ BaseLib::PVariable RPCGetVariablesInRoom::invoke(BaseLib::PRpcClientInfo clientI
 	return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
+BaseLib::PVariable RPCGetTlsMetrics::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
+{
+	try
+	{
+		if(!clientInfo || !clientInfo->acls->checkMethodAccess("getTlsMetrics")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+		if(!parameters->empty()) return getError(ParameterError::Enum::wrongCount);
+
+		BaseLib::PVariable metrics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+		for(auto& server : GD::rpcServers)
+		{
+			if(!server.second->getInfo()->ssl) continue;
+			BaseLib::PVariable serverMetrics = server.second->getTlsMetrics();
+			if(!serverMetrics->errorStruct) metrics->arrayValue->push_back(serverMetrics);
+		}
+		return metrics;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 BaseLib::PVariable RPCGetUpdateStatus::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
 {
 	try
@@ -5394,7 +5526,7 @@ BaseLib::PVariable RPCRemoveCategoryFromChannel::invoke(BaseLib::PRpcClientInfo
 					if(!peer || !clientInfo->acls->checkDeviceWriteAccess(peer)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
 				}
 
-				return central->removeCategoryFromChannel(clientInfo, (uint64_t) parameters->at(0)->integerValue64, parameters->at(1)->integerValue, (uint64_t) parameters->at(2)->integerValue64);
+				return metadataChanged(central->removeCategoryFromChannel(clientInfo, (uint64_t) parameters->at(0)->integerValue64, parameters->at(1)->integerValue, (uint64_t) parameters->at(2)->integerValue64));
 			}
 		}
 
@@ -5441,7 +5573,7 @@ BaseLib::PVariable RPCRemoveCategoryFromDevice::invoke(BaseLib::PRpcClientInfo c
 					if(!peer || !clientInfo->acls->checkDeviceWriteAccess(peer)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
 				}
 
-				return central->removeCategoryFromChannel(clientInfo, parameters->at(0)->integerValue64, -1, parameters->at(1)->integerValue64);
+				return metadataChanged(central->removeCategoryFromChannel(clientInfo, parameters->at(0)->integerValue64, -1, parameters->at(1)->integerValue64));
 			}
 		}
 
@@ -5528,7 +5660,7 @@ BaseLib::PVariable RPCRemoveCategoryFromVariable::invoke(BaseLib::PRpcClientInfo
 			}
 
 			bool result = peer->removeCategoryFromVariable(parameters->at(1)->integerValue, parameters->at(2)->stringValue, (uint64_t) parameters->at(3)->integerValue64);
-			return std::make_shared<BaseLib::Variable>(result);
+			return metadataChanged(std::make_shared<BaseLib::Variable>(result));
 		}
 
 		return BaseLib::Variable::createError(-2, "Device not found.");
@@ -5574,7 +5706,7 @@ BaseLib::PVariable RPCRemoveChannelFromRoom::invoke(BaseLib::PRpcClientInfo clie
 					if(!peer || !clientInfo->acls->checkDeviceWriteAccess(peer)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
 				}
 
-				return central->removeChannelFromRoom(clientInfo, (uint64_t) parameters->at(0)->integerValue64, parameters->at(1)->integerValue, (uint64_t) parameters->at(2)->integerValue64);
+				return metadataChanged(central->removeChannelFromRoom(clientInfo, (uint64_t) parameters->at(0)->integerValue64, parameters->at(1)->integerValue, (uint64_t) parameters->at(2)->integerValue64));
 			}
 		}
 
@@ -5621,7 +5753,7 @@ BaseLib::PVariable RPCRemoveDeviceFromRoom::invoke(BaseLib::PRpcClientInfo clien
 					if(!peer || !clientInfo->acls->checkDeviceWriteAccess(peer)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
 				}
 
-				return central->removeChannelFromRoom(clientInfo, (uint64_t) parameters->at(0)->integerValue64, -1, (uint64_t) parameters->at(1)->integerValue64);
+				return metadataChanged(central->removeChannelFromRoom(clientInfo, (uint64_t) parameters->at(0)->integerValue64, -1, (uint64_t) parameters->at(1)->integerValue64));
 			}
 		}
 
@@ -5884,7 +6016,7 @@ BaseLib::PVariable RPCRemoveVariableFromRoom::invoke(BaseLib::PRpcClientInfo cli
 			{
 				result = peer->setVariableRoom(parameters->at(1)->integerValue, parameters->at(2)->stringValue, 0);
 			}
-			return std::make_shared<BaseLib::Variable>(result);
+			return metadataChanged(std::make_shared<BaseLib::Variable>(result));
 		}
 
 		return BaseLib::Variable::createError(-2, "Device not found.");
@@ -6696,7 +6828,7 @@ BaseLib::PVariable RPCSetMetadata::invoke(BaseLib::PRpcClientInfo clientInfo, Ba
 			BaseLib::Ansi ansi(false, true);
 			parameters->at(2)->stringValue = ansi.toAnsi(parameters->at(2)->stringValue); // I know, this absolutely makes no sense, but this is correct!
 			peer->setName(-1, parameters->at(2)->stringValue);
-			return BaseLib::PVariable(new BaseLib::Variable(BaseLib::VariableType::tVoid));
+			return metadataChanged(BaseLib::PVariable(new BaseLib::Variable(BaseLib::VariableType::tVoid)));
 		}
 		serialNumber = peer->getSerialNumber();
 		return GD::bl->db->setMetadata(clientInfo, peer->getID(), serialNumber, parameters->at(1)->stringValue, value);
@@ -6744,7 +6876,7 @@ BaseLib::PVariable RPCSetName::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLi
 					if(!peer || !clientInfo->acls->checkDeviceWriteAccess(peer)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
 				}
 
-				return central->setName(clientInfo, (uint64_t) parameters->at(0)->integerValue64, channel, name);
+				return metadataChanged(central->setName(clientInfo, (uint64_t) parameters->at(0)->integerValue64, channel, name));
 			}
 		}
 
@@ -6793,6 +6925,42 @@ BaseLib::PVariable RPCSetNodeData::invoke(BaseLib::PRpcClientInfo clientInfo, Ba
 	return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
+BaseLib::PVariable RPCSetEventRateLimit::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
+{
+	try
+	{
+		if(!clientInfo || !clientInfo->acls->checkMethodAccess("setEventRateLimit")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+
+		ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
+																														 std::vector<BaseLib::VariableType>({BaseLib::VariableType::tString, BaseLib::VariableType::tInteger}),
+																														 std::vector<BaseLib::VariableType>({BaseLib::VariableType::tString, BaseLib::VariableType::tInteger, BaseLib::VariableType::tBoolean})
+																												 }));
+		if(error != ParameterError::Enum::noError) return getError(error);
+		if(parameters->at(1)->integerValue < 0) return BaseLib::Variable::createError(-32602, "Maximum number of events per second is invalid.");
+
+		BaseLib::PVariable serverError;
+		std::shared_ptr<RemoteRpcServer> eventServer = getEventServer(parameters->at(0)->stringValue, serverError);
+		if(!eventServer) return serverError;
+
+		eventServer->setEventRateLimit(parameters->at(1)->integerValue, parameters->size() > 2 ? parameters->at(2)->booleanValue : false);
+
+		return std::make_shared<BaseLib::Variable>();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 BaseLib::PVariable RPCSetFlowData::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
 {
 	try
@@ -7256,6 +7424,86 @@ BaseLib::PVariable RPCStopSniffing::invoke(BaseLib::PRpcClientInfo clientInfo, B
 	return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
+BaseLib::PVariable RPCSubscribeEvents::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
+{
+	try
+	{
+		if(!clientInfo || !clientInfo->acls->checkMethodAccess("subscribeEvents")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+
+		ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
+																														 std::vector<BaseLib::VariableType>({BaseLib::VariableType::tString, BaseLib::VariableType::tStruct})
+																												 }));
+		if(error != ParameterError::Enum::noError) return getError(error);
+
+		BaseLib::PVariable serverError;
+		std::shared_ptr<RemoteRpcServer> eventServer = getEventServer(parameters->at(0)->stringValue, serverError);
+		if(!eventServer) return serverError;
+
+		RemoteRpcServer::EventFilter filter;
+		auto filterIterator = parameters->at(1)->structValue->find("peers");
+		if(filterIterator != parameters->at(1)->structValue->end())
+		{
+			for(auto& element : *filterIterator->second->arrayValue)
+			{
+				filter.peers.insert((uint64_t) element->integerValue64);
+			}
+		}
+
+		filterIterator = parameters->at(1)->structValue->find("channels");
+		if(filterIterator != parameters->at(1)->structValue->end())
+		{
+			for(auto& element : *filterIterator->second->arrayValue)
+			{
+				filter.channels.insert(element->integerValue);
+			}
+		}
+
+		filterIterator = parameters->at(1)->structValue->find("variables");
+		if(filterIterator != parameters->at(1)->structValue->end())
+		{
+			for(auto& element : *filterIterator->second->arrayValue)
+			{
+				if(!element->stringValue.empty()) filter.variables.push_back(element->stringValue);
+			}
+		}
+
+		filterIterator = parameters->at(1)->structValue->find("rooms");
+		if(filterIterator != parameters->at(1)->structValue->end())
+		{
+			for(auto& element : *filterIterator->second->arrayValue)
+			{
+				filter.rooms.insert((uint64_t) element->integerValue64);
+			}
+		}
+
+		filterIterator = parameters->at(1)->structValue->find("categories");
+		if(filterIterator != parameters->at(1)->structValue->end())
+		{
+			for(auto& element : *filterIterator->second->arrayValue)
+			{
+				filter.categories.insert((uint64_t) element->integerValue64);
+			}
+		}
+
+		if(filter.peers.empty() && filter.channels.empty() && filter.variables.empty() && filter.rooms.empty() && filter.categories.empty()) return BaseLib::Variable::createError(-32602, "Filter is empty.");
+
+		return std::make_shared<BaseLib::Variable>(eventServer->addEventFilter(filter));
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 BaseLib::PVariable RPCSubscribePeers::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
 {
 	try
@@ -7370,6 +7618,38 @@ BaseLib::PVariable RPCTriggerRpcEvent::invoke(BaseLib::PRpcClientInfo clientInfo
 	return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
+BaseLib::PVariable RPCUnsubscribeEvents::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
+{
+	try
+	{
+		if(!clientInfo || !clientInfo->acls->checkMethodAccess("unsubscribeEvents")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+
+		ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
+																														 std::vector<BaseLib::VariableType>({BaseLib::VariableType::tString, BaseLib::VariableType::tInteger})
+																												 }));
+		if(error != ParameterError::Enum::noError) return getError(error);
+
+		BaseLib::PVariable serverError;
+		std::shared_ptr<RemoteRpcServer> eventServer = getEventServer(parameters->at(0)->stringValue, serverError);
+		if(!eventServer) return serverError;
+
+		return std::make_shared<BaseLib::Variable>(eventServer->removeEventFilter(parameters->at(1)->integerValue));
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 BaseLib::PVariable RPCUnsubscribePeers::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters)
 {
 	try
@@ -889,6 +889,17 @@ public:
 	BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
 };
 
+class RPCGetNodeStatistics : public BaseLib::Rpc::RpcMethod
+{
+public:
+	RPCGetNodeStatistics()
+	{
+		addSignature(BaseLib::VariableType::tStruct, std::vector<BaseLib::VariableType>());
+	}
+
+	BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
+};
+
 class RPCGetNodeVariable : public BaseLib::Rpc::RpcMethod
 {
 public:
@@ -1009,6 +1020,18 @@ public:
 	BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
 };
 
+class RPCGetRpcMetrics : public BaseLib::Rpc::RpcMethod
+{
+public:
+	RPCGetRpcMetrics()
+	{
+		addSignature(BaseLib::VariableType::tArray, std::vector<BaseLib::VariableType>());
+		addSignature(BaseLib::VariableType::tArray, std::vector<BaseLib::VariableType>{BaseLib::VariableType::tBoolean});
+	}
+
+	BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
+};
+
 class RPCGetServiceMessages : public BaseLib::Rpc::RpcMethod
 {
 public:
@@ -1088,6 +1111,17 @@ public:
 	BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
 };
 
+class RPCGetTlsMetrics : public BaseLib::Rpc::RpcMethod
+{
+public:
+	RPCGetTlsMetrics()
+	{
+		addSignature(BaseLib::VariableType::tArray, std::vector<BaseLib::VariableType>());
+	}
+
+	BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
+};
+
 class RPCGetUpdateStatus : public BaseLib::Rpc::RpcMethod
 {
 public:
@@ -1604,6 +1638,18 @@ public:
 	BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
 };
 
+class RPCSetEventRateLimit : public BaseLib::Rpc::RpcMethod
+{
+public:
+	RPCSetEventRateLimit()
+	{
+		addSignature(BaseLib::VariableType::tVoid, std::vector<BaseLib::VariableType>{BaseLib::VariableType::tString, BaseLib::VariableType::tInteger});
+		addSignature(BaseLib::VariableType::tVoid, std::vector<BaseLib::VariableType>{BaseLib::VariableType::tString, BaseLib::VariableType::tInteger, BaseLib::VariableType::tBoolean});
+	}
+
+	BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
+};
+
 class RPCSetId : public BaseLib::Rpc::RpcMethod
 {
 public:
@@ -1793,6 +1839,17 @@ public:
 	BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
 };
 
+class RPCSubscribeEvents : public BaseLib::Rpc::RpcMethod
+{
+public:
+	RPCSubscribeEvents()
+	{
+		addSignature(BaseLib::VariableType::tInteger, std::vector<BaseLib::VariableType>{BaseLib::VariableType::tString, BaseLib::VariableType::tStruct});
+	}
+
+	BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
+};
+
 class RPCSubscribePeers : public BaseLib::Rpc::RpcMethod
 {
 public:
@@ -1826,6 +1883,17 @@ public:
 	BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
 };
 
+class RPCUnsubscribeEvents : public BaseLib::Rpc::RpcMethod
+{
+public:
+	RPCUnsubscribeEvents()
+	{
+		addSignature(BaseLib::VariableType::tBoolean, std::vector<BaseLib::VariableType>{BaseLib::VariableType::tString, BaseLib::VariableType::tInteger});
+	}
+
+	BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters);
+};
+
 class RPCUnsubscribePeers : public BaseLib::Rpc::RpcMethod
 {
 public:
@@ -30,6 +30,8 @@
 
 #include "RemoteRpcServer.h"
 #include "../GD/GD.h"
+#include "WebSocketCompression.h"
+#include "../IPC/Wildcard.h"
 
 namespace Homegear
 {
@@ -67,6 +69,9 @@ RemoteRpcServer::RemoteRpcServer(BaseLib::PRpcClientInfo& serverClientInfo)
 
 	_droppedEntries = 0;
 	_lastQueueFullError = 0;
+	_hasEventFilters = false;
+	_coalescedEventsAvailable = false;
+	_droppedEvents = 0;
 }
 
 RemoteRpcServer::RemoteRpcServer(std::shared_ptr<RpcClient>& client, BaseLib::PRpcClientInfo& serverClientInfo)
@@ -157,7 +162,16 @@ void RemoteRpcServer::processMethods()
 	{
 		try
 		{
-			_methodProcessingConditionVariable.wait(lock, [&] { return _methodProcessingMessageAvailable || _stopMethodProcessingThread; });
+			if(_coalescedEventsAvailable)
+			{
+				//Wake up regularly to send coalesced events as soon as the rate limit allows it.
+				_methodProcessingConditionVariable.wait_for(lock, std::chrono::milliseconds(100), [&] { return _methodProcessingMessageAvailable || _stopMethodProcessingThread; });
+				if(_stopMethodProcessingThread) return;
+				lock.unlock();
+				flushCoalescedEvents();
+				lock.lock();
+			}
+			else _methodProcessingConditionVariable.wait(lock, [&] { return _methodProcessingMessageAvailable || _coalescedEventsAvailable || _stopMethodProcessingThread; });
 			if(_stopMethodProcessingThread) return;
 
 			while(_methodBufferHead != _methodBufferTail)
@@ -198,6 +212,219 @@ void RemoteRpcServer::processMethods()
 	}
 }
 
+// {{{ Event filters
+int32_t RemoteRpcServer::addEventFilter(EventFilter& filter)
+{
+	std::lock_guard<std::mutex> eventFiltersGuard(_eventFiltersMutex);
+	int32_t filterId = _currentEventFilterId++;
+	_eventFilters.emplace(filterId, filter);
+	_hasEventFilters = true;
+	return filterId;
+}
+
+bool RemoteRpcServer::removeEventFilter(int32_t filterId)
+{
+	std::lock_guard<std::mutex> eventFiltersGuard(_eventFiltersMutex);
+	bool removed = false;
+	if(filterId == -1)
+	{
+		removed = !_eventFilters.empty();
+		_eventFilters.clear();
+	}
+	else removed = _eventFilters.erase(filterId) > 0;
+	_hasEventFilters = !_eventFilters.empty();
+	return removed;
+}
+
+bool RemoteRpcServer::eventFilterMatches(uint64_t peerId, int32_t channel, const std::string& variable, std::shared_ptr<BaseLib::Systems::Peer>& peer)
+{
+	try
+	{
+		if(!_hasEventFilters) return true;
+		std::lock_guard<std::mutex> eventFiltersGuard(_eventFiltersMutex);
+		if(_eventFilters.empty()) return true;
+		for(auto& filter : _eventFilters)
+		{
+			if(!filter.second.peers.empty() && filter.second.peers.find(peerId) == filter.second.peers.end()) continue;
+			if(!filter.second.channels.empty() && filter.second.channels.find(channel) == filter.second.channels.end()) continue;
+			if(!filter.second.variables.empty())
+			{
+				bool variableMatches = false;
+				for(auto& pattern : filter.second.variables)
+				{
+					if(Wildcard::match(pattern, variable))
+					{
+						variableMatches = true;
+						break;
+					}
+				}
+				if(!variableMatches) continue;
+			}
+
+			if(!filter.second.rooms.empty() || !filter.second.categories.empty())
+			{
+				if(!peer && peerId != 0)
+				{
+					std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
+					for(auto& family : families)
+					{
+						std::shared_ptr<BaseLib::Systems::ICentral> central = family.second->getCentral();
+						if(central) peer = central->getPeer(peerId);
+						if(peer) break;
+					}
+				}
+				if(!peer) continue;
+
+				if(!filter.second.rooms.empty())
+				{
+					uint64_t roomId = peer->getVariableRoom(channel, variable);
+					if(roomId == 0) roomId = peer->getRoom(channel);
+					if(filter.second.rooms.find(roomId) == filter.second.rooms.end()) continue;
+				}
+
+				if(!filter.second.categories.empty())
+				{
+					bool categoryMatches = false;
+					for(auto categoryId : filter.second.categories)
+					{
+						if(peer->variableHasCategory(channel, variable, categoryId) || peer->hasCategory(channel, categoryId))
+						{
+							categoryMatches = true;
+							break;
+						}
+					}
+					if(!categoryMatches) continue;
+				}
+			}
+
+			return true;
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return false;
+}
+
+void RemoteRpcServer::setEventRateLimit(uint32_t maxEventsPerSecond, bool coalesce)
+{
+	std::lock_guard<std::mutex> eventRateLimitGuard(_eventRateLimitMutex);
+	_maxEventsPerSecond = maxEventsPerSecond;
+	_coalesceEvents = coalesce;
+	_eventTokens = maxEventsPerSecond;
+	_lastEventTokenRefill = BaseLib::HelperFunctions::getTime();
+	if(_maxEventsPerSecond == 0 || !_coalesceEvents)
+	{
+		_coalescedEvents.clear();
+		_coalescedEventsAvailable = false;
+	}
+}
+
+bool RemoteRpcServer::takeEventToken()
+{
+	if(_maxEventsPerSecond == 0) return true;
+	int64_t time = BaseLib::HelperFunctions::getTime();
+	if(time > _lastEventTokenRefill)
+	{
+		_eventTokens += (double)(time - _lastEventTokenRefill) * _maxEventsPerSecond / 1000.0;
+		if(_eventTokens > _maxEventsPerSecond) _eventTokens = _maxEventsPerSecond;
+		_lastEventTokenRefill = time;
+	}
+	if(_eventTokens < 1.0) return false;
+	_eventTokens -= 1.0;
+	return true;
+}
+
+void RemoteRpcServer::queueEvent(uint64_t peerId, int32_t channel, const std::string& variable, std::shared_ptr<std::pair<std::string, std::shared_ptr<std::list<BaseLib::PVariable>>>> method)
+{
+	try
+	{
+		{
+			std::lock_guard<std::mutex> eventRateLimitGuard(_eventRateLimitMutex);
+			if(!takeEventToken())
+			{
+				if(!_coalesceEvents)
+				{
+					_droppedEvents++;
+					return;
+				}
+				//Only the latest value of a variable is kept.
+				_coalescedEvents[std::to_string(peerId) + '.' + std::to_string(channel) + '.' + variable] = method;
+				method.reset();
+			}
+		}
+		if(method)
+		{
+			queueMethod(method);
+			return;
+		}
+		if(!_coalescedEventsAvailable)
+		{
+			{
+				std::lock_guard<std::mutex> methodProcessingGuard(_methodProcessingThreadMutex);
+				_coalescedEventsAvailable = true;
+			}
+			_methodProcessingConditionVariable.notify_one();
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void RemoteRpcServer::flushCoalescedEvents()
+{
+	try
+	{
+		std::vector<std::shared_ptr<std::pair<std::string, std::shared_ptr<std::list<BaseLib::PVariable>>>>> methods;
+		{
+			std::lock_guard<std::mutex> eventRateLimitGuard(_eventRateLimitMutex);
+			methods.reserve(_coalescedEvents.size());
+			while(!_coalescedEvents.empty() && takeEventToken())
+			{
+				methods.push_back(_coalescedEvents.begin()->second);
+				_coalescedEvents.erase(_coalescedEvents.begin());
+			}
+			_coalescedEventsAvailable = !_coalescedEvents.empty();
+		}
+		for(auto& method : methods)
+		{
+			queueMethod(method);
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+// }}}
+
 BaseLib::PVariable RemoteRpcServer::invoke(std::string& methodName, std::shared_ptr<std::list<BaseLib::PVariable>>& parameters)
 {
 	if(_serverClientInfo->sendEventsToRpcServer) return invokeClientMethod(methodName, parameters);
@@ -244,7 +471,8 @@ BaseLib::PVariable RemoteRpcServer::invokeClientMethod(std::string& methodName,
 		{
 			std::vector<char> json;
 			_jsonEncoder->encodeRequest(methodName, parameters, json);
-			BaseLib::WebSocket::encode(json, BaseLib::WebSocket::Header::Opcode::text, encodedPacket);
+			if(webSocketCompression) WebSocketCompression::encode(json, BaseLib::WebSocket::Header::Opcode::text, encodedPacket, webSocketWindowBits);
+			else BaseLib::WebSocket::encode(json, BaseLib::WebSocket::Header::Opcode::text, encodedPacket);
 		}
 		else
 		{
@@ -82,6 +82,23 @@ public:
 	std::mutex sendMutex;
 	int32_t lastPacketSent = -1;
 	std::set<uint64_t> subscribedPeers;
+	bool webSocketCompression = false;
+	int32_t webSocketWindowBits = 15;
+
+	// {{{ Event filters
+	/**
+	 * Restricts the events sent to this server. All criteria which are not empty need to match. Variable names can contain the
+	 * wildcard "*".
+	 */
+	struct EventFilter
+	{
+		std::set<uint64_t> peers;
+		std::set<int32_t> channels;
+		std::vector<std::string> variables;
+		std::set<uint64_t> rooms;
+		std::set<uint64_t> categories;
+	};
+	// }}}
 
 	BaseLib::PRpcClientInfo& getServerClientInfo() { return _serverClientInfo; }
 
@@ -106,6 +123,47 @@ public:
      */
 	BaseLib::PVariable invoke(std::string& methodName, std::shared_ptr<std::list<BaseLib::PVariable>>& parameters);
 
+	// {{{ Event filters
+	/**
+	 * Adds an event filter. As soon as one filter is set, only events matching at least one of the filters are sent.
+	 *
+	 * @return Returns the ID of the new filter.
+	 */
+	int32_t addEventFilter(EventFilter& filter);
+
+	/**
+	 * Removes an event filter.
+	 *
+	 * @param filterId The ID returned by addEventFilter() or -1 to remove all filters.
+	 * @return Returns true when the filter was removed.
+	 */
+	bool removeEventFilter(int32_t filterId);
+
+	bool hasEventFilters() { return _hasEventFilters; }
+
+	/**
+	 * Checks if an event passes the event filters.
+	 *
+	 * @param peer The peer the event belongs to. Only needed for room and category filters. When the peer is empty and a room or category filter is set, it is looked up.
+	 */
+	bool eventFilterMatches(uint64_t peerId, int32_t channel, const std::string& variable, std::shared_ptr<BaseLib::Systems::Peer>& peer);
+
+	/**
+	 * Limits the number of events sent per second.
+	 *
+	 * @param maxEventsPerSecond The maximum number of events per second. 0 disables the limit.
+	 * @param coalesce When true, events exceeding the limit are not dropped. Instead only the latest value of each variable is kept and sent as soon as possible.
+	 */
+	void setEventRateLimit(uint32_t maxEventsPerSecond, bool coalesce);
+
+	/**
+	 * Queues an event method ("event" with one variable) taking the event rate limit into account.
+	 */
+	void queueEvent(uint64_t peerId, int32_t channel, const std::string& variable, std::shared_ptr<std::pair<std::string, std::shared_ptr<std::list<BaseLib::PVariable>>>> method);
+
+	uint64_t droppedEvents() { return _droppedEvents; }
+	// }}}
+
 private:
 	std::shared_ptr<RpcClient> _client;
 	BaseLib::PRpcClientInfo _serverClientInfo;
@@ -128,6 +186,32 @@ private:
 	std::atomic<int64_t> _lastQueueFullError;
 	//}}}
 
+	// {{{ Event filters
+	std::mutex _eventFiltersMutex;
+	std::atomic_bool _hasEventFilters;
+	int32_t _currentEventFilterId = 0;
+	std::map<int32_t, EventFilter> _eventFilters;
+
+	std::mutex _eventRateLimitMutex;
+	uint32_t _maxEventsPerSecond = 0;
+	bool _coalesceEvents = false;
+	double _eventTokens = 0;
+	int64_t _lastEventTokenRefill = 0;
+	std::atomic<uint64_t> _droppedEvents;
+	std::atomic_bool _coalescedEventsAvailable;
+	std::map<std::string, std::shared_ptr<std::pair<std::string, std::shared_ptr<std::list<BaseLib::PVariable>>>>> _coalescedEvents;
+
+	/**
+	 * Returns true when an event may be sent now. Needs to be called with _eventRateLimitMutex locked.
+	 */
+	bool takeEventToken();
+
+	/**
+	 * Queues coalesced events as far as the event rate limit allows it.
+	 */
+	void flushCoalescedEvents();
+	// }}}
+
 	void processMethods();
 
 	BaseLib::PVariable invokeClientMethod(std::string& methodName, std::shared_ptr<std::list<BaseLib::PVariable>>& parameters);
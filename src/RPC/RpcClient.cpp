@@ -144,10 +144,12 @@ void RpcClient::invokeBroadcast(RemoteRpcServer* server, std::string methodName,
 		{
 			std::vector<char> json;
 			_jsonEncoder->encodeRequest(methodName, parameters, json);
-			BaseLib::WebSocket::encode(json, BaseLib::WebSocket::Header::Opcode::text, requestData);
+			if(server->webSocketCompression) WebSocketCompression::encode(json, BaseLib::WebSocket::Header::Opcode::text, requestData, server->webSocketWindowBits);
+			else BaseLib::WebSocket::encode(json, BaseLib::WebSocket::Header::Opcode::text, requestData);
 		}
 		else if(server->json) _jsonEncoder->encodeRequest(methodName, parameters, requestData);
 		else _xmlRpcEncoder->encodeRequest(methodName, parameters, requestData);
+		int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
 		for(uint32_t i = 0; i < retries; ++i)
 		{
 			retry = false;
@@ -168,10 +170,12 @@ void RpcClient::invokeBroadcast(RemoteRpcServer* server, std::string methodName,
 						  << std::endl;
 			}
 			server->removed = true;
+			GD::rpcMetrics.record(RpcMetrics::Direction::outgoing, getMetricsTransport(server), methodName, BaseLib::HelperFunctions::getTimeMicroseconds() - startTime, true);
 			return;
 		}
 		if(responseData.empty())
 		{
+			GD::rpcMetrics.record(RpcMetrics::Direction::outgoing, getMetricsTransport(server), methodName, BaseLib::HelperFunctions::getTimeMicroseconds() - startTime, true);
 			if(server->webSocket)
 			{
 				server->removed = true;
@@ -192,6 +196,7 @@ void RpcClient::invokeBroadcast(RemoteRpcServer* server, std::string methodName,
 		if(server->binary) returnValue = _rpcDecoder->decodeResponse(responseData);
 		else if(server->webSocket || server->json) returnValue = _jsonDecoder->decode(responseData);
 		else returnValue = _xmlRpcDecoder->decodeResponse(responseData);
+		GD::rpcMetrics.record(RpcMetrics::Direction::outgoing, getMetricsTransport(server), methodName, BaseLib::HelperFunctions::getTimeMicroseconds() - startTime, returnValue->errorStruct);
 
 		if(returnValue->errorStruct)
 		{
@@ -235,6 +240,14 @@ void RpcClient::invokeBroadcast(RemoteRpcServer* server, std::string methodName,
 	}
 }
 
+RpcMetrics::Transport RpcClient::getMetricsTransport(RemoteRpcServer* server)
+{
+	if(server->binary) return RpcMetrics::Transport::binary;
+	else if(server->webSocket) return RpcMetrics::Transport::webSocket;
+	else if(server->json) return RpcMetrics::Transport::json;
+	return RpcMetrics::Transport::xml;
+}
+
 BaseLib::PVariable RpcClient::invoke(RemoteRpcServer* server, std::string methodName, std::shared_ptr<std::list<BaseLib::PVariable>> parameters)
 {
 	try
@@ -264,10 +277,12 @@ BaseLib::PVariable RpcClient::invoke(RemoteRpcServer* server, std::string method
 		{
 			std::vector<char> json;
 			_jsonEncoder->encodeRequest(methodName, parameters, json);
-			BaseLib::WebSocket::encode(json, BaseLib::WebSocket::Header::Opcode::text, requestData);
+			if(server->webSocketCompression) WebSocketCompression::encode(json, BaseLib::WebSocket::Header::Opcode::text, requestData, server->webSocketWindowBits);
+			else BaseLib::WebSocket::encode(json, BaseLib::WebSocket::Header::Opcode::text, requestData);
 		}
 		else if(server->json) _jsonEncoder->encodeRequest(methodName, parameters, requestData);
 		else _xmlRpcEncoder->encodeRequest(methodName, parameters, requestData);
+		int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
 		for(uint32_t i = 0; i < retries; ++i)
 		{
 			retry = false;
@@ -288,10 +303,12 @@ BaseLib::PVariable RpcClient::invoke(RemoteRpcServer* server, std::string method
 						  << std::endl;
 			}
 			server->removed = true;
+			GD::rpcMetrics.record(RpcMetrics::Direction::outgoing, getMetricsTransport(server), methodName, BaseLib::HelperFunctions::getTimeMicroseconds() - startTime, true);
 			return BaseLib::Variable::createError(-32300, "Request timed out.");
 		}
 		if(responseData.empty())
 		{
+			GD::rpcMetrics.record(RpcMetrics::Direction::outgoing, getMetricsTransport(server), methodName, BaseLib::HelperFunctions::getTimeMicroseconds() - startTime, true);
 			if(server->webSocket)
 			{
 				server->removed = true;
@@ -304,6 +321,7 @@ BaseLib::PVariable RpcClient::invoke(RemoteRpcServer* server, std::string method
 		if(server->binary) returnValue = _rpcDecoder->decodeResponse(responseData);
 		else if(server->webSocket || server->json) returnValue = _jsonDecoder->decode(responseData);
 		else returnValue = _xmlRpcDecoder->decodeResponse(responseData);
+		GD::rpcMetrics.record(RpcMetrics::Direction::outgoing, getMetricsTransport(server), methodName, BaseLib::HelperFunctions::getTimeMicroseconds() - startTime, returnValue->errorStruct);
 		if(returnValue->errorStruct)
 		{
 			std::cout << BaseLib::Output::getTimeString() << " " << "Error in RPC response from " << server->hostname
@@ -567,6 +585,7 @@ void RpcClient::sendRequest(RemoteRpcServer* server, std::vector<char>& data, st
 		BaseLib::Rpc::BinaryRpc binaryRpc(GD::bl.get());
 		BaseLib::Http http;
 		BaseLib::WebSocket webSocket;
+		bool webSocketCompressed = false;
 
 		while(!binaryRpc.isFinished() && !http.isFinished() && !webSocket.isFinished()) //This is equal to while(true) for binary packets
 		{
@@ -639,6 +658,7 @@ void RpcClient::sendRequest(RemoteRpcServer* server, std::vector<char>& data, st
 			{
 				try
 				{
+					if(!webSocket.dataProcessingStarted()) webSocketCompressed = server->webSocketCompression && WebSocketCompression::isCompressed(buffer);
 					webSocket.process(buffer, receivedBytes); //Check for chunked packets (HomeMatic Manager, ioBroker). Necessary, because HTTP header does not contain transfer-encoding.
 				}
 				catch(BaseLib::WebSocketException& ex)
@@ -733,6 +753,11 @@ void RpcClient::sendRequest(RemoteRpcServer* server, std::vector<char>& data, st
 			}
 		}
 		if(!server->keepAlive) server->socket->close();
+		if(webSocketCompressed && webSocket.isFinished() && !WebSocketCompression::decompress(webSocket.getContent()))
+		{
+			_out.printError("Error: Could not decompress WebSocket packet from server " + server->hostname + ".");
+			webSocket.getContent().clear();
+		}
 		if(GD::bl->debugLevel >= 5)
 		{
 			if(server->binary) _out.printDebug("Debug: Received packet from server " + server->hostname + ": " + GD::bl->hf.getHexString(binaryRpc.getData()));
@@ -35,6 +35,8 @@
 #include <homegear-base/BaseLib.h>
 #include "Auth.h"
 #include "RemoteRpcServer.h"
+#include "WebSocketCompression.h"
+#include "RpcMetrics.h"
 
 #include <iostream>
 #include <string>
@@ -85,6 +87,8 @@ protected:
 
 	std::pair<std::string, std::string> basicAuth(std::string& userName, std::string& password);
 
+	static RpcMetrics::Transport getMetricsTransport(RemoteRpcServer* server);
+
 	void sendRequest(RemoteRpcServer* server, std::vector<char>& data, std::vector<char>& responseData, bool insertHeader, bool& retry);
 };
 
@@ -0,0 +1,196 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "RpcElementEncoder.h"
+
+#include <limits>
+#include <locale>
+#include <sstream>
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+RpcElementEncoder::RpcElementEncoder(BaseLib::SharedObjects* baseLib) : _binaryEncoder(baseLib)
+{
+}
+
+void RpcElementEncoder::encodeBinary(const BaseLib::PVariable& variable, std::vector<char>& encodedData)
+{
+	if(!variable || variable->type == BaseLib::VariableType::tVoid || variable->type == BaseLib::VariableType::tVariant)
+	{
+		//Void is encoded as empty string when "encodeVoid" is disabled.
+		std::string empty;
+		_binaryEncoder.encodeInteger(encodedData, (int32_t)BaseLib::VariableType::tString);
+		_binaryEncoder.encodeString(encodedData, empty);
+	}
+	else if(variable->type == BaseLib::VariableType::tInteger)
+	{
+		_binaryEncoder.encodeInteger(encodedData, (int32_t)BaseLib::VariableType::tInteger);
+		_binaryEncoder.encodeInteger(encodedData, variable->integerValue);
+	}
+	else if(variable->type == BaseLib::VariableType::tInteger64)
+	{
+		_binaryEncoder.encodeInteger(encodedData, (int32_t)BaseLib::VariableType::tInteger64);
+		_binaryEncoder.encodeInteger64(encodedData, variable->integerValue64);
+	}
+	else if(variable->type == BaseLib::VariableType::tFloat)
+	{
+		_binaryEncoder.encodeInteger(encodedData, (int32_t)BaseLib::VariableType::tFloat);
+		_binaryEncoder.encodeFloat(encodedData, variable->floatValue);
+	}
+	else if(variable->type == BaseLib::VariableType::tBoolean)
+	{
+		_binaryEncoder.encodeInteger(encodedData, (int32_t)BaseLib::VariableType::tBoolean);
+		_binaryEncoder.encodeBoolean(encodedData, variable->booleanValue);
+	}
+	else if(variable->type == BaseLib::VariableType::tString || variable->type == BaseLib::VariableType::tBase64)
+	{
+		_binaryEncoder.encodeInteger(encodedData, (int32_t)variable->type);
+		_binaryEncoder.encodeString(encodedData, variable->stringValue);
+	}
+	else if(variable->type == BaseLib::VariableType::tBinary)
+	{
+		_binaryEncoder.encodeInteger(encodedData, (int32_t)BaseLib::VariableType::tBinary);
+		_binaryEncoder.encodeBinary(encodedData, variable->binaryValue);
+	}
+	else if(variable->type == BaseLib::VariableType::tArray)
+	{
+		_binaryEncoder.encodeInteger(encodedData, (int32_t)BaseLib::VariableType::tArray);
+		_binaryEncoder.encodeInteger(encodedData, (int32_t)variable->arrayValue->size());
+		for(auto& element : *variable->arrayValue)
+		{
+			encodeBinary(element, encodedData);
+		}
+	}
+	else if(variable->type == BaseLib::VariableType::tStruct)
+	{
+		_binaryEncoder.encodeInteger(encodedData, (int32_t)BaseLib::VariableType::tStruct);
+		_binaryEncoder.encodeInteger(encodedData, (int32_t)variable->structValue->size());
+		for(auto& element : *variable->structValue)
+		{
+			std::string name = element.first.empty() ? "UNDEFINED" : element.first;
+			_binaryEncoder.encodeString(encodedData, name);
+			encodeBinary(element.second, encodedData);
+		}
+	}
+}
+
+void RpcElementEncoder::encodeXml(const BaseLib::PVariable& variable, std::vector<char>& encodedData)
+{
+	appendXml("<value>", encodedData);
+	if(!variable || variable->type == BaseLib::VariableType::tVoid || variable->type == BaseLib::VariableType::tVariant)
+	{
+	}
+	else if(variable->type == BaseLib::VariableType::tInteger)
+	{
+		appendXml("<i4>" + std::to_string(variable->integerValue) + "</i4>", encodedData);
+	}
+	else if(variable->type == BaseLib::VariableType::tInteger64)
+	{
+		//Many XML-RPC clients don't know "i8", so only use it when the value doesn't fit into "i4".
+		if(variable->integerValue64 >= std::numeric_limits<int32_t>::min() && variable->integerValue64 <= std::numeric_limits<int32_t>::max()) appendXml("<i4>" + std::to_string(variable->integerValue64) + "</i4>", encodedData);
+		else appendXml("<i8>" + std::to_string(variable->integerValue64) + "</i8>", encodedData);
+	}
+	else if(variable->type == BaseLib::VariableType::tFloat)
+	{
+		std::ostringstream stream;
+		stream.imbue(std::locale::classic());
+		stream.precision(15);
+		stream << variable->floatValue;
+		appendXml("<double>" + stream.str() + "</double>", encodedData);
+	}
+	else if(variable->type == BaseLib::VariableType::tBoolean)
+	{
+		appendXml(variable->booleanValue ? "<boolean>1</boolean>" : "<boolean>0</boolean>", encodedData);
+	}
+	else if(variable->type == BaseLib::VariableType::tString)
+	{
+		appendXml("<string>", encodedData);
+		appendEscapedXml(variable->stringValue, encodedData);
+		appendXml("</string>", encodedData);
+	}
+	else if(variable->type == BaseLib::VariableType::tBase64)
+	{
+		appendXml("<base64>" + variable->stringValue + "</base64>", encodedData);
+	}
+	else if(variable->type == BaseLib::VariableType::tBinary)
+	{
+		std::string binary(variable->binaryValue.begin(), variable->binaryValue.end());
+		std::string base64;
+		BaseLib::Base64::encode(binary, base64);
+		appendXml("<base64>" + base64 + "</base64>", encodedData);
+	}
+	else if(variable->type == BaseLib::VariableType::tArray)
+	{
+		appendXml("<array><data>", encodedData);
+		for(auto& element : *variable->arrayValue)
+		{
+			encodeXml(element, encodedData);
+		}
+		appendXml("</data></array>", encodedData);
+	}
+	else if(variable->type == BaseLib::VariableType::tStruct)
+	{
+		appendXml("<struct>", encodedData);
+		for(auto& element : *variable->structValue)
+		{
+			appendXml("<member><name>", encodedData);
+			appendEscapedXml(element.first, encodedData);
+			appendXml("</name>", encodedData);
+			encodeXml(element.second, encodedData);
+			appendXml("</member>", encodedData);
+		}
+		appendXml("</struct>", encodedData);
+	}
+	appendXml("</value>", encodedData);
+}
+
+void RpcElementEncoder::appendXml(const std::string& text, std::vector<char>& encodedData)
+{
+	encodedData.insert(encodedData.end(), text.begin(), text.end());
+}
+
+void RpcElementEncoder::appendEscapedXml(const std::string& text, std::vector<char>& encodedData)
+{
+	for(auto character : text)
+	{
+		if(character == '&') appendXml("&amp;", encodedData);
+		else if(character == '<') appendXml("&lt;", encodedData);
+		else if(character == '>') appendXml("&gt;", encodedData);
+		else encodedData.push_back(character);
+	}
+}
+
+}
+
+}
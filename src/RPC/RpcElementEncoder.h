@@ -0,0 +1,76 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef RPCELEMENTENCODER_H_
+#define RPCELEMENTENCODER_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <string>
+#include <vector>
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+/**
+ * Encodes single values without any packet or response framing. Used to stream large responses element by element. The
+ * output matches the value encoding of BaseLib's RpcEncoder (with "forceInteger64" and "encodeVoid" disabled as in the RPC
+ * server) and XmlrpcEncoder, so the streamed response can be concatenated from the encoded elements.
+ */
+class RpcElementEncoder
+{
+public:
+	RpcElementEncoder(BaseLib::SharedObjects* baseLib);
+	virtual ~RpcElementEncoder() = default;
+
+	/**
+	 * Appends the binary RPC encoding of "variable" (type and value) to "encodedData".
+	 */
+	void encodeBinary(const BaseLib::PVariable& variable, std::vector<char>& encodedData);
+
+	/**
+	 * Appends "variable" as XML-RPC "<value>" element to "encodedData".
+	 */
+	void encodeXml(const BaseLib::PVariable& variable, std::vector<char>& encodedData);
+private:
+	BaseLib::BinaryEncoder _binaryEncoder;
+
+	void appendXml(const std::string& text, std::vector<char>& encodedData);
+	void appendEscapedXml(const std::string& text, std::vector<char>& encodedData);
+};
+
+}
+
+}
+
+#endif
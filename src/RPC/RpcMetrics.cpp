@@ -0,0 +1,377 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "RpcMetrics.h"
+#include "../GD/GD.h"
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+RpcMetrics::MethodMetrics::MethodMetrics()
+{
+	calls = 0;
+	errors = 0;
+	totalLatency = 0;
+	maxLatency = 0;
+	for(int32_t i = 0; i < BUCKET_COUNT; i++)
+	{
+		buckets[i] = 0;
+	}
+}
+
+RpcMetrics::RpcMetrics()
+{
+	pthread_rwlock_init(&_metricsLock, nullptr);
+	_startTime = BaseLib::HelperFunctions::getTime();
+}
+
+RpcMetrics::~RpcMetrics()
+{
+	pthread_rwlock_destroy(&_metricsLock);
+}
+
+std::string RpcMetrics::getTransportName(Transport transport)
+{
+	switch(transport)
+	{
+		case Transport::internal:
+			return "internal";
+		case Transport::binary:
+			return "binary";
+		case Transport::xml:
+			return "xml";
+		case Transport::json:
+			return "json";
+		case Transport::webSocket:
+			return "websocket";
+		case Transport::ipc:
+			return "ipc";
+		case Transport::scriptEngine:
+			return "scriptengine";
+		case Transport::nodeBlue:
+			return "nodeblue";
+	}
+	return "unknown";
+}
+
+int32_t RpcMetrics::getBucketIndex(uint64_t value)
+{
+	if(value < (uint64_t)SUB_BUCKET_COUNT) return (int32_t)value;
+	int32_t exponent = 63 - __builtin_clzll(value);
+	if(exponent >= MAX_EXPONENT) return BUCKET_COUNT - 1;
+	int32_t subBucket = (int32_t)((value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1));
+	return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + subBucket;
+}
+
+uint64_t RpcMetrics::getBucketUpperBound(int32_t index)
+{
+	if(index < SUB_BUCKET_COUNT) return (uint64_t)index;
+	int32_t shift = index / SUB_BUCKET_COUNT - 1;
+	uint64_t subBucket = (uint64_t)(index % SUB_BUCKET_COUNT);
+	return ((SUB_BUCKET_COUNT + subBucket) << shift) + ((uint64_t)1 << shift) - 1;
+}
+
+RpcMetrics::PMethodMetrics RpcMetrics::getMethodMetrics(Direction direction, Transport transport, const std::string& methodName)
+{
+	try
+	{
+		auto& methods = _metrics[(int32_t)direction][(int32_t)transport];
+		{
+			pthread_rwlock_rdlock(&_metricsLock);
+			auto methodIterator = methods.find(methodName);
+			PMethodMetrics metrics;
+			if(methodIterator != methods.end()) metrics = methodIterator->second;
+			pthread_rwlock_unlock(&_metricsLock);
+			if(metrics) return metrics;
+		}
+
+		PMethodMetrics metrics;
+		pthread_rwlock_wrlock(&_metricsLock);
+		try
+		{
+			auto methodIterator = methods.find(methodName);
+			if(methodIterator != methods.end()) metrics = methodIterator->second;
+			else if(methods.size() < MAX_METHODS)
+			{
+				metrics = std::make_shared<MethodMetrics>();
+				methods.emplace(methodName, metrics);
+			}
+		}
+		catch(...)
+		{
+			pthread_rwlock_unlock(&_metricsLock);
+			throw;
+		}
+		pthread_rwlock_unlock(&_metricsLock);
+		return metrics;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return PMethodMetrics();
+}
+
+void RpcMetrics::record(const PMethodMetrics& metrics, int64_t latency, bool error)
+{
+	if(!metrics) return;
+	if(latency < 0) latency = 0;
+	metrics->calls++;
+	if(error) metrics->errors++;
+	metrics->totalLatency += (uint64_t)latency;
+	uint64_t maxLatency = metrics->maxLatency;
+	while((uint64_t)latency > maxLatency && !metrics->maxLatency.compare_exchange_weak(maxLatency, (uint64_t)latency));
+	metrics->buckets[getBucketIndex((uint64_t)latency)]++;
+}
+
+void RpcMetrics::record(const MethodMetricsTable& table, const std::string& methodName, int64_t latency, bool error)
+{
+	auto metricsIterator = table.find(methodName);
+	if(metricsIterator != table.end()) record(metricsIterator->second, latency, error);
+}
+
+void RpcMetrics::record(Direction direction, Transport transport, const std::string& methodName, int64_t latency, bool error)
+{
+	record(getMethodMetrics(direction, transport, methodName), latency, error);
+}
+
+void RpcMetrics::reset()
+{
+	try
+	{
+		std::vector<std::tuple<Direction, Transport, std::string, PMethodMetrics>> entries;
+		getEntries(entries);
+		for(auto& entry : entries)
+		{
+			PMethodMetrics& metrics = std::get<3>(entry);
+			metrics->calls = 0;
+			metrics->errors = 0;
+			metrics->totalLatency = 0;
+			metrics->maxLatency = 0;
+			for(int32_t i = 0; i < BUCKET_COUNT; i++)
+			{
+				metrics->buckets[i] = 0;
+			}
+		}
+		_startTime = BaseLib::HelperFunctions::getTime();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void RpcMetrics::getEntries(std::vector<std::tuple<Direction, Transport, std::string, PMethodMetrics>>& entries)
+{
+	entries.clear();
+	pthread_rwlock_rdlock(&_metricsLock);
+	try
+	{
+		for(int32_t direction = 0; direction < 2; direction++)
+		{
+			for(int32_t transport = 0; transport < TRANSPORT_COUNT; transport++)
+			{
+				for(auto& method : _metrics[direction][transport])
+				{
+					entries.emplace_back((Direction)direction, (Transport)transport, method.first, method.second);
+				}
+			}
+		}
+	}
+	catch(...)
+	{
+		pthread_rwlock_unlock(&_metricsLock);
+		throw;
+	}
+	pthread_rwlock_unlock(&_metricsLock);
+}
+
+RpcMetrics::Summary RpcMetrics::summarize(const PMethodMetrics& metrics)
+{
+	Summary summary;
+	std::vector<uint64_t> buckets(BUCKET_COUNT);
+	uint64_t count = 0;
+	for(int32_t i = 0; i < BUCKET_COUNT; i++)
+	{
+		buckets[i] = metrics->buckets[i];
+		count += buckets[i];
+	}
+	summary.calls = metrics->calls;
+	summary.errors = metrics->errors;
+	summary.totalLatency = metrics->totalLatency;
+	summary.maxLatency = metrics->maxLatency;
+	if(count == 0) return summary;
+
+	std::vector<std::pair<double, uint64_t*>> percentiles{ {0.5, &summary.p50}, {0.9, &summary.p90}, {0.99, &summary.p99}, {0.999, &summary.p999} };
+	uint64_t cumulativeCount = 0;
+	size_t percentileIndex = 0;
+	for(int32_t i = 0; i < BUCKET_COUNT && percentileIndex < percentiles.size(); i++)
+	{
+		cumulativeCount += buckets[i];
+		while(percentileIndex < percentiles.size() && (double)cumulativeCount >= percentiles[percentileIndex].first * count)
+		{
+			uint64_t value = getBucketUpperBound(i);
+			*percentiles[percentileIndex].second = value > summary.maxLatency ? summary.maxLatency : value;
+			percentileIndex++;
+		}
+	}
+	return summary;
+}
+
+BaseLib::PVariable RpcMetrics::get()
+{
+	try
+	{
+		std::vector<std::tuple<Direction, Transport, std::string, PMethodMetrics>> entries;
+		getEntries(entries);
+		double seconds = (double)(BaseLib::HelperFunctions::getTime() - _startTime) / 1000.0;
+		if(seconds < 1) seconds = 1;
+
+		BaseLib::PVariable result = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+		result->arrayValue->reserve(entries.size());
+		for(auto& entry : entries)
+		{
+			Summary summary = summarize(std::get<3>(entry));
+			if(summary.calls == 0) continue; //Resolved by an RPC server, but never called
+
+			BaseLib::PVariable element = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+			element->structValue->emplace("method", std::make_shared<BaseLib::Variable>(std::get<2>(entry)));
+			element->structValue->emplace("direction", std::make_shared<BaseLib::Variable>(std::string(std::get<0>(entry) == Direction::incoming ? "incoming" : "outgoing")));
+			element->structValue->emplace("transport", std::make_shared<BaseLib::Variable>(getTransportName(std::get<1>(entry))));
+			element->structValue->emplace("calls", std::make_shared<BaseLib::Variable>((int64_t)summary.calls));
+			element->structValue->emplace("errors", std::make_shared<BaseLib::Variable>((int64_t)summary.errors));
+			element->structValue->emplace("callsPerSecond", std::make_shared<BaseLib::Variable>((double)summary.calls / seconds));
+			element->structValue->emplace("averageLatency", std::make_shared<BaseLib::Variable>((int64_t)(summary.calls > 0 ? summary.totalLatency / summary.calls : 0)));
+			element->structValue->emplace("latencyP50", std::make_shared<BaseLib::Variable>((int64_t)summary.p50));
+			element->structValue->emplace("latencyP90", std::make_shared<BaseLib::Variable>((int64_t)summary.p90));
+			element->structValue->emplace("latencyP99", std::make_shared<BaseLib::Variable>((int64_t)summary.p99));
+			element->structValue->emplace("latencyP999", std::make_shared<BaseLib::Variable>((int64_t)summary.p999));
+			element->structValue->emplace("maxLatency", std::make_shared<BaseLib::Variable>((int64_t)summary.maxLatency));
+			result->arrayValue->push_back(element);
+		}
+		return result;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+std::string RpcMetrics::getText()
+{
+	try
+	{
+		std::vector<std::tuple<Direction, Transport, std::string, PMethodMetrics>> entries;
+		getEntries(entries);
+
+		std::string calls;
+		std::string errors;
+		std::string latency;
+		calls.reserve(entries.size() * 128);
+		errors.reserve(entries.size() * 128);
+		latency.reserve(entries.size() * 768);
+		for(auto& entry : entries)
+		{
+			Summary summary = summarize(std::get<3>(entry));
+			if(summary.calls == 0) continue;
+
+			std::string method;
+			method.reserve(std::get<2>(entry).size());
+			for(auto& c : std::get<2>(entry))
+			{
+				if(c == '"' || c == '\\') method.push_back('\\');
+				if(c == '\n') method.append("\\n");
+				else method.push_back(c);
+			}
+			std::string labels = "method=\"" + method + "\",direction=\"" + (std::get<0>(entry) == Direction::incoming ? "incoming" : "outgoing") + "\",transport=\"" + getTransportName(std::get<1>(entry)) + "\"";
+
+			calls.append("homegear_rpc_calls_total{" + labels + "} " + std::to_string(summary.calls) + "\n");
+			errors.append("homegear_rpc_errors_total{" + labels + "} " + std::to_string(summary.errors) + "\n");
+			latency.append("homegear_rpc_latency_microseconds{" + labels + ",quantile=\"0.5\"} " + std::to_string(summary.p50) + "\n");
+			latency.append("homegear_rpc_latency_microseconds{" + labels + ",quantile=\"0.9\"} " + std::to_string(summary.p90) + "\n");
+			latency.append("homegear_rpc_latency_microseconds{" + labels + ",quantile=\"0.99\"} " + std::to_string(summary.p99) + "\n");
+			latency.append("homegear_rpc_latency_microseconds{" + labels + ",quantile=\"0.999\"} " + std::to_string(summary.p999) + "\n");
+			latency.append("homegear_rpc_latency_microseconds_sum{" + labels + "} " + std::to_string(summary.totalLatency) + "\n");
+			latency.append("homegear_rpc_latency_microseconds_count{" + labels + "} " + std::to_string(summary.calls) + "\n");
+		}
+
+		std::string text;
+		text.reserve(calls.size() + errors.size() + latency.size() + 512);
+		text.append("# HELP homegear_rpc_calls_total Number of RPC calls.\n# TYPE homegear_rpc_calls_total counter\n").append(calls);
+		text.append("# HELP homegear_rpc_errors_total Number of RPC calls returning an error.\n# TYPE homegear_rpc_errors_total counter\n").append(errors);
+		text.append("# HELP homegear_rpc_latency_microseconds Latency of RPC calls.\n# TYPE homegear_rpc_latency_microseconds summary\n").append(latency);
+		return text;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return "";
+}
+
+}
+
+}
@@ -0,0 +1,187 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef RPCMETRICS_H_
+#define RPCMETRICS_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <atomic>
+#include <map>
+#include <pthread.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+/**
+ * Collects call counts, error counts and latency histograms per RPC method, split by transport and direction.
+ *
+ * Latencies are stored in microseconds in log-linear buckets (HDR style): Every power of two is divided into 8 sub-buckets,
+ * so the relative error of the reported percentiles is at most 12.5 %. The RPC servers resolve the entries of their methods
+ * once with getMethodMetrics() on construction, so recording a call only needs atomic increments. Entries are never removed,
+ * so resolved entries stay valid after reset().
+ */
+class RpcMetrics
+{
+public:
+	enum class Transport : int32_t
+	{
+		internal = 0,
+		binary = 1,
+		xml = 2,
+		json = 3,
+		webSocket = 4,
+		ipc = 5,
+		scriptEngine = 6,
+		nodeBlue = 7
+	};
+
+	enum class Direction : int32_t
+	{
+		incoming = 0,
+		outgoing = 1
+	};
+
+	static const int32_t TRANSPORT_COUNT = 8;
+
+private:
+	static const int32_t SUB_BUCKET_COUNT = 8;
+	static const int32_t SUB_BUCKET_BITS = 3;
+	static const int32_t MAX_EXPONENT = 40;
+	static const int32_t BUCKET_COUNT = (MAX_EXPONENT - 2) * SUB_BUCKET_COUNT;
+	static const size_t MAX_METHODS = 1000;
+
+public:
+	struct MethodMetrics
+	{
+		std::atomic<uint64_t> calls;
+		std::atomic<uint64_t> errors;
+		std::atomic<uint64_t> totalLatency;
+		std::atomic<uint64_t> maxLatency;
+		std::atomic<uint64_t> buckets[BUCKET_COUNT];
+
+		MethodMetrics();
+	};
+	typedef std::shared_ptr<MethodMetrics> PMethodMetrics;
+	typedef std::unordered_map<std::string, PMethodMetrics> MethodMetricsTable;
+
+	RpcMetrics();
+	virtual ~RpcMetrics();
+
+	/**
+	 * Returns the entry of a method and creates it if it doesn't exist yet.
+	 *
+	 * @return The entry or nullptr when MAX_METHODS is reached.
+	 */
+	PMethodMetrics getMethodMetrics(Direction direction, Transport transport, const std::string& methodName);
+
+	/**
+	 * Records one call in an entry returned by getMethodMetrics(). Only uses atomic operations.
+	 *
+	 * @param metrics The entry of the method. Nothing is recorded when it is nullptr.
+	 * @param latency The time the call took in microseconds.
+	 * @param error Set to true when the call returned an error.
+	 */
+	static void record(const PMethodMetrics& metrics, int64_t latency, bool error);
+
+	/**
+	 * Records one call in a table of entries resolved on construction of a server. The table must not be modified anymore.
+	 */
+	static void record(const MethodMetricsTable& table, const std::string& methodName, int64_t latency, bool error);
+
+	/**
+	 * Records one call of a method whose entry has not been resolved beforehand (e. g. methods of IPC clients and calls to RPC
+	 * servers). The entry is looked up under a shared lock.
+	 *
+	 * @param direction "incoming" for calls handled by Homegear, "outgoing" for calls to RPC servers.
+	 * @param transport The transport the call was made over.
+	 * @param methodName The name of the RPC method.
+	 * @param latency The time the call took in microseconds.
+	 * @param error Set to true when the call returned an error.
+	 */
+	void record(Direction direction, Transport transport, const std::string& methodName, int64_t latency, bool error);
+
+	/**
+	 * Returns the metrics of all methods as an array of structs.
+	 */
+	BaseLib::PVariable get();
+
+	/**
+	 * Returns the metrics in the Prometheus text exposition format.
+	 */
+	std::string getText();
+
+	/**
+	 * Sets all collected metrics to zero.
+	 */
+	void reset();
+
+	static std::string getTransportName(Transport transport);
+private:
+	struct Summary
+	{
+		uint64_t calls = 0;
+		uint64_t errors = 0;
+		uint64_t totalLatency = 0;
+		uint64_t maxLatency = 0;
+		uint64_t p50 = 0;
+		uint64_t p90 = 0;
+		uint64_t p99 = 0;
+		uint64_t p999 = 0;
+	};
+
+	pthread_rwlock_t _metricsLock;
+	std::map<std::string, PMethodMetrics> _metrics[2][TRANSPORT_COUNT];
+	std::atomic<int64_t> _startTime;
+
+	static int32_t getBucketIndex(uint64_t value);
+	static uint64_t getBucketUpperBound(int32_t index);
+	static Summary summarize(const PMethodMetrics& metrics);
+
+	/**
+	 * Returns a copy of all entries, so the summaries can be calculated without holding _metricsLock.
+	 */
+	void getEntries(std::vector<std::tuple<Direction, Transport, std::string, PMethodMetrics>>& entries);
+};
+
+}
+
+}
+
+#endif
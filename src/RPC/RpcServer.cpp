@@ -41,6 +41,15 @@ namespace Rpc
 
 int32_t RpcServer::_currentClientID = 0;
 
+/**
+ * Checks if the request line at the start of "buffer" ends with "HTTP/1.1". "buffer" needs to be null terminated.
+ */
+static bool isHttp11Request(const char* buffer)
+{
+    const char* lineEnd = strstr(buffer, "\r\n");
+    return lineEnd && lineEnd - buffer >= 8 && !strncmp(lineEnd - 8, "HTTP/1.1", 8);
+}
+
 RpcServer::Client::Client()
 {
     socket = std::shared_ptr<BaseLib::TcpSocket>(new BaseLib::TcpSocket(GD::bl.get()));
@@ -63,6 +72,7 @@ RpcServer::RpcServer()
     _rpcEncoder = std::unique_ptr<BaseLib::Rpc::RpcEncoder>(new BaseLib::Rpc::RpcEncoder(GD::bl.get()));
     _xmlRpcDecoder = std::unique_ptr<BaseLib::Rpc::XmlrpcDecoder>(new BaseLib::Rpc::XmlrpcDecoder(GD::bl.get()));
     _xmlRpcEncoder = std::unique_ptr<BaseLib::Rpc::XmlrpcEncoder>(new BaseLib::Rpc::XmlrpcEncoder(GD::bl.get()));
+    _elementEncoder = std::unique_ptr<RpcElementEncoder>(new RpcElementEncoder(GD::bl.get()));
     _jsonDecoder = std::unique_ptr<BaseLib::Rpc::JsonDecoder>(new BaseLib::Rpc::JsonDecoder(GD::bl.get()));
     _jsonEncoder = std::unique_ptr<BaseLib::Rpc::JsonEncoder>(new BaseLib::Rpc::JsonEncoder(GD::bl.get()));
 
@@ -74,6 +84,12 @@ RpcServer::RpcServer()
     _stopServer = false;
     _stopped = true;
 
+    _tlsFullHandshakes = 0;
+    _tlsResumedHandshakes = 0;
+    _tlsFailedHandshakes = 0;
+    _tlsHandshakeTime = 0;
+    _tlsMetricsStartTime = BaseLib::HelperFunctions::getTime();
+
     _lifetick1.first = 0;
     _lifetick1.second = true;
     _lifetick2.first = 0;
@@ -148,6 +164,7 @@ RpcServer::RpcServer()
     _rpcMethods->emplace("getGlobalData", std::make_shared<RPCGetGlobalData>());
     _rpcMethods->emplace("getNodeEvents", std::make_shared<RPCGetNodeEvents>());
     _rpcMethods->emplace("getNodesWithFixedInputs", std::make_shared<RPCGetNodesWithFixedInputs>());
+    _rpcMethods->emplace("getNodeStatistics", std::make_shared<RPCGetNodeStatistics>());
     _rpcMethods->emplace("getNodeVariable", std::make_shared<RPCGetNodeVariable>());
     _rpcMethods->emplace("getPairingInfo", std::make_shared<RPCGetPairingInfo>());
     _rpcMethods->emplace("getParamset", std::make_shared<RPCGetParamset>());
@@ -157,11 +174,13 @@ RpcServer::RpcServer()
     _rpcMethods->emplace("getRoomMetadata", std::make_shared<RPCGetRoomMetadata>());
     _rpcMethods->emplace("getRooms", std::make_shared<RPCGetRooms>());
     _rpcMethods->emplace("getRoomsInStory", std::make_shared<RPCGetRoomsInStory>());
+    _rpcMethods->emplace("getRpcMetrics", std::make_shared<RPCGetRpcMetrics>());
     _rpcMethods->emplace("getServiceMessages", std::make_shared<RPCGetServiceMessages>());
     _rpcMethods->emplace("getSniffedDevices", std::make_shared<RPCGetSniffedDevices>());
     _rpcMethods->emplace("getStories", std::make_shared<RPCGetStories>());
     _rpcMethods->emplace("getStoryMetadata", std::make_shared<RPCGetStoryMetadata>());
     _rpcMethods->emplace("getSystemVariable", std::make_shared<RPCGetSystemVariable>());
+    _rpcMethods->emplace("getTlsMetrics", std::make_shared<RPCGetTlsMetrics>());
     _rpcMethods->emplace("getUpdateStatus", std::make_shared<RPCGetUpdateStatus>());
     _rpcMethods->emplace("getValue", std::make_shared<RPCGetValue>());
     _rpcMethods->emplace("getVariableDescription", std::make_shared<RPCGetVariableDescription>());
@@ -203,6 +222,7 @@ RpcServer::RpcServer()
     _rpcMethods->emplace("searchInterfaces", std::make_shared<RPCSearchInterfaces>());
     _rpcMethods->emplace("setCategoryMetadata", std::make_shared<RPCSetCategoryMetadata>());
     _rpcMethods->emplace("setData", std::make_shared<RPCSetData>());
+    _rpcMethods->emplace("setEventRateLimit", std::make_shared<RPCSetEventRateLimit>());
     _rpcMethods->emplace("setGlobalServiceMessage", std::make_shared<RPCSetGlobalServiceMessage>());
     _rpcMethods->emplace("setId", std::make_shared<RPCSetId>());
     _rpcMethods->emplace("setInstallMode", std::make_shared<RPCSetInstallMode>());
@@ -222,9 +242,11 @@ RpcServer::RpcServer()
     _rpcMethods->emplace("setValue", std::make_shared<RPCSetValue>());
     _rpcMethods->emplace("startSniffing", std::make_shared<RPCStartSniffing>());
     _rpcMethods->emplace("stopSniffing", std::make_shared<RPCStopSniffing>());
+    _rpcMethods->emplace("subscribeEvents", std::make_shared<RPCSubscribeEvents>());
     _rpcMethods->emplace("subscribePeers", std::make_shared<RPCSubscribePeers>());
     _rpcMethods->emplace("triggerEvent", std::make_shared<RPCTriggerEvent>());
     _rpcMethods->emplace("triggerRpcEvent", std::make_shared<RPCTriggerRpcEvent>());
+    _rpcMethods->emplace("unsubscribeEvents", std::make_shared<RPCUnsubscribeEvents>());
     _rpcMethods->emplace("unsubscribePeers", std::make_shared<RPCUnsubscribePeers>());
     _rpcMethods->emplace("updateCategory", std::make_shared<RPCUpdateCategory>());
     _rpcMethods->emplace("updateFirmware", std::make_shared<RPCUpdateFirmware>());
@@ -240,6 +262,17 @@ RpcServer::RpcServer()
     _rpcMethods->emplace("getRoomUiElements", std::make_shared<RPCGetRoomUiElements>());
     _rpcMethods->emplace("removeUiElement", std::make_shared<RPCRemoveUiElement>());
     //}}}
+
+    //Resolve the metrics entries once, so calls only need atomic increments
+    for(auto& method : *_rpcMethods)
+    {
+        std::vector<RpcMetrics::PMethodMetrics>& metrics = _rpcMethodMetrics[method.first];
+        metrics.resize((int32_t)RpcMetrics::Transport::webSocket + 1);
+        for(int32_t i = 0; i <= (int32_t)RpcMetrics::Transport::webSocket; i++)
+        {
+            metrics[i] = GD::rpcMetrics.getMethodMetrics(RpcMetrics::Direction::incoming, (RpcMetrics::Transport)i, method.first);
+        }
+    }
 }
 
 RpcServer::~RpcServer()
@@ -442,6 +475,12 @@ void RpcServer::start(BaseLib::Rpc::PServerInfo& info)
                 return;
             }
             gnutls_certificate_set_dh_params(_x509Cred, _dhParams);
+            if(!_sessionTicketKey.data && (result = gnutls_session_ticket_key_generate(&_sessionTicketKey)) != GNUTLS_E_SUCCESS)
+            {
+                _out.printWarning("Warning: Could not generate TLS session ticket key. Session tickets are disabled: " + std::string(gnutls_strerror(result)));
+                _sessionTicketKey.data = nullptr;
+                _sessionTicketKey.size = 0;
+            }
         }
         _webServer.reset(new WebServer::WebServer(_info));
         _restServer.reset(new RestServer(_info));
@@ -500,6 +539,17 @@ void RpcServer::stop()
             gnutls_dh_params_deinit(_dhParams);
             _dhParams = nullptr;
         }
+        if(_sessionTicketKey.data)
+        {
+            memset(_sessionTicketKey.data, 0, _sessionTicketKey.size);
+            gnutls_free(_sessionTicketKey.data);
+            _sessionTicketKey.data = nullptr;
+            _sessionTicketKey.size = 0;
+        }
+        {
+            std::lock_guard<std::mutex> tlsSessionCacheGuard(_tlsSessionCacheMutex);
+            _tlsSessionCache.clear();
+        }
         _webServer.reset();
         _restServer.reset();
     }
@@ -618,16 +668,7 @@ void RpcServer::mainThread()
 
                 try
                 {
-                    if(_info->ssl)
-                    {
-                        getSSLSocketDescriptor(client);
-                        if(!client->socketDescriptor->tlsSession)
-                        {
-                            //Remove client from _clients again. Socket is already closed.
-                            closeClientConnection(client);
-                            continue;
-                        }
-                    }
+                    //The TLS handshake is done in readClient, so slow handshakes don't block accepting new connections.
                     client->socket = std::shared_ptr<BaseLib::TcpSocket>(new BaseLib::TcpSocket(GD::bl.get(), client->socketDescriptor));
                     client->socket->setReadTimeout(100000);
                     client->socket->setWriteTimeout(15000000);
@@ -642,7 +683,7 @@ void RpcServer::mainThread()
                     }
 #endif
 
-                    GD::bl->threadManager.start(client->readThread, false, _threadPriority, _threadPolicy, &RpcServer::readClient, this, client);
+                    if(!GD::bl->threadManager.start(client->readThread, false, _threadPriority, _threadPolicy, &RpcServer::readClient, this, client)) closeClientConnection(client);
                 }
                 catch(const std::exception& ex)
                 {
@@ -841,6 +882,8 @@ void RpcServer::sendRPCResponseToClient(std::shared_ptr<Client> client, BaseLib:
     try
     {
         if(_stopped) return;
+        if(sendSnapshotResponseToClient(client, variable, messageId, responseType, keepAlive)) return;
+        if(sendStreamedRPCResponseToClient(client, variable, messageId, responseType, keepAlive)) return;
         std::vector<char> data;
         if(responseType == PacketType::Enum::xmlResponse)
         {
@@ -880,7 +923,8 @@ void RpcServer::sendRPCResponseToClient(std::shared_ptr<Client> client, BaseLib:
         {
             std::vector<char> json;
             _jsonEncoder->encodeResponse(variable, messageId, json);
-            BaseLib::WebSocket::encode(json, BaseLib::WebSocket::Header::Opcode::text, data);
+            if(client->webSocketCompression) WebSocketCompression::encode(json, BaseLib::WebSocket::Header::Opcode::text, data, client->webSocketWindowBits);
+            else BaseLib::WebSocket::encode(json, BaseLib::WebSocket::Header::Opcode::text, data);
             if(GD::bl->debugLevel >= 5)
             {
                 _out.printDebug("Response WebSocket packet: ");
@@ -903,6 +947,349 @@ void RpcServer::sendRPCResponseToClient(std::shared_ptr<Client> client, BaseLib:
     }
 }
 
+void RpcServer::printResponse(PacketType::Enum responseType, const char* data, size_t size)
+{
+    if(responseType == PacketType::Enum::binaryResponse)
+    {
+        std::vector<char> binary(data, data + size);
+        _out.printDebug("Response binary:");
+        _out.printBinary(binary);
+    }
+    else if(responseType == PacketType::Enum::webSocketResponse)
+    {
+        std::vector<char> binary(data, data + size);
+        _out.printDebug("Response WebSocket packet: ");
+        _out.printBinary(binary);
+    }
+    else _out.printDebug("Response packet: " + std::string(data, size));
+}
+
+bool RpcServer::encodeStreamElement(BaseLib::PVariable& element, PacketType::Enum responseType, std::vector<char>& data)
+{
+    try
+    {
+        data.clear();
+        if(responseType == PacketType::Enum::binaryResponse) _elementEncoder->encodeBinary(element, data);
+        else if(responseType == PacketType::Enum::xmlResponse) _elementEncoder->encodeXml(element, data);
+        else if(responseType == PacketType::Enum::jsonResponse) _jsonEncoder->encode(element, data);
+        else return false;
+        return true;
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return false;
+}
+
+bool RpcServer::sendStreamedRPCResponseToClient(std::shared_ptr<Client> client, BaseLib::PVariable& variable, int32_t messageId, PacketType::Enum responseType, bool keepAlive)
+{
+    try
+    {
+        if(!variable || variable->errorStruct || variable->type != BaseLib::VariableType::tArray || variable->arrayValue->size() < STREAMING_RESPONSE_THRESHOLD) return false;
+        if(responseType != PacketType::Enum::binaryResponse && responseType != PacketType::Enum::xmlResponse && responseType != PacketType::Enum::jsonResponse) return false;
+        if(responseType != PacketType::Enum::binaryResponse && !client->http11) return false; //Chunked transfer encoding requires HTTP/1.1
+        if(!clientValid(client)) return true;
+
+        std::vector<char> element;
+        std::vector<char> data;
+        data.reserve(STREAMING_CHUNK_SIZE + 1024);
+        const bool chunked = responseType != PacketType::Enum::binaryResponse;
+        bool error = false;
+        bool firstWrite = true;
+
+        auto write = [&](bool force, bool chunk) -> bool
+        {
+            if(data.empty() || (!force && data.size() < STREAMING_CHUNK_SIZE)) return true;
+            if(firstWrite)
+            {
+                firstWrite = false;
+                //Sleep a tiny little bit. Some clients like the linux version of IP-Symcon don't accept responses too fast.
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                if(!keepAlive || client->rpcType != BaseLib::RpcType::binary) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+            try
+            {
+                if(GD::bl->debugLevel >= 5) printResponse(responseType, data.data(), data.size());
+                if(chunk)
+                {
+                    std::string chunkHeader = BaseLib::HelperFunctions::getHexString((int32_t)data.size()) + "\r\n";
+                    data.insert(data.begin(), chunkHeader.begin(), chunkHeader.end());
+                    data.push_back('\r');
+                    data.push_back('\n');
+                }
+                client->socket->proofwrite(data);
+                data.clear();
+                return true;
+            }
+            catch(BaseLib::SocketDataLimitException& ex)
+            {
+                _out.printWarning("Warning: " + ex.what());
+            }
+            catch(const BaseLib::SocketOperationException& ex)
+            {
+                _out.printError("Error: " + ex.what());
+            }
+            error = true;
+            return false;
+        };
+
+        auto append = [&](const std::string& value)
+        {
+            data.insert(data.end(), value.begin(), value.end());
+        };
+
+        if(responseType == PacketType::Enum::binaryResponse)
+        {
+            uint32_t payloadSize = 8;
+            for(auto& arrayElement : *variable->arrayValue)
+            {
+                if(!encodeStreamElement(arrayElement, responseType, element)) return false;
+                payloadSize += element.size();
+            }
+
+            //Binary RPC integers are big endian
+            auto appendInteger = [&](uint32_t value)
+            {
+                data.push_back((char)(uint8_t)(value >> 24));
+                data.push_back((char)(uint8_t)(value >> 16));
+                data.push_back((char)(uint8_t)(value >> 8));
+                data.push_back((char)(uint8_t)value);
+            };
+
+            append(std::string("Bin"));
+            data.push_back(1);
+            appendInteger(payloadSize);
+            appendInteger(0x100);
+            appendInteger((uint32_t)variable->arrayValue->size());
+        }
+        else if(responseType == PacketType::Enum::xmlResponse)
+        {
+            append(getChunkedHttpResponseHeader("text/xml", !keepAlive));
+            write(true, false);
+            append(std::string("<?xml version=\"1.0\"?><methodResponse><params><param><value><array><data>"));
+        }
+        else
+        {
+            append(getChunkedHttpResponseHeader("application/json", !keepAlive));
+            write(true, false);
+            append(std::string("{\"jsonrpc\":\"2.0\",\"result\":["));
+        }
+
+        bool firstElement = true;
+        for(auto& arrayElement : *variable->arrayValue)
+        {
+            if(_stopped || error) break;
+            if(!encodeStreamElement(arrayElement, responseType, element))
+            {
+                //Part of the response has been sent already, so the connection is unusable.
+                _out.printError("Error: Could not encode array element of streamed response. Closing connection.");
+                error = true;
+                break;
+            }
+            if(responseType == PacketType::Enum::jsonResponse && !firstElement) data.push_back(',');
+            firstElement = false;
+            data.insert(data.end(), element.begin(), element.end());
+            write(false, chunked);
+        }
+
+        if(!error && !_stopped)
+        {
+            if(responseType == PacketType::Enum::xmlResponse) append(std::string("</data></array></value></param></params></methodResponse>\r\n"));
+            else if(responseType == PacketType::Enum::jsonResponse) append("],\"id\":" + std::to_string(messageId) + "}\r\n");
+            write(true, chunked);
+            if(chunked && !error)
+            {
+                //Terminating chunk
+                append(std::string("0\r\n\r\n"));
+                write(true, false);
+            }
+        }
+
+        if(!keepAlive || error || _stopped) closeClientConnection(client);
+        return true;
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    closeClientConnection(client);
+    return true;
+}
+
+std::shared_ptr<const std::vector<char>> RpcServer::getEncodedSnapshot(BaseLib::PVariable& variable, PacketType::Enum encoding)
+{
+    try
+    {
+        std::lock_guard<std::mutex> encodedSnapshotGuard(_encodedSnapshotMutex);
+        if(_encodedSnapshot != variable)
+        {
+            _encodedSnapshot = variable;
+            _encodedSnapshotData.clear();
+        }
+
+        std::shared_ptr<const std::vector<char>>& encodedData = _encodedSnapshotData[(int32_t)encoding];
+        if(!encodedData)
+        {
+            auto data = std::make_shared<std::vector<char>>();
+            if(encoding == PacketType::Enum::xmlResponse) _xmlRpcEncoder->encodeResponse(variable, *data);
+            else if(encoding == PacketType::Enum::binaryResponse) _rpcEncoder->encodeResponse(variable, *data);
+            else if(encoding == PacketType::Enum::jsonResponse) _jsonEncoder->encode(variable, *data); //Only the result. The message ID differs for every response.
+            else return std::shared_ptr<const std::vector<char>>();
+            encodedData = data;
+        }
+        return encodedData;
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return std::shared_ptr<const std::vector<char>>();
+}
+
+bool RpcServer::sendSnapshotResponseToClient(std::shared_ptr<Client> client, BaseLib::PVariable& variable, int32_t messageId, PacketType::Enum responseType, bool keepAlive)
+{
+    try
+    {
+        BaseLib::PVariable snapshot = GD::familyController->getValuesSnapshot(variable);
+        if(!snapshot) return false;
+        if(responseType != PacketType::Enum::binaryResponse && responseType != PacketType::Enum::xmlResponse && responseType != PacketType::Enum::jsonResponse && responseType != PacketType::Enum::webSocketResponse) return false;
+
+        PacketType::Enum encoding = responseType == PacketType::Enum::webSocketResponse ? PacketType::Enum::jsonResponse : responseType;
+        std::shared_ptr<const std::vector<char>> encodedData = getEncodedSnapshot(snapshot, encoding);
+        if(!encodedData || encodedData->empty()) return false;
+        if(!clientValid(client)) return true;
+
+        //Everything around the encoded snapshot. The snapshot itself is written straight from the shared buffer.
+        std::string prefix;
+        std::string suffix;
+        if(responseType == PacketType::Enum::xmlResponse)
+        {
+            prefix = getHttpResponseHeader("text/xml", encodedData->size() + 23, !keepAlive) + "<?xml version=\"1.0\"?>";
+            suffix = "\r\n";
+        }
+        else if(responseType == PacketType::Enum::jsonResponse || responseType == PacketType::Enum::webSocketResponse)
+        {
+            std::string start("{\"jsonrpc\":\"2.0\",\"result\":");
+            suffix = ",\"id\":" + std::to_string(messageId) + "}";
+            if(responseType == PacketType::Enum::jsonResponse)
+            {
+                suffix.append("\r\n");
+                prefix = getHttpResponseHeader("application/json", start.size() + encodedData->size() + suffix.size(), !keepAlive) + start;
+            }
+            else if(client->webSocketCompression)
+            {
+                //The frame is compressed as a whole, so it can't be sent from the shared buffer.
+                std::vector<char> json;
+                json.reserve(start.size() + encodedData->size() + suffix.size());
+                json.insert(json.end(), start.begin(), start.end());
+                json.insert(json.end(), encodedData->begin(), encodedData->end());
+                json.insert(json.end(), suffix.begin(), suffix.end());
+                std::vector<char> data;
+                WebSocketCompression::encode(json, BaseLib::WebSocket::Header::Opcode::text, data, client->webSocketWindowBits);
+                if(GD::bl->debugLevel >= 5) printResponse(responseType, data.data(), data.size());
+                sendRPCResponseToClient(client, data, keepAlive);
+                return true;
+            }
+            else
+            {
+                //Unmasked, unfragmented text frame header
+                uint64_t payloadSize = start.size() + encodedData->size() + suffix.size();
+                prefix.push_back((char)0x81);
+                if(payloadSize < 126) prefix.push_back((char)payloadSize);
+                else if(payloadSize <= 0xFFFF)
+                {
+                    prefix.push_back((char)126);
+                    prefix.push_back((char)(uint8_t)(payloadSize >> 8));
+                    prefix.push_back((char)(uint8_t)payloadSize);
+                }
+                else
+                {
+                    prefix.push_back((char)127);
+                    for(int32_t i = 56; i >= 0; i -= 8) prefix.push_back((char)(uint8_t)(payloadSize >> i));
+                }
+                prefix.append(start);
+            }
+        }
+
+        if(GD::bl->debugLevel >= 5)
+        {
+            std::vector<char> response;
+            response.reserve(prefix.size() + encodedData->size() + suffix.size());
+            response.insert(response.end(), prefix.begin(), prefix.end());
+            response.insert(response.end(), encodedData->begin(), encodedData->end());
+            response.insert(response.end(), suffix.begin(), suffix.end());
+            printResponse(responseType, response.data(), response.size());
+        }
+
+        bool error = false;
+        try
+        {
+            //Sleep a tiny little bit. Some clients like the linux version of IP-Symcon don't accept responses too fast.
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            if(!keepAlive || client->rpcType != BaseLib::RpcType::binary) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            if(!prefix.empty()) client->socket->proofwrite(prefix.data(), prefix.size());
+            for(size_t offset = 0; offset < encodedData->size() && !_stopped; offset += STREAMING_CHUNK_SIZE)
+            {
+                size_t bytesToWrite = encodedData->size() - offset;
+                if(bytesToWrite > STREAMING_CHUNK_SIZE) bytesToWrite = STREAMING_CHUNK_SIZE;
+                client->socket->proofwrite(encodedData->data() + offset, bytesToWrite);
+            }
+            if(!suffix.empty() && !_stopped) client->socket->proofwrite(suffix.data(), suffix.size());
+        }
+        catch(BaseLib::SocketDataLimitException& ex)
+        {
+            _out.printWarning("Warning: " + ex.what());
+            error = true;
+        }
+        catch(const BaseLib::SocketOperationException& ex)
+        {
+            _out.printError("Error: " + ex.what());
+            error = true;
+        }
+        if(!keepAlive || error || _stopped) closeClientConnection(client);
+        return true;
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    closeClientConnection(client);
+    return true;
+}
+
 bool RpcServer::methodExists(BaseLib::PRpcClientInfo clientInfo, std::string& methodName)
 {
     try
@@ -949,7 +1336,9 @@ BaseLib::PVariable RpcServer::callMethod(BaseLib::PRpcClientInfo clientInfo, std
                 (*i)->print(true, false);
             }
         }
+        int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
         BaseLib::PVariable ret = _rpcMethods->at(methodName)->invoke(clientInfo, parameters->arrayValue);
+        recordMetrics(methodName, RpcMetrics::Transport::internal, BaseLib::HelperFunctions::getTimeMicroseconds() - startTime, ret->errorStruct);
         if(GD::bl->debugLevel >= 5)
         {
             _out.printDebug("Response: ");
@@ -1011,7 +1400,9 @@ void RpcServer::callMethod(std::shared_ptr<Client> client, std::string methodNam
                 (*i)->print(true, false);
             }
         }
+        int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
         BaseLib::PVariable ret = _rpcMethods->at(methodName)->invoke(client, parameters);
+        recordMetrics(methodName, getMetricsTransport(responseType), BaseLib::HelperFunctions::getTimeMicroseconds() - startTime, ret->errorStruct);
         if(GD::bl->debugLevel >= 5)
         {
             _out.printDebug("Response: ");
@@ -1036,6 +1427,83 @@ void RpcServer::callMethod(std::shared_ptr<Client> client, std::string methodNam
     }
 }
 
+void RpcServer::recordMetrics(const std::string& methodName, RpcMetrics::Transport transport, int64_t latency, bool error)
+{
+    auto metricsIterator = _rpcMethodMetrics.find(methodName);
+    if(metricsIterator == _rpcMethodMetrics.end() || (int32_t)transport >= (int32_t)metricsIterator->second.size()) return;
+    RpcMetrics::record(metricsIterator->second[(int32_t)transport], latency, error);
+}
+
+RpcMetrics::Transport RpcServer::getMetricsTransport(PacketType::Enum responseType)
+{
+    switch(responseType)
+    {
+        case PacketType::Enum::binaryRequest:
+        case PacketType::Enum::binaryResponse:
+            return RpcMetrics::Transport::binary;
+        case PacketType::Enum::xmlRequest:
+        case PacketType::Enum::xmlResponse:
+            return RpcMetrics::Transport::xml;
+        case PacketType::Enum::jsonRequest:
+        case PacketType::Enum::jsonResponse:
+            return RpcMetrics::Transport::json;
+        case PacketType::Enum::webSocketRequest:
+        case PacketType::Enum::webSocketResponse:
+            return RpcMetrics::Transport::webSocket;
+    }
+    return RpcMetrics::Transport::internal;
+}
+
+void RpcServer::sendMetrics(std::shared_ptr<Client> client, bool keepAlive)
+{
+    try
+    {
+        std::vector<char> data;
+        if(!client->acls->checkMethodAccess("getRpcMetrics"))
+        {
+            _webServer->getError(403, "Forbidden", "You don't have permission to access the metrics.", data);
+            sendRPCResponseToClient(client, data, false);
+            return;
+        }
+        std::string metrics = GD::rpcMetrics.getText();
+        std::string fullHandshakes;
+        std::string resumedHandshakes;
+        std::string failedHandshakes;
+        for(auto& server : GD::rpcServers)
+        {
+            if(!server.second->getInfo()->ssl) continue;
+            BaseLib::PVariable tlsMetrics = server.second->getTlsMetrics();
+            if(tlsMetrics->errorStruct) continue;
+            std::string port = std::to_string(server.second->getInfo()->port);
+            fullHandshakes.append("homegear_tls_handshakes_total{port=\"" + port + "\",type=\"full\"} " + std::to_string(tlsMetrics->structValue->at("fullHandshakes")->integerValue64) + "\n");
+            resumedHandshakes.append("homegear_tls_handshakes_total{port=\"" + port + "\",type=\"resumed\"} " + std::to_string(tlsMetrics->structValue->at("resumedHandshakes")->integerValue64) + "\n");
+            failedHandshakes.append("homegear_tls_handshakes_total{port=\"" + port + "\",type=\"failed\"} " + std::to_string(tlsMetrics->structValue->at("failedHandshakes")->integerValue64) + "\n");
+        }
+        if(!fullHandshakes.empty())
+        {
+            metrics.append("# HELP homegear_tls_handshakes_total Number of TLS handshakes.\n# TYPE homegear_tls_handshakes_total counter\n");
+            metrics.append(fullHandshakes).append(resumedHandshakes).append(failedHandshakes);
+        }
+        std::string header = getHttpResponseHeader("text/plain; version=0.0.4", metrics.size(), !keepAlive);
+        data.reserve(header.size() + metrics.size());
+        data.insert(data.end(), header.begin(), header.end());
+        data.insert(data.end(), metrics.begin(), metrics.end());
+        sendRPCResponseToClient(client, data, keepAlive);
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
 std::string RpcServer::getHttpResponseHeader(std::string contentType, uint32_t contentLength, bool closeConnection)
 {
     std::string header;
@@ -1047,6 +1515,17 @@ std::string RpcServer::getHttpResponseHeader(std::string contentType, uint32_t c
     return header;
 }
 
+std::string RpcServer::getChunkedHttpResponseHeader(std::string contentType, bool closeConnection)
+{
+    std::string header;
+    header.append("HTTP/1.1 200 OK\r\n");
+    header.append("Connection: ");
+    header.append(closeConnection ? "close\r\n" : "Keep-Alive\r\n");
+    header.append("Content-Type: " + contentType + "\r\n");
+    header.append("Transfer-Encoding: chunked\r\n\r\n");
+    return header;
+}
+
 void RpcServer::analyzeRPCResponse(std::shared_ptr<Client> client, std::vector<char>& packet, PacketType::Enum packetType, bool keepAlive)
 {
     try
@@ -1246,6 +1725,7 @@ void RpcServer::handleConnectionUpgrade(std::shared_ptr<Client> client, BaseLib:
                 client->webSocketClientId = http.getHeader().path.substr(1);
             }
             BaseLib::HelperFunctions::toLower(client->webSocketClientId);
+            client->webSocketCompression = WebSocketCompression::negotiate(http, client->webSocketWindowBits);
 
             if(protocol == "server" || pathProtocol == "server" || protocol == "server2" || pathProtocol == "server2" || protocol == "nodeserver" || pathProtocol == "nodeserver")
             {
@@ -1256,12 +1736,13 @@ void RpcServer::handleConnectionUpgrade(std::shared_ptr<Client> client, BaseLib:
                 client->initSubscribePeers = true;
                 if(protocol == "nodeserver" || pathProtocol == "nodeserver") client->nodeClient = true;
                 std::string header;
-                header.reserve(133 + websocketAccept.size());
+                header.reserve(233 + websocketAccept.size());
                 header.append("HTTP/1.1 101 Switching Protocols\r\n");
                 header.append("Connection: Upgrade\r\n");
                 header.append("Upgrade: websocket\r\n");
                 header.append("Sec-WebSocket-Accept: ").append(websocketAccept).append("\r\n");
                 if(!protocol.empty()) header.append("Sec-WebSocket-Protocol: " + protocol + "\r\n");
+                if(client->webSocketCompression) header.append(WebSocketCompression::getResponseHeader(client->webSocketWindowBits));
                 header.append("\r\n");
                 std::vector<char> data(header.begin(), header.end());
                 sendRPCResponseToClient(client, data, true);
@@ -1269,7 +1750,7 @@ void RpcServer::handleConnectionUpgrade(std::shared_ptr<Client> client, BaseLib:
                 {
                     client->sendEventsToRpcServer = true;
                     _out.printInfo("Info: Transferring client number " + std::to_string(client->id) + " to RPC client.");
-                    GD::rpcClient->addWebSocketServer(client->socket, client->webSocketClientId, client, client->address, client->nodeClient);
+                    GD::rpcClient->addWebSocketServer(client->socket, client->webSocketClientId, client, client->address, client->nodeClient, client->webSocketCompression, client->webSocketWindowBits);
                 }
             }
             else if(protocol == "client" || pathProtocol == "client" || protocol == "nodeclient" || pathProtocol == "nodeclient")
@@ -1277,19 +1758,20 @@ void RpcServer::handleConnectionUpgrade(std::shared_ptr<Client> client, BaseLib:
                 client->rpcType = BaseLib::RpcType::websocket;
                 client->webSocketClient = true;
                 std::string header;
-                header.reserve(133 + websocketAccept.size());
+                header.reserve(233 + websocketAccept.size());
                 header.append("HTTP/1.1 101 Switching Protocols\r\n");
                 header.append("Connection: Upgrade\r\n");
                 header.append("Upgrade: websocket\r\n");
                 header.append("Sec-WebSocket-Accept: ").append(websocketAccept).append("\r\n");
                 if(!protocol.empty()) header.append("Sec-WebSocket-Protocol: " + protocol + "\r\n");
+                if(client->webSocketCompression) header.append(WebSocketCompression::getResponseHeader(client->webSocketWindowBits));
                 header.append("\r\n");
                 std::vector<char> data(header.begin(), header.end());
                 sendRPCResponseToClient(client, data, true);
                 if(_info->websocketAuthType == BaseLib::Rpc::ServerInfo::Info::AuthType::none)
                 {
                     _out.printInfo("Info: Transferring client number " + std::to_string(client->id) + " to RPC client.");
-                    auto server = GD::rpcClient->addWebSocketServer(client->socket, client->webSocketClientId, client, client->address, client->nodeClient);
+                    auto server = GD::rpcClient->addWebSocketServer(client->socket, client->webSocketClientId, client, client->address, client->nodeClient, client->webSocketCompression, client->webSocketWindowBits);
                     client->socketDescriptor.reset(new BaseLib::FileDescriptor());
                     client->socket.reset(new BaseLib::TcpSocket(GD::bl.get()));
                     client->closed = true;
@@ -1326,6 +1808,16 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
     try
     {
         if(!client) return;
+        if(_info->ssl)
+        {
+            getSSLSocketDescriptor(client);
+            if(!client->socketDescriptor->tlsSession || client->socketDescriptor->descriptor == -1)
+            {
+                //Remove client from _clients again. Socket is already closed.
+                closeClientConnection(client);
+                return;
+            }
+        }
         int32_t bufferMax = 1024;
         char buffer[bufferMax + 1];
         //Make sure the buffer is null terminated.
@@ -1336,6 +1828,7 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
         BaseLib::Rpc::BinaryRpc binaryRpc(GD::bl.get());
         BaseLib::Http http;
         BaseLib::WebSocket webSocket;
+        bool webSocketCompressed = false;
 
         _out.printDebug("Listening for incoming packets from client number " + std::to_string(client->socketDescriptor->id) + ".");
         while(!_stopServer)
@@ -1427,6 +1920,7 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
                 {
                     buffer[bytesRead] = '\0';
                     packetType = PacketType::Enum::xmlRequest;
+                    client->http11 = isHttp11Request(buffer);
 
                     if(!_info->redirectTo.empty())
                     {
@@ -1462,6 +1956,7 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
                     if(bytesRead < 8) continue;
                     buffer[bytesRead] = '\0';
                     packetType = (!strncmp(buffer, "POST", 4)) || (!strncmp(buffer, "PUT", 3)) ? PacketType::Enum::xmlRequest : PacketType::Enum::xmlResponse;
+                    if(packetType == PacketType::Enum::xmlRequest) client->http11 = isHttp11Request(buffer);
 
                     try
                     {
@@ -1476,6 +1971,7 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
                 else if(client->rpcType == BaseLib::RpcType::websocket)
                 {
                     packetType = PacketType::Enum::webSocketRequest;
+                    webSocketCompressed = client->webSocketCompression && WebSocketCompression::isCompressed(buffer);
                     webSocket.reset();
                     webSocket.process(buffer, bytesRead);
                 }
@@ -1515,6 +2011,15 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
             }
             if(client->rpcType == BaseLib::RpcType::websocket && webSocket.isFinished())
             {
+                if(webSocketCompressed)
+                {
+                    webSocketCompressed = false;
+                    if(!WebSocketCompression::decompress(webSocket.getContent()))
+                    {
+                        _out.printError("Error: Could not decompress WebSocket message from client number " + std::to_string(client->id) + ". Closing connection.");
+                        break;
+                    }
+                }
                 if(webSocket.getHeader().close)
                 {
                     std::vector<char> response;
@@ -1550,7 +2055,7 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
                             if(client->webSocketClient || client->sendEventsToRpcServer)
                             {
                                 _out.printInfo("Info: Transferring client number " + std::to_string(client->id) + " to rpc client.");
-                                GD::rpcClient->addWebSocketServer(client->socket, client->webSocketClientId, client, client->address, client->nodeClient);
+                                GD::rpcClient->addWebSocketServer(client->socket, client->webSocketClientId, client, client->address, client->nodeClient, client->webSocketCompression, client->webSocketWindowBits);
                                 if(client->webSocketClient)
                                 {
                                     client->socketDescriptor.reset(new BaseLib::FileDescriptor());
@@ -1606,7 +2111,11 @@ void RpcServer::readClient(std::shared_ptr<Client> client)
                         break;
                     }
                 }
-                if(_info->restServer && http.getHeader().path.compare(0, 5, "/api/") == 0)
+                if(http.getHeader().method == "GET" && http.getHeader().path == "/metrics")
+                {
+                    sendMetrics(client, http.getHeader().connection & BaseLib::Http::Connection::Enum::keepAlive);
+                }
+                else if(_info->restServer && http.getHeader().path.compare(0, 5, "/api/") == 0)
                 {
                     _restServer->process(client, http, client->socket);
                 }
@@ -1804,6 +2313,16 @@ void RpcServer::getSSLSocketDescriptor(std::shared_ptr<Client> client)
             GD::bl->fileDescriptorManager.shutdown(client->socketDescriptor);
             return;
         }
+        //Session ID based resumption for older clients and session tickets for clients supporting RFC 5077
+        gnutls_db_set_cache_expiration(client->socketDescriptor->tlsSession, TLS_SESSION_EXPIRATION);
+        gnutls_db_set_retrieve_function(client->socketDescriptor->tlsSession, &RpcServer::retrieveTlsSession);
+        gnutls_db_set_remove_function(client->socketDescriptor->tlsSession, &RpcServer::removeTlsSession);
+        gnutls_db_set_store_function(client->socketDescriptor->tlsSession, &RpcServer::storeTlsSession);
+        gnutls_db_set_ptr(client->socketDescriptor->tlsSession, this);
+        if(_sessionTicketKey.data && (result = gnutls_session_ticket_enable_server(client->socketDescriptor->tlsSession, &_sessionTicketKey)) != GNUTLS_E_SUCCESS)
+        {
+            _out.printWarning("Warning: Could not enable TLS session tickets: " + std::string(gnutls_strerror(result)));
+        }
         if(!client->socketDescriptor || client->socketDescriptor->descriptor == -1)
         {
             _out.printError("Error setting TLS socket descriptor: Provided socket descriptor is invalid.");
@@ -1814,16 +2333,21 @@ void RpcServer::getSSLSocketDescriptor(std::shared_ptr<Client> client)
 
         if(_info->authType == BaseLib::Rpc::ServerInfo::Info::AuthType::cert) gnutls_certificate_server_set_request(client->socketDescriptor->tlsSession, GNUTLS_CERT_REQUIRE);
         else if(_info->authType & BaseLib::Rpc::ServerInfo::Info::AuthType::cert) gnutls_certificate_server_set_request(client->socketDescriptor->tlsSession, GNUTLS_CERT_REQUEST);
+        int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
         do
         {
             result = gnutls_handshake(client->socketDescriptor->tlsSession);
         } while(result < 0 && gnutls_error_is_fatal(result) == 0);
+        _tlsHandshakeTime += BaseLib::HelperFunctions::getTimeMicroseconds() - startTime;
         if(result < 0)
         {
+            _tlsFailedHandshakes++;
             _out.printWarning("Warning: TLS handshake has failed: " + std::string(gnutls_strerror(result)));
             GD::bl->fileDescriptorManager.shutdown(client->socketDescriptor);
             return;
         }
+        if(gnutls_session_is_resumed(client->socketDescriptor->tlsSession)) _tlsResumedHandshakes++;
+        else _tlsFullHandshakes++;
 
         if(_info->authType & BaseLib::Rpc::ServerInfo::Info::AuthType::cert)
         {
@@ -1858,6 +2382,158 @@ void RpcServer::getSSLSocketDescriptor(std::shared_ptr<Client> client)
     GD::bl->fileDescriptorManager.shutdown(client->socketDescriptor);
 }
 
+int RpcServer::storeTlsSession(void* userData, gnutls_datum_t key, gnutls_datum_t data)
+{
+    try
+    {
+        RpcServer* server = (RpcServer*)userData;
+        if(!server || !key.data || key.size == 0 || !data.data) return -1;
+        std::string sessionId((char*)key.data, key.size);
+        int64_t time = BaseLib::HelperFunctions::getTimeSeconds();
+
+        std::lock_guard<std::mutex> tlsSessionCacheGuard(server->_tlsSessionCacheMutex);
+        if(server->_tlsSessionCache.size() >= TLS_SESSION_CACHE_SIZE)
+        {
+            auto oldestEntry = server->_tlsSessionCache.end();
+            for(auto i = server->_tlsSessionCache.begin(); i != server->_tlsSessionCache.end();)
+            {
+                if(time - i->second.first > TLS_SESSION_EXPIRATION) i = server->_tlsSessionCache.erase(i);
+                else
+                {
+                    if(oldestEntry == server->_tlsSessionCache.end() || i->second.first < oldestEntry->second.first) oldestEntry = i;
+                    ++i;
+                }
+            }
+            if(server->_tlsSessionCache.size() >= TLS_SESSION_CACHE_SIZE && oldestEntry != server->_tlsSessionCache.end()) server->_tlsSessionCache.erase(oldestEntry);
+        }
+        auto& entry = server->_tlsSessionCache[sessionId];
+        entry.first = time;
+        entry.second.assign(data.data, data.data + data.size);
+        return 0;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return -1;
+}
+
+gnutls_datum_t RpcServer::retrieveTlsSession(void* userData, gnutls_datum_t key)
+{
+    gnutls_datum_t result{nullptr, 0};
+    try
+    {
+        RpcServer* server = (RpcServer*)userData;
+        if(!server || !key.data || key.size == 0) return result;
+        std::string sessionId((char*)key.data, key.size);
+
+        std::lock_guard<std::mutex> tlsSessionCacheGuard(server->_tlsSessionCacheMutex);
+        auto entryIterator = server->_tlsSessionCache.find(sessionId);
+        if(entryIterator == server->_tlsSessionCache.end()) return result;
+        if(BaseLib::HelperFunctions::getTimeSeconds() - entryIterator->second.first > TLS_SESSION_EXPIRATION || entryIterator->second.second.empty())
+        {
+            server->_tlsSessionCache.erase(entryIterator);
+            return result;
+        }
+        //GnuTLS frees the returned data with gnutls_free.
+        result.data = (unsigned char*)gnutls_malloc(entryIterator->second.second.size());
+        if(!result.data) return result;
+        memcpy(result.data, entryIterator->second.second.data(), entryIterator->second.second.size());
+        result.size = entryIterator->second.second.size();
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return result;
+}
+
+int RpcServer::removeTlsSession(void* userData, gnutls_datum_t key)
+{
+    try
+    {
+        RpcServer* server = (RpcServer*)userData;
+        if(!server || !key.data || key.size == 0) return -1;
+        std::string sessionId((char*)key.data, key.size);
+
+        std::lock_guard<std::mutex> tlsSessionCacheGuard(server->_tlsSessionCacheMutex);
+        return server->_tlsSessionCache.erase(sessionId) > 0 ? 0 : -1;
+    }
+    catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return -1;
+}
+
+BaseLib::PVariable RpcServer::getTlsMetrics()
+{
+    try
+    {
+        uint64_t fullHandshakes = _tlsFullHandshakes;
+        uint64_t resumedHandshakes = _tlsResumedHandshakes;
+        uint64_t failedHandshakes = _tlsFailedHandshakes;
+        uint64_t handshakes = fullHandshakes + resumedHandshakes + failedHandshakes;
+        double seconds = (double)(BaseLib::HelperFunctions::getTime() - _tlsMetricsStartTime) / 1000.0;
+        if(seconds < 1) seconds = 1;
+        size_t cachedSessions = 0;
+        {
+            std::lock_guard<std::mutex> tlsSessionCacheGuard(_tlsSessionCacheMutex);
+            cachedSessions = _tlsSessionCache.size();
+        }
+
+        BaseLib::PVariable metrics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+        metrics->structValue->emplace("port", std::make_shared<BaseLib::Variable>((int32_t)_info->port));
+        metrics->structValue->emplace("ssl", std::make_shared<BaseLib::Variable>(_info->ssl));
+        metrics->structValue->emplace("fullHandshakes", std::make_shared<BaseLib::Variable>((int64_t)fullHandshakes));
+        metrics->structValue->emplace("resumedHandshakes", std::make_shared<BaseLib::Variable>((int64_t)resumedHandshakes));
+        metrics->structValue->emplace("failedHandshakes", std::make_shared<BaseLib::Variable>((int64_t)failedHandshakes));
+        metrics->structValue->emplace("handshakesPerSecond", std::make_shared<BaseLib::Variable>((double)handshakes / seconds));
+        metrics->structValue->emplace("resumptionRatio", std::make_shared<BaseLib::Variable>(fullHandshakes + resumedHandshakes > 0 ? (double)resumedHandshakes / (double)(fullHandshakes + resumedHandshakes) : 0.0));
+        metrics->structValue->emplace("averageHandshakeTime", std::make_shared<BaseLib::Variable>((int64_t)(handshakes > 0 ? _tlsHandshakeTime / handshakes : 0)));
+        metrics->structValue->emplace("cachedSessions", std::make_shared<BaseLib::Variable>((int64_t)cachedSessions));
+        metrics->structValue->emplace("sessionTickets", std::make_shared<BaseLib::Variable>(_sessionTicketKey.data != nullptr));
+        return metrics;
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 void RpcServer::getSocketDescriptor()
 {
     try
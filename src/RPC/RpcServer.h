@@ -35,6 +35,9 @@
 #include "RPCMethods.h"
 #include "Auth.h"
 #include "RestServer.h"
+#include "RpcElementEncoder.h"
+#include "WebSocketCompression.h"
+#include "RpcMetrics.h"
 #include "../WebServer/WebServer.h"
 #include <homegear-base/BaseLib.h>
 
@@ -44,6 +47,9 @@
 #include <list>
 #include <mutex>
 #include <memory>
+#include <map>
+#include <unordered_map>
+#include <atomic>
 
 #include <gnutls/gnutls.h>
 
@@ -61,7 +67,10 @@ public:
 	public:
 		bool webSocketClient = false;
 		bool webSocketAuthorized = false;
+		bool webSocketCompression = false;
+		int32_t webSocketWindowBits = 15;
 		bool nodeClient = false;
+		bool http11 = false;
 		std::thread readThread;
 		std::shared_ptr<Auth> auth;
 
@@ -115,14 +124,47 @@ public:
 
 	void removeWebserverEventHandler(BaseLib::PEventHandler eventHandler);
 
+	/**
+	 * Returns the number of full, resumed and failed TLS handshakes together with the handshake rate and the resumption ratio.
+	 */
+	BaseLib::PVariable getTlsMetrics();
+
 protected:
 private:
+	/**
+	 * Array responses with at least this number of elements are encoded and sent element by element.
+	 */
+	static const size_t STREAMING_RESPONSE_THRESHOLD = 500;
+
+	/**
+	 * The size of the data written to the socket at once when streaming responses.
+	 */
+	static const size_t STREAMING_CHUNK_SIZE = 65536;
+
+	/**
+	 * The maximum number of TLS sessions kept for session resumption.
+	 */
+	static const size_t TLS_SESSION_CACHE_SIZE = 1000;
+
+	/**
+	 * The time in seconds TLS sessions and session tickets can be resumed.
+	 */
+	static const uint32_t TLS_SESSION_EXPIRATION = 3600;
+
 	BaseLib::Output _out;
 	static int32_t _currentClientID;
 	BaseLib::Rpc::PServerInfo _info;
 	gnutls_certificate_credentials_t _x509Cred = nullptr;
 	gnutls_priority_t _tlsPriorityCache = nullptr;
 	gnutls_dh_params_t _dhParams = nullptr;
+	gnutls_datum_t _sessionTicketKey{nullptr, 0};
+	std::mutex _tlsSessionCacheMutex;
+	std::map<std::string, std::pair<int64_t, std::vector<uint8_t>>> _tlsSessionCache;
+	std::atomic<uint64_t> _tlsFullHandshakes;
+	std::atomic<uint64_t> _tlsResumedHandshakes;
+	std::atomic<uint64_t> _tlsFailedHandshakes;
+	std::atomic<uint64_t> _tlsHandshakeTime;
+	int64_t _tlsMetricsStartTime = 0;
 	int32_t _threadPolicy = SCHED_OTHER;
 	int32_t _threadPriority = 0;
 	std::atomic_bool _stopServer;
@@ -135,11 +177,17 @@ private:
 	std::mutex _stateMutex;
 	std::map<int32_t, std::shared_ptr<Client>> _clients;
 	std::shared_ptr<std::map<std::string, std::shared_ptr<BaseLib::Rpc::RpcMethod>>> _rpcMethods;
+
+	/**
+	 * The metrics entries of all methods in _rpcMethods indexed by transport. Filled in the constructor and read only afterwards.
+	 */
+	std::unordered_map<std::string, std::vector<RpcMetrics::PMethodMetrics>> _rpcMethodMetrics;
 	std::unique_ptr<BaseLib::Rpc::RpcDecoder> _rpcDecoder;
 	std::unique_ptr<BaseLib::Rpc::RpcDecoder> _rpcDecoderAnsi;
 	std::unique_ptr<BaseLib::Rpc::RpcEncoder> _rpcEncoder;
 	std::unique_ptr<BaseLib::Rpc::XmlrpcDecoder> _xmlRpcDecoder;
 	std::unique_ptr<BaseLib::Rpc::XmlrpcEncoder> _xmlRpcEncoder;
+	std::unique_ptr<RpcElementEncoder> _elementEncoder;
 	std::unique_ptr<BaseLib::Rpc::JsonDecoder> _jsonDecoder;
 	std::unique_ptr<BaseLib::Rpc::JsonEncoder> _jsonEncoder;
 	std::unique_ptr<WebServer::WebServer> _webServer;
@@ -148,6 +196,9 @@ private:
 	std::pair<int64_t, bool> _lifetick1;
 	std::mutex _lifetick2Mutex;
 	std::pair<int64_t, bool> _lifetick2;
+	std::mutex _encodedSnapshotMutex;
+	BaseLib::PVariable _encodedSnapshot;
+	std::map<int32_t, std::shared_ptr<const std::vector<char>>> _encodedSnapshotData;
 
 	void collectGarbage();
 
@@ -157,6 +208,12 @@ private:
 
 	void getSSLSocketDescriptor(std::shared_ptr<Client>);
 
+	// {{{ TLS session cache callbacks
+	static int storeTlsSession(void* userData, gnutls_datum_t key, gnutls_datum_t data);
+	static gnutls_datum_t retrieveTlsSession(void* userData, gnutls_datum_t key);
+	static int removeTlsSession(void* userData, gnutls_datum_t key);
+	// }}}
+
 	void mainThread();
 
 	void readClient(std::shared_ptr<Client> client);
@@ -165,6 +222,40 @@ private:
 
 	void sendRPCResponseToClient(std::shared_ptr<Client> client, std::vector<char>& data, bool keepAlive);
 
+	/**
+	 * Encodes a value snapshot returned by FamilyController::getValuesSnapshot(). The encoded data is shared by all responses until the
+	 * snapshot is replaced.
+	 */
+	std::shared_ptr<const std::vector<char>> getEncodedSnapshot(BaseLib::PVariable& variable, PacketType::Enum encoding);
+
+	/**
+	 * Sends a value snapshot. The encoded snapshot is written to the socket in chunks of STREAMING_CHUNK_SIZE bytes directly from the
+	 * shared buffer, so it is never copied per response. Only compressed WebSocket responses need their own copy.
+	 *
+	 * @return Returns false when "variable" is no copy of a snapshot. In this case nothing was sent.
+	 */
+	bool sendSnapshotResponseToClient(std::shared_ptr<Client> client, BaseLib::PVariable& variable, int32_t messageId, PacketType::Enum responseType, bool keepAlive);
+
+	/**
+	 * Sends large array responses without encoding the complete response into one buffer. Every array element is encoded on
+	 * its own and the data is written to the socket in chunks of STREAMING_CHUNK_SIZE bytes. HTTP responses use chunked transfer
+	 * encoding. As binary RPC packets need the packet size in the header, binary responses are encoded twice: Once to calculate
+	 * the size and once to send the data.
+	 *
+	 * @return Returns false when the response can't be streamed. In this case nothing was sent.
+	 */
+	bool sendStreamedRPCResponseToClient(std::shared_ptr<Client> client, BaseLib::PVariable& variable, int32_t messageId, PacketType::Enum responseType, bool keepAlive);
+
+	/**
+	 * Prints a response or a part of it at debug level 5 the same way sendRPCResponseToClient() does.
+	 */
+	void printResponse(PacketType::Enum responseType, const char* data, size_t size);
+
+	/**
+	 * Encodes one array element for sendStreamedRPCResponseToClient().
+	 */
+	bool encodeStreamElement(BaseLib::PVariable& element, PacketType::Enum responseType, std::vector<char>& data);
+
 	void packetReceived(std::shared_ptr<Client> client, std::vector<char>& packet, PacketType::Enum packetType, bool keepAlive);
 
 	void handleConnectionUpgrade(std::shared_ptr<Client> client, BaseLib::Http& http);
@@ -175,8 +266,19 @@ private:
 
 	void callMethod(std::shared_ptr<Client> client, std::string methodName, std::shared_ptr<std::vector<BaseLib::PVariable>> parameters, int32_t messageId, PacketType::Enum responseType, bool keepAlive);
 
+	static RpcMetrics::Transport getMetricsTransport(PacketType::Enum responseType);
+
+	void recordMetrics(const std::string& methodName, RpcMetrics::Transport transport, int64_t latency, bool error);
+
+	/**
+	 * Answers "GET /metrics" with the RPC metrics in the Prometheus text format.
+	 */
+	void sendMetrics(std::shared_ptr<Client> client, bool keepAlive);
+
 	std::string getHttpResponseHeader(std::string contentType, uint32_t contentLength, bool closeConnection);
 
+	std::string getChunkedHttpResponseHeader(std::string contentType, bool closeConnection);
+
 	void closeClientConnection(std::shared_ptr<Client> client);
 
 	bool clientValid(std::shared_ptr<Client>& client);
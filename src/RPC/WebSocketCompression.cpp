@@ -0,0 +1,282 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "WebSocketCompression.h"
+#include "../GD/GD.h"
+
+#include <zlib.h>
+
+#include <set>
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+/**
+ * The deflate stream of the current thread. Initializing a stream allocates about 256 KiB, so it is reused for all messages
+ * with the same window size.
+ */
+struct DeflateStream
+{
+	z_stream stream{};
+	int32_t windowBits = 0;
+
+	~DeflateStream()
+	{
+		if(windowBits != 0) deflateEnd(&stream);
+	}
+};
+
+static thread_local DeflateStream _deflateStream;
+
+bool WebSocketCompression::negotiate(BaseLib::Http& http, int32_t& serverWindowBits)
+{
+	try
+	{
+		serverWindowBits = 15;
+		auto extensionsIterator = http.getHeader().fields.find("sec-websocket-extensions");
+		if(extensionsIterator == http.getHeader().fields.end()) return false;
+		std::string extensions = extensionsIterator->second;
+		BaseLib::HelperFunctions::toLower(extensions);
+
+		//The offers are separated by ",", the parameters of an offer by ";". The offers are ordered by preference.
+		std::vector<std::string> offers = BaseLib::HelperFunctions::splitAll(extensions, ',');
+		for(auto& offer : offers)
+		{
+			std::vector<std::string> parameters = BaseLib::HelperFunctions::splitAll(offer, ';');
+			for(auto& parameter : parameters)
+			{
+				BaseLib::HelperFunctions::trim(parameter);
+			}
+			if(parameters.empty() || parameters.front() != "permessage-deflate") continue;
+			parameters.erase(parameters.begin());
+			if(acceptOffer(parameters, serverWindowBits)) return true;
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	serverWindowBits = 15;
+	return false;
+}
+
+bool WebSocketCompression::acceptOffer(const std::vector<std::string>& parameters, int32_t& serverWindowBits)
+{
+	std::set<std::string> names;
+	int32_t windowBits = 15;
+	for(auto& parameter : parameters)
+	{
+		if(parameter.empty()) continue;
+		std::pair<std::string, std::string> nameValue = BaseLib::HelperFunctions::splitFirst(parameter, '=');
+		BaseLib::HelperFunctions::trim(nameValue.first);
+		BaseLib::HelperFunctions::trim(nameValue.second);
+		if(nameValue.second.size() >= 2 && nameValue.second.front() == '"' && nameValue.second.back() == '"') nameValue.second = nameValue.second.substr(1, nameValue.second.size() - 2);
+		if(!names.insert(nameValue.first).second) return false; //RFC 7692 7: An offer with duplicate parameters must be declined.
+
+		if(nameValue.first == "server_no_context_takeover" || nameValue.first == "client_no_context_takeover")
+		{
+			if(!nameValue.second.empty()) return false;
+		}
+		else if(nameValue.first == "server_max_window_bits")
+		{
+			if(nameValue.second.empty() || nameValue.second.find_first_not_of("0123456789") != std::string::npos || nameValue.second.size() > 2) return false;
+			windowBits = BaseLib::Math::getNumber(nameValue.second);
+			//zlib doesn't support a window size of 256 bytes for raw deflate streams.
+			if(windowBits < 9 || windowBits > 15) return false;
+		}
+		else if(nameValue.first == "client_max_window_bits")
+		{
+			//Messages of the client are always inflated with the maximum window size, so any limit is fine.
+			if(nameValue.second.empty()) continue;
+			if(nameValue.second.find_first_not_of("0123456789") != std::string::npos || nameValue.second.size() > 2) return false;
+			int32_t clientWindowBits = BaseLib::Math::getNumber(nameValue.second);
+			if(clientWindowBits < 8 || clientWindowBits > 15) return false;
+		}
+		else return false;
+	}
+	serverWindowBits = windowBits;
+	return true;
+}
+
+std::string WebSocketCompression::getResponseHeader(int32_t serverWindowBits)
+{
+	std::string header = "Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover; client_no_context_takeover";
+	if(serverWindowBits < 15) header.append("; server_max_window_bits=" + std::to_string(serverWindowBits));
+	header.append("\r\n");
+	return header;
+}
+
+void WebSocketCompression::encode(std::vector<char>& data, BaseLib::WebSocket::Header::Opcode::Enum messageType, std::vector<char>& output, int32_t windowBits)
+{
+	try
+	{
+		output.clear();
+
+		z_stream& stream = _deflateStream.stream;
+		if(_deflateStream.windowBits != windowBits)
+		{
+			if(_deflateStream.windowBits != 0) deflateEnd(&stream);
+			stream = z_stream{};
+			_deflateStream.windowBits = 0;
+			if(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+			{
+				GD::out.printError("Error: Could not initialize deflate.");
+				BaseLib::WebSocket::encode(data, messageType, output);
+				return;
+			}
+			_deflateStream.windowBits = windowBits;
+		}
+		else if(deflateReset(&stream) != Z_OK)
+		{
+			GD::out.printError("Error: Could not reset deflate.");
+			BaseLib::WebSocket::encode(data, messageType, output);
+			return;
+		}
+
+		std::vector<char> compressedData(deflateBound(&stream, data.size()) + 16);
+		stream.next_in = (Bytef*)data.data();
+		stream.avail_in = (uInt)data.size();
+		stream.next_out = (Bytef*)compressedData.data();
+		stream.avail_out = (uInt)compressedData.size();
+		int result = deflate(&stream, Z_SYNC_FLUSH);
+		size_t compressedSize = compressedData.size() - stream.avail_out;
+		if(result != Z_OK || stream.avail_in != 0)
+		{
+			GD::out.printError("Error: Could not compress WebSocket message.");
+			BaseLib::WebSocket::encode(data, messageType, output);
+			return;
+		}
+		//RFC 7692 7.2.1: Remove the empty block added by the sync flush.
+		if(compressedSize >= 4) compressedSize -= 4;
+
+		output.reserve(compressedSize + 10);
+		output.push_back((char)(0x80 | 0x40 | ((uint8_t)messageType & 0x0F))); //FIN, RSV1 and opcode
+		if(compressedSize < 126) output.push_back((char)compressedSize);
+		else if(compressedSize <= 0xFFFF)
+		{
+			output.push_back(126);
+			output.push_back((char)(uint8_t)(compressedSize >> 8));
+			output.push_back((char)(uint8_t)compressedSize);
+		}
+		else
+		{
+			output.push_back(127);
+			for(int32_t i = 7; i >= 0; i--)
+			{
+				output.push_back((char)(uint8_t)((uint64_t)compressedSize >> (i * 8)));
+			}
+		}
+		output.insert(output.end(), compressedData.begin(), compressedData.begin() + compressedSize);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+bool WebSocketCompression::decompress(std::vector<char>& data)
+{
+	try
+	{
+		z_stream stream{};
+		if(inflateInit2(&stream, -15) != Z_OK) return false;
+
+		//RFC 7692 7.2.2: Append the empty block removed by the sender.
+		data.push_back(0);
+		data.push_back(0);
+		data.push_back((char)0xFF);
+		data.push_back((char)0xFF);
+
+		std::vector<char> decompressedData;
+		std::vector<char> buffer(16384);
+		stream.next_in = (Bytef*)data.data();
+		stream.avail_in = (uInt)data.size();
+		int result = Z_OK;
+		do
+		{
+			stream.next_out = (Bytef*)buffer.data();
+			stream.avail_out = (uInt)buffer.size();
+			result = inflate(&stream, Z_SYNC_FLUSH);
+			if(result == Z_BUF_ERROR && stream.avail_in == 0) //No more input and all output already returned
+			{
+				result = Z_OK;
+				break;
+			}
+			if(result != Z_OK && result != Z_STREAM_END) break;
+			decompressedData.insert(decompressedData.end(), buffer.begin(), buffer.begin() + (buffer.size() - stream.avail_out));
+			if(decompressedData.size() > 104857600) //Same limit as for HTTP packets
+			{
+				result = Z_MEM_ERROR;
+				break;
+			}
+		} while((stream.avail_in > 0 || stream.avail_out == 0) && result != Z_STREAM_END);
+		inflateEnd(&stream);
+
+		if(result != Z_OK && result != Z_STREAM_END) return false;
+		data.swap(decompressedData);
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return false;
+}
+
+}
+
+}
@@ -0,0 +1,101 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef WEBSOCKETCOMPRESSION_H_
+#define WEBSOCKETCOMPRESSION_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <string>
+#include <vector>
+
+namespace Homegear
+{
+
+namespace Rpc
+{
+
+/**
+ * Implements the WebSocket extension "permessage-deflate" (RFC 7692). Context takeover is disabled in both directions, so
+ * every message is compressed independently. The deflate stream is kept per thread and reset for every message.
+ */
+class WebSocketCompression
+{
+public:
+	/**
+	 * Parses the "permessage-deflate" offers of the client's upgrade request and accepts the first one whose parameters are
+	 * supported.
+	 *
+	 * @param http The upgrade request.
+	 * @param[out] serverWindowBits The window size (as base 2 logarithm) to compress with. Lower than 15 when the client
+	 * restricted it with "server_max_window_bits".
+	 * @return Returns true when an offer was accepted.
+	 */
+	static bool negotiate(BaseLib::Http& http, int32_t& serverWindowBits);
+
+	/**
+	 * Returns the "Sec-WebSocket-Extensions" header line to accept the offer selected by negotiate().
+	 */
+	static std::string getResponseHeader(int32_t serverWindowBits);
+
+	/**
+	 * Checks the RSV1 bit of a frame.
+	 *
+	 * @param frameStart The first byte of the frame.
+	 */
+	static bool isCompressed(const char* frameStart) { return (frameStart[0] & 0x40) != 0; }
+
+	/**
+	 * Compresses "data" and encodes it into a single unmasked WebSocket frame with RSV1 set.
+	 *
+	 * @param windowBits The window size negotiated with negotiate().
+	 */
+	static void encode(std::vector<char>& data, BaseLib::WebSocket::Header::Opcode::Enum messageType, std::vector<char>& output, int32_t windowBits = 15);
+
+	/**
+	 * Decompresses the payload of a compressed message.
+	 *
+	 * @return Returns false on error.
+	 */
+	static bool decompress(std::vector<char>& data);
+private:
+	WebSocketCompression() = delete;
+
+	/**
+	 * Checks the parameters of one offer (the part after "permessage-deflate").
+	 */
+	static bool acceptOffer(const std::vector<std::string>& parameters, int32_t& serverWindowBits);
+};
+
+}
+
+}
+
+#endif
@@ -37,11 +37,16 @@ namespace Homegear
 
 std::mutex PhpEvents::eventsMapMutex;
 std::map<int32_t, std::shared_ptr<PhpEvents>> PhpEvents::eventsMap;
+std::mutex PhpEvents::_subscribersMutex;
+std::unordered_map<uint64_t, std::set<int32_t>> PhpEvents::_subscribers;
 
-PhpEvents::PhpEvents(std::string& token, std::function<void(std::string output, bool error)>& outputCallback, std::function<BaseLib::PVariable(std::string methodName, BaseLib::PVariable parameters, bool wait)>& rpcCallback)
+PhpEvents::PhpEvents(int32_t scriptId, std::string& token, std::function<void(std::string output, bool error)>& outputCallback, std::function<BaseLib::PVariable(std::string methodName, BaseLib::PVariable parameters, bool wait)>& rpcCallback)
 {
+	_scriptId = scriptId;
 	_stopProcessing = false;
-	_bufferCount = 0;
+	_queueSize = DEFAULT_QUEUE_SIZE;
+	_deliveredEvents = 0;
+	_droppedEvents = 0;
 	_token = token;
 	_outputCallback = outputCallback;
 	_rpcCallback = rpcCallback;
@@ -50,6 +55,60 @@ PhpEvents::PhpEvents(std::string& token, std::function<void(std::string output,
 PhpEvents::~PhpEvents()
 {
 	stop();
+
+	try
+	{
+		std::lock_guard<std::mutex> peersGuard(_peersMutex);
+		std::lock_guard<std::mutex> subscribersGuard(_subscribersMutex);
+		for(auto& peer : _peers)
+		{
+			auto subscribersIterator = _subscribers.find(peer.first);
+			if(subscribersIterator == _subscribers.end()) continue;
+			subscribersIterator->second.erase(_scriptId);
+			if(subscribersIterator->second.empty()) _subscribers.erase(subscribersIterator);
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(const BaseLib::Exception& ex)
+	{
+		GD::bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void PhpEvents::getSubscribers(uint64_t peerId, std::vector<std::shared_ptr<PhpEvents>>& subscribers)
+{
+	try
+	{
+		std::lock_guard<std::mutex> eventsMapGuard(eventsMapMutex);
+		std::lock_guard<std::mutex> subscribersGuard(_subscribersMutex);
+		auto subscribersIterator = _subscribers.find(peerId);
+		if(subscribersIterator == _subscribers.end()) return;
+		subscribers.reserve(subscribersIterator->second.size());
+		for(auto scriptId : subscribersIterator->second)
+		{
+			auto eventsIterator = eventsMap.find(scriptId);
+			if(eventsIterator != eventsMap.end() && eventsIterator->second) subscribers.push_back(eventsIterator->second);
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(const BaseLib::Exception& ex)
+	{
+		GD::bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
 }
 
 void PhpEvents::stop()
@@ -64,16 +123,17 @@ bool PhpEvents::enqueue(std::shared_ptr<EventData>& entry)
 	try
 	{
 		if(!entry || _stopProcessing) return false;
-		std::unique_lock<std::mutex> lock(_queueMutex);
-		if(_stopProcessing) return true;
+		{
+			std::lock_guard<std::mutex> lock(_queueMutex);
+			if(_stopProcessing) return true;
 
-		if(_bufferCount >= _bufferSize) return false;
+			if((signed)_queue.size() >= _queueSize)
+			{
+				_droppedEvents++;
+				return false;
+			}
 
-		{
-			std::lock_guard<std::mutex> bufferGuard(_bufferMutex);
-			_buffer[_bufferTail] = entry;
-			_bufferTail = (_bufferTail + 1) % _bufferSize;
-			++_bufferCount;
+			_queue.push_back(entry);
 		}
 
 		_processingConditionVariable.notify_one();
@@ -101,18 +161,89 @@ std::shared_ptr<PhpEvents::EventData> PhpEvents::poll(int32_t timeout)
 	if(_stopProcessing) return eventData;
 	try
 	{
+		std::unique_lock<std::mutex> lock(_queueMutex);
+
+		if(!_processingConditionVariable.wait_for(lock, std::chrono::milliseconds(timeout), [&] { return !_queue.empty() || _stopProcessing; })) return eventData;
+		if(_stopProcessing) return eventData;
+
+		eventData = std::move(_queue.front());
+		_queue.pop_front();
+		_deliveredEvents++;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(const BaseLib::Exception& ex)
+	{
+		GD::bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return eventData;
+}
+
+std::vector<std::shared_ptr<PhpEvents::EventData>> PhpEvents::pollMultiple(int32_t maxCount, int32_t timeout)
+{
+	if(timeout < 1) timeout = 10000;
+	std::vector<std::shared_ptr<EventData>> events;
+	if(_stopProcessing || maxCount < 1) return events;
+	try
+	{
+		std::unique_lock<std::mutex> lock(_queueMutex);
+
+		if(!_processingConditionVariable.wait_for(lock, std::chrono::milliseconds(timeout), [&] { return !_queue.empty() || _stopProcessing; })) return events;
+		if(_stopProcessing) return events;
+
+		size_t count = std::min((size_t)maxCount, _queue.size());
+		events.reserve(count);
+		for(size_t i = 0; i < count; i++)
 		{
-			std::unique_lock<std::mutex> lock(_queueMutex);
+			events.push_back(std::move(_queue.front()));
+			_queue.pop_front();
+		}
+		_deliveredEvents += count;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(const BaseLib::Exception& ex)
+	{
+		GD::bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return events;
+}
 
-			if(!_processingConditionVariable.wait_for(lock, std::chrono::milliseconds(timeout), [&] { return _bufferCount > 0 || _stopProcessing; })) return eventData;
-			if(_stopProcessing) return eventData;
+void PhpEvents::setQueueSize(int32_t size)
+{
+	if(size < 1) size = DEFAULT_QUEUE_SIZE;
+	else if(size > MAX_QUEUE_SIZE) size = MAX_QUEUE_SIZE;
+	_queueSize = size;
+}
 
-			std::lock_guard<std::mutex> bufferGuard(_bufferMutex);
-			eventData = _buffer[_bufferHead];
-			_buffer[_bufferHead].reset();
-			_bufferHead = (_bufferHead + 1) % _bufferSize;
-			--_bufferCount;
+BaseLib::PVariable PhpEvents::getStatistics()
+{
+	try
+	{
+		BaseLib::PVariable statistics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+		size_t queued = 0;
+		{
+			std::lock_guard<std::mutex> lock(_queueMutex);
+			queued = _queue.size();
 		}
+		statistics->structValue->emplace("queueSize", std::make_shared<BaseLib::Variable>(_queueSize.load()));
+		statistics->structValue->emplace("maxQueueSize", std::make_shared<BaseLib::Variable>((int32_t)MAX_QUEUE_SIZE));
+		statistics->structValue->emplace("queued", std::make_shared<BaseLib::Variable>((uint64_t)queued));
+		statistics->structValue->emplace("delivered", std::make_shared<BaseLib::Variable>((uint64_t)_deliveredEvents));
+		statistics->structValue->emplace("dropped", std::make_shared<BaseLib::Variable>((uint64_t)_droppedEvents));
+		return statistics;
 	}
 	catch(const std::exception& ex)
 	{
@@ -126,7 +257,7 @@ std::shared_ptr<PhpEvents::EventData> PhpEvents::poll(int32_t timeout)
 	{
 		GD::bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
 	}
-	return eventData;
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
 void PhpEvents::addPeer(uint64_t peerId, int32_t channel, std::string& variable)
@@ -136,6 +267,9 @@ void PhpEvents::addPeer(uint64_t peerId, int32_t channel, std::string& variable)
 		std::lock_guard<std::mutex> peersGuard(_peersMutex);
 		if(channel > -1 && !variable.empty()) _peers[peerId][channel].insert(variable);
 		else _peers.emplace(std::make_pair(peerId, std::map<int32_t, std::set<std::string>>()));
+
+		std::lock_guard<std::mutex> subscribersGuard(_subscribersMutex);
+		_subscribers[peerId].insert(_scriptId);
 	}
 	catch(const std::exception& ex)
 	{
@@ -158,10 +292,21 @@ void PhpEvents::removePeer(uint64_t peerId, int32_t channel, std::string& variab
 		std::lock_guard<std::mutex> peersGuard(_peersMutex);
 		if(channel > -1 && !variable.empty())
 		{
-			_peers[peerId][channel].erase(variable);
-			if(_peers[peerId][channel].empty()) _peers[peerId].erase(channel);
+			auto peerIterator = _peers.find(peerId);
+			if(peerIterator == _peers.end()) return;
+			peerIterator->second[channel].erase(variable);
+			if(peerIterator->second[channel].empty()) peerIterator->second.erase(channel);
+		}
+		else
+		{
+			if(_peers.erase(peerId) == 0) return;
+
+			std::lock_guard<std::mutex> subscribersGuard(_subscribersMutex);
+			auto subscribersIterator = _subscribers.find(peerId);
+			if(subscribersIterator == _subscribers.end()) return;
+			subscribersIterator->second.erase(_scriptId);
+			if(subscribersIterator->second.empty()) _subscribers.erase(subscribersIterator);
 		}
-		else _peers.erase(peerId);
 	}
 	catch(const std::exception& ex)
 	{
@@ -33,6 +33,11 @@
 
 #ifndef NO_SCRIPTENGINE
 
+#include <homegear-base/BaseLib.h>
+
+#include <deque>
+#include <unordered_map>
+
 namespace Homegear
 {
 
@@ -52,10 +57,28 @@ public:
 		BaseLib::PVariable value;
 	};
 
+	/**
+	 * The number of events queued per script unless the script calls "setEventQueueSize".
+	 */
+	static const int32_t DEFAULT_QUEUE_SIZE = 1000;
+
+	/**
+	 * The maximum number of events a script can request to be queued.
+	 */
+	static const int32_t MAX_QUEUE_SIZE = 100000;
+
 	static std::mutex eventsMapMutex;
 	static std::map<int32_t, std::shared_ptr<PhpEvents>> eventsMap;
 
-	PhpEvents(std::string& token, std::function<void(std::string output, bool error)>& outputCallback, std::function<BaseLib::PVariable(std::string methodName, BaseLib::PVariable parameters, bool wait)>& rpcCallback);
+	/**
+	 * Returns the event objects of all scripts subscribed to a peer, so events only need to be passed to these. Locks "eventsMapMutex".
+	 *
+	 * @param peerId The ID of the peer the event is from.
+	 * @param[out] subscribers Filled with the subscribed event objects.
+	 */
+	static void getSubscribers(uint64_t peerId, std::vector<std::shared_ptr<PhpEvents>>& subscribers);
+
+	PhpEvents(int32_t scriptId, std::string& token, std::function<void(std::string output, bool error)>& outputCallback, std::function<BaseLib::PVariable(std::string methodName, BaseLib::PVariable parameters, bool wait)>& rpcCallback);
 
 	virtual ~PhpEvents();
 
@@ -65,6 +88,27 @@ public:
 
 	std::shared_ptr<EventData> poll(int32_t timeout = -1);
 
+	/**
+	 * Waits for at least one event and then returns up to "maxCount" queued events at once.
+	 *
+	 * @param maxCount The maximum number of events to return.
+	 * @param timeout The maximum time to wait in milliseconds.
+	 * @return The events in the order they were queued. Empty on timeout.
+	 */
+	std::vector<std::shared_ptr<EventData>> pollMultiple(int32_t maxCount, int32_t timeout = -1);
+
+	/**
+	 * Sets the maximum number of queued events. Already queued events are kept.
+	 */
+	void setQueueSize(int32_t size);
+
+	int32_t getQueueSize() { return _queueSize; }
+
+	/**
+	 * Returns the queue size, the number of currently queued, delivered and dropped events.
+	 */
+	BaseLib::PVariable getStatistics();
+
 	void addPeer(uint64_t peerId, int32_t channel, std::string& variable);
 
 	void removePeer(uint64_t peerId, int32_t channel, std::string& variable);
@@ -95,14 +139,16 @@ private:
 	int32_t _logLevel = -1;
 	// }}}
 
+	static std::mutex _subscribersMutex;
+	static std::unordered_map<uint64_t, std::set<int32_t>> _subscribers;
+
+	int32_t _scriptId = 0;
 	std::atomic_bool _stopProcessing;
-	static const int32_t _bufferSize = 1000;
 	std::mutex _queueMutex;
-	int32_t _bufferHead = 0;
-	int32_t _bufferTail = 0;
-	std::atomic_int _bufferCount;
-	std::mutex _bufferMutex;
-	std::shared_ptr<EventData> _buffer[_bufferSize];
+	std::atomic_int _queueSize;
+	std::deque<std::shared_ptr<EventData>> _queue;
+	std::atomic<uint64_t> _deliveredEvents;
+	std::atomic<uint64_t> _droppedEvents;
 	std::condition_variable _processingConditionVariable;
 	std::mutex _peersMutex;
 	std::map<uint64_t, std::map<int32_t, std::set<std::string>>> _peers;
@@ -52,6 +52,7 @@ BaseLib::PVariable PhpVariableConverter::getVariable(zval* value, bool arraysAre
 	{
 		BaseLib::PVariable variable;
 		if(!value) return variable;
+		ZVAL_DEREF(value);
 		if(Z_TYPE_P(value) == IS_LONG)
 		{
 			variable.reset(new BaseLib::Variable(Z_LVAL_P(value)));
@@ -71,59 +72,58 @@ BaseLib::PVariable PhpVariableConverter::getVariable(zval* value, bool arraysAre
 		}
 		else if(Z_TYPE_P(value) == IS_STRING)
 		{
-			if(Z_STRLEN_P(value) > 0) variable.reset(new BaseLib::Variable(std::string(Z_STRVAL_P(value), Z_STRLEN_P(value))));
-			else variable.reset(new BaseLib::Variable(std::string("")));
+			//Copy the string only once directly into the variable. Constructing the variable from a temporary string copies large payloads twice.
+			variable = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tString);
+			if(Z_STRLEN_P(value) > 0) variable->stringValue.assign(Z_STRVAL_P(value), Z_STRLEN_P(value));
 		}
 		else if(Z_TYPE_P(value) == IS_ARRAY)
 		{
 			zval* element = nullptr;
 			HashTable* ht = Z_ARRVAL_P(value);
 			zend_string* key = nullptr;
-			ulong keyIndex = 0;
-			if(zend_hash_num_elements(ht) == 0)
+			zend_ulong keyIndex = 0;
+			uint32_t elementCount = zend_hash_num_elements(ht);
+			if(elementCount == 0) return std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+
+			//Determine the type from the keys first, so the elements only need to be converted once. An array needs to have numeric keys
+			//from 0 to n - 1. Otherwise it is converted to a struct. Negative keys are checked separately, because they would wrap around in the sum.
+			bool isStruct = arraysAreStructs;
+			if(!isStruct)
+			{
+				uint64_t indexSum = 0;
+				ZEND_HASH_FOREACH_KEY(ht, keyIndex, key)
+				{
+					if(key || (zend_long)keyIndex < 0)
+					{
+						isStruct = true;
+						break;
+					}
+					indexSum += keyIndex;
+				} ZEND_HASH_FOREACH_END();
+				if(!isStruct && indexSum * 2 != (uint64_t)(elementCount - 1) * elementCount) isStruct = true;
+			}
+
+			if(isStruct) variable = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+			else
 			{
-				variable.reset(new BaseLib::Variable(BaseLib::VariableType::tArray));
-				return variable;
+				variable = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+				variable->arrayValue->reserve(elementCount);
 			}
-			bool arraysAreStructsLocal = arraysAreStructs;
-			for(int32_t i = 0; i < 2; i++)
+
+			ZEND_HASH_FOREACH_KEY_VAL(ht, keyIndex, key, element)
 			{
-				int64_t indexSum = 0;
-				ZEND_HASH_FOREACH_KEY_VAL(ht, keyIndex, key, element)
-						{
-							if(!variable)
-							{
-								if(key || arraysAreStructsLocal) variable.reset(new BaseLib::Variable(BaseLib::VariableType::tStruct));
-								else
-								{
-									variable.reset(new BaseLib::Variable(BaseLib::VariableType::tArray));
-									variable->arrayValue->reserve(zend_hash_num_elements(ht));
-								}
-							}
-							BaseLib::PVariable arrayElement = getVariable(element, subArraysAreStructs, subArraysAreStructs);
-							if(!arrayElement) continue;
-							if(key || arraysAreStructsLocal)
-							{
-								std::string keyName;
-								keyName = key ? std::string(key->val, key->len) : std::to_string((int64_t) keyIndex);
-								if(keyName.size() > 1 && keyName.at(0) == '\\') keyName = keyName.substr(1);
-								variable->structValue->emplace(keyName, arrayElement);
-							}
-							else
-							{
-								if(keyIndex < 0) indexSum = -1;
-								if(indexSum >= 0) indexSum += keyIndex;
-								variable->arrayValue->push_back(arrayElement);
-							}
-						}ZEND_HASH_FOREACH_END();
-
-				if(variable->type == BaseLib::VariableType::tArray && (uint64_t) indexSum * 2 != (variable->arrayValue->size() - 1) * variable->arrayValue->size())
+				BaseLib::PVariable arrayElement = getVariable(element, subArraysAreStructs, subArraysAreStructs);
+				if(!arrayElement) continue;
+				if(isStruct)
 				{
-					arraysAreStructsLocal = true;
-					variable.reset(new BaseLib::Variable(BaseLib::VariableType::tStruct));
+					std::string keyName;
+					if(!key) keyName = std::to_string((int64_t) keyIndex);
+					else if(ZSTR_LEN(key) > 1 && ZSTR_VAL(key)[0] == '\\') keyName.assign(ZSTR_VAL(key) + 1, ZSTR_LEN(key) - 1);
+					else keyName.assign(ZSTR_VAL(key), ZSTR_LEN(key));
+					variable->structValue->emplace(std::move(keyName), std::move(arrayElement));
 				}
-				else break;
-			}
+				else variable->arrayValue->push_back(std::move(arrayElement));
+			} ZEND_HASH_FOREACH_END();
 		}
 		else
 		{
@@ -149,31 +149,36 @@ BaseLib::PVariable PhpVariableConverter::getVariable(zval* value, bool arraysAre
 
 #pragma GCC diagnostic warning "-Wunused-but-set-variable"
 
-void PhpVariableConverter::getPHPVariable(BaseLib::PVariable input, zval* output)
+void PhpVariableConverter::getPHPVariable(const BaseLib::PVariable& input, zval* output)
 {
 	try
 	{
-		if(!input || !output) return;
+		if(!output) return;
+		if(!input)
+		{
+			ZVAL_NULL(output);
+			return;
+		}
 
 		if(input->type == BaseLib::VariableType::tArray)
 		{
-			array_init(output);
-			for(std::vector<BaseLib::PVariable>::iterator i = input->arrayValue->begin(); i != input->arrayValue->end(); ++i)
+			array_init_size(output, (uint32_t)input->arrayValue->size());
+			for(auto& arrayElement : *input->arrayValue)
 			{
 				zval element;
-				getPHPVariable(*i, &element);
-				add_next_index_zval(output, &element);
+				getPHPVariable(arrayElement, &element);
+				zend_hash_next_index_insert_new(Z_ARRVAL_P(output), &element);
 			}
 			return;
 		}
 		else if(input->type == BaseLib::VariableType::tStruct)
 		{
-			array_init(output);
-			for(std::map<std::string, BaseLib::PVariable>::iterator i = input->structValue->begin(); i != input->structValue->end(); ++i)
+			array_init_size(output, (uint32_t)input->structValue->size());
+			for(auto& structElement : *input->structValue)
 			{
 				zval element;
-				getPHPVariable(i->second, &element);
-				add_assoc_zval_ex(output, i->first.c_str(), i->first.size(), &element);
+				getPHPVariable(structElement.second, &element);
+				add_assoc_zval_ex(output, structElement.first.c_str(), structElement.first.size(), &element);
 			}
 			return;
 		}
@@ -200,13 +205,13 @@ void PhpVariableConverter::getPHPVariable(BaseLib::PVariable input, zval* output
 		}
 		else if(input->type == BaseLib::VariableType::tString || input->type == BaseLib::VariableType::tBase64)
 		{
-			if(input->stringValue.empty()) ZVAL_STRINGL(output, "", 0); //At least once, input->stringValue.c_str() on an empty string was a nullptr causing a segementation fault, so check for empty string
+			if(input->stringValue.empty()) ZVAL_EMPTY_STRING(output); //At least once, input->stringValue.c_str() on an empty string was a nullptr causing a segementation fault, so check for empty string
 			else
 				ZVAL_STRINGL(output, input->stringValue.c_str(), input->stringValue.size());
 		}
 		else if(input->type == BaseLib::VariableType::tBinary)
 		{
-			if(input->binaryValue.empty()) ZVAL_STRINGL(output, "", 0); //At least once, input->stringValue.c_str() on an empty string was a nullptr causing a segementation fault, so check for empty string
+			if(input->binaryValue.empty()) ZVAL_EMPTY_STRING(output); //At least once, input->stringValue.c_str() on an empty string was a nullptr causing a segementation fault, so check for empty string
 			else
 				ZVAL_STRINGL(output, (char*) input->binaryValue.data(), input->binaryValue.size());
 		}
@@ -50,9 +50,16 @@ public:
 
 	virtual ~PhpVariableConverter();
 
+	/**
+	 * Converts a PHP value. PHP arrays are converted to arrays when their keys are 0 to n - 1 and to structs otherwise.
+	 */
 	static BaseLib::PVariable getVariable(zval* value, bool arraysAreStructs = false, bool subArraysAreStructs = false);
 
-	static void getPHPVariable(BaseLib::PVariable input, zval* output);
+	/**
+	 * Converts a variable to a PHP value. The hash tables of arrays and structs are created with their final size. The input is not modified,
+	 * so variables shared between threads (e. g. from the value cache) can be passed.
+	 */
+	static void getPHPVariable(const BaseLib::PVariable& input, zval* output);
 
 protected:
 };
@@ -0,0 +1,485 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef NO_SCRIPTENGINE
+
+#include "ScriptCache.h"
+#include "../GD/GD.h"
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace Homegear
+{
+
+namespace ScriptEngine
+{
+
+ScriptCache::ScriptCache()
+{
+	_hits = 0;
+	_misses = 0;
+	_evictions = 0;
+	_invalidations = 0;
+	_stopWatcher = false;
+	_watchLimitWarningPrinted = false;
+}
+
+ScriptCache::~ScriptCache()
+{
+	_stopWatcher = true;
+	if(_watcherThread.joinable()) _watcherThread.join();
+	if(_inotifyDescriptor != -1) close(_inotifyDescriptor);
+	clear();
+}
+
+std::shared_ptr<CacheInfo> ScriptCache::get(const std::string& path)
+{
+	try
+	{
+		uint64_t generation = 0;
+		{
+			std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+			auto cacheIterator = _cache.find(path);
+			if(cacheIterator != _cache.end() && isWatched(path))
+			{
+				_lru.splice(_lru.begin(), _lru, cacheIterator->second.lruPosition);
+				_hits++;
+				return cacheIterator->second.info;
+			}
+			generation = _generation;
+		}
+
+		int32_t lastModified = BaseLib::Io::getFileLastModifiedTime(path);
+		if(lastModified < 0) return std::shared_ptr<CacheInfo>();
+
+		{
+			std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+			auto cacheIterator = _cache.find(path);
+			if(cacheIterator != _cache.end() && cacheIterator->second.info->lastModified == lastModified)
+			{
+				_lru.splice(_lru.begin(), _lru, cacheIterator->second.lruPosition);
+				_hits++;
+				return cacheIterator->second.info;
+			}
+		}
+
+		//Load outside of the lock, so decrypting a large script doesn't block other script threads.
+		_misses++;
+		std::shared_ptr<CacheInfo> info = load(path, lastModified);
+		if(info && info->script.size() <= MAX_ENTRY_SIZE) insert(path, info, generation);
+		return info;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return std::shared_ptr<CacheInfo>();
+}
+
+std::shared_ptr<CacheInfo> ScriptCache::load(const std::string& path, int32_t lastModified)
+{
+	std::shared_ptr<CacheInfo> info = std::make_shared<CacheInfo>();
+	info->lastModified = lastModified;
+	std::vector<char> data = BaseLib::Io::getBinaryFileContent(path);
+	int32_t pos = -1;
+	for(uint32_t i = 0; i < 11 && i < data.size(); i++)
+	{
+		if(data[i] == ' ')
+		{
+			pos = (int32_t)i;
+			break;
+		}
+	}
+	if(pos == -1)
+	{
+		GD::out.printError("Error: License module id is missing in encrypted script file \"" + path + "\"");
+		return std::shared_ptr<CacheInfo>();
+	}
+	std::string moduleIdString(&data.at(0), static_cast<unsigned long>(pos));
+	int32_t moduleId = BaseLib::Math::getNumber(moduleIdString);
+	if((unsigned)pos + 1 >= data.size()) return std::shared_ptr<CacheInfo>();
+	std::vector<char> input(&data.at(static_cast<unsigned long>(pos + 1)), &data.at(data.size() - 1) + 1);
+	std::map<int32_t, std::unique_ptr<BaseLib::Licensing::Licensing>>::iterator i = GD::licensingModules.find(moduleId);
+	if(i == GD::licensingModules.end() || !i->second)
+	{
+		GD::out.printError("Error: Could not decrypt script file. Licensing module with id 0x" + BaseLib::HelperFunctions::getHexString(moduleId) + " not found");
+		return std::shared_ptr<CacheInfo>();
+	}
+	i->second->decryptScript(input, info->script);
+	if(info->script.empty()) return std::shared_ptr<CacheInfo>();
+	return info;
+}
+
+void ScriptCache::insert(const std::string& path, std::shared_ptr<CacheInfo>& info, uint64_t generation)
+{
+	std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+	if(generation != _generation) return; //Something changed while the file was loaded. It might be outdated already.
+
+	auto cacheIterator = _cache.find(path);
+	if(cacheIterator != _cache.end()) erase(cacheIterator);
+
+	while(!_lru.empty() && _memoryUsage + info->script.size() > MAX_MEMORY)
+	{
+		auto evictIterator = _cache.find(_lru.back());
+		if(evictIterator != _cache.end()) erase(evictIterator);
+		else _lru.pop_back();
+		_evictions++;
+	}
+
+	_lru.push_front(path);
+	CacheEntry& entry = _cache[path];
+	entry.info = info;
+	entry.lruPosition = _lru.begin();
+	_memoryUsage += info->script.size();
+}
+
+std::unordered_map<std::string, ScriptCache::CacheEntry>::iterator ScriptCache::erase(std::unordered_map<std::string, CacheEntry>::iterator cacheIterator)
+{
+	_memoryUsage -= cacheIterator->second.info->script.size();
+	_lru.erase(cacheIterator->second.lruPosition);
+	return _cache.erase(cacheIterator);
+}
+
+bool ScriptCache::isWatched(const std::string& path)
+{
+	if(_inotifyDescriptor == -1) return false;
+	auto pos = path.find_last_of('/');
+	if(pos == std::string::npos) return false;
+	return _watchedDirectories.find(path.substr(0, pos + 1)) != _watchedDirectories.end();
+}
+
+void ScriptCache::watch(std::string path)
+{
+	try
+	{
+		if(path.empty()) return;
+		if(path.back() != '/') path.push_back('/');
+
+		int inotifyDescriptor = -1;
+		{
+			std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+			if(_watchRoots.find(path) != _watchRoots.end()) return;
+			_watchRoots.insert(path);
+
+			if(_inotifyDescriptor == -1)
+			{
+				_inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+				if(_inotifyDescriptor == -1)
+				{
+					GD::out.printWarning("Warning: Could not initialize inotify. Scripts are checked for changes on every execution: " + std::string(strerror(errno)));
+					return;
+				}
+				_stopWatcher = false;
+				GD::bl->threadManager.start(_watcherThread, true, &ScriptCache::watcherThread, this);
+			}
+			inotifyDescriptor = _inotifyDescriptor;
+		}
+
+		//Walking a whole web root takes a while. Script threads keep using the cache in the meantime.
+		watchDirectory(inotifyDescriptor, path);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void ScriptCache::stopWatching()
+{
+	try
+	{
+		_stopWatcher = true;
+		GD::bl->threadManager.join(_watcherThread);
+
+		std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+		if(_inotifyDescriptor != -1)
+		{
+			close(_inotifyDescriptor);
+			_inotifyDescriptor = -1;
+		}
+		_watchRoots.clear();
+		_watchDescriptors.clear();
+		_watchedDirectories.clear();
+		_generation++;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void ScriptCache::addWatches(int inotifyDescriptor, const std::string& directory, std::unordered_map<int, std::string>& watches)
+{
+	int watchDescriptor = inotify_add_watch(inotifyDescriptor, directory.c_str(), IN_ONLYDIR | IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF);
+	if(watchDescriptor == -1)
+	{
+		//Files in this directory are checked by modification time.
+		if(errno == ENOSPC)
+		{
+			if(!_watchLimitWarningPrinted.exchange(true)) GD::out.printWarning("Warning: The inotify watch limit is reached. Directories from \"" + directory + "\" on are checked for script changes on every execution. Increase \"fs.inotify.max_user_watches\" to watch all scripts.");
+		}
+		else GD::out.printWarning("Warning: Could not watch directory \"" + directory + "\" for script changes: " + std::string(strerror(errno)));
+		return;
+	}
+	//inotify returns the existing descriptor for directories watched already, e. g. when reached through a symlink. Don't follow loops.
+	if(!watches.emplace(watchDescriptor, directory).second) return;
+
+	std::vector<std::string> subdirectories = GD::bl->io.getDirectories(directory);
+	for(auto& subdirectory : subdirectories)
+	{
+		std::string path = directory + subdirectory;
+		if(path.back() != '/') path.push_back('/');
+		addWatches(inotifyDescriptor, path, watches);
+	}
+}
+
+void ScriptCache::publishWatches(int inotifyDescriptor, const std::string& directory, const std::unordered_map<int, std::string>& watches)
+{
+	//stopWatching() was called during the walk.
+	if(_inotifyDescriptor != inotifyDescriptor) return;
+	for(auto& watch : watches)
+	{
+		if(!_watchDescriptors.emplace(watch.first, watch.second).second) continue;
+		_watchedDirectories.insert(watch.second);
+	}
+	//Entries cached before the directory was watched might have changed in the meantime.
+	invalidate(directory, true);
+}
+
+void ScriptCache::watchDirectory(int inotifyDescriptor, const std::string& directory)
+{
+	std::unordered_map<int, std::string> watches;
+	addWatches(inotifyDescriptor, directory, watches);
+
+	std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+	publishWatches(inotifyDescriptor, directory, watches);
+}
+
+void ScriptCache::invalidate(const std::string& path, bool isDirectory)
+{
+	_generation++;
+	if(!isDirectory)
+	{
+		auto cacheIterator = _cache.find(path);
+		if(cacheIterator == _cache.end()) return;
+		erase(cacheIterator);
+		_invalidations++;
+		return;
+	}
+
+	for(auto cacheIterator = _cache.begin(); cacheIterator != _cache.end();)
+	{
+		if(cacheIterator->first.compare(0, path.size(), path) == 0)
+		{
+			cacheIterator = erase(cacheIterator);
+			_invalidations++;
+		}
+		else ++cacheIterator;
+	}
+}
+
+void ScriptCache::watcherThread()
+{
+	alignas(struct inotify_event) char buffer[16384];
+	while(!_stopWatcher)
+	{
+		try
+		{
+			pollfd pollInfo{};
+			{
+				std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+				pollInfo.fd = _inotifyDescriptor;
+			}
+			if(pollInfo.fd == -1) return;
+			pollInfo.events = POLLIN;
+			if(poll(&pollInfo, 1, 1000) <= 0) continue;
+
+			ssize_t length = ::read(pollInfo.fd, buffer, sizeof(buffer));
+			if(length <= 0) continue;
+
+			std::vector<std::string> newDirectories;
+			std::unique_lock<std::mutex> cacheGuard(_cacheMutex);
+			for(char* position = buffer; position < buffer + length;)
+			{
+				const struct inotify_event* event = (const struct inotify_event*)position;
+				position += sizeof(struct inotify_event) + event->len;
+
+				if(event->mask & IN_Q_OVERFLOW)
+				{
+					//Events were lost, so no entry can be trusted anymore.
+					for(auto& root : _watchRoots)
+					{
+						invalidate(root, true);
+					}
+					continue;
+				}
+
+				auto watchIterator = _watchDescriptors.find(event->wd);
+				if(watchIterator == _watchDescriptors.end()) continue;
+				std::string directory = watchIterator->second;
+
+				if(event->mask & IN_IGNORED)
+				{
+					//The watch was removed (directory deleted or unmounted).
+					_watchedDirectories.erase(directory);
+					_watchDescriptors.erase(watchIterator);
+					invalidate(directory, true);
+					continue;
+				}
+
+				if(event->len == 0)
+				{
+					if(event->mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+					{
+						//The watch of a moved directory would report the old path. IN_IGNORED follows.
+						_watchedDirectories.erase(directory);
+						invalidate(directory, true);
+						inotify_rm_watch(pollInfo.fd, event->wd);
+					}
+					continue;
+				}
+
+				std::string path = directory + event->name;
+				if(event->mask & IN_ISDIR)
+				{
+					path.push_back('/');
+					if(event->mask & (IN_CREATE | IN_MOVED_TO)) newDirectories.push_back(path);
+					invalidate(path, true);
+				}
+				else invalidate(path, false);
+			}
+			cacheGuard.unlock();
+
+			for(auto& directory : newDirectories)
+			{
+				watchDirectory(pollInfo.fd, directory);
+			}
+		}
+		catch(const std::exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(BaseLib::Exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(...)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+		}
+	}
+}
+
+void ScriptCache::clear()
+{
+	try
+	{
+		std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+		_cache.clear();
+		_lru.clear();
+		_memoryUsage = 0;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+BaseLib::PVariable ScriptCache::getStatistics()
+{
+	try
+	{
+		BaseLib::PVariable statistics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+		uint64_t hits = _hits;
+		uint64_t misses = _misses;
+		statistics->structValue->emplace("hits", std::make_shared<BaseLib::Variable>(hits));
+		statistics->structValue->emplace("misses", std::make_shared<BaseLib::Variable>(misses));
+		statistics->structValue->emplace("evictions", std::make_shared<BaseLib::Variable>((uint64_t)_evictions));
+		statistics->structValue->emplace("invalidations", std::make_shared<BaseLib::Variable>((uint64_t)_invalidations));
+		statistics->structValue->emplace("hitRate", std::make_shared<BaseLib::Variable>(hits + misses == 0 ? 0.0 : (double)hits / (double)(hits + misses)));
+		{
+			std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+			statistics->structValue->emplace("entries", std::make_shared<BaseLib::Variable>((uint64_t)_cache.size()));
+			statistics->structValue->emplace("memoryUsage", std::make_shared<BaseLib::Variable>((uint64_t)_memoryUsage));
+			statistics->structValue->emplace("watchedDirectories", std::make_shared<BaseLib::Variable>((uint64_t)_watchedDirectories.size()));
+		}
+		statistics->structValue->emplace("maxMemory", std::make_shared<BaseLib::Variable>((uint64_t)MAX_MEMORY));
+		return statistics;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+}
+
+}
+
+#endif
@@ -0,0 +1,175 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef HOMEGEAR_SCRIPTCACHE_H
+#define HOMEGEAR_SCRIPTCACHE_H
+
+#ifndef NO_SCRIPTENGINE
+
+#include "CacheInfo.h"
+#include <homegear-base/BaseLib.h>
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Homegear
+{
+
+namespace ScriptEngine
+{
+
+/**
+ * Process wide cache of decrypted encrypted scripts (".hgs" and ".hgn") shared by all script threads. Memory usage is bounded; least recently used
+ * entries are evicted first.
+ *
+ * This is a source cache only, scripts are still compiled by Zend on every execution. Plain PHP files are not cached here: hg_stream_open() passes them
+ * to Zend as file handles, so OPcache (enabled for the "homegear" SAPI by Homegear's PHP build and php.ini) caches their compiled opcodes by path and
+ * modification time. OPcache can't do that for encrypted scripts, because they are handed to Zend from memory without a file timestamp.
+ *
+ * Entries of files in directories watched with inotify (see watch()) are invalidated when the file changes and are served without touching the file
+ * system. All other entries are validated by the file's modification time on every execution.
+ */
+class ScriptCache
+{
+public:
+	/**
+	 * The maximum number of bytes of decrypted script source kept in the cache.
+	 */
+	static const size_t MAX_MEMORY = 33554432;
+
+	/**
+	 * Files larger than this are loaded on every execution and never cached.
+	 */
+	static const size_t MAX_ENTRY_SIZE = 4194304;
+
+	ScriptCache();
+	virtual ~ScriptCache();
+
+	/**
+	 * Returns the decrypted source of an encrypted script. The returned entry stays valid after it has been evicted.
+	 *
+	 * @param path The full path of the encrypted script.
+	 * @return The cache entry or nullptr if the file does not exist or could not be decrypted.
+	 */
+	std::shared_ptr<CacheInfo> get(const std::string& path);
+
+	/**
+	 * Removes all entries. The statistic counters are kept.
+	 */
+	void clear();
+
+	/**
+	 * Adds inotify watches for a directory and all of its subdirectories and starts the watcher thread if necessary. Calling this for a directory that
+	 * is already watched does nothing, so it can be called for every execution.
+	 *
+	 * @param path The directory to watch.
+	 */
+	void watch(std::string path);
+
+	/**
+	 * Stops the watcher thread and removes all watches. Entries are validated by modification time again afterwards.
+	 */
+	void stopWatching();
+
+	/**
+	 * Returns a struct with the hit and miss counters, the hit rate and the current memory usage.
+	 */
+	BaseLib::PVariable getStatistics();
+private:
+	struct CacheEntry
+	{
+		std::shared_ptr<CacheInfo> info;
+		std::list<std::string>::iterator lruPosition;
+	};
+
+	std::mutex _cacheMutex;
+	std::unordered_map<std::string, CacheEntry> _cache;
+	std::list<std::string> _lru;
+	size_t _memoryUsage = 0;
+
+	std::atomic<uint64_t> _hits;
+	std::atomic<uint64_t> _misses;
+	std::atomic<uint64_t> _evictions;
+	std::atomic<uint64_t> _invalidations;
+
+	// {{{ inotify, all protected by _cacheMutex
+	int _inotifyDescriptor = -1;
+	std::unordered_set<std::string> _watchRoots;
+	std::unordered_map<int, std::string> _watchDescriptors;
+	std::unordered_set<std::string> _watchedDirectories;
+
+	/**
+	 * Incremented on every invalidation. Used to not insert files which changed while they were loaded.
+	 */
+	uint64_t _generation = 0;
+	// }}}
+
+	std::atomic_bool _stopWatcher;
+	std::thread _watcherThread;
+	std::atomic_bool _watchLimitWarningPrinted;
+
+	std::shared_ptr<CacheInfo> load(const std::string& path, int32_t lastModified);
+	void insert(const std::string& path, std::shared_ptr<CacheInfo>& info, uint64_t generation);
+	std::unordered_map<std::string, CacheEntry>::iterator erase(std::unordered_map<std::string, CacheEntry>::iterator cacheIterator);
+	bool isWatched(const std::string& path);
+
+	/**
+	 * Adds inotify watches for a directory and all of its subdirectories. Walks the file system, so "_cacheMutex" must not be locked.
+	 *
+	 * @param inotifyDescriptor The inotify instance to add the watches to.
+	 * @param directory The directory to watch. Needs to end with "/".
+	 * @param[out] watches The added watch descriptors and their directories.
+	 */
+	void addWatches(int inotifyDescriptor, const std::string& directory, std::unordered_map<int, std::string>& watches);
+
+	/**
+	 * Makes watches returned by addWatches() known to the watcher thread and invalidates all entries below "directory". "_cacheMutex" needs to be
+	 * locked.
+	 */
+	void publishWatches(int inotifyDescriptor, const std::string& directory, const std::unordered_map<int, std::string>& watches);
+
+	/**
+	 * Calls addWatches() and publishWatches() for a directory. "_cacheMutex" must not be locked.
+	 */
+	void watchDirectory(int inotifyDescriptor, const std::string& directory);
+	void invalidate(const std::string& path, bool isDirectory);
+	void watcherThread();
+};
+
+}
+
+}
+
+#endif
+#endif
@@ -76,6 +76,7 @@ ScriptEngineClient::ScriptEngineClient() : IQueue(GD::bl.get(), 2, 100000)
 	_dummyClientInfo.reset(new BaseLib::RpcClientInfo());
 
 	_binaryRpc = std::unique_ptr<BaseLib::Rpc::BinaryRpc>(new BaseLib::Rpc::BinaryRpc(GD::bl.get()));
+	_sharedMemoryRingBinaryRpc = std::unique_ptr<BaseLib::Rpc::BinaryRpc>(new BaseLib::Rpc::BinaryRpc(GD::bl.get()));
 	_rpcDecoder = std::unique_ptr<BaseLib::Rpc::RpcDecoder>(new BaseLib::Rpc::RpcDecoder(GD::bl.get(), false, false));
 	_rpcEncoder = std::unique_ptr<BaseLib::Rpc::RpcEncoder>(new BaseLib::Rpc::RpcEncoder(GD::bl.get(), true, true));
 
@@ -86,6 +87,7 @@ ScriptEngineClient::ScriptEngineClient() : IQueue(GD::bl.get(), 2, 100000)
 	_localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(BaseLib::PArray& parameters)>>("executeScript", std::bind(&ScriptEngineClient::executeScript, this, std::placeholders::_1)));
 	_localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(BaseLib::PArray& parameters)>>("scriptCount", std::bind(&ScriptEngineClient::scriptCount, this, std::placeholders::_1)));
 	_localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(BaseLib::PArray& parameters)>>("getRunningScripts", std::bind(&ScriptEngineClient::getRunningScripts, this, std::placeholders::_1)));
+	_localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(BaseLib::PArray& parameters)>>("getScriptCacheStatistics", std::bind(&ScriptEngineClient::getScriptCacheStatistics, this, std::placeholders::_1)));
 	_localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(BaseLib::PArray& parameters)>>("checkSessionId", std::bind(&ScriptEngineClient::checkSessionId, this, std::placeholders::_1)));
 	_localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(BaseLib::PArray& parameters)>>("executePhpNodeMethod", std::bind(&ScriptEngineClient::executePhpNodeMethod, this, std::placeholders::_1)));
 	_localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(BaseLib::PArray& parameters)>>("executeDeviceMethod", std::bind(&ScriptEngineClient::executeDeviceMethod, this, std::placeholders::_1)));
@@ -102,6 +104,7 @@ ScriptEngineClient::~ScriptEngineClient()
 	dispose(true);
 	if(_maintenanceThread.joinable()) _maintenanceThread.join();
 	if(_watchdogThread.joinable()) _watchdogThread.join();
+	if(_sharedMemoryRingThread.joinable()) _sharedMemoryRingThread.join();
 #ifdef DEBUGSESOCKET
 	_socketOutput.close();
 #endif
@@ -152,12 +155,11 @@ void ScriptEngineClient::dispose(bool broadcastShutdown)
 		}
 
 		_stopped = true;
+		_pendingRequests.notifyAll();
 		stopEventThreads();
 		stopQueue(0);
 		stopQueue(1);
 		php_homegear_deinit();
-		_scriptCache.clear();
-		_rpcResponses.clear();
 	}
 	catch(const std::exception& ex)
 	{
@@ -388,9 +390,9 @@ void ScriptEngineClient::start()
 		}
 
 		std::vector<char> buffer(1024);
+		std::vector<int> fileDescriptors;
 		int32_t result = 0;
 		int32_t bytesRead = 0;
-		int32_t processedBytes = 0;
 		while(!_stopped)
 		{
 			try
@@ -421,7 +423,7 @@ void ScriptEngineClient::start()
 					return;
 				}
 
-				bytesRead = static_cast<int32_t>(read(_fileDescriptor->descriptor, buffer.data(), buffer.size()));
+				bytesRead = SharedMemoryRing::receive(_fileDescriptor->descriptor, buffer.data(), buffer.size(), fileDescriptors);
 				if(bytesRead <= 0) //read returns 0, when connection is disrupted.
 				{
 					GD::bl->fileDescriptorManager.close(_fileDescriptor);
@@ -431,50 +433,13 @@ void ScriptEngineClient::start()
 				}
 
 				if(bytesRead > (signed) buffer.size()) bytesRead = static_cast<int32_t>(buffer.size());
-
-				try
+				if(!fileDescriptors.empty())
 				{
-					processedBytes = 0;
-					while(processedBytes < bytesRead)
-					{
-						processedBytes += _binaryRpc->process(buffer.data() + processedBytes, bytesRead - processedBytes);
-						if(_binaryRpc->isFinished())
-						{
-#ifdef DEBUGSESOCKET
-                            if(_binaryRpc->getType() == BaseLib::Rpc::BinaryRpc::Type::request)
-                            {
-                                std::string methodName;
-                                BaseLib::PArray request = _rpcDecoder->decodeRequest(_binaryRpc->getData(), methodName);
-                                socketOutput(request->at(0)->integerValue, false, true, _binaryRpc->getData());
-                            }
-                            else
-                            {
-                                BaseLib::PVariable response = _rpcDecoder->decodeResponse(_binaryRpc->getData());
-                                socketOutput(response->arrayValue->at(1)->integerValue, true, false, _binaryRpc->getData());
-                            }
-#endif
-							if(_binaryRpc->getType() == BaseLib::Rpc::BinaryRpc::Type::request)
-							{
-								std::string methodName;
-								BaseLib::PArray parameters = _rpcDecoder->decodeRequest(_binaryRpc->getData(), methodName);
-								std::shared_ptr<BaseLib::IQueueEntry> queueEntry = std::make_shared<QueueEntry>(methodName, parameters);
-								if(methodName == "shutdown") shutdown(parameters->at(2)->arrayValue);
-								else if(!enqueue(0, queueEntry)) printQueueFullError(_out, "Error: Could not queue RPC request because buffer is full. Dropping it.");
-							}
-							else
-							{
-								std::shared_ptr<BaseLib::IQueueEntry> queueEntry = std::make_shared<QueueEntry>(_binaryRpc->getData());
-								if(!enqueue(1, queueEntry)) printQueueFullError(_out, "Error: Could not queue RPC response because buffer is full. Dropping it.");
-							}
-							_binaryRpc->reset();
-						}
-					}
-				}
-				catch(BaseLib::Rpc::BinaryRpcException& ex)
-				{
-					_out.printError("Error processing packet: " + ex.what());
-					_binaryRpc->reset();
+					startSharedMemoryRing(fileDescriptors);
+					fileDescriptors.clear();
 				}
+
+				processData(*_binaryRpc, buffer.data(), bytesRead);
 			}
 			catch(const std::exception& ex)
 			{
@@ -505,6 +470,136 @@ void ScriptEngineClient::start()
 	}
 }
 
+void ScriptEngineClient::processData(BaseLib::Rpc::BinaryRpc& binaryRpc, char* data, int32_t length)
+{
+	try
+	{
+		int32_t processedBytes = 0;
+		while(processedBytes < length)
+		{
+			processedBytes += binaryRpc.process(data + processedBytes, length - processedBytes);
+			if(binaryRpc.isFinished())
+			{
+#ifdef DEBUGSESOCKET
+                if(binaryRpc.getType() == BaseLib::Rpc::BinaryRpc::Type::request)
+                {
+                    std::string methodName;
+                    BaseLib::PArray request = _rpcDecoder->decodeRequest(binaryRpc.getData(), methodName);
+                    socketOutput(request->at(0)->integerValue, false, true, binaryRpc.getData());
+                }
+                else
+                {
+                    BaseLib::PVariable response = _rpcDecoder->decodeResponse(binaryRpc.getData());
+                    socketOutput(response->arrayValue->at(1)->integerValue, true, false, binaryRpc.getData());
+                }
+#endif
+				if(binaryRpc.getType() == BaseLib::Rpc::BinaryRpc::Type::request)
+				{
+					std::string methodName;
+					BaseLib::PArray parameters = _rpcDecoder->decodeRequest(binaryRpc.getData(), methodName);
+					std::shared_ptr<BaseLib::IQueueEntry> queueEntry = std::make_shared<QueueEntry>(methodName, parameters);
+					if(methodName == "shutdown") shutdown(parameters->at(2)->arrayValue);
+					else if(!enqueue(0, queueEntry)) printQueueFullError(_out, "Error: Could not queue RPC request because buffer is full. Dropping it.");
+				}
+				else
+				{
+					std::shared_ptr<BaseLib::IQueueEntry> queueEntry = std::make_shared<QueueEntry>(binaryRpc.getData());
+					if(!enqueue(1, queueEntry)) printQueueFullError(_out, "Error: Could not queue RPC response because buffer is full. Dropping it.");
+				}
+				binaryRpc.reset();
+			}
+		}
+	}
+	catch(BaseLib::Rpc::BinaryRpcException& ex)
+	{
+		_out.printError("Error processing packet: " + ex.what());
+		binaryRpc.reset();
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void ScriptEngineClient::startSharedMemoryRing(std::vector<int>& fileDescriptors)
+{
+	try
+	{
+		if(fileDescriptors.size() != 3 || _sharedMemoryRing)
+		{
+			for(auto fileDescriptor : fileDescriptors)
+			{
+				close(fileDescriptor);
+			}
+			return;
+		}
+
+		auto sharedMemoryRing = std::make_shared<SharedMemoryRing>();
+		if(!sharedMemoryRing->open(fileDescriptors.at(0), fileDescriptors.at(1), fileDescriptors.at(2)))
+		{
+			//The server already switched to the ring, so we can't continue with the socket.
+			_out.printCritical("Critical: Could not open shared memory ring. Closing connection.");
+			GD::bl->fileDescriptorManager.shutdown(_fileDescriptor);
+			return;
+		}
+		_sharedMemoryRing = sharedMemoryRing;
+		if(_sharedMemoryRingThread.joinable()) _sharedMemoryRingThread.join();
+		_sharedMemoryRingThread = std::thread(&ScriptEngineClient::readSharedMemoryRing, this);
+		_out.printInfo("Info: Receiving data from server through shared memory.");
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void ScriptEngineClient::readSharedMemoryRing()
+{
+	try
+	{
+		std::vector<char> buffer(65536);
+		while(!_stopped)
+		{
+			int32_t bytesRead = _sharedMemoryRing->read(buffer.data(), buffer.size(), 100);
+			if(bytesRead == 0) continue;
+			else if(bytesRead < 0)
+			{
+				if(!_stopped) _out.printMessage("Shared memory ring was closed by script server.");
+				return;
+			}
+			processData(*_sharedMemoryRingBinaryRpc, buffer.data(), bytesRead);
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
 std::vector<std::string> ScriptEngineClient::getArgs(const std::string& path, const std::string& args)
 {
 	std::vector<std::string> argv;
@@ -556,8 +651,16 @@ void ScriptEngineClient::registerClient()
 		{
 			_out.printCritical("Critical: Could not register client.");
 			dispose(false);
+			return;
 		}
 		_out.printInfo("Info: Client registered to server.");
+		auto valueCacheIterator = result->structValue->find("valueCache");
+		_valueCache.setEnabled(valueCacheIterator != result->structValue->end() && valueCacheIterator->second->booleanValue);
+
+		methodName = "openSharedMemoryRing";
+		parameters = std::make_shared<BaseLib::Array>();
+		result = sendGlobalRequest(methodName, parameters);
+		if(result->errorStruct) _out.printInfo("Info: Shared memory transport is not available. Using socket: " + result->structValue->at("faultString")->stringValue);
 	}
 	catch(const std::exception& ex)
 	{
@@ -645,72 +748,8 @@ void ScriptEngineClient::processQueueEntry(int32_t index, std::shared_ptr<BaseLi
 					_out.printError("Error: Response has wrong array size.");
 					return;
 				}
-				int32_t scriptId = response->arrayValue->at(0)->integerValue;
 				int32_t packetId = response->arrayValue->at(1)->integerValue;
-
-				{
-					std::lock_guard<std::mutex> responseGuard(_rpcResponsesMutex);
-					auto responseIterator = _rpcResponses[scriptId].find(packetId);
-					if(responseIterator != _rpcResponses[scriptId].end())
-					{
-						PScriptEngineResponse element = responseIterator->second;
-						if(element)
-						{
-							element->response = response;
-							element->packetId = packetId;
-							element->finished = true;
-						}
-					}
-				}
-				if(scriptId != 0)
-				{
-					std::lock_guard<std::mutex> requestInfoGuard(_requestInfoMutex);
-					std::map<int32_t, PRequestInfo>::iterator requestIterator = _requestInfo.find(scriptId);
-					if(requestIterator != _requestInfo.end())
-					{
-						std::unique_lock<std::mutex> waitLock(requestIterator->second->waitMutex);
-
-						{
-							std::lock_guard<std::mutex> responseGuard(_rpcResponsesMutex);
-							auto responseIterator = _rpcResponses[scriptId].find(packetId);
-							if(responseIterator != _rpcResponses[scriptId].end())
-							{
-								PScriptEngineResponse element = responseIterator->second;
-								if(element)
-								{
-									element->response = response;
-									element->packetId = packetId;
-									element->finished = true;
-								}
-							}
-						}
-
-						waitLock.unlock();
-						requestIterator->second->conditionVariable.notify_all();
-					}
-				}
-				else
-				{
-					std::unique_lock<std::mutex> waitLock(_waitMutex);
-
-					{
-						std::lock_guard<std::mutex> responseGuard(_rpcResponsesMutex);
-						auto responseIterator = _rpcResponses[scriptId].find(packetId);
-						if(responseIterator != _rpcResponses[scriptId].end())
-						{
-							PScriptEngineResponse element = responseIterator->second;
-							if(element)
-							{
-								element->response = response;
-								element->packetId = packetId;
-								element->finished = true;
-							}
-						}
-					}
-
-					waitLock.unlock();
-					_requestConditionVariable.notify_all();
-				}
+				_pendingRequests.setResponse(packetId, response);
 			}
 			catch(const std::exception& ex)
 			{
@@ -798,6 +837,18 @@ BaseLib::PVariable ScriptEngineClient::callMethod(std::string methodName, BaseLi
 	{
 		if(_nodesStopped) return BaseLib::Variable::createError(-32500, "RPC calls are forbidden after \"stop\" is executed.");
 		zend_homegear_globals* globals = php_homegear_get_globals();
+		uint64_t peerId = 0;
+		int32_t channel = -1;
+		std::string variable;
+		if(methodName == "setValue" || methodName == "setSystemVariable")
+		{
+			if(getValueCacheKey(methodName, parameters->arrayValue, peerId, channel, variable)) _valueCache.erase(peerId, channel, variable);
+		}
+		else if(wait && globals->user.empty()) //The cache is filled with the permissions of the script engine, so scripts executed for a user always bypass it.
+		{
+			if(getValueCacheKey(methodName, parameters->arrayValue, peerId, channel, variable)) return getCachedValue(globals, methodName, parameters->arrayValue, peerId, channel, variable);
+			else if(methodName == "multicall") return multicall(globals, parameters->arrayValue);
+		}
 		return sendRequest(globals->id, globals->peerId, globals->user, globals->language, methodName, parameters->arrayValue, wait);
 	}
 	catch(const std::exception& ex)
@@ -815,6 +866,139 @@ BaseLib::PVariable ScriptEngineClient::callMethod(std::string methodName, BaseLi
 	return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
+bool ScriptEngineClient::getValueCacheKey(const std::string& methodName, const BaseLib::PArray& parameters, uint64_t& peerId, int32_t& channel, std::string& variable)
+{
+	if(methodName == "getValue" || methodName == "setValue")
+	{
+		//Only plain reads are cached. "getValue" with "requestFromDevice" or "asynchronous" set has side effects.
+		if(methodName == "getValue" ? parameters->size() != 3 : parameters->size() < 3) return false;
+		if((parameters->at(0)->type != BaseLib::VariableType::tInteger && parameters->at(0)->type != BaseLib::VariableType::tInteger64) || parameters->at(1)->type != BaseLib::VariableType::tInteger || parameters->at(2)->type != BaseLib::VariableType::tString) return false;
+		peerId = (uint64_t)(parameters->at(0)->type == BaseLib::VariableType::tInteger64 ? parameters->at(0)->integerValue64 : parameters->at(0)->integerValue);
+		channel = parameters->at(1)->integerValue;
+		variable = parameters->at(2)->stringValue;
+		return true;
+	}
+	else if(methodName == "getSystemVariable" || methodName == "setSystemVariable")
+	{
+		if(parameters->empty() || parameters->at(0)->type != BaseLib::VariableType::tString || (methodName == "getSystemVariable" && parameters->size() != 1)) return false;
+		peerId = 0;
+		channel = -1;
+		variable = parameters->at(0)->stringValue;
+		return true;
+	}
+	return false;
+}
+
+BaseLib::PVariable ScriptEngineClient::getCachedValue(zend_homegear_globals* globals, std::string& methodName, BaseLib::PArray& parameters, uint64_t peerId, int32_t channel, std::string& variable)
+{
+	try
+	{
+		BaseLib::PVariable value;
+		if(_valueCache.get(peerId, channel, variable, value)) return value;
+		_valueCache.reserve(peerId, channel, variable);
+		BaseLib::PVariable result = sendRequest(globals->id, globals->peerId, globals->user, globals->language, methodName, parameters, true);
+		_valueCache.set(peerId, channel, variable, result);
+		return result;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable ScriptEngineClient::multicall(zend_homegear_globals* globals, BaseLib::PArray& parameters)
+{
+	try
+	{
+		std::string methodName("multicall");
+		if(parameters->size() != 1 || parameters->at(0)->type != BaseLib::VariableType::tArray) return sendRequest(globals->id, globals->peerId, globals->user, globals->language, methodName, parameters, true);
+
+		BaseLib::Array& calls = *parameters->at(0)->arrayValue;
+		BaseLib::PVariable results = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+		results->arrayValue->resize(calls.size());
+
+		BaseLib::PVariable remainingCalls = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+		std::vector<size_t> remainingIndexes;
+		std::vector<std::tuple<bool, uint64_t, int32_t, std::string>> remainingKeys;
+		remainingCalls->arrayValue->reserve(calls.size());
+		remainingIndexes.reserve(calls.size());
+		remainingKeys.reserve(calls.size());
+		for(size_t i = 0; i < calls.size(); i++)
+		{
+			uint64_t peerId = 0;
+			int32_t channel = -1;
+			std::string variable;
+			bool cacheable = false;
+			if(calls[i]->type == BaseLib::VariableType::tStruct)
+			{
+				auto methodNameIterator = calls[i]->structValue->find("methodName");
+				auto parametersIterator = calls[i]->structValue->find("params");
+				if(methodNameIterator != calls[i]->structValue->end() && parametersIterator != calls[i]->structValue->end() && parametersIterator->second->type == BaseLib::VariableType::tArray)
+				{
+					std::string& callMethodName = methodNameIterator->second->stringValue;
+					if(callMethodName == "setValue" || callMethodName == "setSystemVariable")
+					{
+						if(getValueCacheKey(callMethodName, parametersIterator->second->arrayValue, peerId, channel, variable)) _valueCache.erase(peerId, channel, variable);
+					}
+					else if(getValueCacheKey(callMethodName, parametersIterator->second->arrayValue, peerId, channel, variable))
+					{
+						if(_valueCache.get(peerId, channel, variable, results->arrayValue->at(i))) continue;
+						_valueCache.reserve(peerId, channel, variable);
+						cacheable = true;
+					}
+				}
+			}
+			remainingCalls->arrayValue->push_back(calls[i]);
+			remainingIndexes.push_back(i);
+			remainingKeys.emplace_back(cacheable, peerId, channel, std::move(variable));
+		}
+
+		if(remainingCalls->arrayValue->empty()) return results;
+
+		BaseLib::PArray remainingParameters = std::make_shared<BaseLib::Array>();
+		remainingParameters->push_back(remainingCalls);
+		BaseLib::PVariable response = sendRequest(globals->id, globals->peerId, globals->user, globals->language, methodName, remainingParameters, true);
+		if(response->errorStruct || response->type != BaseLib::VariableType::tArray || response->arrayValue->size() != remainingIndexes.size())
+		{
+			for(auto& key : remainingKeys)
+			{
+				if(std::get<0>(key)) _valueCache.set(std::get<1>(key), std::get<2>(key), std::get<3>(key), BaseLib::PVariable());
+			}
+			return response->errorStruct ? response : BaseLib::Variable::createError(-32500, "Invalid response to multicall.");
+		}
+
+		for(size_t i = 0; i < remainingIndexes.size(); i++)
+		{
+			BaseLib::PVariable& result = response->arrayValue->at(i);
+			results->arrayValue->at(remainingIndexes[i]) = result;
+			if(std::get<0>(remainingKeys[i])) _valueCache.set(std::get<1>(remainingKeys[i]), std::get<2>(remainingKeys[i]), std::get<3>(remainingKeys[i]), result);
+		}
+		return results;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 BaseLib::PVariable ScriptEngineClient::send(std::vector<char>& data)
 {
 	try
@@ -852,22 +1036,12 @@ BaseLib::PVariable ScriptEngineClient::sendRequest(int32_t scriptId, uint64_t pe
 {
 	try
 	{
-		std::unique_lock<std::mutex> requestInfoGuard(_requestInfoMutex);
-		PRequestInfo requestInfo = _requestInfo[scriptId];
-		if(!requestInfo)
+		int32_t packetId = wait ? _pendingRequests.add() : _pendingRequests.nextPacketId();
+		if(packetId == -1)
 		{
-			_out.printError("Error: Request info does not exist.");
+			_out.printError("Error: Too many RPC requests are waiting for a response.");
 			return BaseLib::Variable::createError(-32500, "Unknown application error.");
 		}
-		requestInfoGuard.unlock();
-
-		std::lock_guard<std::mutex> requestGuard(requestInfo->requestMutex);
-
-		int32_t packetId;
-		{
-			std::lock_guard<std::mutex> packetIdGuard(_packetIdMutex);
-			packetId = _currentPacketId++;
-		}
 		BaseLib::PArray array = std::make_shared<BaseLib::Array>();
 		array->reserve(4);
 		auto scriptInfo = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
@@ -882,21 +1056,6 @@ BaseLib::PVariable ScriptEngineClient::sendRequest(int32_t scriptId, uint64_t pe
 		std::vector<char> data;
 		_rpcEncoder->encodeRequest(methodName, array, data);
 
-		PScriptEngineResponse response;
-		if(wait)
-		{
-			{
-				std::lock_guard<std::mutex> responseGuard(_rpcResponsesMutex);
-				auto result = _rpcResponses[scriptId].emplace(packetId, std::make_shared<ScriptEngineResponse>());
-				if(result.second) response = result.first->second;
-			}
-			if(!response)
-			{
-				_out.printCritical("Critical: Could not insert response struct into map.");
-				return BaseLib::Variable::createError(-32500, "Unknown application error.");
-			}
-		}
-
 #ifdef DEBUGSESOCKET
 		socketOutput(packetId, true, true, data);
 #endif
@@ -906,34 +1065,24 @@ BaseLib::PVariable ScriptEngineClient::sendRequest(int32_t scriptId, uint64_t pe
 			if(!wait) return std::make_shared<BaseLib::Variable>();
 			else
 			{
-				std::lock_guard<std::mutex> responseGuard(_rpcResponsesMutex);
-				_rpcResponses[scriptId].erase(packetId);
+				_pendingRequests.remove(packetId);
 				return result;
 			}
 		}
 
-		int32_t i = 0;
-		std::unique_lock<std::mutex> waitLock(requestInfo->waitMutex);
-		while(!requestInfo->conditionVariable.wait_for(waitLock, std::chrono::milliseconds(1000), [&]
+		int64_t startTime = BaseLib::HelperFunctions::getTime();
+		BaseLib::PVariable response;
+		bool responseReceived = _pendingRequests.wait(packetId, [&]
 		{
-			return response->finished || _stopped;
-		}))
-		{
-			i++;
-			if(i == 60) break;
-		}
+			return _stopped || BaseLib::HelperFunctions::getTime() - startTime >= 60000;
+		}, response);
 
-		if(!response->finished || response->response->arrayValue->size() != 3 || response->packetId != packetId)
+		if(!responseReceived || !response || response->arrayValue->size() != 3)
 		{
 			_out.printError("Error: No response received to RPC request. Method: " + methodName);
 			result = BaseLib::Variable::createError(-1, "No response received.");
 		}
-		else result = response->response->arrayValue->at(2);
-
-		{
-			std::lock_guard<std::mutex> responseGuard(_rpcResponsesMutex);
-			_rpcResponses[scriptId].erase(packetId);
-		}
+		else result = response->arrayValue->at(2);
 
 		return result;
 	}
@@ -956,11 +1105,11 @@ BaseLib::PVariable ScriptEngineClient::sendGlobalRequest(std::string methodName,
 {
 	try
 	{
-		std::lock_guard<std::mutex> requestGuard(_requestMutex);
-		int32_t packetId;
+		int32_t packetId = _pendingRequests.add();
+		if(packetId == -1)
 		{
-			std::lock_guard<std::mutex> packetIdGuard(_packetIdMutex);
-			packetId = _currentPacketId++;
+			_out.printError("Error: Too many RPC requests are waiting for a response.");
+			return BaseLib::Variable::createError(-32500, "Unknown application error.");
 		}
 		BaseLib::PArray array = std::make_shared<BaseLib::Array>();
 		array->reserve(4);
@@ -974,46 +1123,28 @@ BaseLib::PVariable ScriptEngineClient::sendGlobalRequest(std::string methodName,
 		std::vector<char> data;
 		_rpcEncoder->encodeRequest(methodName, array, data);
 
-		PScriptEngineResponse response;
-		{
-			std::lock_guard<std::mutex> responseGuard(_rpcResponsesMutex);
-			auto result = _rpcResponses[0].emplace(packetId, std::make_shared<ScriptEngineResponse>());
-			if(result.second) response = result.first->second;
-		}
-		if(!response)
-		{
-			_out.printError("Critical: Could not insert response struct into map.");
-			return BaseLib::Variable::createError(-32500, "Unknown application error.");
-		}
-
 #ifdef DEBUGSESOCKET
 		socketOutput(packetId, true, true, data);
 #endif
 		BaseLib::PVariable result = send(data);
 		if(result->errorStruct)
 		{
-			std::lock_guard<std::mutex> responseGuard(_rpcResponsesMutex);
-			_rpcResponses[0].erase(packetId);
+			_pendingRequests.remove(packetId);
 			return result;
 		}
 
-		std::unique_lock<std::mutex> waitLock(_waitMutex);
-		while(!_requestConditionVariable.wait_for(waitLock, std::chrono::milliseconds(10000), [&]
+		BaseLib::PVariable response;
+		bool responseReceived = _pendingRequests.wait(packetId, [&]
 		{
-			return response->finished || _stopped;
-		}));
+			return (bool)_stopped;
+		}, response);
 
-		if(!response->finished || response->response->arrayValue->size() != 3 || response->packetId != packetId)
+		if(!responseReceived || !response || response->arrayValue->size() != 3)
 		{
 			_out.printError("Error: No response received to RPC request. Method: " + methodName);
 			result = BaseLib::Variable::createError(-1, "No response received.");
 		}
-		else result = response->response->arrayValue->at(2);
-
-		{
-			std::lock_guard<std::mutex> responseGuard(_rpcResponsesMutex);
-			_rpcResponses[0].erase(packetId);
-		}
+		else result = response->arrayValue->at(2);
 
 		return result;
 	}
@@ -1089,14 +1220,6 @@ void ScriptEngineClient::collectGarbage()
 		{
 			try
 			{
-				{
-					std::lock_guard<std::mutex> responseGuard(_rpcResponsesMutex);
-					_rpcResponses.erase(*i);
-				}
-				{
-					std::lock_guard<std::mutex> requestInfoGuard(_requestInfoMutex);
-					_requestInfo.erase(*i);
-				}
 				_scriptThreads.erase(*i);
 			}
 			catch(const std::exception& ex)
@@ -1251,7 +1374,7 @@ void ScriptEngineClient::runScript(int32_t id, PScriptInfo scriptInfo)
 			{
 				//BaseLib::Base64::encode(BaseLib::HelperFunctions::getRandomBytes(16), globals->token);
 				BaseLib::Base64::encode(std::vector<uint8_t>{0, 1, 2, 3, 4, 5}, globals->token);
-				std::shared_ptr<PhpEvents> phpEvents = std::make_shared<PhpEvents>(globals->token, globals->outputCallback, globals->rpcCallback);
+				std::shared_ptr<PhpEvents> phpEvents = std::make_shared<PhpEvents>(id, globals->token, globals->outputCallback, globals->rpcCallback);
 				phpEvents->setPeerId(static_cast<uint64_t>(scriptInfo->peerId));
 				std::lock_guard<std::mutex> eventsGuard(PhpEvents::eventsMapMutex);
 				PhpEvents::eventsMap.emplace(id, phpEvents);
@@ -1273,6 +1396,7 @@ void ScriptEngineClient::runScript(int32_t id, PScriptInfo scriptInfo)
 			}
 			else if(type == ScriptInfo::ScriptType::web)
 			{
+				php_homegear_watch_script_path(scriptInfo->contentPath);
 				SG(sapi_headers).http_response_code = 200;
 				SG(request_info).content_length = globals->http.getHeader().contentLength;
 				if(!globals->http.getHeader().contentTypeFull.empty()) SG(request_info).content_type = globals->http.getHeader().contentTypeFull.c_str();
@@ -1516,55 +1640,8 @@ void ScriptEngineClient::scriptThread(int32_t id, PScriptInfo scriptInfo, bool s
 			globals->sendHeadersCallback = std::bind(&ScriptEngineClient::sendHeaders, this, std::placeholders::_1);
 		}
 		globals->rpcCallback = std::bind(&ScriptEngineClient::callMethod, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
-		{
-			std::lock_guard<std::mutex> requestInfoGuard(_requestInfoMutex);
-			_requestInfo.emplace(std::piecewise_construct, std::make_tuple(id), std::make_tuple(std::make_shared<RequestInfo>()));
-		}
 		ScriptGuard scriptGuard(this, globals, id, scriptInfo);
 
-		if(scriptInfo->script.empty() && scriptInfo->fullPath.size() > 3 && (scriptInfo->fullPath.compare(scriptInfo->fullPath.size() - 4, 4, ".hgs") == 0 || scriptInfo->fullPath.compare(scriptInfo->fullPath.size() - 4, 4, ".hgn") == 0))
-		{
-			std::lock_guard<std::mutex> scriptCacheGuard(_scriptCacheMutex);
-			std::map<std::string, std::shared_ptr<CacheInfo>>::iterator scriptIterator = _scriptCache.find(scriptInfo->fullPath);
-			if(scriptIterator != _scriptCache.end() && scriptIterator->second->lastModified == BaseLib::Io::getFileLastModifiedTime(scriptInfo->fullPath)) scriptInfo->script = scriptIterator->second->script;
-			else
-			{
-				std::vector<char> data = BaseLib::Io::getBinaryFileContent(scriptInfo->fullPath);
-				int32_t pos = -1;
-				for(uint32_t i = 0; i < 11 && i < data.size(); i++)
-				{
-					if(data[i] == ' ')
-					{
-						pos = (int32_t) i;
-						break;
-					}
-				}
-				if(pos == -1)
-				{
-					GD::bl->out.printError("Error: License module id is missing in encrypted script file \"" + scriptInfo->fullPath + "\"");
-					return;
-				}
-				std::string moduleIdString(&data.at(0), static_cast<unsigned long>(pos));
-				int32_t moduleId = BaseLib::Math::getNumber(moduleIdString);
-				std::vector<char> input(&data.at(static_cast<unsigned long>(pos + 1)), &data.at(data.size() - 1) + 1);
-				if(input.empty()) return;
-				std::map<int32_t, std::unique_ptr<BaseLib::Licensing::Licensing>>::iterator i = GD::licensingModules.find(moduleId);
-				if(i == GD::licensingModules.end() || !i->second)
-				{
-					GD::out.printError("Error: Could not decrypt script file. Licensing module with id 0x" + BaseLib::HelperFunctions::getHexString(moduleId) + " not found");
-					return;
-				}
-				std::shared_ptr<CacheInfo> cacheInfo = std::make_shared<ScriptEngine::CacheInfo>();
-				i->second->decryptScript(input, cacheInfo->script);
-				cacheInfo->lastModified = BaseLib::Io::getFileLastModifiedTime(scriptInfo->fullPath);
-				if(!cacheInfo->script.empty())
-				{
-					_scriptCache[scriptInfo->fullPath] = cacheInfo;
-					scriptInfo->script = cacheInfo->script;
-				}
-			}
-		}
-
 		runScript(id, scriptInfo);
 	}
 	catch(const std::exception& ex)
@@ -2058,6 +2135,29 @@ BaseLib::PVariable ScriptEngineClient::getRunningScripts(BaseLib::PArray& parame
 	return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
+BaseLib::PVariable ScriptEngineClient::getScriptCacheStatistics(BaseLib::PArray& parameters)
+{
+	try
+	{
+		BaseLib::PVariable statistics = php_homegear_get_script_cache_statistics();
+		if(!statistics->errorStruct) statistics->structValue->emplace("valueCache", _valueCache.getStatistics());
+		return statistics;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 BaseLib::PVariable ScriptEngineClient::checkSessionId(BaseLib::PArray& parameters)
 {
 	try
@@ -2232,28 +2332,31 @@ BaseLib::PVariable ScriptEngineClient::broadcastEvent(BaseLib::PArray& parameter
 {
 	try
 	{
-		if(parameters->size() != 5) return BaseLib::Variable::createError(-1, "Wrong parameter count.");
+		if(parameters->size() != 6) return BaseLib::Variable::createError(-1, "Wrong parameter count.");
 
-		std::lock_guard<std::mutex> eventsGuard(PhpEvents::eventsMapMutex);
-		for(std::map<int32_t, std::shared_ptr<PhpEvents>>::iterator i = PhpEvents::eventsMap.begin(); i != PhpEvents::eventsMap.end(); ++i)
+		uint64_t peerId = static_cast<uint64_t>(parameters->at(1)->integerValue64);
+		int32_t channel = parameters->at(2)->integerValue;
+		BaseLib::Array& variables = *parameters->at(3)->arrayValue;
+		BaseLib::Array& values = *parameters->at(4)->arrayValue;
+		_valueCache.update(static_cast<uint64_t>(parameters->at(5)->integerValue64), peerId, channel, variables, values);
+
+		//Only scripts subscribed to the peer get to see the event
+		std::vector<std::shared_ptr<PhpEvents>> subscribers;
+		PhpEvents::getSubscribers(peerId, subscribers);
+		for(auto& phpEvents : subscribers)
 		{
-			int32_t channel = parameters->at(2)->integerValue;
-			std::string variableName;
-			if(i->second && (parameters->at(1)->integerValue64 == 0 || i->second->peerSubscribed(parameters->at(1)->integerValue64, -1, variableName)))
+			for(uint32_t j = 0; j < variables.size() && j < values.size(); j++)
 			{
-				for(uint32_t j = 0; j < parameters->at(3)->arrayValue->size(); j++)
-				{
-					variableName = parameters->at(3)->arrayValue->at(j)->stringValue;
-					if(!i->second->peerSubscribed(static_cast<uint64_t>(parameters->at(1)->integerValue64), channel, variableName)) continue;
-					auto eventData = std::make_shared<PhpEvents::EventData>();
-					eventData->source = parameters->at(0)->stringValue;
-					eventData->type = "event";
-					eventData->id = static_cast<uint64_t>(parameters->at(1)->integerValue64);
-					eventData->channel = channel;
-					eventData->variable = variableName;
-					eventData->value = parameters->at(4)->arrayValue->at(j);
-					if(!i->second->enqueue(eventData)) printQueueFullError(_out, "Error: Could not queue event as event buffer is full. Dropping it.");
-				}
+				std::string& variableName = variables[j]->stringValue;
+				if(!phpEvents->peerSubscribed(peerId, channel, variableName)) continue;
+				auto eventData = std::make_shared<PhpEvents::EventData>();
+				eventData->source = parameters->at(0)->stringValue;
+				eventData->type = "event";
+				eventData->id = peerId;
+				eventData->channel = channel;
+				eventData->variable = variableName;
+				eventData->value = values[j];
+				if(!phpEvents->enqueue(eventData)) printQueueFullError(_out, "Error: Could not queue event as event buffer is full. Dropping it.");
 			}
 		}
 
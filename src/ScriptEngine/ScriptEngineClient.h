@@ -35,8 +35,9 @@
 
 #include "php_config_fixes.h"
 #include "../../config.h"
-#include "ScriptEngineResponse.h"
-#include "CacheInfo.h"
+#include "../IPC/SharedMemoryRing.h"
+#include "../IPC/PendingRequests.h"
+#include "ValueCache.h"
 #include <homegear-base/BaseLib.h>
 
 #include <thread>
@@ -77,14 +78,6 @@ private:
 
 	typedef std::shared_ptr<ThreadInfo> PThreadInfo;
 
-	struct RequestInfo
-	{
-		std::mutex requestMutex;
-		std::mutex waitMutex;
-		std::condition_variable conditionVariable;
-	};
-	typedef std::shared_ptr<RequestInfo> PRequestInfo;
-
 	class ScriptGuard
 	{
 	private:
@@ -162,11 +155,8 @@ private:
 	std::atomic_bool _stopped;
 	static std::mutex _resourceMutex;
 	std::mutex _sendMutex;
-	std::mutex _requestMutex;
-	std::mutex _waitMutex;
-	std::mutex _rpcResponsesMutex;
-	std::map<int32_t, std::map<int32_t, PScriptEngineResponse>> _rpcResponses;
-	std::condition_variable _requestConditionVariable;
+	PendingRequests<BaseLib::PVariable> _pendingRequests;
+	ValueCache _valueCache;
 	std::shared_ptr<BaseLib::RpcClientInfo> _dummyClientInfo;
 	std::map<std::string, std::function<BaseLib::PVariable(BaseLib::PArray& parameters)>> _localRpcMethods;
 	std::mutex _maintenanceThreadMutex;
@@ -174,12 +164,6 @@ private:
 	std::thread _watchdogThread;
 	std::mutex _scriptThreadMutex;
 	std::map<int32_t, PThreadInfo> _scriptThreads;
-	std::mutex _requestInfoMutex;
-	std::map<int32_t, PRequestInfo> _requestInfo;
-	std::mutex _scriptCacheMutex;
-	std::map<std::string, std::shared_ptr<CacheInfo>> _scriptCache;
-	std::mutex _packetIdMutex;
-	int32_t _currentPacketId = 0;
 	std::atomic_bool _nodesStopped;
 	static std::mutex _nodeInfoMutex;
 	static std::unordered_map<std::string, PNodeInfo> _nodeInfo;
@@ -187,6 +171,9 @@ private:
 	static std::unordered_map<uint64_t, PDeviceInfo> _deviceInfo;
 
 	std::unique_ptr<BaseLib::Rpc::BinaryRpc> _binaryRpc;
+	std::unique_ptr<BaseLib::Rpc::BinaryRpc> _sharedMemoryRingBinaryRpc;
+	PSharedMemoryRing _sharedMemoryRing;
+	std::thread _sharedMemoryRingThread;
 	std::unique_ptr<BaseLib::Rpc::RpcDecoder> _rpcDecoder;
 	std::unique_ptr<BaseLib::Rpc::RpcEncoder> _rpcEncoder;
 
@@ -198,12 +185,39 @@ private:
 
 	void registerClient();
 
+	void processData(BaseLib::Rpc::BinaryRpc& binaryRpc, char* data, int32_t length);
+
+	/**
+	 * Maps the shared memory ring passed by the server and starts reading from it. From then on all data from the server
+	 * is received through the ring. Data to the server is still sent over the socket.
+	 */
+	void startSharedMemoryRing(std::vector<int>& fileDescriptors);
+
+	void readSharedMemoryRing();
+
 	void sendOutput(std::string output, bool error);
 
 	void sendHeaders(BaseLib::PVariable headers);
 
 	BaseLib::PVariable callMethod(std::string methodName, BaseLib::PVariable parameters, bool wait);
 
+	/**
+	 * Checks if a call reads a single value that can be served from the value cache ("getValue" with three parameters and "getSystemVariable").
+	 *
+	 * @return Returns true when the call is cacheable. In this case the cache key is returned in "peerId", "channel" and "variable".
+	 */
+	bool getValueCacheKey(const std::string& methodName, const BaseLib::PArray& parameters, uint64_t& peerId, int32_t& channel, std::string& variable);
+
+	/**
+	 * Executes a call through the value cache.
+	 */
+	BaseLib::PVariable getCachedValue(zend_homegear_globals* globals, std::string& methodName, BaseLib::PArray& parameters, uint64_t peerId, int32_t channel, std::string& variable);
+
+	/**
+	 * Serves the cacheable calls of a batch from the value cache and sends all other calls to the server in one "multicall" request.
+	 */
+	BaseLib::PVariable multicall(zend_homegear_globals* globals, BaseLib::PArray& parameters);
+
 	BaseLib::PVariable sendRequest(int32_t scriptId, uint64_t peerId, std::string& user, std::string& language, std::string methodName, BaseLib::PArray& parameters, bool wait);
 
 	BaseLib::PVariable sendGlobalRequest(std::string methodName, BaseLib::PArray& parameters);
@@ -271,6 +285,11 @@ private:
 
 	BaseLib::PVariable getRunningScripts(BaseLib::PArray& parameters);
 
+	/**
+	 * Returns hit, miss and memory statistics of the script source cache of this process.
+	 */
+	BaseLib::PVariable getScriptCacheStatistics(BaseLib::PArray& parameters);
+
 	BaseLib::PVariable checkSessionId(BaseLib::PArray& parameters);
 
 	BaseLib::PVariable executePhpNodeMethod(BaseLib::PArray& parameters);
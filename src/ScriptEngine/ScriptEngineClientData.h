@@ -34,6 +34,7 @@
 #ifndef NO_SCRIPTENGINE
 
 #include "ScriptEngineResponse.h"
+#include "../IPC/SharedMemoryRing.h"
 #include <homegear-base/BaseLib.h>
 
 namespace Homegear
@@ -59,10 +60,12 @@ public:
 	std::unique_ptr<BaseLib::Rpc::BinaryRpc> binaryRpc;
 	std::shared_ptr<BaseLib::FileDescriptor> fileDescriptor;
 	std::mutex sendMutex;
+	PSharedMemoryRing sharedMemoryRing; //Only accessed with std::atomic_load/std::atomic_store. When set, all data to the client is sent through the ring.
 	std::mutex waitMutex;
 	std::mutex rpcResponsesMutex;
 	std::map<int32_t, PScriptEngineResponse> rpcResponses;
 	std::condition_variable requestConditionVariable;
+	std::atomic<uint64_t> eventSequenceNumber{0}; //Number of the last event sent to the client, including dropped ones.
 };
 
 typedef std::shared_ptr<ScriptEngineClientData> PScriptEngineClientData;
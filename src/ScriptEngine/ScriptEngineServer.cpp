@@ -115,9 +115,11 @@ ScriptEngineServer::ScriptEngineServer() : IQueue(GD::bl.get(), 3, 100000)
 	_rpcMethods.emplace("getParamsetDescription", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetParamsetDescription()));
 	_rpcMethods.emplace("getParamsetId", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetParamsetId()));
 	_rpcMethods.emplace("getPeerId", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetPeerId()));
+	_rpcMethods.emplace("getRpcMetrics", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetRpcMetrics()));
 	_rpcMethods.emplace("getServiceMessages", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetServiceMessages()));
 	_rpcMethods.emplace("getSniffedDevices", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetSniffedDevices()));
 	_rpcMethods.emplace("getSystemVariable", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetSystemVariable()));
+	_rpcMethods.emplace("getTlsMetrics", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetTlsMetrics()));
 	_rpcMethods.emplace("getUpdateStatus", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetUpdateStatus()));
 	_rpcMethods.emplace("getValue", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetValue()));
 	_rpcMethods.emplace("getVariableDescription", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCGetVariableDescription()));
@@ -144,6 +146,7 @@ ScriptEngineServer::ScriptEngineServer() : IQueue(GD::bl.get(), 3, 100000)
 	_rpcMethods.emplace("searchDevices", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSearchDevices()));
 	_rpcMethods.emplace("searchInterfaces", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSearchInterfaces()));
 	_rpcMethods.emplace("setData", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetData()));
+	_rpcMethods.emplace("setEventRateLimit", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetEventRateLimit()));
 	_rpcMethods.emplace("setGlobalServiceMessage", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetGlobalServiceMessage()));
 	_rpcMethods.emplace("setId", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetId()));
 	_rpcMethods.emplace("setInstallMode", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetInstallMode()));
@@ -161,9 +164,11 @@ ScriptEngineServer::ScriptEngineServer() : IQueue(GD::bl.get(), 3, 100000)
 	_rpcMethods.emplace("setValue", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSetValue()));
 	_rpcMethods.emplace("startSniffing", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCStartSniffing()));
 	_rpcMethods.emplace("stopSniffing", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCStopSniffing()));
+	_rpcMethods.emplace("subscribeEvents", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSubscribeEvents()));
 	_rpcMethods.emplace("subscribePeers", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCSubscribePeers()));
 	_rpcMethods.emplace("triggerEvent", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCTriggerEvent()));
 	_rpcMethods.emplace("triggerRpcEvent", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCTriggerRpcEvent()));
+	_rpcMethods.emplace("unsubscribeEvents", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCUnsubscribeEvents()));
 	_rpcMethods.emplace("unsubscribePeers", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCUnsubscribePeers()));
 	_rpcMethods.emplace("updateFirmware", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCUpdateFirmware()));
 	_rpcMethods.emplace("writeLog", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCWriteLog()));
@@ -277,10 +282,21 @@ ScriptEngineServer::ScriptEngineServer() : IQueue(GD::bl.get(), 3, 100000)
 	_localRpcMethods.emplace("removeLicense", std::bind(&ScriptEngineServer::removeLicense, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
 	_localRpcMethods.emplace("getLicenseStates", std::bind(&ScriptEngineServer::getLicenseStates, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
 	_localRpcMethods.emplace("getTrialStartTime", std::bind(&ScriptEngineServer::getTrialStartTime, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+	_localRpcMethods.emplace("multicall", std::bind(&ScriptEngineServer::multicall, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
 
 	_localRpcMethods.emplace("nodeEvent", std::bind(&ScriptEngineServer::nodeEvent, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
 	_localRpcMethods.emplace("nodeOutput", std::bind(&ScriptEngineServer::nodeOutput, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
 	_localRpcMethods.emplace("executePhpNodeBaseMethod", std::bind(&ScriptEngineServer::executePhpNodeBaseMethod, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+
+	//Resolve the metrics entries once, so calls only need atomic increments
+	for(auto& method : _rpcMethods)
+	{
+		_methodMetrics.emplace(method.first, GD::rpcMetrics.getMethodMetrics(Rpc::RpcMetrics::Direction::incoming, Rpc::RpcMetrics::Transport::scriptEngine, method.first));
+	}
+	for(auto& method : _localRpcMethods)
+	{
+		_methodMetrics.emplace(method.first, GD::rpcMetrics.getMethodMetrics(Rpc::RpcMetrics::Direction::incoming, Rpc::RpcMetrics::Transport::scriptEngine, method.first));
+	}
 }
 
 ScriptEngineServer::~ScriptEngineServer()
@@ -443,21 +459,22 @@ void ScriptEngineServer::collectGarbage()
 		std::vector<PScriptEngineProcess> processesToShutdown;
 		{
 			std::lock_guard<std::mutex> processGuard(_processMutex);
-			bool emptyProcess = false;
-			bool emptyNodeProcess = false;
+			uint32_t idleProcesses = 0;
+			uint32_t idleNodeProcesses = 0;
+			uint32_t warmPoolMinSize = _warmPoolMinSize;
+			uint32_t warmPoolMaxSize = _warmPoolMaxSize;
+			int64_t warmPoolIdleTimeout = _warmPoolIdleTimeout;
+			int64_t time = BaseLib::HelperFunctions::getTime();
 			for(std::map<pid_t, PScriptEngineProcess>::iterator i = _processes.begin(); i != _processes.end(); ++i)
 			{
-				if(i->second->scriptCount() == 0 && BaseLib::HelperFunctions::getTime() - i->second->lastExecution > 10000 && i->second->getClientData() && !i->second->getClientData()->closed)
+				if(i->second->scriptCount() == 0 && i->second->getClientData() && !i->second->getClientData()->closed)
 				{
-					if(i->second->isNodeProcess())
+					uint32_t& idleCount = i->second->isNodeProcess() ? idleNodeProcesses : idleProcesses;
+					idleCount++;
+					if(idleCount > warmPoolMaxSize || (idleCount > warmPoolMinSize && time - i->second->lastExecution > warmPoolIdleTimeout))
 					{
-						if(emptyNodeProcess) closeClientConnection(i->second->getClientData());
-						else emptyNodeProcess = true;
-					}
-					else
-					{
-						if(emptyProcess) closeClientConnection(i->second->getClientData());
-						else emptyProcess = true;
+						closeClientConnection(i->second->getClientData());
+						idleCount--;
 					}
 				}
 			}
@@ -513,13 +530,16 @@ bool ScriptEngineServer::start()
 		_socketPath = GD::bl->settings.socketPath() + "homegearSE.sock";
 		_shuttingDown = false;
 		_stopServer = false;
+		if(!_reactor.init()) return false;
 		if(!getFileDescriptor(true)) return false;
+		loadWarmPool();
 		uint32_t scriptEngineThreadCount = GD::bl->settings.scriptEngineThreadCount();
 		if(scriptEngineThreadCount < 5) scriptEngineThreadCount = 5;
 		startQueue(0, false, scriptEngineThreadCount, 0, SCHED_OTHER);
 		startQueue(1, false, scriptEngineThreadCount, 0, SCHED_OTHER);
 		startQueue(2, false, scriptEngineThreadCount, 0, SCHED_OTHER);
 		GD::bl->threadManager.start(_mainThread, true, &ScriptEngineServer::mainThread, this);
+		GD::bl->threadManager.start(_warmPoolThread, true, &ScriptEngineServer::warmPoolThread, this);
 		return true;
 	}
 	catch(const std::exception& ex)
@@ -542,6 +562,8 @@ void ScriptEngineServer::stop()
 	try
 	{
 		_shuttingDown = true;
+		refillWarmPool();
+		GD::bl->threadManager.join(_warmPoolThread);
 		_out.printDebug("Debug: Waiting for script engine server's client threads to finish.");
 		std::vector<PScriptEngineClientData> clients;
 		{
@@ -834,6 +856,47 @@ std::vector<std::tuple<int32_t, uint64_t, int32_t, std::string>> ScriptEngineSer
 	return std::vector<std::tuple<int32_t, uint64_t, int32_t, std::string>>();
 }
 
+BaseLib::PVariable ScriptEngineServer::getScriptCacheStatistics()
+{
+	try
+	{
+		BaseLib::PVariable statistics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+		if(_shuttingDown) return statistics;
+		std::vector<PScriptEngineClientData> clients;
+		{
+			std::lock_guard<std::mutex> stateGuard(_stateMutex);
+			for(std::map<int32_t, PScriptEngineClientData>::iterator i = _clients.begin(); i != _clients.end(); ++i)
+			{
+				if(i->second->closed) continue;
+				clients.push_back(i->second);
+			}
+		}
+
+		BaseLib::PArray parameters = std::make_shared<BaseLib::Array>();
+		for(std::vector<PScriptEngineClientData>::iterator i = clients.begin(); i != clients.end(); ++i)
+		{
+			BaseLib::PVariable response = sendRequest(*i, "getScriptCacheStatistics", parameters, true);
+			if(response->errorStruct || response->type != BaseLib::VariableType::tStruct) continue;
+			response->structValue->emplace("pid", std::make_shared<BaseLib::Variable>((int32_t)(*i)->pid));
+			statistics->arrayValue->push_back(response);
+		}
+		return statistics;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 BaseLib::PVariable ScriptEngineServer::executePhpNodeMethod(BaseLib::PArray& parameters)
 {
 	try
@@ -974,12 +1037,14 @@ void ScriptEngineServer::broadcastEvent(std::string& source, uint64_t id, int32_
 		for(std::vector<PScriptEngineClientData>::iterator i = clients.begin(); i != clients.end(); ++i)
 		{
 			auto parameters = std::make_shared<BaseLib::Array>();
-			parameters->reserve(5);
+			parameters->reserve(6);
 			parameters->emplace_back(std::make_shared<BaseLib::Variable>(source));
 			parameters->emplace_back(std::make_shared<BaseLib::Variable>(id));
 			parameters->emplace_back(std::make_shared<BaseLib::Variable>(channel));
 			parameters->emplace_back(std::make_shared<BaseLib::Variable>(*variables));
 			parameters->emplace_back(std::make_shared<BaseLib::Variable>(values));
+			//Also counted when the event is dropped below, so the client notices the gap and clears its value cache.
+			parameters->emplace_back(std::make_shared<BaseLib::Variable>((uint64_t)++(*i)->eventSequenceNumber));
 			std::shared_ptr<BaseLib::IQueueEntry> queueEntry = std::make_shared<QueueEntry>(*i, "broadcastEvent", parameters);
 			if(!enqueue(2, queueEntry)) printQueueFullError(_out, "Error: Could not queue RPC method call \"broadcastEvent\". Queue is full.");
 		}
@@ -1145,6 +1210,8 @@ void ScriptEngineServer::closeClientConnection(PScriptEngineClientData client)
 	{
 		if(!client) return;
 		GD::bl->fileDescriptorManager.shutdown(client->fileDescriptor);
+		auto sharedMemoryRing = std::atomic_load(&client->sharedMemoryRing); //Don't lock sendMutex here, a writer might be waiting for the client.
+		if(sharedMemoryRing) sharedMemoryRing->shutdown();
 		client->closed = true;
 	}
 	catch(const std::exception& ex)
@@ -1251,7 +1318,9 @@ void ScriptEngineServer::processQueueEntry(int32_t index, std::shared_ptr<BaseLi
 						}
 					}
 				}
+				int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
 				BaseLib::PVariable result = localMethodIterator->second(queueEntry->clientData, scriptInfo, queueEntry->parameters->at(3)->arrayValue);
+				Rpc::RpcMetrics::record(_methodMetrics, queueEntry->methodName, BaseLib::HelperFunctions::getTimeMicroseconds() - startTime, result->errorStruct);
 				if(GD::bl->debugLevel >= 5)
 				{
 					_out.printDebug("Response: ");
@@ -1281,7 +1350,9 @@ void ScriptEngineServer::processQueueEntry(int32_t index, std::shared_ptr<BaseLi
 					}
 				}
 			}
+			int64_t startTime = BaseLib::HelperFunctions::getTimeMicroseconds();
 			BaseLib::PVariable result = _rpcMethods.at(queueEntry->methodName)->invoke(scriptInfo->clientInfo, queueEntry->parameters->at(3)->arrayValue);
+			Rpc::RpcMetrics::record(_methodMetrics, queueEntry->methodName, BaseLib::HelperFunctions::getTimeMicroseconds() - startTime, result->errorStruct);
 			if(GD::bl->debugLevel >= 5)
 			{
 				_out.printDebug("Response: ");
@@ -1337,7 +1408,20 @@ BaseLib::PVariable ScriptEngineServer::send(PScriptEngineClientData& clientData,
 	try
 	{
 		int32_t totallySentBytes = 0;
-		std::lock_guard<std::mutex> sendGuard(clientData->sendMutex);
+		std::unique_lock<std::mutex> sendGuard(clientData->sendMutex);
+		auto sharedMemoryRing = std::atomic_load(&clientData->sharedMemoryRing);
+		if(sharedMemoryRing)
+		{
+			//sendMutex is released while the ring is full, so a slow client doesn't block other senders.
+			if(!sharedMemoryRing->write(sendGuard, data.data(), data.size(), 30000))
+			{
+				if(!sharedMemoryRing->isClosed()) GD::out.printError("Could not write data to shared memory ring of client: " + std::to_string(clientData->id) + ". Closing connection.");
+				//Part of the packet might be in the ring already, so all following packets would be misframed.
+				closeClientConnection(clientData);
+				return BaseLib::Variable::createError(-32500, "Unknown application error.");
+			}
+			return std::make_shared<BaseLib::Variable>();
+		}
 		while(totallySentBytes < (signed) data.size())
 		{
 			int32_t sentBytes = ::send(clientData->fileDescriptor->descriptor, &data.at(0) + totallySentBytes, data.size() - totallySentBytes, MSG_NOSIGNAL);
@@ -1483,119 +1567,83 @@ void ScriptEngineServer::mainThread()
 {
 	try
 	{
-		int32_t result = 0;
-		std::shared_ptr<BaseLib::FileDescriptor> clientFileDescriptor;
-		while(!_stopServer)
+		EpollReactor::Callbacks callbacks;
+		callbacks.getServerFileDescriptor = [this]() -> std::shared_ptr<BaseLib::FileDescriptor>
 		{
-			if(!_serverFileDescriptor || _serverFileDescriptor->descriptor == -1)
-			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-				getFileDescriptor();
-				continue;
-			}
-
-			timeval timeout;
-			timeout.tv_sec = 0;
-			timeout.tv_usec = 100000;
-			fd_set readFileDescriptor;
-			int32_t maxfd = 0;
-			FD_ZERO(&readFileDescriptor);
-			{
-				std::vector<PScriptEngineClientData> clients;
-				{
-					std::lock_guard<std::mutex> stateGuard(_stateMutex);
-					clients.reserve(_clients.size());
-					for(auto& client : _clients)
-					{
-						if(client.second->closed) continue;
-						if(client.second->fileDescriptor->descriptor == -1)
-						{
-							client.second->closed = true;
-							continue;
-						}
-						clients.push_back(client.second);
-					}
-				}
-
-				auto fileDescriptorGuard = GD::bl->fileDescriptorManager.getLock();
-				fileDescriptorGuard.lock();
-				maxfd = _serverFileDescriptor->descriptor;
-				FD_SET(_serverFileDescriptor->descriptor, &readFileDescriptor);
-
-				for(auto& client : clients)
-				{
-					int32_t descriptor = client->fileDescriptor->descriptor;
-					if(descriptor == -1) continue; //Never pass -1 to FD_SET => undefined behaviour. This is just a safety precaution, because the file descriptor manager is locked and descriptors shouldn't be modified.
-					FD_SET(descriptor, &readFileDescriptor);
-					if(descriptor > maxfd) maxfd = descriptor;
-				}
-			}
-
-			result = select(maxfd + 1, &readFileDescriptor, NULL, NULL, &timeout);
-			if(result == 0)
+			if(!_serverFileDescriptor || _serverFileDescriptor->descriptor == -1) getFileDescriptor();
+			return _serverFileDescriptor;
+		};
+		callbacks.clientAccepted = std::bind(&ScriptEngineServer::clientAccepted, this, std::placeholders::_1);
+		callbacks.readClient = [this](uint64_t token) -> bool
+		{
+			PScriptEngineClientData clientData;
 			{
-				if(GD::bl->hf.getTime() - _lastGargabeCollection > 10000 || _clients.size() > GD::bl->settings.scriptEngineServerMaxConnections() * 100 / 112) collectGarbage();
-				continue;
+				std::lock_guard<std::mutex> stateGuard(_stateMutex);
+				auto clientIterator = _clients.find((int32_t)token);
+				if(clientIterator == _clients.end()) return false;
+				clientData = clientIterator->second;
 			}
-			else if(result == -1)
+			if(clientData->closed) return false;
+			if(clientData->fileDescriptor->descriptor == -1)
 			{
-				if(errno == EINTR) continue;
-				_out.printError("Error: select returned -1: " + std::string(strerror(errno)));
-				continue;
+				clientData->closed = true;
+				return false;
 			}
+			return readClient(clientData);
+		};
+		callbacks.idle = [this]()
+		{
+			if(GD::bl->hf.getTime() - _lastGargabeCollection > 10000 || _clients.size() > GD::bl->settings.scriptEngineServerMaxConnections() * 100 / 112) collectGarbage();
+		};
 
-			if(FD_ISSET(_serverFileDescriptor->descriptor, &readFileDescriptor) && !_shuttingDown)
-			{
-				sockaddr_un clientAddress;
-				socklen_t addressSize = sizeof(addressSize);
-				std::shared_ptr<BaseLib::FileDescriptor> clientFileDescriptor = GD::bl->fileDescriptorManager.add(accept(_serverFileDescriptor->descriptor, (struct sockaddr*) &clientAddress, &addressSize));
-				if(!clientFileDescriptor || clientFileDescriptor->descriptor == -1) continue;
-				_out.printInfo("Info: Connection accepted. Client number: " + std::to_string(clientFileDescriptor->id));
-
-				if(_clients.size() > GD::bl->settings.scriptEngineServerMaxConnections())
-				{
-					collectGarbage();
-					if(_clients.size() > GD::bl->settings.scriptEngineServerMaxConnections())
-					{
-						_out.printError("Error: There are too many clients connected to me. Closing connection. You can increase the number of allowed connections in main.conf.");
-						GD::bl->fileDescriptorManager.close(clientFileDescriptor);
-						continue;
-					}
-				}
+		_reactor.run(_stopServer, callbacks);
+		GD::bl->fileDescriptorManager.close(_serverFileDescriptor);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
 
-				std::lock_guard<std::mutex> stateGuard(_stateMutex);
-				if(_shuttingDown)
-				{
-					GD::bl->fileDescriptorManager.close(clientFileDescriptor);
-					continue;
-				}
-				PScriptEngineClientData clientData = PScriptEngineClientData(new ScriptEngineClientData(clientFileDescriptor));
-				clientData->id = _currentClientId++;
-				_clients[clientData->id] = clientData;
-				continue;
-			}
+void ScriptEngineServer::clientAccepted(std::shared_ptr<BaseLib::FileDescriptor>& clientFileDescriptor)
+{
+	try
+	{
+		_out.printInfo("Info: Connection accepted. Client number: " + std::to_string(clientFileDescriptor->id));
 
-			PScriptEngineClientData clientData;
+		if(_clients.size() > GD::bl->settings.scriptEngineServerMaxConnections())
+		{
+			collectGarbage();
+			if(_clients.size() > GD::bl->settings.scriptEngineServerMaxConnections())
 			{
-				std::lock_guard<std::mutex> stateGuard(_stateMutex);
-				for(std::map<int32_t, PScriptEngineClientData>::iterator i = _clients.begin(); i != _clients.end(); ++i)
-				{
-					if(i->second->fileDescriptor->descriptor == -1)
-					{
-						i->second->closed = true;
-						continue;
-					}
-					if(FD_ISSET(i->second->fileDescriptor->descriptor, &readFileDescriptor))
-					{
-						clientData = i->second;
-						break;
-					}
-				}
+				_out.printError("Error: There are too many clients connected to me. Closing connection. You can increase the number of allowed connections in main.conf.");
+				GD::bl->fileDescriptorManager.close(clientFileDescriptor);
+				return;
 			}
+		}
 
-			if(clientData) readClient(clientData);
+		std::lock_guard<std::mutex> stateGuard(_stateMutex);
+		if(_shuttingDown)
+		{
+			GD::bl->fileDescriptorManager.close(clientFileDescriptor);
+			return;
 		}
-		GD::bl->fileDescriptorManager.close(_serverFileDescriptor);
+		PScriptEngineClientData clientData = PScriptEngineClientData(new ScriptEngineClientData(clientFileDescriptor));
+		clientData->id = _currentClientId++;
+		if(!_reactor.add(clientFileDescriptor->descriptor, (uint64_t)clientData->id, true))
+		{
+			GD::bl->fileDescriptorManager.close(clientFileDescriptor);
+			return;
+		}
+		_clients[clientData->id] = clientData;
 	}
 	catch(const std::exception& ex)
 	{
@@ -1627,19 +1675,44 @@ PScriptEngineProcess ScriptEngineServer::getFreeProcess(bool nodeProcess, uint32
 			std::lock_guard<std::mutex> processGuard(_processMutex);
 			for(std::map<pid_t, std::shared_ptr<ScriptEngineProcess>>::iterator i = _processes.begin(); i != _processes.end(); ++i)
 			{
-				if(i->second->getClientData()->closed) continue;
+				if(!i->second->getClientData() || i->second->getClientData()->closed) continue;
 				if(nodeProcess && i->second->isNodeProcess() && (GD::bl->settings.maxNodeThreadsPerProcess() == -1 || i->second->nodeThreadCount() + maxThreadCount + 1 <= (unsigned) GD::bl->settings.maxNodeThreadsPerProcess()))
 				{
+					if(i->second->scriptCount() == 0) refillWarmPool();
 					i->second->lastExecution = BaseLib::HelperFunctions::getTime();
 					return i->second;
 				}
 				else if(!nodeProcess && !i->second->isNodeProcess() && i->second->scriptCount() < GD::bl->threadManager.getMaxThreadCount() / GD::bl->settings.scriptEngineMaxThreadsPerScript() && (GD::bl->settings.scriptEngineMaxScriptsPerProcess() == -1 || i->second->scriptCount() < (unsigned) GD::bl->settings.scriptEngineMaxScriptsPerProcess()))
 				{
+					if(i->second->scriptCount() == 0) refillWarmPool();
 					i->second->lastExecution = BaseLib::HelperFunctions::getTime();
 					return i->second;
 				}
 			}
 		}
+		PScriptEngineProcess process = spawnProcess(nodeProcess);
+		refillWarmPool();
+		return process;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return std::shared_ptr<ScriptEngineProcess>();
+}
+
+PScriptEngineProcess ScriptEngineServer::spawnProcess(bool nodeProcess)
+{
+	try
+	{
 		_out.printInfo("Info: Spawning new script engine process.");
 		std::shared_ptr<ScriptEngineProcess> process(new ScriptEngineProcess(nodeProcess));
 		std::vector<std::string> arguments{"-c", GD::configPath, "-rse"};
@@ -1671,6 +1744,7 @@ PScriptEngineProcess ScriptEngineServer::getFreeProcess(bool nodeProcess, uint32
 			process->setUnregisterNode(std::function<void(std::string)>(std::bind(&ScriptEngineServer::unregisterNode, this, std::placeholders::_1)));
 			process->setUnregisterDevice(std::function<void(uint64_t)>(std::bind(&ScriptEngineServer::unregisterDevice, this, std::placeholders::_1)));
 			_out.printInfo("Info: Script engine process successfully spawned. Process id is " + std::to_string(process->getPid()) + ". Client id is: " + std::to_string(process->getClientData()->id) + ".");
+			process->lastExecution = BaseLib::HelperFunctions::getTime();
 			return process;
 		}
 	}
@@ -1689,18 +1763,222 @@ PScriptEngineProcess ScriptEngineServer::getFreeProcess(bool nodeProcess, uint32
 	return std::shared_ptr<ScriptEngineProcess>();
 }
 
-void ScriptEngineServer::readClient(PScriptEngineClientData& clientData)
+uint32_t ScriptEngineServer::idleProcessCount(bool nodeProcess)
+{
+	try
+	{
+		uint32_t count = 0;
+		std::lock_guard<std::mutex> processGuard(_processMutex);
+		for(std::map<pid_t, std::shared_ptr<ScriptEngineProcess>>::iterator i = _processes.begin(); i != _processes.end(); ++i)
+		{
+			if(!i->second->getClientData() || i->second->getClientData()->closed || i->second->isNodeProcess() != nodeProcess) continue;
+			if(i->second->scriptCount() == 0) count++;
+		}
+		return count;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return 0;
+}
+
+void ScriptEngineServer::refillWarmPool()
+{
+	{
+		std::lock_guard<std::mutex> warmPoolGuard(_warmPoolMutex);
+		_refillWarmPool = true;
+	}
+	_warmPoolConditionVariable.notify_one();
+}
+
+BaseLib::PVariable ScriptEngineServer::getWarmPool()
+{
+	try
+	{
+		BaseLib::PVariable warmPool = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+		warmPool->structValue->emplace("minSize", std::make_shared<BaseLib::Variable>((int32_t)_warmPoolMinSize));
+		warmPool->structValue->emplace("maxSize", std::make_shared<BaseLib::Variable>((int32_t)_warmPoolMaxSize));
+		warmPool->structValue->emplace("idleTimeout", std::make_shared<BaseLib::Variable>((int64_t)_warmPoolIdleTimeout));
+		return warmPool;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+bool ScriptEngineServer::setWarmPool(uint32_t minSize, uint32_t maxSize, int64_t idleTimeout)
+{
+	try
+	{
+		if(minSize > maxSize || idleTimeout < 0) return false;
+		{
+			std::lock_guard<std::mutex> warmPoolSettingsGuard(_warmPoolSettingsMutex);
+			_warmPoolMinSize = minSize;
+			_warmPoolMaxSize = maxSize;
+			_warmPoolIdleTimeout = idleTimeout;
+			saveWarmPool();
+		}
+		refillWarmPool();
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return false;
+}
+
+void ScriptEngineServer::loadWarmPool()
+{
+	try
+	{
+		std::string warmPoolFile = GD::bl->settings.dataPath() + "scriptenginewarmpool.json";
+		if(!GD::bl->io.fileExists(warmPoolFile)) return;
+		std::string rawWarmPool = GD::bl->io.getFileContent(warmPoolFile);
+		if(BaseLib::HelperFunctions::trim(rawWarmPool).empty()) return;
+		BaseLib::Rpc::JsonDecoder jsonDecoder(GD::bl.get());
+		BaseLib::PVariable warmPool = jsonDecoder.decode(rawWarmPool);
+
+		uint32_t minSize = DEFAULT_WARM_POOL_MIN_SIZE;
+		uint32_t maxSize = DEFAULT_WARM_POOL_MAX_SIZE;
+		int64_t idleTimeout = DEFAULT_WARM_POOL_IDLE_TIMEOUT;
+		auto settingIterator = warmPool->structValue->find("minSize");
+		if(settingIterator != warmPool->structValue->end() && settingIterator->second->integerValue >= 0) minSize = settingIterator->second->integerValue;
+		settingIterator = warmPool->structValue->find("maxSize");
+		if(settingIterator != warmPool->structValue->end() && settingIterator->second->integerValue >= 0) maxSize = settingIterator->second->integerValue;
+		settingIterator = warmPool->structValue->find("idleTimeout");
+		if(settingIterator != warmPool->structValue->end() && settingIterator->second->integerValue64 >= 0) idleTimeout = settingIterator->second->integerValue64;
+		if(minSize > maxSize)
+		{
+			_out.printWarning("Warning: Ignoring " + warmPoolFile + ", because minSize is greater than maxSize.");
+			return;
+		}
+
+		std::lock_guard<std::mutex> warmPoolSettingsGuard(_warmPoolSettingsMutex);
+		_warmPoolMinSize = minSize;
+		_warmPoolMaxSize = maxSize;
+		_warmPoolIdleTimeout = idleTimeout;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void ScriptEngineServer::saveWarmPool()
+{
+	try
+	{
+		BaseLib::PVariable warmPool = getWarmPool();
+		if(warmPool->errorStruct) return;
+		BaseLib::Rpc::JsonEncoder jsonEncoder(GD::bl.get());
+		std::vector<char> rawWarmPool;
+		jsonEncoder.encode(warmPool, rawWarmPool);
+		std::string warmPoolFile = GD::bl->settings.dataPath() + "scriptenginewarmpool.json";
+		GD::bl->io.writeFile(warmPoolFile, rawWarmPool, rawWarmPool.size());
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void ScriptEngineServer::warmPoolThread()
+{
+	if(GD::bl->settings.scriptEngineManualClientStart()) return;
+	while(!_shuttingDown && !_stopServer)
+	{
+		try
+		{
+			{
+				std::unique_lock<std::mutex> warmPoolGuard(_warmPoolMutex);
+				_warmPoolConditionVariable.wait_for(warmPoolGuard, std::chrono::milliseconds(1000), [&] { return _refillWarmPool || _shuttingDown || _stopServer; });
+				_refillWarmPool = false;
+			}
+
+			for(int32_t nodeProcess = 0; nodeProcess < 2; nodeProcess++)
+			{
+				if(nodeProcess && !GD::bl->settings.enableNodeBlue()) continue;
+				while(!_shuttingDown && !_stopServer && idleProcessCount(nodeProcess) < _warmPoolMinSize)
+				{
+					std::lock_guard<std::mutex> newProcessGuard(_newProcessMutex);
+					if(_shuttingDown || _stopServer) break;
+					if(idleProcessCount(nodeProcess) >= _warmPoolMinSize) break;
+					if(!spawnProcess(nodeProcess)) break; //Try again in the next iteration
+				}
+			}
+		}
+		catch(const std::exception& ex)
+		{
+			_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(BaseLib::Exception& ex)
+		{
+			_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(...)
+		{
+			_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+		}
+	}
+}
+
+bool ScriptEngineServer::readClient(PScriptEngineClientData& clientData)
 {
 	try
 	{
 		int32_t processedBytes = 0;
 		int32_t bytesRead = 0;
-		bytesRead = read(clientData->fileDescriptor->descriptor, clientData->buffer.data(), clientData->buffer.size());
-		if(bytesRead <= 0) //read returns 0, when connection is disrupted.
+		bytesRead = recv(clientData->fileDescriptor->descriptor, clientData->buffer.data(), clientData->buffer.size(), MSG_DONTWAIT);
+		if(bytesRead == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return errno == EINTR;
+		if(bytesRead <= 0) //recv returns 0, when connection is disrupted.
 		{
 			_out.printInfo("Info: Connection to script server's client number " + std::to_string(clientData->fileDescriptor->id) + " closed.");
 			closeClientConnection(clientData);
-			return;
+			return false;
 		}
 
 		if(bytesRead > (signed) clientData->buffer.size()) bytesRead = clientData->buffer.size();
@@ -1737,6 +2015,10 @@ void ScriptEngineServer::readClient(PScriptEngineClientData& clientData)
 							BaseLib::PVariable result = registerScriptEngineClient(clientData, parameters->at(3)->arrayValue);
 							sendResponse(clientData, parameters->at(0)->structValue->at("scriptId"), parameters->at(1), result);
 						}
+						else if(methodName == "openSharedMemoryRing" && parameters->size() == 4)
+						{
+							openSharedMemoryRing(clientData, parameters->at(0)->structValue->at("scriptId"), parameters->at(1));
+						}
 						else if(methodName == "scriptFinished" && parameters->size() == 4)
 						{
 							scriptFinished(clientData, parameters->at(0)->structValue->at("scriptId")->integerValue, parameters->at(3)->arrayValue);
@@ -1761,6 +2043,7 @@ void ScriptEngineServer::readClient(PScriptEngineClientData& clientData)
 			_out.printError("Error processing packet: " + ex.what());
 			clientData->binaryRpc->reset();
 		}
+		return true;
 	}
 	catch(const std::exception& ex)
 	{
@@ -1774,6 +2057,7 @@ void ScriptEngineServer::readClient(PScriptEngineClientData& clientData)
 	{
 		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
 	}
+	return false;
 }
 
 bool ScriptEngineServer::getFileDescriptor(bool deleteOldSocket)
@@ -2192,6 +2476,50 @@ void ScriptEngineServer::unregisterDevice(uint64_t peerId)
 }
 
 // {{{ RPC methods
+void ScriptEngineServer::openSharedMemoryRing(PScriptEngineClientData& clientData, BaseLib::PVariable& scriptId, BaseLib::PVariable& packetId)
+{
+	try
+	{
+		auto sharedMemoryRing = std::make_shared<SharedMemoryRing>();
+		if(!sharedMemoryRing->create())
+		{
+			BaseLib::PVariable error = BaseLib::Variable::createError(-1, "Shared memory rings are not supported on this system.");
+			sendResponse(clientData, scriptId, packetId, error);
+			return;
+		}
+
+		BaseLib::PVariable array(new BaseLib::Variable(BaseLib::PArray(new BaseLib::Array{scriptId, packetId, std::make_shared<BaseLib::Variable>()})));
+		std::vector<char> data;
+		_rpcEncoder->encodeResponse(array, data);
+#ifdef DEBUGSESOCKET
+		socketOutput(packetId->integerValue, clientData, false, false, data);
+#endif
+
+		//The response carries the file descriptors. Everything sent after it goes through the ring.
+		std::lock_guard<std::mutex> sendGuard(clientData->sendMutex);
+		if(std::atomic_load(&clientData->sharedMemoryRing) || !sharedMemoryRing->sendFileDescriptors(clientData->fileDescriptor->descriptor, data.data(), data.size()))
+		{
+			_out.printError("Error: Could not pass shared memory ring to client " + std::to_string(clientData->id) + ".");
+			GD::bl->fileDescriptorManager.shutdown(clientData->fileDescriptor);
+			return;
+		}
+		std::atomic_store(&clientData->sharedMemoryRing, sharedMemoryRing);
+		_out.printInfo("Info: Client " + std::to_string(clientData->id) + " now receives data through shared memory.");
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
 BaseLib::PVariable ScriptEngineServer::registerScriptEngineClient(PScriptEngineClientData& clientData, BaseLib::PArray& parameters)
 {
 	try
@@ -2223,7 +2551,12 @@ BaseLib::PVariable ScriptEngineServer::registerScriptEngineClient(PScriptEngineC
 		processGuard.unlock();
 		processIterator->second->requestConditionVariable.notify_all();
 		_out.printInfo("Info: Client with pid " + std::to_string(pid) + " successfully registered.");
-		return BaseLib::PVariable(new BaseLib::Variable());
+
+		//The client may only cache values when it receives every event. With variable ACLs set, events are filtered per variable.
+		BaseLib::PVariable result = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+		bool valueCache = _scriptEngineClientInfo->acls->checkEventServerMethodAccess("event") && !_scriptEngineClientInfo->acls->variablesRoomsCategoriesDevicesReadSet();
+		result->structValue->emplace("valueCache", std::make_shared<BaseLib::Variable>(valueCache));
+		return result;
 	}
 	catch(const std::exception& ex)
 	{
@@ -3470,6 +3803,71 @@ BaseLib::PVariable ScriptEngineServer::getTrialStartTime(PScriptEngineClientData
 }
 // }}}
 
+BaseLib::PVariable ScriptEngineServer::multicall(PScriptEngineClientData& clientData, PClientScriptInfo scriptInfo, BaseLib::PArray& parameters)
+{
+	try
+	{
+		if(parameters->size() != 1) return BaseLib::Variable::createError(-1, "Method expects exactly one parameter.");
+		if(parameters->at(0)->type != BaseLib::VariableType::tArray) return BaseLib::Variable::createError(-1, "Parameter 1 is not of type array.");
+
+		BaseLib::PVariable returns = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+		returns->arrayValue->reserve(parameters->at(0)->arrayValue->size());
+		for(auto& call : *parameters->at(0)->arrayValue)
+		{
+			if(call->type != BaseLib::VariableType::tStruct)
+			{
+				returns->arrayValue->push_back(BaseLib::Variable::createError(-32602, "Array element is no struct."));
+				continue;
+			}
+			auto methodNameIterator = call->structValue->find("methodName");
+			if(methodNameIterator == call->structValue->end() || methodNameIterator->second->type != BaseLib::VariableType::tString)
+			{
+				returns->arrayValue->push_back(BaseLib::Variable::createError(-32602, "No method name provided."));
+				continue;
+			}
+			auto parametersIterator = call->structValue->find("params");
+			if(parametersIterator == call->structValue->end() || parametersIterator->second->type != BaseLib::VariableType::tArray)
+			{
+				returns->arrayValue->push_back(BaseLib::Variable::createError(-32602, "No parameters provided."));
+				continue;
+			}
+			std::string& methodName = methodNameIterator->second->stringValue;
+			BaseLib::PArray& callParameters = parametersIterator->second->arrayValue;
+
+			if(methodName == "multicall" || methodName == "system.multicall")
+			{
+				returns->arrayValue->push_back(BaseLib::Variable::createError(-32602, "Recursive calls to multicall are not allowed."));
+				continue;
+			}
+
+			auto localMethodIterator = _localRpcMethods.find(methodName);
+			if(localMethodIterator != _localRpcMethods.end())
+			{
+				returns->arrayValue->push_back(localMethodIterator->second(clientData, scriptInfo, callParameters));
+				continue;
+			}
+
+			auto methodIterator = _rpcMethods.find(methodName);
+			if(methodIterator != _rpcMethods.end()) returns->arrayValue->push_back(methodIterator->second->invoke(scriptInfo->clientInfo, callParameters));
+			else returns->arrayValue->push_back(GD::ipcServer->callRpcMethod(scriptInfo->clientInfo, methodName, callParameters));
+		}
+		return returns;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 // {{{ Flows
 BaseLib::PVariable ScriptEngineServer::nodeEvent(PScriptEngineClientData& clientData, PClientScriptInfo scriptInfo, BaseLib::PArray& parameters)
 {
@@ -34,6 +34,8 @@
 #ifndef NO_SCRIPTENGINE
 
 #include "ScriptEngineProcess.h"
+#include "../IPC/EpollReactor.h"
+#include "../RPC/RpcMetrics.h"
 #include "../../config.h"
 #include <homegear-base/BaseLib.h>
 
@@ -61,6 +63,22 @@ namespace ScriptEngine
 class ScriptEngineServer : public BaseLib::IQueue
 {
 public:
+	/**
+	 * The default minimum number of idle, fully registered processes kept per process type (script and node processes), so scripts don't have to
+	 * wait for process startup.
+	 */
+	static const uint32_t DEFAULT_WARM_POOL_MIN_SIZE = 1;
+
+	/**
+	 * The default maximum number of idle processes kept per process type. Idle processes above this limit are stopped immediately.
+	 */
+	static const uint32_t DEFAULT_WARM_POOL_MAX_SIZE = 4;
+
+	/**
+	 * The default time in milliseconds after which idle processes above the minimum pool size are stopped.
+	 */
+	static const int64_t DEFAULT_WARM_POOL_IDLE_TIMEOUT = 30000;
+
 	ScriptEngineServer();
 
 	virtual ~ScriptEngineServer();
@@ -81,6 +99,25 @@ public:
 
 	std::vector<std::tuple<int32_t, uint64_t, int32_t, std::string>> getRunningScripts();
 
+	/**
+	 * Returns the minimum and maximum number of idle processes per process type and the idle timeout in milliseconds.
+	 */
+	BaseLib::PVariable getWarmPool();
+
+	/**
+	 * Sets the size limits and the idle timeout of the warm pool and stores them in "scriptenginewarmpool.json" in the data directory.
+	 *
+	 * @return Returns false when "minSize" is greater than "maxSize" or "idleTimeout" is negative.
+	 */
+	bool setWarmPool(uint32_t minSize, uint32_t maxSize, int64_t idleTimeout);
+
+	/**
+	 * Collects the script cache statistics of all script engine processes.
+	 *
+	 * @return An array with one struct per process. Next to the counters returned by ScriptCache::getStatistics(), each struct contains the process ID as "pid".
+	 */
+	BaseLib::PVariable getScriptCacheStatistics();
+
 	void executeScript(PScriptInfo& scriptInfo, bool wait);
 
 	std::string checkSessionId(const std::string& sessionId);
@@ -150,8 +187,17 @@ private:
 	std::thread _mainThread;
 	int32_t _backlog = 100;
 	std::shared_ptr<BaseLib::FileDescriptor> _serverFileDescriptor;
+	EpollReactor _reactor;
 	std::mutex _newProcessMutex;
 	std::mutex _processMutex;
+	std::thread _warmPoolThread;
+	std::mutex _warmPoolMutex;
+	std::condition_variable _warmPoolConditionVariable;
+	bool _refillWarmPool = false;
+	std::mutex _warmPoolSettingsMutex;
+	std::atomic<uint32_t> _warmPoolMinSize{DEFAULT_WARM_POOL_MIN_SIZE};
+	std::atomic<uint32_t> _warmPoolMaxSize{DEFAULT_WARM_POOL_MAX_SIZE};
+	std::atomic<int64_t> _warmPoolIdleTimeout{DEFAULT_WARM_POOL_IDLE_TIMEOUT};
 	std::mutex _resourceMutex;
 	std::map<pid_t, PScriptEngineProcess> _processes;
 	std::mutex _currentScriptIdMutex;
@@ -163,6 +209,11 @@ private:
 	BaseLib::PRpcClientInfo _scriptEngineClientInfo;
 	std::map<std::string, std::shared_ptr<BaseLib::Rpc::RpcMethod>> _rpcMethods;
 	std::map<std::string, std::function<BaseLib::PVariable(PScriptEngineClientData& clientData, PClientScriptInfo scriptInfo, BaseLib::PArray& parameters)>> _localRpcMethods;
+
+	/**
+	 * The metrics entries of all methods in _rpcMethods and _localRpcMethods. Filled in the constructor and read only afterwards.
+	 */
+	Rpc::RpcMetrics::MethodMetricsTable _methodMetrics;
 	std::mutex _executeScriptMutex;
 	std::mutex _packetIdMutex;
 	int32_t _currentPacketId = 0;
@@ -192,7 +243,17 @@ private:
 
 	void mainThread();
 
-	void readClient(PScriptEngineClientData& clientData);
+	/**
+	 * Creates the client of a connection accepted by _reactor.
+	 */
+	void clientAccepted(std::shared_ptr<BaseLib::FileDescriptor>& clientFileDescriptor);
+
+	/**
+	 * Reads and processes one chunk of data from the client.
+	 *
+	 * @return Returns true when more data might be available.
+	 */
+	bool readClient(PScriptEngineClientData& clientData);
 
 	BaseLib::PVariable send(PScriptEngineClientData& clientData, std::vector<char>& data);
 
@@ -204,6 +265,36 @@ private:
 
 	PScriptEngineProcess getFreeProcess(bool nodeProcess, uint32_t maxThreadCount = 0);
 
+	/**
+	 * Starts a new script engine process and waits until it has registered. "_newProcessMutex" needs to be locked by the caller.
+	 */
+	PScriptEngineProcess spawnProcess(bool nodeProcess);
+
+	/**
+	 * Returns the number of connected processes of the given type without running scripts.
+	 */
+	uint32_t idleProcessCount(bool nodeProcess);
+
+	/**
+	 * Wakes up the warm pool thread to replace processes that have just been taken out of the pool.
+	 */
+	void refillWarmPool();
+
+	/**
+	 * Keeps "_warmPoolMinSize" idle processes of each type running.
+	 */
+	void warmPoolThread();
+
+	/**
+	 * Loads the warm pool settings from "scriptenginewarmpool.json" in the data directory.
+	 */
+	void loadWarmPool();
+
+	/**
+	 * Writes the warm pool settings to "scriptenginewarmpool.json". "_warmPoolSettingsMutex" needs to be locked by the caller.
+	 */
+	void saveWarmPool();
+
 	void unregisterNode(std::string nodeId);
 
 	void unregisterDevice(uint64_t peerId);
@@ -217,6 +308,11 @@ private:
 	void processQueueEntry(int32_t index, std::shared_ptr<BaseLib::IQueueEntry>& entry);
 
 	// {{{ RPC methods
+	/**
+	 * Creates a shared memory ring for all data sent to the client and passes it with the response.
+	 */
+	void openSharedMemoryRing(PScriptEngineClientData& clientData, BaseLib::PVariable& scriptId, BaseLib::PVariable& packetId);
+
 	BaseLib::PVariable registerScriptEngineClient(PScriptEngineClientData& clientData, BaseLib::PArray& parameters);
 
 	BaseLib::PVariable scriptFinished(PScriptEngineClientData& clientData, int32_t scriptId, BaseLib::PArray& parameters);
@@ -299,6 +395,14 @@ private:
 	BaseLib::PVariable getLicenseStates(PScriptEngineClientData& clientData, PClientScriptInfo scriptInfo, BaseLib::PArray& parameters);
 
 	BaseLib::PVariable getTrialStartTime(PScriptEngineClientData& clientData, PClientScriptInfo scriptInfo, BaseLib::PArray& parameters);
+
+	/**
+	 * Executes multiple RPC calls in one round trip. Expects an array of structs with the elements "methodName" and "params" like "system.multicall",
+	 * but calls script engine methods with the script's client info.
+	 *
+	 * @return Returns an array with the result of each call in the order of the calls.
+	 */
+	BaseLib::PVariable multicall(PScriptEngineClientData& clientData, PClientScriptInfo scriptInfo, BaseLib::PArray& parameters);
 	// }}}
 
 	// {{{ Flows
@@ -0,0 +1,261 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef NO_SCRIPTENGINE
+
+#include "ValueCache.h"
+#include "../GD/GD.h"
+
+namespace Homegear
+{
+
+namespace ScriptEngine
+{
+
+ValueCache::ValueCache()
+{
+	_enabled = false;
+	_hits = 0;
+	_misses = 0;
+	_sequenceGaps = 0;
+}
+
+ValueCache::~ValueCache()
+{
+	clear();
+}
+
+void ValueCache::setEnabled(bool enabled)
+{
+	_enabled = enabled;
+	if(!enabled) clear();
+}
+
+bool ValueCache::get(uint64_t peerId, int32_t channel, const std::string& variable, BaseLib::PVariable& value)
+{
+	if(!_enabled) return false;
+	try
+	{
+		std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+		auto cacheIterator = _cache.find(CacheKey(peerId, channel, variable));
+		if(cacheIterator != _cache.end() && !cacheIterator->second.pending && BaseLib::HelperFunctions::getTime() - cacheIterator->second.time <= MAX_AGE)
+		{
+			value = cacheIterator->second.value;
+			_hits++;
+			return true;
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	_misses++;
+	return false;
+}
+
+void ValueCache::reserve(uint64_t peerId, int32_t channel, const std::string& variable)
+{
+	if(!_enabled) return;
+	try
+	{
+		std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+		CacheKey key(peerId, channel, variable);
+		auto cacheIterator = _cache.find(key);
+		if(cacheIterator == _cache.end())
+		{
+			int64_t time = BaseLib::HelperFunctions::getTime();
+			if(_cache.size() >= MAX_ENTRIES) removeExpired(time);
+			if(_cache.size() >= MAX_ENTRIES) return;
+			CacheEntry& entry = _cache[key];
+			entry.time = time;
+		}
+		else
+		{
+			cacheIterator->second.pending = true;
+			cacheIterator->second.value.reset();
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void ValueCache::set(uint64_t peerId, int32_t channel, const std::string& variable, const BaseLib::PVariable& value)
+{
+	try
+	{
+		std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+		auto cacheIterator = _cache.find(CacheKey(peerId, channel, variable));
+		if(cacheIterator == _cache.end() || !cacheIterator->second.pending) return;
+		if(!value || value->errorStruct)
+		{
+			_cache.erase(cacheIterator);
+			return;
+		}
+		cacheIterator->second.value = value;
+		cacheIterator->second.pending = false;
+		cacheIterator->second.time = BaseLib::HelperFunctions::getTime();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void ValueCache::update(uint64_t sequenceNumber, uint64_t peerId, int32_t channel, const BaseLib::Array& variables, const BaseLib::Array& values)
+{
+	try
+	{
+		std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+		if(sequenceNumber != _lastSequenceNumber + 1)
+		{
+			//Events were lost or are processed out of order. Any entry might be outdated.
+			if(sequenceNumber > _lastSequenceNumber) _lastSequenceNumber = sequenceNumber;
+			_cache.clear();
+			_sequenceGaps++;
+			return;
+		}
+		_lastSequenceNumber = sequenceNumber;
+		if(_cache.empty()) return;
+
+		int64_t time = BaseLib::HelperFunctions::getTime();
+		for(uint32_t i = 0; i < variables.size() && i < values.size(); i++)
+		{
+			auto cacheIterator = _cache.find(CacheKey(peerId, channel, variables[i]->stringValue));
+			if(cacheIterator == _cache.end()) continue;
+			cacheIterator->second.value = values[i];
+			cacheIterator->second.pending = false;
+			cacheIterator->second.time = time;
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void ValueCache::erase(uint64_t peerId, int32_t channel, const std::string& variable)
+{
+	try
+	{
+		std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+		_cache.erase(CacheKey(peerId, channel, variable));
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void ValueCache::clear()
+{
+	try
+	{
+		std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+		_cache.clear();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void ValueCache::removeExpired(int64_t time)
+{
+	for(auto i = _cache.begin(); i != _cache.end();)
+	{
+		if(time - i->second.time > MAX_AGE) i = _cache.erase(i);
+		else ++i;
+	}
+}
+
+BaseLib::PVariable ValueCache::getStatistics()
+{
+	try
+	{
+		BaseLib::PVariable statistics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+		uint64_t hits = _hits;
+		uint64_t misses = _misses;
+		statistics->structValue->emplace("hits", std::make_shared<BaseLib::Variable>(hits));
+		statistics->structValue->emplace("misses", std::make_shared<BaseLib::Variable>(misses));
+		statistics->structValue->emplace("hitRate", std::make_shared<BaseLib::Variable>(hits + misses == 0 ? 0.0 : (double)hits / (double)(hits + misses)));
+		statistics->structValue->emplace("enabled", std::make_shared<BaseLib::Variable>((bool)_enabled));
+		statistics->structValue->emplace("sequenceGaps", std::make_shared<BaseLib::Variable>((uint64_t)_sequenceGaps));
+		{
+			std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+			statistics->structValue->emplace("entries", std::make_shared<BaseLib::Variable>((uint64_t)_cache.size()));
+		}
+		return statistics;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+}
+
+}
+
+#endif
@@ -0,0 +1,140 @@
+/* Copyright 2013-2017 Sathya Laufer
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef HOMEGEAR_VALUECACHE_H
+#define HOMEGEAR_VALUECACHE_H
+
+#ifndef NO_SCRIPTENGINE
+
+#include <homegear-base/BaseLib.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace Homegear
+{
+
+namespace ScriptEngine
+{
+
+/**
+ * Read-through cache for variable values requested by scripts. Entries are created on the first request and afterwards kept up to date by the events
+ * the script engine client receives. System variables are stored with peer ID 0 and channel -1, matching the events raised for them.
+ *
+ * The server numbers the events of each client consecutively. When an event is missing or arrives out of order, for example because the server's
+ * queue was full, the whole cache is cleared. The cache is disabled until the server confirms on registration that the client receives all events.
+ *
+ * To not overwrite a value from an event with an older value from a response, an entry is reserved before the request is sent. Responses are only
+ * stored while the entry is still pending.
+ */
+class ValueCache
+{
+public:
+	/**
+	 * The maximum number of cached values. When the cache is full, expired entries are removed. If there are none, new values are not cached.
+	 */
+	static const size_t MAX_ENTRIES = 10000;
+
+	/**
+	 * Time in milliseconds after which a value is requested again even without an event. Protects against values changed without raising an event
+	 * and bounds the age of values when the last events before a gap were lost.
+	 */
+	static const int64_t MAX_AGE = 5000;
+
+	ValueCache();
+	virtual ~ValueCache();
+
+	/**
+	 * Enables or disables the cache. Disabling clears all entries.
+	 */
+	void setEnabled(bool enabled);
+
+	/**
+	 * Returns a cached value.
+	 *
+	 * @return Returns true on a cache hit. In this case "value" is set.
+	 */
+	bool get(uint64_t peerId, int32_t channel, const std::string& variable, BaseLib::PVariable& value);
+
+	/**
+	 * Reserves an entry before requesting the value from the server.
+	 */
+	void reserve(uint64_t peerId, int32_t channel, const std::string& variable);
+
+	/**
+	 * Stores the value returned by the server, if no event updated the entry in the meantime. Errors remove the reservation.
+	 */
+	void set(uint64_t peerId, int32_t channel, const std::string& variable, const BaseLib::PVariable& value);
+
+	/**
+	 * Updates existing entries with the values of an event. Values that have never been requested are ignored.
+	 *
+	 * @param sequenceNumber The event's sequence number. When it doesn't directly follow the previous one, the cache is cleared instead.
+	 */
+	void update(uint64_t sequenceNumber, uint64_t peerId, int32_t channel, const BaseLib::Array& variables, const BaseLib::Array& values);
+
+	void erase(uint64_t peerId, int32_t channel, const std::string& variable);
+
+	void clear();
+
+	BaseLib::PVariable getStatistics();
+private:
+	typedef std::tuple<uint64_t, int32_t, std::string> CacheKey;
+
+	struct CacheEntry
+	{
+		BaseLib::PVariable value;
+		bool pending = true;
+		int64_t time = 0;
+	};
+
+	std::atomic_bool _enabled;
+	std::mutex _cacheMutex;
+	std::map<CacheKey, CacheEntry> _cache;
+	uint64_t _lastSequenceNumber = 0;
+
+	std::atomic<uint64_t> _hits;
+	std::atomic<uint64_t> _misses;
+	std::atomic<uint64_t> _sequenceGaps;
+
+	/**
+	 * Removes expired entries. "_cacheMutex" needs to be locked.
+	 */
+	void removeExpired(int64_t time);
+};
+
+}
+
+}
+
+#endif
+#endif
@@ -36,6 +36,7 @@
 #include <homegear-base/BaseLib.h>
 #include "../../config.h"
 #include "php_config_fixes.h"
+#include "CacheInfo.h"
 
 #include <zend_types.h>
 
@@ -50,7 +51,7 @@ typedef struct _zend_homegear_globals
 	std::function<BaseLib::PVariable(std::string methodName, BaseLib::PVariable parameters, bool wait)> rpcCallback;
 	BaseLib::Http http;
 	BaseLib::ScriptEngine::PScriptInfo scriptInfo;
-	std::forward_list<std::string> additionalStrings;
+	std::forward_list<std::shared_ptr<Homegear::ScriptEngine::CacheInfo>> cachedScripts;
 
 	bool webRequest = false;
 	bool commandLine = false;
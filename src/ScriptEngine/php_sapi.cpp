@@ -54,8 +54,7 @@
 
 static bool _disposed = true;
 static zend_homegear_superglobals _superglobals;
-static std::mutex _scriptCacheMutex;
-static std::map<std::string, std::shared_ptr<Homegear::ScriptEngine::CacheInfo>> _scriptCache;
+static Homegear::ScriptEngine::ScriptCache _scriptCache;
 
 static zend_class_entry* homegear_class_entry = nullptr;
 static zend_class_entry* homegear_gpio_class_entry = nullptr;
@@ -122,6 +121,8 @@ ZEND_FUNCTION(hg_check_license);
 ZEND_FUNCTION(hg_remove_license);
 ZEND_FUNCTION(hg_get_license_states);
 ZEND_FUNCTION(hg_poll_event);
+ZEND_FUNCTION(hg_set_event_queue_size);
+ZEND_FUNCTION(hg_get_event_queue_statistics);
 ZEND_FUNCTION(hg_list_rpc_clients);
 ZEND_FUNCTION(hg_peer_exists);
 ZEND_FUNCTION(hg_subscribe_peer);
@@ -174,6 +175,8 @@ static const zend_function_entry homegear_functions[] = {
 	ZEND_FE(hg_remove_license, NULL)
 	ZEND_FE(hg_get_license_states, NULL)
 	ZEND_FE(hg_poll_event, NULL)
+	ZEND_FE(hg_set_event_queue_size, NULL)
+	ZEND_FE(hg_get_event_queue_statistics, NULL)
 	ZEND_FE(hg_list_rpc_clients, NULL)
 	ZEND_FE(hg_peer_exists, NULL)
 	ZEND_FE(hg_subscribe_peer, NULL)
@@ -294,75 +297,26 @@ int hg_stream_open(const char *filename, zend_file_handle *handle)
 	std::string file(filename);
 	if(file.size() > 3 && (file.compare(file.size() - 4, 4, ".hgs") == 0 || file.compare(file.size() - 4, 4, ".hgn") == 0))
 	{
-        std::lock_guard<std::mutex> scriptCacheGuard(_scriptCacheMutex);
+		std::shared_ptr<Homegear::ScriptEngine::CacheInfo> cacheInfo = _scriptCache.get(file);
+		if(!cacheInfo) return FAILURE;
+
 		zend_homegear_globals* globals = php_homegear_get_globals();
-        std::map<std::string, std::shared_ptr<Homegear::ScriptEngine::CacheInfo>>::iterator scriptIterator = _scriptCache.find(file);
-        if(scriptIterator != _scriptCache.end() && scriptIterator->second->lastModified == BaseLib::Io::getFileLastModifiedTime(file))
-        {
-			globals->additionalStrings.push_front(scriptIterator->second->script);
-            handle->type = ZEND_HANDLE_MAPPED;
-            handle->handle.fp = nullptr;
-            handle->handle.stream.handle = nullptr;
-            handle->handle.stream.closer = nullptr;
-            memset(&handle->handle.stream.mmap, 0, sizeof(zend_mmap));
-            handle->handle.stream.mmap.buf = (char*)globals->additionalStrings.front().c_str(); //String is not modified
-            handle->handle.stream.mmap.len = scriptIterator->second->script.size();
-            handle->filename = filename;
-            handle->opened_path = nullptr;
-            handle->free_filename = 0;
-			return SUCCESS;
-        }
-        else
-        {
-            std::vector<char> data = BaseLib::Io::getBinaryFileContent(file);
-            int32_t pos = -1;
-            for(uint32_t i = 0; i < 11 && i < data.size(); i++)
-            {
-                if(data[i] == ' ')
-                {
-                    pos = (int32_t)i;
-                    break;
-                }
-            }
-            if(pos == -1)
-            {
-				Homegear::GD::bl->out.printError("Error: License module id is missing in encrypted script file \"" + file + "\"");
-                return FAILURE;
-            }
-            std::string moduleIdString(&data.at(0), static_cast<unsigned long>(pos));
-            int32_t moduleId = BaseLib::Math::getNumber(moduleIdString);
-            std::vector<char> input(&data.at(static_cast<unsigned long>(pos + 1)), &data.at(data.size() - 1) + 1);
-            if(input.empty()) return FAILURE;
-            std::map<int32_t, std::unique_ptr<BaseLib::Licensing::Licensing>>::iterator i = Homegear::GD::licensingModules.find(moduleId);
-            if(i == Homegear::GD::licensingModules.end() || !i->second)
-            {
-				Homegear::GD::out.printError("Error: Could not decrypt script file. Licensing module with id 0x" + BaseLib::HelperFunctions::getHexString(moduleId) + " not found");
-                return FAILURE;
-            }
-            std::shared_ptr<Homegear::ScriptEngine::CacheInfo> cacheInfo = std::make_shared<Homegear::ScriptEngine::CacheInfo>();
-            i->second->decryptScript(input, cacheInfo->script);
-            cacheInfo->lastModified = BaseLib::Io::getFileLastModifiedTime(file);
-            if(!cacheInfo->script.empty())
-            {
-				globals->additionalStrings.push_front(cacheInfo->script);
-                _scriptCache[file] = cacheInfo;
-                handle->type = ZEND_HANDLE_MAPPED;
-                handle->handle.fp = nullptr;
-                handle->handle.stream.handle = nullptr;
-                handle->handle.stream.closer = nullptr;
-                memset(&handle->handle.stream.mmap, 0, sizeof(zend_mmap));
-                handle->handle.stream.mmap.buf = (char*)globals->additionalStrings.front().c_str(); //String is not modified
-                handle->handle.stream.mmap.len = cacheInfo->script.size();
-                handle->filename = filename;
-                handle->opened_path = nullptr;
-                handle->free_filename = 0;
-				return SUCCESS;
-            }
-			else return FAILURE;
-        }
+		globals->cachedScripts.push_front(cacheInfo); //Keeps the source alive until the thread finishes, even if the entry is evicted in the meantime.
+		handle->type = ZEND_HANDLE_MAPPED;
+		handle->handle.fp = nullptr;
+		handle->handle.stream.handle = nullptr;
+		handle->handle.stream.closer = nullptr;
+		memset(&handle->handle.stream.mmap, 0, sizeof(zend_mmap));
+		handle->handle.stream.mmap.buf = (char*)cacheInfo->script.c_str(); //String is not modified
+		handle->handle.stream.mmap.len = cacheInfo->script.size();
+		handle->filename = filename;
+		handle->opened_path = nullptr;
+		handle->free_filename = 0;
+		return SUCCESS;
 	}
 	else
 	{
+		//Plain files are opened as a file handle, so OPcache can cache the compiled script by path and modification time.
 		//{{{ 100% from zend_stream_open in zend_stream.c */
 		handle->type = ZEND_HANDLE_FP;
 		handle->opened_path = nullptr;
@@ -1131,6 +1085,62 @@ ZEND_FUNCTION(hg_register_thread)
 	}
 // }}}
 
+static std::shared_ptr<Homegear::PhpEvents> php_homegear_get_php_events()
+{
+	std::unique_lock<std::mutex> eventsMapGuard(Homegear::PhpEvents::eventsMapMutex);
+	std::map<int32_t, std::shared_ptr<Homegear::PhpEvents>>::iterator eventsIterator = Homegear::PhpEvents::eventsMap.find(SEG(id));
+	if(eventsIterator == Homegear::PhpEvents::eventsMap.end())
+	{
+		eventsMapGuard.unlock();
+		zend_throw_exception(homegear_exception_class_entry, "Script id is invalid.", -1);
+		return std::shared_ptr<Homegear::PhpEvents>();
+	}
+	if(!eventsIterator->second) eventsIterator->second = std::make_shared<Homegear::PhpEvents>(SEG(id), SEG(token), SEG(outputCallback), SEG(rpcCallback));
+	return eventsIterator->second;
+}
+
+static void php_homegear_get_event(const std::shared_ptr<Homegear::PhpEvents::EventData>& eventData, zval* event)
+{
+	array_init(event);
+	zval element;
+
+	if(!eventData->type.empty())
+	{
+		ZVAL_STRINGL(&element, eventData->type.c_str(), eventData->type.size());
+		add_assoc_zval_ex(event, "TYPE", sizeof("TYPE") - 1, &element);
+	}
+
+	if(!eventData->source.empty())
+	{
+		ZVAL_STRINGL(&element, eventData->source.c_str(), eventData->source.size());
+		add_assoc_zval_ex(event, "EVENTSOURCE", sizeof("EVENTSOURCE") - 1, &element);
+	}
+
+	ZVAL_LONG(&element, eventData->id);
+	add_assoc_zval_ex(event, "PEERID", sizeof("PEERID") - 1, &element);
+
+	ZVAL_LONG(&element, eventData->channel);
+	add_assoc_zval_ex(event, "CHANNEL", sizeof("CHANNEL") - 1, &element);
+
+	if(!eventData->variable.empty())
+	{
+		ZVAL_STRINGL(&element, eventData->variable.c_str(), eventData->variable.size());
+		add_assoc_zval_ex(event, "VARIABLE", sizeof("VARIABLE") - 1, &element);
+	}
+
+	if(eventData->hint != -1)
+	{
+		ZVAL_LONG(&element, eventData->hint);
+		add_assoc_zval_ex(event, "HINT", sizeof("HINT") - 1, &element);
+	}
+
+	if(eventData->value)
+	{
+		Homegear::PhpVariableConverter::getPHPVariable(eventData->value, &element);
+		add_assoc_zval_ex(event, "VALUE", sizeof("VALUE") - 1, &element);
+	}
+}
+
 ZEND_FUNCTION(hg_poll_event)
 {
 	if(_disposed) RETURN_NULL();
@@ -1148,69 +1158,72 @@ ZEND_FUNCTION(hg_poll_event)
 	zval* args = nullptr;
 	if(zend_parse_parameters(ZEND_NUM_ARGS(), "*", &args, &argc) != SUCCESS) RETURN_NULL();
 	int32_t timeout = -1;
-	if(argc > 1) php_error_docref(NULL, E_WARNING, "Too many arguments passed to Homegear::pollEvent().");
-	else if(argc == 1)
-	{
-		if(Z_TYPE(args[0]) != IS_LONG) php_error_docref(NULL, E_WARNING, "timeout is not of type int.");
-		else timeout = Z_LVAL(args[0]);
-	}
-
-	std::shared_ptr<Homegear::PhpEvents> phpEvents;
-	{
-		std::unique_lock<std::mutex> eventsMapGuard(Homegear::PhpEvents::eventsMapMutex);
-		std::map<int32_t, std::shared_ptr<Homegear::PhpEvents>>::iterator eventsIterator = Homegear::PhpEvents::eventsMap.find(SEG(id));
-		if(eventsIterator == Homegear::PhpEvents::eventsMap.end())
-		{
-			eventsMapGuard.unlock();
-			zend_throw_exception(homegear_exception_class_entry, "Script id is invalid.", -1);
-			RETURN_FALSE
-		}
-		if(!eventsIterator->second) eventsIterator->second = std::make_shared<Homegear::PhpEvents>(SEG(token), SEG(outputCallback), SEG(rpcCallback));
-		phpEvents = eventsIterator->second;
-	}
-	std::shared_ptr<Homegear::PhpEvents::EventData> eventData = phpEvents->poll(timeout);
-	if(eventData)
+	int32_t maxEvents = 0;
+	if(argc > 2) php_error_docref(NULL, E_WARNING, "Too many arguments passed to Homegear::pollEvent().");
+	else
 	{
-		array_init(return_value);
-		zval element;
-
-		if(!eventData->type.empty())
+		if(argc >= 1)
 		{
-			ZVAL_STRINGL(&element, eventData->type.c_str(), eventData->type.size());
-			add_assoc_zval_ex(return_value, "TYPE", sizeof("TYPE") - 1, &element);
+			if(Z_TYPE(args[0]) != IS_LONG) php_error_docref(NULL, E_WARNING, "timeout is not of type int.");
+			else timeout = Z_LVAL(args[0]);
 		}
-
-		if(!eventData->source.empty())
+		if(argc == 2)
 		{
-			ZVAL_STRINGL(&element, eventData->source.c_str(), eventData->source.size());
-			add_assoc_zval_ex(return_value, "EVENTSOURCE", sizeof("EVENTSOURCE") - 1, &element);
+			if(Z_TYPE(args[1]) != IS_LONG) php_error_docref(NULL, E_WARNING, "maxEvents is not of type int.");
+			else maxEvents = Z_LVAL(args[1]);
 		}
+	}
 
-		ZVAL_LONG(&element, eventData->id);
-		add_assoc_zval_ex(return_value, "PEERID", sizeof("PEERID") - 1, &element);
-
-		ZVAL_LONG(&element, eventData->channel);
-		add_assoc_zval_ex(return_value, "CHANNEL", sizeof("CHANNEL") - 1, &element);
+	std::shared_ptr<Homegear::PhpEvents> phpEvents = php_homegear_get_php_events();
+	if(!phpEvents) RETURN_FALSE
 
-		if(!eventData->variable.empty())
+	if(maxEvents > 0)
+	{
+		//Batch retrieval: Return an array of up to maxEvents events
+		std::vector<std::shared_ptr<Homegear::PhpEvents::EventData>> events = phpEvents->pollMultiple(maxEvents, timeout);
+		if(events.empty()) RETURN_FALSE
+		array_init_size(return_value, events.size());
+		for(auto& eventData : events)
 		{
-			ZVAL_STRINGL(&element, eventData->variable.c_str(), eventData->variable.size());
-			add_assoc_zval_ex(return_value, "VARIABLE", sizeof("VARIABLE") - 1, &element);
+			zval event;
+			php_homegear_get_event(eventData, &event);
+			add_next_index_zval(return_value, &event);
 		}
+		return;
+	}
 
-		if(eventData->hint != -1)
-		{
-			ZVAL_LONG(&element, eventData->hint);
-			add_assoc_zval_ex(return_value, "HINT", sizeof("HINT") - 1, &element);
-		}
+	std::shared_ptr<Homegear::PhpEvents::EventData> eventData = phpEvents->poll(timeout);
+	if(eventData) php_homegear_get_event(eventData, return_value);
+	else RETURN_FALSE
+}
 
-		if(eventData->value)
-		{
-            Homegear::PhpVariableConverter::getPHPVariable(eventData->value, &element);
-			add_assoc_zval_ex(return_value, "VALUE", sizeof("VALUE") - 1, &element);
-		}
+ZEND_FUNCTION(hg_set_event_queue_size)
+{
+	if(_disposed) RETURN_NULL();
+	if(SEG(id) == 0)
+	{
+		zend_throw_exception(homegear_exception_class_entry, "Script id is unset. Did you call \"registerThread\"?", -1);
+		RETURN_FALSE
 	}
-	else RETURN_FALSE
+	long size = 0;
+	if(zend_parse_parameters(ZEND_NUM_ARGS(), "l", &size) != SUCCESS) RETURN_NULL();
+	std::shared_ptr<Homegear::PhpEvents> phpEvents = php_homegear_get_php_events();
+	if(!phpEvents) RETURN_FALSE
+	phpEvents->setQueueSize(size > Homegear::PhpEvents::MAX_QUEUE_SIZE ? Homegear::PhpEvents::MAX_QUEUE_SIZE : (int32_t)size);
+	RETURN_LONG(phpEvents->getQueueSize());
+}
+
+ZEND_FUNCTION(hg_get_event_queue_statistics)
+{
+	if(_disposed) RETURN_NULL();
+	if(SEG(id) == 0)
+	{
+		zend_throw_exception(homegear_exception_class_entry, "Script id is unset. Did you call \"registerThread\"?", -1);
+		RETURN_FALSE
+	}
+	std::shared_ptr<Homegear::PhpEvents> phpEvents = php_homegear_get_php_events();
+	if(!phpEvents) RETURN_FALSE
+	Homegear::PhpVariableConverter::getPHPVariable(phpEvents->getStatistics(), return_value);
 }
 
 ZEND_FUNCTION(hg_list_rpc_clients)
@@ -1277,19 +1290,8 @@ ZEND_FUNCTION(hg_subscribe_peer)
 		}
 	}
 
-	std::shared_ptr<Homegear::PhpEvents> phpEvents;
-	{
-		std::unique_lock<std::mutex> eventsMapGuard(Homegear::PhpEvents::eventsMapMutex);
-		std::map<int32_t, std::shared_ptr<Homegear::PhpEvents>>::iterator eventsIterator = Homegear::PhpEvents::eventsMap.find(SEG(id));
-		if(eventsIterator == Homegear::PhpEvents::eventsMap.end())
-		{
-			eventsMapGuard.unlock();
-			zend_throw_exception(homegear_exception_class_entry, "Script id is invalid.", -1);
-			RETURN_FALSE
-		}
-		if(!eventsIterator->second) eventsIterator->second.reset(new Homegear::PhpEvents(SEG(token), SEG(outputCallback), SEG(rpcCallback)));
-		phpEvents = eventsIterator->second;
-	}
+	std::shared_ptr<Homegear::PhpEvents> phpEvents = php_homegear_get_php_events();
+	if(!phpEvents) RETURN_FALSE
 	phpEvents->addPeer(peerId, channel, variable);
 }
 
@@ -1337,19 +1339,8 @@ ZEND_FUNCTION(hg_unsubscribe_peer)
 			peerId = Z_LVAL(args[0]);
 		}
 	}
-	std::shared_ptr<Homegear::PhpEvents> phpEvents;
-	{
-		std::unique_lock<std::mutex> eventsMapGuard(Homegear::PhpEvents::eventsMapMutex);
-		std::map<int32_t, std::shared_ptr<Homegear::PhpEvents>>::iterator eventsIterator = Homegear::PhpEvents::eventsMap.find(SEG(id));
-		if(eventsIterator == Homegear::PhpEvents::eventsMap.end())
-		{
-			eventsMapGuard.unlock();
-			zend_throw_exception(homegear_exception_class_entry, "Script id is invalid.", -1);
-			RETURN_FALSE
-		}
-		if(!eventsIterator->second) eventsIterator->second.reset(new Homegear::PhpEvents(SEG(token), SEG(outputCallback), SEG(rpcCallback)));
-		phpEvents = eventsIterator->second;
-	}
+	std::shared_ptr<Homegear::PhpEvents> phpEvents = php_homegear_get_php_events();
+	if(!phpEvents) RETURN_FALSE
 	phpEvents->removePeer(peerId, channel, variable);
 }
 
@@ -2385,6 +2376,8 @@ static const zend_function_entry homegear_methods[] = {
     ZEND_ME_MAPPING(ssdpSearch, hg_ssdp_search, NULL, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     ZEND_ME_MAPPING(configureGateway, hg_configure_gateway, NULL, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
 	ZEND_ME_MAPPING(pollEvent, hg_poll_event, NULL, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+	ZEND_ME_MAPPING(setEventQueueSize, hg_set_event_queue_size, NULL, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+	ZEND_ME_MAPPING(getEventQueueStatistics, hg_get_event_queue_statistics, NULL, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
 	ZEND_ME_MAPPING(setLanguage, hg_set_language, NULL, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
 	ZEND_ME_MAPPING(setUserPrivileges, hg_set_user_privileges, NULL, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
 	ZEND_ME_MAPPING(subscribePeer, hg_subscribe_peer, NULL, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
@@ -2456,11 +2449,27 @@ int php_homegear_init()
 
 	sapi_module.startup(&php_homegear_sapi_module);
 
+	//Web roots are added when the first web script is executed (see ScriptEngineClient).
+	_scriptCache.watch(Homegear::GD::bl->settings.scriptPath());
+	_scriptCache.watch(Homegear::GD::bl->settings.nodeBluePath());
+
 	return SUCCESS;
 }
 
+BaseLib::PVariable php_homegear_get_script_cache_statistics()
+{
+	return _scriptCache.getStatistics();
+}
+
+void php_homegear_watch_script_path(const std::string& path)
+{
+	_scriptCache.watch(path);
+}
+
 void php_homegear_deinit()
 {
+	_scriptCache.stopWatching();
+	_scriptCache.clear();
 	_disposed = true;
 	if(_disposed) return;
 	php_homegear_sapi_module.shutdown(&php_homegear_sapi_module);
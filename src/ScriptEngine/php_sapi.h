@@ -35,7 +35,7 @@
 
 #include <homegear-base/BaseLib.h>
 #include "PhpEvents.h"
-#include "CacheInfo.h"
+#include "ScriptCache.h"
 #include "php_homegear_globals.h"
 #include "php_node.h"
 #include "php_device.h"
@@ -60,6 +60,8 @@
 void php_homegear_build_argv(std::vector<std::string>& arguments);
 int php_homegear_init();
 void php_homegear_deinit();
+BaseLib::PVariable php_homegear_get_script_cache_statistics();
+void php_homegear_watch_script_path(const std::string& path);
 
 #endif
 #endif
@@ -32,6 +32,8 @@
 #include "../GD/GD.h"
 #include <homegear-base/BaseLib.h>
 
+#include <algorithm>
+
 namespace Homegear
 {
 
@@ -206,6 +208,7 @@ void FamilyController::onRPCEvent(std::string source, uint64_t id, int32_t chann
 {
 	try
 	{
+		invalidateValuesSnapshot();
 		GD::rpcClient->broadcastEvent(source, id, channel, deviceAddress, valueKeys, values);
 	}
 	catch(const std::exception& ex)
@@ -226,6 +229,7 @@ void FamilyController::onRPCUpdateDevice(uint64_t id, int32_t channel, std::stri
 {
 	try
 	{
+		invalidateValuesSnapshot();
 		GD::rpcClient->broadcastUpdateDevice(id, channel, address, (Rpc::Client::Hint::Enum) hint);
 	}
 	catch(const std::exception& ex)
@@ -246,6 +250,7 @@ void FamilyController::onRPCNewDevices(std::vector<uint64_t>& ids, BaseLib::PVar
 {
 	try
 	{
+		invalidateValuesSnapshot();
 		GD::rpcClient->broadcastNewDevices(ids, deviceDescriptions);
 	}
 	catch(const std::exception& ex)
@@ -266,6 +271,7 @@ void FamilyController::onRPCDeleteDevices(std::vector<uint64_t>& ids, BaseLib::P
 {
 	try
 	{
+		invalidateValuesSnapshot();
 		GD::rpcClient->broadcastDeleteDevices(ids, deviceAddresses, deviceInfo);
 	}
 	catch(const std::exception& ex)
@@ -611,6 +617,7 @@ int32_t FamilyController::loadModule(std::string filename)
 			return -3;
 		}
 		_rpcCache.reset();
+		invalidateValuesSnapshot();
 		_moduleLoadersMutex.unlock();
 		return 0;
 	}
@@ -682,6 +689,7 @@ int32_t FamilyController::unloadModule(std::string filename)
 		_moduleLoaders.erase(moduleLoaderIterator);
 
 		_rpcCache.reset();
+		invalidateValuesSnapshot();
 		_moduleLoadersMutex.unlock();
 		GD::out.printInfo("Info: " + filename + " unloaded.");
 		return 0;
@@ -1087,6 +1095,171 @@ BaseLib::PVariable FamilyController::listFamilies(int32_t familyId)
 	return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
+// {{{ Value snapshot
+void FamilyController::getCentralValues(std::shared_ptr<BaseLib::Systems::DeviceFamily> family, BaseLib::PRpcClientInfo clientInfo, bool returnWriteOnly, bool checkAcls, BaseLib::PVariable* result)
+{
+	try
+	{
+		std::shared_ptr<BaseLib::Systems::ICentral> central = family->getCentral();
+		if(!central) return;
+		*result = central->getAllValues(clientInfo, std::make_shared<BaseLib::Array>(), returnWriteOnly, checkAcls);
+		if(*result && (*result)->errorStruct)
+		{
+			GD::out.printWarning("Warning: Error calling method \"getAllValues\" on device family " + family->getName() + ": " + (*result)->structValue->at("faultString")->stringValue);
+			result->reset();
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+BaseLib::PVariable FamilyController::getAllValues(BaseLib::PRpcClientInfo clientInfo, bool returnWriteOnly, bool checkAcls)
+{
+	try
+	{
+		//The version needs to be read before querying the families, so events raised during the query invalidate the result.
+		uint64_t version = _valuesSnapshotVersion;
+		ValuesSnapshot& snapshot = _valuesSnapshot[returnWriteOnly ? 1 : 0];
+		if(!checkAcls)
+		{
+			std::lock_guard<std::mutex> valuesSnapshotGuard(_valuesSnapshotMutex);
+			if(snapshot.values && snapshot.version == version && BaseLib::HelperFunctions::getTime() - snapshot.time <= VALUES_SNAPSHOT_MAX_AGE) return copySnapshot(snapshot);
+		}
+
+		BaseLib::PVariable values = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+		if(_disposed) return values;
+
+		std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = getFamilies();
+		std::vector<BaseLib::PVariable> results(families.size());
+		std::vector<std::thread> threads(families.size());
+		std::vector<bool> threadStarted(families.size(), false);
+		size_t index = 0;
+		for(auto& family : families)
+		{
+			if(family.second)
+			{
+				//Fall back to querying the family in this thread when no more threads are available.
+				if(families.size() > 1 && GD::bl->threadManager.start(threads.at(index), false, &FamilyController::getCentralValues, this, family.second, clientInfo, returnWriteOnly, checkAcls, &results.at(index))) threadStarted.at(index) = true;
+				else getCentralValues(family.second, clientInfo, returnWriteOnly, checkAcls, &results.at(index));
+			}
+			index++;
+		}
+
+		size_t valueCount = 0;
+		for(size_t i = 0; i < threads.size(); i++)
+		{
+			if(threadStarted.at(i)) GD::bl->threadManager.join(threads.at(i));
+			if(results.at(i)) valueCount += results.at(i)->arrayValue->size();
+		}
+
+		values->arrayValue->reserve(valueCount);
+		for(auto& result : results)
+		{
+			if(result && !result->arrayValue->empty()) values->arrayValue->insert(values->arrayValue->end(), result->arrayValue->begin(), result->arrayValue->end());
+		}
+
+		if(!checkAcls)
+		{
+			std::lock_guard<std::mutex> valuesSnapshotGuard(_valuesSnapshotMutex);
+			if(version >= snapshot.version)
+			{
+				snapshot.version = version;
+				snapshot.time = BaseLib::HelperFunctions::getTime();
+				snapshot.values = values;
+				snapshot.copies.clear();
+				return copySnapshot(snapshot);
+			}
+		}
+
+		return values;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable FamilyController::copySnapshot(ValuesSnapshot& snapshot)
+{
+	BaseLib::PVariable copy = copyValues(snapshot.values);
+	snapshot.copies.erase(std::remove_if(snapshot.copies.begin(), snapshot.copies.end(), [](const std::weak_ptr<BaseLib::Variable>& element) { return element.expired(); }), snapshot.copies.end());
+	snapshot.copies.emplace_back(copy);
+	return copy;
+}
+
+BaseLib::PVariable FamilyController::copyValues(const BaseLib::PVariable& values)
+{
+	if(values->type == BaseLib::VariableType::tArray)
+	{
+		BaseLib::PVariable copy = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+		copy->arrayValue->reserve(values->arrayValue->size());
+		for(auto& element : *values->arrayValue)
+		{
+			copy->arrayValue->push_back(copyValues(element));
+		}
+		return copy;
+	}
+	else if(values->type == BaseLib::VariableType::tStruct)
+	{
+		BaseLib::PVariable copy = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+		for(auto& element : *values->structValue)
+		{
+			copy->structValue->emplace(element.first, copyValues(element.second));
+		}
+		return copy;
+	}
+	return std::make_shared<BaseLib::Variable>(*values);
+}
+
+BaseLib::PVariable FamilyController::getValuesSnapshot(const BaseLib::PVariable& variable)
+{
+	try
+	{
+		if(!variable) return BaseLib::PVariable();
+		std::lock_guard<std::mutex> valuesSnapshotGuard(_valuesSnapshotMutex);
+		for(auto& snapshot : _valuesSnapshot)
+		{
+			for(auto& copy : snapshot.copies)
+			{
+				if(copy.lock() == variable) return snapshot.values;
+			}
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return BaseLib::PVariable();
+}
+// }}}
+
 uint32_t FamilyController::physicalInterfaceCount(int32_t family)
 {
 	uint32_t size = 0;
@@ -38,6 +38,7 @@
 #include <vector>
 #include <memory>
 #include <mutex>
+#include <atomic>
 
 #include <dlfcn.h>
 
@@ -204,10 +205,56 @@ public:
 
 	BaseLib::PVariable listFamilies(int32_t familyId);
 
+	// {{{ Value snapshot
+	/**
+	 * Returns the values of all peers of all families. The families are queried in parallel. When no ACLs need to be
+	 * checked, the result is served from a snapshot which stays valid until the next value change event or until it is
+	 * older than VALUES_SNAPSHOT_MAX_AGE milliseconds. Every caller gets its own copy of the snapshot.
+	 *
+	 * @param clientInfo The client info of the calling client.
+	 * @param returnWriteOnly Passed on to ICentral::getAllValues().
+	 * @param checkAcls Set to true when the client's ACLs need to be checked for every peer.
+	 * @return Returns an array with the values of all peers.
+	 */
+	BaseLib::PVariable getAllValues(BaseLib::PRpcClientInfo clientInfo, bool returnWriteOnly, bool checkAcls);
+
+	/**
+	 * Returns the snapshot a variable returned by getAllValues() was copied from or nullptr when it isn't such a copy.
+	 * The snapshot is shared and must not be modified.
+	 */
+	BaseLib::PVariable getValuesSnapshot(const BaseLib::PVariable& variable);
+
+	/**
+	 * Marks all value snapshots as outdated. Needs to be called after values or metadata (names, rooms or categories)
+	 * of peers changed.
+	 */
+	void invalidateValuesSnapshot() { _valuesSnapshotVersion++; }
+
+	uint64_t valuesSnapshotVersion() { return _valuesSnapshotVersion; }
+	// }}}
+
 private:
+	struct ValuesSnapshot
+	{
+		uint64_t version = 0;
+		int64_t time = 0;
+		BaseLib::PVariable values;
+
+		/**
+		 * The copies of "values" handed out by getAllValues() which are still in use.
+		 */
+		std::vector<std::weak_ptr<BaseLib::Variable>> copies;
+	};
+
+	static const int64_t VALUES_SNAPSHOT_MAX_AGE = 10000;
+
 	bool _disposed = false;
 	BaseLib::PVariable _rpcCache;
 
+	std::atomic<uint64_t> _valuesSnapshotVersion{0};
+	std::mutex _valuesSnapshotMutex;
+	ValuesSnapshot _valuesSnapshot[2];
+
 	std::mutex _moduleLoadersMutex;
 	std::map<std::string, std::unique_ptr<ModuleLoader>> _moduleLoaders;
 	std::map<int32_t, std::string> _moduleFilenames;
@@ -217,6 +264,18 @@ private:
 
 	std::shared_ptr<BaseLib::RpcClientInfo> _dummyClientInfo;
 
+	/**
+	 * Copies "snapshot.values" and remembers the copy, so getValuesSnapshot() can find the snapshot again. _valuesSnapshotMutex needs to be locked.
+	 */
+	BaseLib::PVariable copySnapshot(ValuesSnapshot& snapshot);
+
+	/**
+	 * Copies a variable including all array and struct elements.
+	 */
+	static BaseLib::PVariable copyValues(const BaseLib::PVariable& values);
+
+	void getCentralValues(std::shared_ptr<BaseLib::Systems::DeviceFamily> family, BaseLib::PRpcClientInfo clientInfo, bool returnWriteOnly, bool checkAcls, BaseLib::PVariable* result);
+
 	FamilyController(const FamilyController&);
 
 	FamilyController& operator=(const FamilyController&);
@@ -109,16 +109,24 @@ void WebServer::get(BaseLib::Http& http, std::shared_ptr<BaseLib::TcpSocket> soc
 		{
 			_out.printInfo("Client is requesting: " + http.getHeader().path + " (translated to " + _serverInfo->contentPath + path + ", method: GET)");
 			std::string responseEncoding;
-			std::string contentString = GD::nodeBlueServer->handleGet(path, http, responseEncoding);
+			std::vector<std::string> headers;
+			std::string contentString = GD::nodeBlueServer->handleGet(path, http, responseEncoding, headers);
 			if(contentString == "unauthorized")
 			{
 				getError(401, _http.getStatusText(401), "You are not logged in.", content);
 				send(socket, content);
 				return;
 			}
+			else if(contentString == "notmodified")
+			{
+				std::string header;
+				_http.constructHeader(0, responseEncoding, 304, "Not Modified", headers, header);
+				content.insert(content.end(), header.begin(), header.end());
+				send(socket, content);
+				return;
+			}
 			else if(!contentString.empty())
 			{
-				std::vector<std::string> headers;
 				std::string header;
 				_http.constructHeader(contentString.size(), responseEncoding, 200, "OK", headers, header);
 				content.insert(content.end(), header.begin(), header.end());